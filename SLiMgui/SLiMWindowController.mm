@@ -2066,6 +2066,12 @@
 		[content appendAttributedString:[NSAttributedString attributedStringForByteCount:mem_last.mutationRefcountBuffer total:final_total attributes:menlo11_d]];
 		[content eidosAppendString:@" : refcount buffer\n" attributes:optima13_d];
 		
+		[content eidosAppendString:@"   " attributes:menlo11_d];
+		[content appendAttributedString:[NSAttributedString attributedStringForByteCount:mem_tot.mutationHotBuffers / div total:average_total attributes:menlo11_d]];
+		[content eidosAppendString:@" / " attributes:optima13_d];
+		[content appendAttributedString:[NSAttributedString attributedStringForByteCount:mem_last.mutationHotBuffers total:final_total attributes:menlo11_d]];
+		[content eidosAppendString:@" : hot side buffers\n" attributes:optima13_d];
+		
 		[content eidosAppendString:@"   " attributes:menlo11_d];
 		[content appendAttributedString:[NSAttributedString attributedStringForByteCount:mem_tot.mutationUnusedPoolSpace / div total:average_total attributes:menlo11_d]];
 		[content eidosAppendString:@" / " attributes:optima13_d];
@@ -2239,65 +2245,8 @@
 	profileElapsedWallClock = 0;
 	profileStartGeneration = sim->Generation();
 	
-	// call this first, which has the side effect of emptying out any pending profile counts
-	sim->CollectSLiMguiMutationProfileInfo();
-	
-	// zero out profile counts for generation stages
-	sim->profile_stage_totals_[0] = 0;
-	sim->profile_stage_totals_[1] = 0;
-	sim->profile_stage_totals_[2] = 0;
-	sim->profile_stage_totals_[3] = 0;
-	sim->profile_stage_totals_[4] = 0;
-	sim->profile_stage_totals_[5] = 0;
-	sim->profile_stage_totals_[6] = 0;
-	
-	// zero out profile counts for callback types (note SLiMEidosUserDefinedFunction is excluded; that is not a category we profile)
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosEventEarly)] = 0;
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosEventLate)] = 0;
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosInitializeCallback)] = 0;
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosFitnessCallback)] = 0;
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback)] = 0;
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosInteractionCallback)] = 0;
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)] = 0;
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosModifyChildCallback)] = 0;
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosRecombinationCallback)] = 0;
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMutationCallback)] = 0;
-	sim->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosReproductionCallback)] = 0;
-	
-	// zero out profile counts for script blocks; dynamic scripts will be zeroed on construction
-	std::vector<SLiMEidosBlock*> &script_blocks = sim->AllScriptBlocks();
-	
-	for (SLiMEidosBlock *script_block : script_blocks)
-		if (script_block->type_ != SLiMEidosBlockType::SLiMEidosUserDefinedFunction)	// exclude user-defined functions; not user-visible as blocks
-			script_block->root_node_->ZeroProfileTotals();
-	
-	// zero out profile counts for all user-defined functions
-	EidosFunctionMap &function_map = sim->FunctionMap();
-	
-	for (auto functionPairIter = function_map.begin(); functionPairIter != function_map.end(); ++functionPairIter)
-	{
-		const EidosFunctionSignature *signature = functionPairIter->second.get();
-		
-		if (signature->body_script_ && signature->user_defined_)
-			signature->body_script_->AST()->ZeroProfileTotals();
-	}
-	
-#if SLIM_USE_NONNEUTRAL_CACHES
-	// zero out mutation run metrics
-	sim->profile_mutcount_history_.clear();
-	sim->profile_nonneutral_regime_history_.clear();
-	sim->profile_mutation_total_usage_ = 0;
-	sim->profile_nonneutral_mutation_total_ = 0;
-	sim->profile_mutrun_total_usage_ = 0;
-	sim->profile_unique_mutrun_total_ = 0;
-	sim->profile_mutrun_nonneutral_recache_total_ = 0;
-	sim->profile_max_mutation_index_ = 0;
-#endif
-	
-	// zero out memory usage metrics
-	EIDOS_BZERO(&sim->profile_last_memory_usage_, sizeof(SLiM_MemoryUsage));
-	EIDOS_BZERO(&sim->profile_total_memory_usage_, sizeof(SLiM_MemoryUsage));
-	sim->total_memory_tallies_ = 0;
+	// zero out the profile counts kept by the simulation; this is shared with the command-line -profile option
+	sim->StartProfiling();
 }
 
 - (void)endProfiling
@@ -203,7 +203,7 @@ void Chromosome::InitializeDraws(void)
 	// Now remake our mutation map info, which we delegate to _InitializeOneMutationMap()
 	if (single_mutation_map_)
 	{
-		_InitializeOneMutationMap(lookup_mutation_H_, mutation_end_positions_H_, mutation_rates_H_, overall_mutation_rate_H_, exp_neg_overall_mutation_rate_H_, mutation_subranges_H_);
+		_InitializeOneMutationMap(lookup_mutation_H_, mutation_end_positions_H_, mutation_rates_H_, overall_mutation_rate_H_, exp_neg_overall_mutation_rate_H_, mutation_subranges_H_, overlay_subranges_H_);
 		
 		// Copy the H rates into the M and F ivars, so that they can be used by DrawMutationAndBreakpointCounts() if needed
 		overall_mutation_rate_M_ = overall_mutation_rate_F_ = overall_mutation_rate_H_;
@@ -211,8 +211,8 @@ void Chromosome::InitializeDraws(void)
 	}
 	else
 	{
-		_InitializeOneMutationMap(lookup_mutation_M_, mutation_end_positions_M_, mutation_rates_M_, overall_mutation_rate_M_, exp_neg_overall_mutation_rate_M_, mutation_subranges_M_);
-		_InitializeOneMutationMap(lookup_mutation_F_, mutation_end_positions_F_, mutation_rates_F_, overall_mutation_rate_F_, exp_neg_overall_mutation_rate_F_, mutation_subranges_F_);
+		_InitializeOneMutationMap(lookup_mutation_M_, mutation_end_positions_M_, mutation_rates_M_, overall_mutation_rate_M_, exp_neg_overall_mutation_rate_M_, mutation_subranges_M_, overlay_subranges_M_);
+		_InitializeOneMutationMap(lookup_mutation_F_, mutation_end_positions_F_, mutation_rates_F_, overall_mutation_rate_F_, exp_neg_overall_mutation_rate_F_, mutation_subranges_F_, overlay_subranges_F_);
 	}
 	
 	// Now remake our recombination map info, which we delegate to _InitializeOneRecombinationMap()
@@ -475,7 +475,7 @@ void Chromosome::_InitializeOneRecombinationMap(gsl_ran_discrete_t *&p_lookup, s
 }
 
 // initialize one mutation map, used internally by InitializeDraws() to avoid code duplication
-void Chromosome::_InitializeOneMutationMap(gsl_ran_discrete_t *&p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_overall_rate, double &p_exp_neg_overall_rate, std::vector<GESubrange> &p_subranges)
+void Chromosome::_InitializeOneMutationMap(gsl_ran_discrete_t *&p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_overall_rate, double &p_exp_neg_overall_rate, std::vector<GESubrange> &p_subranges, std::vector<OverlaySubrange> &p_overlay_subranges)
 {
 	// Patch the mutation interval end vector if it is empty; see setMutationRate() and initializeMutationRate().
 	// Basically, the length of the chromosome might not have been known yet when the user set the rate.
@@ -501,6 +501,7 @@ void Chromosome::_InitializeOneMutationMap(gsl_ran_discrete_t *&p_lookup, std::v
 	// mutation rate map with the genomic element map to create a list of new genomic elements of constant mut rate.
 	// The class we use to represent these constant-rate subregions is GESubrange, declared in chromosome.h.
 	p_subranges.clear();
+	p_overlay_subranges.clear();
 	
 	// We need to work with a *sorted* genomic elements vector here.  We sort it internally here, rather than in
 	// genomic_elements_, so that genomic_elements_ reflects exactly what they user gave us (mostly for backward
@@ -536,8 +537,18 @@ void Chromosome::_InitializeOneMutationMap(gsl_ran_discrete_t *&p_lookup, std::v
 				slim_position_t subrange_start = std::max(end_of_previous_mutrange + 1, ge.start_position_);
 				slim_position_t subrange_end = std::min(end_of_mutrange, ge.end_position_);
 				slim_position_t subrange_length = subrange_end - subrange_start + 1;
+				double overlay_fraction = ge.genomic_element_type_ptr_->overlay_fraction_;
 				double subrange_weight = p_rates[mutrange_index] * subrange_length;
 				
+				// Mutations of overlaid types are not drawn during forward simulation; we keep a separate map of their rates instead
+				if (overlay_fraction != 0.0)
+				{
+					if (p_rates[mutrange_index] != 0.0)
+						p_overlay_subranges.emplace_back(OverlaySubrange{subrange_start, subrange_end, p_rates[mutrange_index] * overlay_fraction, ge.genomic_element_type_ptr_});
+					
+					subrange_weight *= (1.0 - overlay_fraction);
+				}
+				
 				B.emplace_back(subrange_weight);
 				p_subranges.emplace_back(&ge, subrange_start, subrange_end);
 				
@@ -630,7 +641,7 @@ MutationIndex Chromosome::DrawNewMutation(IndividualSex p_sex, slim_objectid_t p
 // apply mutation() to a generated mutation; a return of T means accept, F means reject
 bool Chromosome::ApplyMutationCallbacks(Mutation *p_mut, Genome *p_genome, GenomicElement *p_genomic_element, int8_t p_original_nucleotide, std::vector<SLiMEidosBlock*> &p_mutation_callbacks) const
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -720,7 +731,7 @@ bool Chromosome::ApplyMutationCallbacks(Mutation *p_mut, Genome *p_genome, Genom
 	
 	sim_->executing_block_type_ = old_executing_block_type;
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(sim_->profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMutationCallback)]);
 #endif
@@ -2037,6 +2048,9 @@ EidosValue_SP Chromosome::ExecuteMethod_setMutationRate(EidosGlobalStringID p_me
 		if ((mutation_rate < 0.0) || !std::isfinite(mutation_rate))		// intentionally no upper bound
 			EIDOS_TERMINATION << "ERROR (Chromosome::ExecuteMethod_setMutationRate): setMutationRate() rate " << EidosStringForFloat(mutation_rate) << " out of range; rates must be >= 0." << EidosTerminate();
 		
+		if (sim_->OverlayingMutationTypes() && !((rates.size() == 1) && (rates[0] == mutation_rate)))
+			EIDOS_TERMINATION << "ERROR (Chromosome::ExecuteMethod_setMutationRate): setMutationRate() cannot change the mutation rate map when overlaid mutation types are in use; overlaid mutations are drawn with the same rates throughout the model's history." << EidosTerminate();
+		
 		// then adopt them
 		rates.clear();
 		positions.clear();
@@ -2074,6 +2088,19 @@ EidosValue_SP Chromosome::ExecuteMethod_setMutationRate(EidosGlobalStringID p_me
 		if (new_last_position != last_position_)
 			EIDOS_TERMINATION << "ERROR (Chromosome::ExecuteMethod_setMutationRate): setMutationRate() end " << new_last_position << " noncompliant; the last interval must end at the last position of the chromosome (" << last_position_ << ")." << EidosTerminate();
 		
+		// Overlaid mutations are drawn at output from the rate map in effect then, for the whole history, so it must stay fixed
+		if (sim_->OverlayingMutationTypes())
+		{
+			bool map_changed = (rates.size() != (size_t)end_count);
+			
+			for (int interval_index = 0; !map_changed && (interval_index < end_count); ++interval_index)
+				if ((rates[interval_index] != rates_value->FloatAtIndex(interval_index, nullptr)) || (positions[interval_index] != ends_value->IntAtIndex(interval_index, nullptr)))
+					map_changed = true;
+			
+			if (map_changed)
+				EIDOS_TERMINATION << "ERROR (Chromosome::ExecuteMethod_setMutationRate): setMutationRate() cannot change the mutation rate map when overlaid mutation types are in use; overlaid mutations are drawn with the same rates throughout the model's history." << EidosTerminate();
+		}
+		
 		// then adopt them
 		rates.clear();
 		positions.clear();
@@ -43,6 +43,16 @@ struct GESubrange;
 class Genome;
 class SLiMSim;
 
+// A subregion of constant mutation rate within a genomic element, for the mutation types that are overlaid on the tree sequence
+// at output rather than simulated (MutationType::overlay_); rate_ is the per-base rate of overlaid mutations in the subregion
+struct OverlaySubrange
+{
+	slim_position_t start_position_;
+	slim_position_t end_position_;
+	double rate_;
+	GenomicElementType *genomic_element_type_ptr_;
+};
+
 
 extern EidosObjectClass *gSLiM_Chromosome_Class;
 
@@ -118,6 +128,10 @@ public:
 	std::vector<double> mutation_rates_M_;
 	std::vector<double> mutation_rates_F_;
 	
+	std::vector<OverlaySubrange> overlay_subranges_H_;			// constant-rate subregions for overlaid mutation types; see SLiMSim::OverlayMutations()
+	std::vector<OverlaySubrange> overlay_subranges_M_;
+	std::vector<OverlaySubrange> overlay_subranges_F_;
+	
 	std::vector<slim_position_t> recombination_end_positions_H_;	// end positions of each defined recombination region
 	std::vector<slim_position_t> recombination_end_positions_M_;
 	std::vector<slim_position_t> recombination_end_positions_F_;
@@ -180,7 +194,7 @@ public:
 	// initialize the random lookup tables used by Chromosome to draw mutation and recombination events
 	void InitializeDraws(void);
 	void _InitializeOneRecombinationMap(gsl_ran_discrete_t *&p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_overall_rate, double &p_exp_neg_overall_rate, double &p_overall_rate_userlevel);
-	void _InitializeOneMutationMap(gsl_ran_discrete_t *&p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_overall_rate, double &p_exp_neg_overall_rate, std::vector<GESubrange> &p_subranges);
+	void _InitializeOneMutationMap(gsl_ran_discrete_t *&p_lookup, std::vector<slim_position_t> &p_end_positions, std::vector<double> &p_rates, double &p_overall_rate, double &p_exp_neg_overall_rate, std::vector<GESubrange> &p_subranges, std::vector<OverlaySubrange> &p_overlay_subranges);
 	void ChooseMutationRunLayout(int p_preferred_count);
 	
 	inline bool UsingSingleRecombinationMap(void) const { return single_recombination_map_; }
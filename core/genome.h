@@ -124,6 +124,7 @@ public:
 	inline __attribute__((always_inline)) slim_genomeid_t GenomeID(void)			{ return genome_id_; }
 	inline __attribute__((always_inline)) Subpopulation *OwningSubpopulation(void)	{ return subpop_; }
 	inline __attribute__((always_inline)) Individual *OwningIndividual(void)		{ return individual_; }
+	inline __attribute__((always_inline)) tsk_id_t TskNodeID(void)				{ return tsk_node_id_; }
 	
 	void NullGenomeAccessError(void) const __attribute__((__noreturn__)) __attribute__((cold)) __attribute__((analyzer_noreturn));		// prints an error message, a stacktrace, and exits; called only for DEBUG
 	
@@ -155,6 +156,20 @@ public:
 		return new_run;
 	}
 	
+	// This shares a run from another genome into the (cleared) slot at a given index, like assigning from the other genome's
+	// mutruns_, except that the run's refcount is incremented atomically.  This allows multiple threads to share runs from
+	// the same parental genomes at once, as parallel offspring generation does; see Population::AssembleDeferredChildGenome().
+	inline void ShareRunAtomic(int p_run_index, MutationRun *p_run)
+	{
+#ifdef DEBUG
+		if (mutruns_[p_run_index])
+			EIDOS_TERMINATION << "ERROR (Genome::ShareRunAtomic): (internal error) attempt to share a run into an uncleared slot." << EidosTerminate();
+#endif
+		
+		Eidos_intrusive_ptr_add_ref_atomic(p_run);
+		mutruns_[p_run_index].reset(p_run, false);
+	}
+	
 	// This should be called before modifying the run at a given index.  It will replicate the run to produce a single-referenced copy
 	// if necessary, thus guaranteeting that the run can be modified legally.  If the run is already single-referenced, it is a no-op.
 	void WillModifyRun(slim_mutrun_index_t p_run_index);
@@ -226,7 +241,10 @@ public:
 			{
 				// If the MutationRun is private to us, we can just empty it out, otherwise we replace it with a new empty one
 				if (mutrun->UseCount() == 1)
+				{
+					mutrun->will_modify_run();
 					mutrun->clear();
+				}
 				else
 					*mutrun_sp = MutationRun_SP(MutationRun::NewMutationRun());
 			}
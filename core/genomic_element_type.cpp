@@ -70,24 +70,38 @@ void GenomicElementType::InitializeDraws(void)
 		lookup_mutation_type_ = nullptr;
 	}
 	
+	overlay_fraction_ = 0.0;
+	
 	// We allow an empty mutation type vector initially, because people might want to add mutation types in script.
 	// However, if DrawMutationType() is called and our vector is still empty, that will be an error.
 	if (mutation_type_count)
 	{
-		// Prepare to randomly draw mutation types
+		// Prepare to randomly draw mutation types; overlaid mutation types are never drawn during forward simulation, so they get
+		// a weight of zero here, and the chromosome scales down the mutation rate in this element by (1 - overlay_fraction_) to match
 		std::vector<double> A(mutation_type_count);
 		bool nonzero_seen = false;
+		double total_fraction = 0.0, overlay_fraction = 0.0;
 		
 		for (unsigned int i = 0; i < mutation_type_count; i++)
 		{
 			double fraction = mutation_fractions_[i];
 			
+			total_fraction += fraction;
+			
+			if (mutation_type_ptrs_[i]->overlay_)
+			{
+				overlay_fraction += fraction;
+				fraction = 0.0;
+			}
+			
 			if (fraction > 0.0)
 				nonzero_seen = true;
 			
 			A[i] = fraction;
 		}
 		
+		overlay_fraction_ = (overlay_fraction > 0.0) ? overlay_fraction / total_fraction : 0.0;
+		
 		// A mutation type vector with all zero proportions is treated the same as an empty vector: we allow it
 		// on the assumption that it will be fixed later, but if it isn't, that will be an error.
 		if (nonzero_seen)
@@ -400,6 +414,19 @@ EidosValue_SP GenomicElementType::ExecuteMethod_setMutationFractions(EidosGlobal
 			sim.pure_neutral_ = false;
 	}
 	
+	// Overlaid mutation types are drawn only at output, using the mutation fractions in effect then for the whole history; so
+	// the mutation fractions of a genomic element type that involves an overlaid mutation type cannot change once simulation begins
+	if ((mutation_types != mutation_type_ptrs_) || (mutation_fractions != mutation_fractions_))
+	{
+		for (MutationType *mutation_type_ptr : mutation_type_ptrs_)
+			if (mutation_type_ptr->overlay_)
+				EIDOS_TERMINATION << "ERROR (GenomicElementType::ExecuteMethod_setMutationFractions): setMutationFractions() cannot change the mutation fractions of genomic element type g" << genomic_element_type_id_ << ", which uses overlaid mutation type m" << mutation_type_ptr->mutation_type_id_ << "; overlaid mutations are drawn with the same fractions throughout the model's history." << EidosTerminate();
+		
+		for (MutationType *mutation_type_ptr : mutation_types)
+			if (mutation_type_ptr->overlay_)
+				EIDOS_TERMINATION << "ERROR (GenomicElementType::ExecuteMethod_setMutationFractions): setMutationFractions() cannot add overlaid mutation type m" << mutation_type_ptr->mutation_type_id_ << " to genomic element type g" << genomic_element_type_id_ << "; overlaid mutations are drawn with the same fractions throughout the model's history." << EidosTerminate();
+	}
+	
 	// Everything seems to be in order, so replace our mutation info with the new info
 	mutation_type_ptrs_ = mutation_types;
 	mutation_fractions_ = mutation_fractions;
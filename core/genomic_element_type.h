@@ -63,6 +63,7 @@ public:
 	
 	std::vector<MutationType*> mutation_type_ptrs_;						// mutation types identifiers in this element
 	std::vector<double> mutation_fractions_;							// relative fractions of each mutation type
+	double overlay_fraction_ = 0.0;										// the fraction of mutations that are of overlaid types (MutationType::overlay_); set by InitializeDraws()
 	
 	std::string color_;													// color to use when displayed (in SLiMgui)
 	float color_red_, color_green_, color_blue_;						// cached color components from color_; should always be in sync
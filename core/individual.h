@@ -157,6 +157,7 @@ public:
 	}
 	
 	double RelatednessToIndividual(Individual &p_ind);
+	double SumOfMutationsOfType(MutationType *p_mutation_type_ptr);		// the sum of selection coefficients of mutations of the given type
 	
 	inline __attribute__((always_inline)) slim_pedigreeid_t PedigreeID()			{ return pedigree_id_; }
 	inline __attribute__((always_inline)) void SetPedigreeID(slim_pedigreeid_t p_new_id)		{ pedigree_id_ = p_new_id; }	// should basically never be called
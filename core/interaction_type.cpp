@@ -28,6 +28,10 @@
 #include <utility>
 #include <algorithm>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 // stream output for enumerations
 std::ostream& operator<<(std::ostream& p_out, IFType p_if_type)
@@ -44,16 +48,28 @@ std::ostream& operator<<(std::ostream& p_out, IFType p_if_type)
 	return p_out;
 }
 
+std::ostream& operator<<(std::ostream& p_out, SpatialIndexType p_index_type)
+{
+	switch (p_index_type)
+	{
+		case SpatialIndexType::kKDTree:		p_out << "kdtree";	break;
+		case SpatialIndexType::kGrid:		p_out << "grid";	break;
+		case SpatialIndexType::kAuto:		p_out << "auto";	break;
+	}
+	
+	return p_out;
+}
+
 
 #pragma mark -
 #pragma mark InteractionType
 #pragma mark -
 
-InteractionType::InteractionType(SLiMSim &p_sim, slim_objectid_t p_interaction_type_id, std::string p_spatiality_string, bool p_reciprocal, double p_max_distance, IndividualSex p_receiver_sex, IndividualSex p_exerter_sex) :
+InteractionType::InteractionType(SLiMSim &p_sim, slim_objectid_t p_interaction_type_id, std::string p_spatiality_string, bool p_reciprocal, double p_max_distance, IndividualSex p_receiver_sex, IndividualSex p_exerter_sex, SpatialIndexType p_spatial_index_type) :
 	sim_(p_sim),
 	self_symbol_(Eidos_GlobalStringIDForString(SLiMEidosScript::IDStringWithPrefix('i', p_interaction_type_id)),
 			 EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Object_singleton(this, gSLiM_InteractionType_Class))),
-	spatiality_string_(p_spatiality_string), reciprocal_(p_reciprocal), max_distance_(p_max_distance), max_distance_sq_(p_max_distance * p_max_distance), receiver_sex_(p_receiver_sex), exerter_sex_(p_exerter_sex), if_type_(IFType::kFixed), if_param1_(1.0), if_param2_(0.0), interaction_type_id_(p_interaction_type_id)
+	spatiality_string_(p_spatiality_string), reciprocal_(p_reciprocal), max_distance_(p_max_distance), max_distance_sq_(p_max_distance * p_max_distance), receiver_sex_(p_receiver_sex), exerter_sex_(p_exerter_sex), spatial_index_type_(p_spatial_index_type), if_type_(IFType::kFixed), if_param1_(1.0), if_param2_(0.0), interaction_type_id_(p_interaction_type_id)
 {
 	// Figure out our spatiality, which is the number of spatial dimensions we actively use for distances
 	if (spatiality_string_ == "")
@@ -70,6 +86,9 @@ InteractionType::InteractionType(SLiMSim &p_sim, slim_objectid_t p_interaction_t
 
 InteractionType::~InteractionType(void)
 {
+	for (SparseArray *fragment : sa_fragments_)
+		delete fragment;
+	sa_fragments_.clear();
 }
 
 void InteractionType::EvaluateSubpopulation(Subpopulation *p_subpop, bool p_immediate)
@@ -117,6 +136,20 @@ void InteractionType::EvaluateSubpopulation(Subpopulation *p_subpop, bool p_imme
 		
 		subpop_data->kd_root_ = nullptr;
 		
+		if (subpop_data->grid_cell_starts_)
+		{
+			free(subpop_data->grid_cell_starts_);
+			subpop_data->grid_cell_starts_ = nullptr;
+		}
+		
+		if (subpop_data->grid_entries_)
+		{
+			free(subpop_data->grid_entries_);
+			subpop_data->grid_entries_ = nullptr;
+		}
+		
+		subpop_data->grid_cell_count_ = 0;
+		
 		subpop_data->evaluation_interaction_callbacks_.clear();
 	}
 	
@@ -452,7 +485,7 @@ void InteractionType::Invalidate(void)
 {
 	// Called by SLiM when the old generation goes away; should invalidate all evaluation.  We avoid actually freeing the
 	// big blocks if possible, though, since that can incur large overhead from madvise() – see header comments.  We do free
-	// the positional data and the k-d tree, though, in an attempt to make fatal errors occur if somebody doesn't manage
+	// the positional data and the spatial index, though, in an attempt to make fatal errors occur if somebody doesn't manage
 	// the buffers and evaluated state correctly.  They should be smaller, and thus not trigger madvise(), anyway.
 	for (auto &data_iter : data_)
 	{
@@ -478,6 +511,20 @@ void InteractionType::Invalidate(void)
 		
 		data.kd_root_ = nullptr;
 		
+		if (data.grid_cell_starts_)
+		{
+			free(data.grid_cell_starts_);
+			data.grid_cell_starts_ = nullptr;
+		}
+		
+		if (data.grid_entries_)
+		{
+			free(data.grid_entries_);
+			data.grid_entries_ = nullptr;
+		}
+		
+		data.grid_cell_count_ = 0;
+		
 		data.evaluation_interaction_callbacks_.clear();
 	}
 }
@@ -494,9 +541,9 @@ void InteractionType::CalculateAllDistances(Subpopulation *p_subpop)
 		
 		if (spatiality_ > 0)
 		{
-			// Here we use the k-d tree to find all interacting pairs, and calculate their distances.
+			// Here we use the spatial index to find all interacting pairs, and calculate their distances.
 			// This does not use reciprocality at all, but I don't think there's a good way to do so, so that's OK.
-			EnsureKDTreePresent(subpop_data);
+			EnsureSpatialIndexPresent(subpop_data);
 			
 			slim_popsize_t subpop_size = p_subpop->parent_subpop_size_;
 			
@@ -505,8 +552,8 @@ void InteractionType::CalculateAllDistances(Subpopulation *p_subpop)
 			else
 				subpop_data.dist_str_ = new SparseArray(subpop_size, subpop_size);
 			
-			double *position_data = subpop_data.positions_;
-			int start_row = 0, after_end_row = subpop_size, row;
+			int start_row = 0, after_end_row = subpop_size;
+			int start_exerter = 0, after_end_exerter = subpop_size;
 			
 			if (receiver_sex_ == IndividualSex::kUnspecified)
 				;
@@ -518,52 +565,58 @@ void InteractionType::CalculateAllDistances(Subpopulation *p_subpop)
 				EIDOS_TERMINATION << "ERROR (InteractionType::CalculateAllDistances): (internal error) unrecognized value for receiver_sex_." << EidosTerminate();
 			
 			if (exerter_sex_ == IndividualSex::kUnspecified)
-			{
-				// Without a specified exerter sex, we can add each exerter with no sex test
-				switch (spatiality_)
-				{
-					case 1:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_1(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_);
-						break;
-					case 2:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_2(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, 0);
-						break;
-					case 3:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_3(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, 0);
-						break;
-				}
-			}
+				;
+			else if (exerter_sex_ == IndividualSex::kMale)
+				start_exerter = subpop_data.first_male_index_;
+			else if (exerter_sex_ == IndividualSex::kFemale)
+				after_end_exerter = subpop_data.first_male_index_;
 			else
+				EIDOS_TERMINATION << "ERROR (InteractionType::CalculateAllDistances): (internal error) unrecognized value for exerter_sex_." << EidosTerminate();
+			
+#ifdef _OPENMP
+			if ((gEidosMaxThreads > 1) && (after_end_row - start_row >= 1000))
 			{
-				// With a specified exerter sex, we use a special version of BuildSA_X() that tests for that by range
-				int start_exerter = 0, after_end_exerter = subpop_size;
+				// Each thread fills a contiguous block of rows into its own fragment, and then the fragments are appended
+				// to the sparse array in row order.  Each row's entries are found in the same order as in the serial case,
+				// so the result is identical to the single-threaded result.
+				int thread_count = gEidosMaxThreads;
+				SparseArray *dist_str = subpop_data.dist_str_;
 				
-				if (exerter_sex_ == IndividualSex::kMale)
-					start_exerter = subpop_data.first_male_index_;
-				else if (exerter_sex_ == IndividualSex::kFemale)
-					after_end_exerter = subpop_data.first_male_index_;
-				else
-					EIDOS_TERMINATION << "ERROR (InteractionType::CalculateAllDistances): (internal error) unrecognized value for exerter_sex_." << EidosTerminate();
+				while ((int)sa_fragments_.size() < thread_count)
+					sa_fragments_.push_back(new SparseArray(subpop_size, subpop_size));
 				
-				switch (spatiality_)
+				SparseArray **fragments = sa_fragments_.data();
+				int64_t row_count = after_end_row - start_row;
+				int team_count = 1;
+				
+#pragma omp parallel num_threads(thread_count)
 				{
-					case 1:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_SS_1(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, start_exerter, after_end_exerter);
-						break;
-					case 2:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_SS_2(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, start_exerter, after_end_exerter, 0);
-						break;
-					case 3:
-						for (row = start_row; row < after_end_row; row++)
-							BuildSA_SS_3(subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, subpop_data.dist_str_, start_exerter, after_end_exerter, 0);
-						break;
+					int thread_num = omp_get_thread_num();
+					int team_size = omp_get_num_threads();
+					int block_start = start_row + (int)((row_count * thread_num) / team_size);
+					int block_after_end = start_row + (int)((row_count * (thread_num + 1)) / team_size);
+					SparseArray *fragment = fragments[thread_num];
+					
+					fragment->Reset(subpop_size, subpop_size);
+					CalculateDistancesForRows(subpop_data, fragment, block_start, block_after_end, start_exerter, after_end_exerter);
+					
+#pragma omp single
+					team_count = team_size;
+				}
+				
+				for (int fragment_index = 0; fragment_index < team_count; ++fragment_index)
+				{
+					int fragment_start = start_row + (int)((row_count * fragment_index) / team_count);
+					int fragment_after_end = start_row + (int)((row_count * (fragment_index + 1)) / team_count);
+					
+					dist_str->AddRowsFromFragment(*fragments[fragment_index], fragment_start, fragment_after_end);
 				}
 			}
+			else
+#endif
+			{
+				CalculateDistancesForRows(subpop_data, subpop_data.dist_str_, start_row, after_end_row, start_exerter, after_end_exerter);
+			}
 			
 			subpop_data.dist_str_->Finished();
 			subpop_data.distances_calculated_ = true;
@@ -575,6 +628,67 @@ void InteractionType::CalculateAllDistances(Subpopulation *p_subpop)
 	}
 }
 
+// Find all interacting pairs for receivers in [p_start_row, p_after_end_row) and add their distances to p_sparse_array, in row order.
+// This is called from multiple threads at once when multithreading, each with its own sparse array, so it must not modify shared state.
+void InteractionType::CalculateDistancesForRows(InteractionsData &p_subpop_data, SparseArray *p_sparse_array, int p_start_row, int p_after_end_row, int p_start_exerter, int p_after_end_exerter)
+{
+	double *position_data = p_subpop_data.positions_;
+	int row;
+	
+	if (p_subpop_data.grid_cell_starts_)
+	{
+		// The grid handles all spatialities and the exerter sex range in a single scan routine
+		std::vector<uint32_t> neighbor_indices;
+		std::vector<double> neighbor_distances_sq;
+		
+		for (row = p_start_row; row < p_after_end_row; row++)
+		{
+			GridNeighborsOfPoint(p_subpop_data, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_start_exerter, p_after_end_exerter, neighbor_indices, neighbor_distances_sq);
+			
+			for (size_t neighbor_index = 0; neighbor_index < neighbor_indices.size(); ++neighbor_index)
+				p_sparse_array->AddEntryDistance(row, neighbor_indices[neighbor_index], (sa_distance_t)sqrt(neighbor_distances_sq[neighbor_index]));
+		}
+	}
+	else if (exerter_sex_ == IndividualSex::kUnspecified)
+	{
+		// Without a specified exerter sex, we can add each exerter with no sex test
+		switch (spatiality_)
+		{
+			case 1:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_1(p_subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array);
+				break;
+			case 2:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_2(p_subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array, 0);
+				break;
+			case 3:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_3(p_subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array, 0);
+				break;
+		}
+	}
+	else
+	{
+		// With a specified exerter sex, we use a special version of BuildSA_X() that tests for that by range
+		switch (spatiality_)
+		{
+			case 1:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_SS_1(p_subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array, p_start_exerter, p_after_end_exerter);
+				break;
+			case 2:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_SS_2(p_subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array, p_start_exerter, p_after_end_exerter, 0);
+				break;
+			case 3:
+				for (row = p_start_row; row < p_after_end_row; row++)
+					BuildSA_SS_3(p_subpop_data.kd_root_, position_data + row * SLIM_MAX_DIMENSIONALITY, row, p_sparse_array, p_start_exerter, p_after_end_exerter, 0);
+				break;
+		}
+	}
+}
+
 void InteractionType::CalculateAllStrengths(Subpopulation *p_subpop)
 {
 	slim_objectid_t subpop_id = p_subpop->subpopulation_id_;
@@ -601,6 +715,11 @@ void InteractionType::CalculateAllStrengths(Subpopulation *p_subpop)
 			{
 				// No callbacks; strength calculations come from the interaction function only
 				// We do not use reciprocity here, as searching for the mirrored entry would probably take longer than just calculating twice
+				// Each row is independent, so when multithreading the rows are simply divided among the threads; as for the
+				// sparse array fill in CalculateAllDistances(), small subpopulations are not worth the overhead of a thread team
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) num_threads(gEidosMaxThreads) if(subpop_size >= 1000)
+#endif
 				for (uint32_t row = 0; row < (uint32_t)subpop_size; ++row)
 				{
 					uint32_t row_nnz, *row_columns;
@@ -981,7 +1100,7 @@ double InteractionType::CalculateStrengthWithCallbacks(double p_distance, Indivi
 
 double InteractionType::ApplyInteractionCallbacks(Individual *p_receiver, Individual *p_exerter, Subpopulation *p_subpop, double p_strength, double p_distance, std::vector<SLiMEidosBlock*> &p_interaction_callbacks)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -1080,7 +1199,7 @@ double InteractionType::ApplyInteractionCallbacks(Individual *p_receiver, Indivi
 	
 	sim.executing_block_type_ = old_executing_block_type;
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(sim.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosInteractionCallback)]);
 #endif
@@ -1095,7 +1214,11 @@ size_t InteractionType::MemoryUsageForKDTrees(void)
 	for (auto &iter : data_)
 	{
 		const InteractionsData &data = iter.second;
-		usage += sizeof(SLiM_kdNode) * data.individual_count_;
+		
+		if (data.grid_cell_starts_)
+			usage += sizeof(slim_popsize_t) * (data.grid_cell_count_ + 1) + sizeof(SLiM_gridEntry) * data.individual_count_;
+		else
+			usage += sizeof(SLiM_kdNode) * data.individual_count_;
 	}
 	
 	return usage;
@@ -1341,6 +1464,52 @@ SLiM_kdNode *InteractionType::MakeKDTree3_p2(SLiM_kdNode *t, int len)
 	return n;
 }
 
+// make k-d tree for the top levels of the tree in parallel, for any spatiality and phase; below p_depth levels, or for small
+// subtrees, this hands off to the single-threaded functions above.  FindMedian_pX() partitions a subtree's nodes in place and
+// the two resulting subtrees occupy disjoint ranges of the node buffer, so they can be built concurrently as OpenMP tasks;
+// the tree produced is identical to the single-threaded tree.  This must be called from within a parallel region.
+SLiM_kdNode *InteractionType::MakeKDTree_Parallel(SLiM_kdNode *t, int len, int p_phase, int p_depth)
+{
+	if ((p_depth <= 0) || (len < 10000))
+	{
+		switch (spatiality_)
+		{
+			case 1: return MakeKDTree1_p0(t, len);
+			case 2: return ((p_phase == 0) ? MakeKDTree2_p0(t, len) : MakeKDTree2_p1(t, len));
+			case 3: return ((p_phase == 0) ? MakeKDTree3_p0(t, len) : ((p_phase == 1) ? MakeKDTree3_p1(t, len) : MakeKDTree3_p2(t, len)));
+		}
+		return 0;
+	}
+	
+	SLiM_kdNode *n;
+	
+	switch (p_phase)
+	{
+		case 0:		n = FindMedian_p0(t, t + len); break;
+		case 1:		n = FindMedian_p1(t, t + len); break;
+		default:	n = FindMedian_p2(t, t + len); break;
+	}
+	
+	if (n)
+	{
+		int next_phase = ((p_phase + 1 >= spatiality_) ? 0 : p_phase + 1);
+		int left_len = (int)(n - t);
+		int right_len = (int)(t + len - (n + 1));
+		
+#ifdef _OPENMP
+#pragma omp task
+#endif
+		n->left  = (left_len ? MakeKDTree_Parallel(t, left_len, next_phase, p_depth - 1) : 0);
+		
+		n->right = (right_len ? MakeKDTree_Parallel(n + 1, right_len, next_phase, p_depth - 1) : 0);
+		
+#ifdef _OPENMP
+#pragma omp taskwait
+#endif
+	}
+	return n;
+}
+
 void InteractionType::EnsureKDTreePresent(InteractionsData &p_subpop_data)
 {
 	if (!p_subpop_data.evaluated_)
@@ -1504,11 +1673,33 @@ void InteractionType::EnsureKDTreePresent(InteractionsData &p_subpop_data)
 		else
 		{
 			// Now call out to recursively construct the tree
-			switch (spatiality_)
+#ifdef _OPENMP
+			if ((gEidosMaxThreads > 1) && (p_subpop_data.kd_node_count_ >= 10000))
 			{
-				case 1: p_subpop_data.kd_root_ = MakeKDTree1_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
-				case 2: p_subpop_data.kd_root_ = MakeKDTree2_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
-				case 3: p_subpop_data.kd_root_ = MakeKDTree3_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
+				// Build the top levels of the tree as tasks; enough levels that there are a few subtrees per thread
+				SLiM_kdNode *kd_root = nullptr;
+				int task_depth = 2;
+				
+				while ((1 << task_depth) < gEidosMaxThreads * 4)
+					task_depth++;
+				
+#pragma omp parallel num_threads(gEidosMaxThreads)
+				{
+#pragma omp single
+					kd_root = MakeKDTree_Parallel(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_, 0, task_depth);
+				}
+				
+				p_subpop_data.kd_root_ = kd_root;
+			}
+			else
+#endif
+			{
+				switch (spatiality_)
+				{
+					case 1: p_subpop_data.kd_root_ = MakeKDTree1_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
+					case 2: p_subpop_data.kd_root_ = MakeKDTree2_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
+					case 3: p_subpop_data.kd_root_ = MakeKDTree3_p0(p_subpop_data.kd_nodes_, p_subpop_data.kd_node_count_);	break;
+				}
 			}
 			
 			// Check the tree for correctness; for now I will leave this enabled in the DEBUG case,
@@ -1832,11 +2023,11 @@ void InteractionType::BuildSA_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_
 // I guess I'll use this version; I've made the stack plenty deep so it shouldn't ever run out.  So why not, it's faster.
 // But for now, I don't think I will do the same for the (less common) 1D and 3D cases, to keep the code base simple.
 // I'm a bit surprised by how slow this is – more than 50% of total runtime for that test model.  Maybe Boyana will have ideas.
-static SLiM_kdNode *(recurse_root[1000]);
-static int (recurse_phase[1000]);
-
+// The stack is local, not static, so that multiple threads can build sparse arrays concurrently.
 void InteractionType::BuildSA_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, SparseArray *p_sparse_array, int p_phase)
 {
+	SLiM_kdNode *recurse_root[1000];
+	int recurse_phase[1000];
 	int recurse_top = 0;
 	double local_max_distance_sq = max_distance_sq_;	// put a few non-local things into local variables so the compiler can cache them in registers
 	double local_nd_0 = nd[0], local_nd_1 = nd[1];
@@ -2552,6 +2743,13 @@ void InteractionType::FindNeighbors(Subpopulation *p_subpop, InteractionsData &p
 	{
 		EIDOS_TERMINATION << "ERROR (InteractionType::FindNeighbors): (internal error) neighbors cannot be found for non-spatial interactions." << EidosTerminate();
 	}
+	else if (p_subpop_data.grid_cell_starts_)
+	{
+		if (p_count == 0)
+			return;
+		
+		FindNeighbors_Grid(p_subpop, p_subpop_data, p_point, p_count, p_result_vec, p_excluded_individual ? p_excluded_individual->index_ : -1);
+	}
 	else if (!p_subpop_data.kd_nodes_)
 	{
 		EIDOS_TERMINATION << "ERROR (InteractionType::FindNeighbors): (internal error) the k-d tree has not been constructed." << EidosTerminate();
@@ -2639,6 +2837,395 @@ void InteractionType::FindNeighbors(Subpopulation *p_subpop, InteractionsData &p
 }
 
 
+#pragma mark -
+#pragma mark uniform grid spatial index
+#pragma mark -
+
+// The uniform grid is an alternative to the k-d tree for models in which maxDistance is small relative to the occupied space.
+// Individuals are bucketed into cells at least maxDistance wide by a counting sort, which is O(N), and all interacting partners
+// of a point are then found by scanning the (at most 3^spatiality) cells around it, which is cache-friendly since each cell's
+// entries are contiguous.  Periodic dimensions are handled by wrapping cell indices and using minimum-image distances, rather
+// than by replicating individuals as the k-d tree does.  Note that neighbors are found in a different order than with the k-d
+// tree, so models that depend upon that order (through drawByStrength(), for example) will not be reproducible across indexes.
+
+static inline bool GridDimensionIsPeriodic(int p_dim, bool p_periodic_x, bool p_periodic_y, bool p_periodic_z)
+{
+	return (p_dim == 0) ? p_periodic_x : ((p_dim == 1) ? p_periodic_y : p_periodic_z);
+}
+
+static inline double GridPeriodicBound(InteractionsData &p_subpop_data, int p_dim)
+{
+	return (p_dim == 0) ? p_subpop_data.bounds_x1_ : ((p_dim == 1) ? p_subpop_data.bounds_y1_ : p_subpop_data.bounds_z1_);
+}
+
+// Sets up the number, origin, and size of grid cells along each dimension.  Returns true if the grid looks like a good choice
+// compared to the k-d tree: maxDistance must be finite and positive, and there must be at least three cells along every dimension,
+// so that the cells scanned around a point cover only part of the space.  The total number of cells is capped relative to the
+// number of individuals, so at low densities the grid is coarsened and will generally be judged not worthwhile.
+bool InteractionType::ConfigureGridGeometry(InteractionsData &p_subpop_data)
+{
+	int individual_count = p_subpop_data.individual_count_;
+	double *positions = p_subpop_data.positions_;
+	bool usable_distance = ((max_distance_ > 0.0) && !std::isinf(max_distance_));
+	double extents[SLIM_MAX_DIMENSIONALITY];
+	
+	for (int dim = 0; dim < SLIM_MAX_DIMENSIONALITY; ++dim)
+	{
+		p_subpop_data.grid_dims_[dim] = 1;
+		p_subpop_data.grid_origins_[dim] = 0.0;
+		p_subpop_data.grid_cell_scales_[dim] = 0.0;
+		extents[dim] = 0.0;
+	}
+	
+	for (int dim = 0; dim < spatiality_; ++dim)
+	{
+		if (GridDimensionIsPeriodic(dim, periodic_x_, periodic_y_, periodic_z_))
+		{
+			// periodic dimensions are gridded across their full bounds, so that the cells tile the wrapped space exactly
+			extents[dim] = GridPeriodicBound(p_subpop_data, dim);
+		}
+		else if (individual_count > 0)
+		{
+			// non-periodic dimensions are gridded across the occupied range of coordinates
+			double min_coord = positions[dim], max_coord = positions[dim];
+			
+			for (int ind_index = 1; ind_index < individual_count; ++ind_index)
+			{
+				double coord = positions[ind_index * SLIM_MAX_DIMENSIONALITY + dim];
+				
+				if (coord < min_coord) min_coord = coord;
+				if (coord > max_coord) max_coord = coord;
+			}
+			
+			p_subpop_data.grid_origins_[dim] = min_coord;
+			extents[dim] = max_coord - min_coord;
+		}
+	}
+	
+	if (!usable_distance || !std::isfinite(extents[0]) || !std::isfinite(extents[1]) || !std::isfinite(extents[2]))
+		return false;
+	
+	// Choose the cell width, starting from maxDistance and doubling it until the cell count is acceptable
+	double max_cell_count = std::max(64.0, 2.0 * individual_count);
+	double cell_width = max_distance_;
+	double dim_counts[SLIM_MAX_DIMENSIONALITY];
+	
+	while (true)
+	{
+		double total_cells = 1.0;
+		
+		for (int dim = 0; dim < spatiality_; ++dim)
+		{
+			if (GridDimensionIsPeriodic(dim, periodic_x_, periodic_y_, periodic_z_))
+				dim_counts[dim] = std::max(1.0, floor(extents[dim] / cell_width));		// cells are widened to tile the bounds
+			else
+				dim_counts[dim] = floor(extents[dim] / cell_width) + 1.0;				// the last cell extends past the maximum
+			
+			total_cells *= dim_counts[dim];
+		}
+		
+		if (!(total_cells > max_cell_count))
+			break;
+		
+		cell_width *= 2.0;
+	}
+	
+	bool grid_worthwhile = true;
+	
+	for (int dim = 0; dim < spatiality_; ++dim)
+	{
+		int dim_count = (int)dim_counts[dim];
+		
+		p_subpop_data.grid_dims_[dim] = dim_count;
+		
+		if (dim_count > 1)
+		{
+			if (GridDimensionIsPeriodic(dim, periodic_x_, periodic_y_, periodic_z_))
+				p_subpop_data.grid_cell_scales_[dim] = dim_count / extents[dim];
+			else
+				p_subpop_data.grid_cell_scales_[dim] = 1.0 / cell_width;
+		}
+		
+		if (dim_count < 3)
+			grid_worthwhile = false;
+	}
+	
+	return grid_worthwhile;
+}
+
+static inline int GridCellForCoordinate(double p_coord, double p_origin, double p_scale, int p_dim_count)
+{
+	int cell = (int)((p_coord - p_origin) * p_scale);
+	
+	if (cell < 0) return 0;
+	if (cell >= p_dim_count) return p_dim_count - 1;
+	return cell;
+}
+
+void InteractionType::BuildGrid(InteractionsData &p_subpop_data)
+{
+	int individual_count = p_subpop_data.individual_count_;
+	double *positions = p_subpop_data.positions_;
+	int *grid_dims = p_subpop_data.grid_dims_;
+	double *grid_origins = p_subpop_data.grid_origins_;
+	double *grid_cell_scales = p_subpop_data.grid_cell_scales_;
+	int64_t cell_count = (int64_t)grid_dims[0] * grid_dims[1] * grid_dims[2];
+	
+	slim_popsize_t *cell_starts = (slim_popsize_t *)calloc(cell_count + 1, sizeof(slim_popsize_t));
+	SLiM_gridEntry *entries = (SLiM_gridEntry *)malloc(std::max(individual_count, 1) * sizeof(SLiM_gridEntry));
+	int64_t *individual_cells = (int64_t *)malloc(std::max(individual_count, 1) * sizeof(int64_t));
+	
+	if (!cell_starts || !entries || !individual_cells)
+		EIDOS_TERMINATION << "ERROR (InteractionType::BuildGrid): allocation failed; you may need to raise the memory limit for SLiM." << EidosTerminate(nullptr);
+	
+	// Assign each individual to a cell and count the individuals in each cell
+	for (int ind_index = 0; ind_index < individual_count; ++ind_index)
+	{
+		double *ind_position = positions + ind_index * SLIM_MAX_DIMENSIONALITY;
+		int64_t cell = GridCellForCoordinate(ind_position[0], grid_origins[0], grid_cell_scales[0], grid_dims[0]);
+		
+		if (spatiality_ >= 2)
+			cell += (int64_t)grid_dims[0] * GridCellForCoordinate(ind_position[1], grid_origins[1], grid_cell_scales[1], grid_dims[1]);
+		if (spatiality_ >= 3)
+			cell += (int64_t)grid_dims[0] * grid_dims[1] * GridCellForCoordinate(ind_position[2], grid_origins[2], grid_cell_scales[2], grid_dims[2]);
+		
+		individual_cells[ind_index] = cell;
+		cell_starts[cell + 1]++;
+	}
+	
+	// Turn the counts into cell start offsets, then place the individuals; within a cell, individuals stay in index order
+	for (int64_t cell = 0; cell < cell_count; ++cell)
+		cell_starts[cell + 1] += cell_starts[cell];
+	
+	for (int ind_index = 0; ind_index < individual_count; ++ind_index)
+	{
+		SLiM_gridEntry *entry = entries + cell_starts[individual_cells[ind_index]]++;
+		double *ind_position = positions + ind_index * SLIM_MAX_DIMENSIONALITY;
+		
+		entry->x[0] = ind_position[0];
+		entry->x[1] = ind_position[1];
+		entry->x[2] = ind_position[2];
+		entry->individual_index_ = ind_index;
+	}
+	
+	// Placement advanced each cell's start to the start of the following cell, so shift the offsets back down
+	for (int64_t cell = cell_count; cell > 0; --cell)
+		cell_starts[cell] = cell_starts[cell - 1];
+	cell_starts[0] = 0;
+	
+	free(individual_cells);
+	
+	p_subpop_data.grid_cell_count_ = cell_count;
+	p_subpop_data.grid_cell_starts_ = cell_starts;
+	p_subpop_data.grid_entries_ = entries;
+}
+
+void InteractionType::EnsureSpatialIndexPresent(InteractionsData &p_subpop_data)
+{
+	if (!p_subpop_data.evaluated_)
+		EIDOS_TERMINATION << "ERROR (InteractionType::EnsureSpatialIndexPresent): (internal error) the interaction has not been evaluated." << EidosTerminate();
+	
+	if (p_subpop_data.kd_nodes_ || p_subpop_data.grid_cell_starts_)
+		return;
+	
+	if (spatial_index_type_ == SpatialIndexType::kKDTree)
+	{
+		EnsureKDTreePresent(p_subpop_data);
+	}
+	else
+	{
+		bool grid_worthwhile = ConfigureGridGeometry(p_subpop_data);
+		
+		if (grid_worthwhile || (spatial_index_type_ == SpatialIndexType::kGrid))
+			BuildGrid(p_subpop_data);
+		else
+			EnsureKDTreePresent(p_subpop_data);
+	}
+}
+
+// Fills p_cells with the cells along dimension p_dim that could contain individuals within max_distance_ of p_coord, and returns
+// their count (0 to 3).  For periodic dimensions p_coord must already be within bounds.
+int InteractionType::GridCellsForCoordinate(InteractionsData &p_subpop_data, int p_dim, double p_coord, int *p_cells)
+{
+	int dim_count = p_subpop_data.grid_dims_[p_dim];
+	
+	if (dim_count == 1)
+	{
+		p_cells[0] = 0;
+		return 1;
+	}
+	
+	if (GridDimensionIsPeriodic(p_dim, periodic_x_, periodic_y_, periodic_z_))
+	{
+		int cell = GridCellForCoordinate(p_coord, 0.0, p_subpop_data.grid_cell_scales_[p_dim], dim_count);
+		
+		if (dim_count == 2)
+		{
+			// with two cells, the cells on either side are the same cell; don't scan it twice
+			p_cells[0] = 0;
+			p_cells[1] = 1;
+			return 2;
+		}
+		
+		p_cells[0] = (cell == 0) ? dim_count - 1 : cell - 1;
+		p_cells[1] = cell;
+		p_cells[2] = (cell == dim_count - 1) ? 0 : cell + 1;
+		return 3;
+	}
+	else
+	{
+		// points may lie outside the grid (for nearestNeighborsOfPoint()); only cells adjacent to the point's cell can be in range
+		double cell = floor((p_coord - p_subpop_data.grid_origins_[p_dim]) * p_subpop_data.grid_cell_scales_[p_dim]);
+		
+		if ((cell < -1.0) || (cell > dim_count) || std::isnan(cell))
+			return 0;
+		
+		int first_cell = std::max((int)cell - 1, 0);
+		int last_cell = std::min((int)cell + 1, dim_count - 1);
+		int count = 0;
+		
+		for (int cell_index = first_cell; cell_index <= last_cell; ++cell_index)
+			p_cells[count++] = cell_index;
+		
+		return count;
+	}
+}
+
+// Collects the individuals within max_distance_ of p_point, excluding p_focal_individual_index and any individuals outside
+// [p_start_exerter, p_after_end_exerter), into p_indices and p_distances_sq.  Distances use the minimum image in periodic
+// dimensions; p_point must be within bounds in those dimensions.
+void InteractionType::GridNeighborsOfPoint(InteractionsData &p_subpop_data, double *p_point, slim_popsize_t p_focal_individual_index, int p_start_exerter, int p_after_end_exerter, std::vector<uint32_t> &p_indices, std::vector<double> &p_distances_sq)
+{
+	int cells[SLIM_MAX_DIMENSIONALITY][3];
+	int cell_counts[SLIM_MAX_DIMENSIONALITY] = {1, 1, 1};
+	double wrap_bounds[SLIM_MAX_DIMENSIONALITY] = {0.0, 0.0, 0.0};
+	
+	cells[1][0] = 0;
+	cells[2][0] = 0;
+	
+	p_indices.clear();
+	p_distances_sq.clear();
+	
+	for (int dim = 0; dim < spatiality_; ++dim)
+	{
+		cell_counts[dim] = GridCellsForCoordinate(p_subpop_data, dim, p_point[dim], cells[dim]);
+		
+		if (cell_counts[dim] == 0)
+			return;
+		
+		if (GridDimensionIsPeriodic(dim, periodic_x_, periodic_y_, periodic_z_))
+			wrap_bounds[dim] = GridPeriodicBound(p_subpop_data, dim);
+	}
+	
+	int dim0 = p_subpop_data.grid_dims_[0];
+	int64_t dim01 = (int64_t)dim0 * p_subpop_data.grid_dims_[1];
+	slim_popsize_t *cell_starts = p_subpop_data.grid_cell_starts_;
+	SLiM_gridEntry *entries = p_subpop_data.grid_entries_;
+	
+	for (int cell2_index = 0; cell2_index < cell_counts[2]; ++cell2_index)
+	{
+		for (int cell1_index = 0; cell1_index < cell_counts[1]; ++cell1_index)
+		{
+			int64_t row_base = cells[2][cell2_index] * dim01 + (int64_t)cells[1][cell1_index] * dim0;
+			
+			for (int cell0_index = 0; cell0_index < cell_counts[0]; ++cell0_index)
+			{
+				int64_t cell = row_base + cells[0][cell0_index];
+				SLiM_gridEntry *entry = entries + cell_starts[cell];
+				SLiM_gridEntry *entry_end = entries + cell_starts[cell + 1];
+				
+				for (; entry < entry_end; ++entry)
+				{
+					slim_popsize_t individual_index = entry->individual_index_;
+					
+					if ((individual_index == p_focal_individual_index) || (individual_index < p_start_exerter) || (individual_index >= p_after_end_exerter))
+						continue;
+					
+					double distance_sq = 0.0;
+					
+					for (int dim = 0; dim < spatiality_; ++dim)
+					{
+						double delta = fabs(entry->x[dim] - p_point[dim]);
+						
+						if ((wrap_bounds[dim] > 0.0) && (delta > wrap_bounds[dim] * 0.5))
+							delta = wrap_bounds[dim] - delta;
+						
+						distance_sq += delta * delta;
+					}
+					
+					if (distance_sq <= max_distance_sq_)
+					{
+						p_indices.push_back((uint32_t)individual_index);
+						p_distances_sq.push_back(distance_sq);
+					}
+				}
+			}
+		}
+	}
+}
+
+void InteractionType::FindNeighbors_Grid(Subpopulation *p_subpop, InteractionsData &p_subpop_data, double *p_point, int p_count, EidosValue_Object_vector &p_result_vec, slim_popsize_t p_focal_individual_index)
+{
+	// Wrap the point into bounds in periodic dimensions, as the k-d tree's replicated nodes effectively do
+	double point[SLIM_MAX_DIMENSIONALITY] = {0.0, 0.0, 0.0};
+	
+	for (int dim = 0; dim < spatiality_; ++dim)
+	{
+		double coord = p_point[dim];
+		
+		if (GridDimensionIsPeriodic(dim, periodic_x_, periodic_y_, periodic_z_))
+		{
+			double bound = GridPeriodicBound(p_subpop_data, dim);
+			
+			if ((coord < 0.0) || (coord > bound))
+				coord -= floor(coord / bound) * bound;
+		}
+		
+		point[dim] = coord;
+	}
+	
+	std::vector<uint32_t> neighbor_indices;
+	std::vector<double> neighbor_distances_sq;
+	std::vector<Individual *> &individuals = p_subpop->parent_individuals_;
+	
+	GridNeighborsOfPoint(p_subpop_data, point, p_focal_individual_index, 0, p_subpop_data.individual_count_, neighbor_indices, neighbor_distances_sq);
+	
+	size_t found_count = neighbor_indices.size();
+	
+	if (found_count == 0)
+		return;
+	
+	if (p_count == 1)
+	{
+		size_t best_index = 0;
+		
+		for (size_t neighbor_index = 1; neighbor_index < found_count; ++neighbor_index)
+			if (neighbor_distances_sq[neighbor_index] < neighbor_distances_sq[best_index])
+				best_index = neighbor_index;
+		
+		p_result_vec.push_object_element(individuals[neighbor_indices[best_index]]);
+	}
+	else if (found_count <= (size_t)p_count)
+	{
+		for (size_t neighbor_index = 0; neighbor_index < found_count; ++neighbor_index)
+			p_result_vec.push_object_element(individuals[neighbor_indices[neighbor_index]]);
+	}
+	else
+	{
+		// More candidates than requested; select the p_count nearest, which are returned in no particular order
+		std::vector<size_t> order(found_count);
+		
+		for (size_t neighbor_index = 0; neighbor_index < found_count; ++neighbor_index)
+			order[neighbor_index] = neighbor_index;
+		
+		std::nth_element(order.begin(), order.begin() + (p_count - 1), order.end(), [&neighbor_distances_sq](size_t a, size_t b) { return neighbor_distances_sq[a] < neighbor_distances_sq[b]; });
+		
+		for (int best_index = 0; best_index < p_count; ++best_index)
+			p_result_vec.push_object_element(individuals[neighbor_indices[order[best_index]]]);
+	}
+}
+
+
 //
 //	Eidos support
 //
@@ -3525,7 +4112,7 @@ EidosValue_SP InteractionType::ExecuteMethod_nearestNeighbors(EidosGlobalStringI
 	double *position_data = subpop_data.positions_;
 	double *ind_position = position_data + ind_index * SLIM_MAX_DIMENSIONALITY;
 	
-	EnsureKDTreePresent(subpop_data);
+	EnsureSpatialIndexPresent(subpop_data);
 	
 	EidosValue_Object_vector *result_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class))->reserve((int)count);
 	
@@ -3579,7 +4166,7 @@ EidosValue_SP InteractionType::ExecuteMethod_nearestNeighborsOfPoint(EidosGlobal
 	// Find the neighbors
 	InteractionsData &subpop_data = subpop_data_iter->second;
 	
-	EnsureKDTreePresent(subpop_data);
+	EnsureSpatialIndexPresent(subpop_data);
 	
 	EidosValue_Object_vector *result_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class))->reserve((int)count);
 	
@@ -4046,6 +4633,12 @@ _InteractionsData::_InteractionsData(_InteractionsData&& p_source)
 	dist_str_ = p_source.dist_str_;
 	kd_nodes_ = p_source.kd_nodes_;
 	kd_root_ = p_source.kd_root_;
+	grid_cell_count_ = p_source.grid_cell_count_;
+	grid_cell_starts_ = p_source.grid_cell_starts_;
+	grid_entries_ = p_source.grid_entries_;
+	std::copy(p_source.grid_dims_, p_source.grid_dims_ + SLIM_MAX_DIMENSIONALITY, grid_dims_);
+	std::copy(p_source.grid_origins_, p_source.grid_origins_ + SLIM_MAX_DIMENSIONALITY, grid_origins_);
+	std::copy(p_source.grid_cell_scales_, p_source.grid_cell_scales_ + SLIM_MAX_DIMENSIONALITY, grid_cell_scales_);
 	
 	p_source.evaluated_ = false;
 	p_source.evaluation_interaction_callbacks_.clear();
@@ -4056,6 +4649,9 @@ _InteractionsData::_InteractionsData(_InteractionsData&& p_source)
 	p_source.dist_str_ = nullptr;
 	p_source.kd_nodes_ = nullptr;
 	p_source.kd_root_ = nullptr;
+	p_source.grid_cell_count_ = 0;
+	p_source.grid_cell_starts_ = nullptr;
+	p_source.grid_entries_ = nullptr;
 }
 
 _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
@@ -4068,6 +4664,10 @@ _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
 			delete dist_str_;
 		if (kd_nodes_)
 			free(kd_nodes_);
+		if (grid_cell_starts_)
+			free(grid_cell_starts_);
+		if (grid_entries_)
+			free(grid_entries_);
 		
 		evaluated_ = p_source.evaluated_;
 		evaluation_interaction_callbacks_.swap(p_source.evaluation_interaction_callbacks_);
@@ -4078,6 +4678,12 @@ _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
 		dist_str_ = p_source.dist_str_;
 		kd_nodes_ = p_source.kd_nodes_;
 		kd_root_ = p_source.kd_root_;
+		grid_cell_count_ = p_source.grid_cell_count_;
+		grid_cell_starts_ = p_source.grid_cell_starts_;
+		grid_entries_ = p_source.grid_entries_;
+		std::copy(p_source.grid_dims_, p_source.grid_dims_ + SLIM_MAX_DIMENSIONALITY, grid_dims_);
+		std::copy(p_source.grid_origins_, p_source.grid_origins_ + SLIM_MAX_DIMENSIONALITY, grid_origins_);
+		std::copy(p_source.grid_cell_scales_, p_source.grid_cell_scales_ + SLIM_MAX_DIMENSIONALITY, grid_cell_scales_);
 		
 		p_source.evaluated_ = false;
 		p_source.evaluation_interaction_callbacks_.clear();
@@ -4088,6 +4694,9 @@ _InteractionsData& _InteractionsData::operator=(_InteractionsData&& p_source)
 		p_source.dist_str_ = nullptr;
 		p_source.kd_nodes_ = nullptr;
 		p_source.kd_root_ = nullptr;
+		p_source.grid_cell_count_ = 0;
+		p_source.grid_cell_starts_ = nullptr;
+		p_source.grid_entries_ = nullptr;
 	}
 	
 	return *this;
@@ -4123,6 +4732,18 @@ _InteractionsData::~_InteractionsData(void)
 	
 	kd_root_ = nullptr;
 	
+	if (grid_cell_starts_)
+	{
+		free(grid_cell_starts_);
+		grid_cell_starts_ = nullptr;
+	}
+	
+	if (grid_entries_)
+	{
+		free(grid_entries_);
+		grid_entries_ = nullptr;
+	}
+	
 	// Unnecessary since it's about to be destroyed anyway
 	//evaluation_interaction_callbacks_.clear();
 }
@@ -63,6 +63,18 @@ enum class IFType : char {
 std::ostream& operator<<(std::ostream& p_out, IFType p_if_type);
 
 
+// This enumeration represents the spatial index an interaction type uses to find neighbors and interacting pairs.  The k-d tree
+// is the default and works well in general; the uniform grid is faster when maxDistance is small relative to the occupied space,
+// since it can be built in O(N) and scanned cache-friendly.  kAuto chooses between them at evaluation time.
+enum class SpatialIndexType : char {
+	kKDTree = 0,
+	kGrid,
+	kAuto
+};
+
+std::ostream& operator<<(std::ostream& p_out, SpatialIndexType p_index_type);
+
+
 // This class uses an internal implementation of kd-trees for fast nearest-neighbor finding.  We use the same data structure to
 // save computed distances and interaction strengths.  A value of NaN is used as a placeholder to indicate that a given value
 // has not yet been calculated, and we fill the data structure in lazily.  We keep one such data structure per evaluated
@@ -78,6 +90,16 @@ struct _SLiM_kdNode
 };
 typedef struct _SLiM_kdNode SLiM_kdNode;
 
+// The uniform grid (cell list) alternative to the k-d tree keeps individuals sorted by cell; each cell's entries are contiguous,
+// and grid_cell_starts_ gives the first entry of each cell (with one extra entry at the end).  Cells are at least maxDistance
+// wide, so all interacting partners of an individual lie within its own cell and the cells adjacent to it.
+struct _SLiM_gridEntry
+{
+	double x[SLIM_MAX_DIMENSIONALITY];		// the coordinates of the individual
+	slim_popsize_t individual_index_;		// the index of the individual in its subpopulation
+};
+typedef struct _SLiM_gridEntry SLiM_gridEntry;
+
 struct _InteractionsData
 {
 	// This flag is true when the interaction has been evaluated.  What that means in practice is that allocated blocks below
@@ -104,6 +126,13 @@ struct _InteractionsData
 	SLiM_kdNode *kd_nodes_ = nullptr;		// individual_count_ entries, holding the nodes of the k-d tree
 	SLiM_kdNode *kd_root_ = nullptr;		// the root of the k-d tree
 	
+	int grid_dims_[SLIM_MAX_DIMENSIONALITY];				// the number of grid cells along each dimension; unused dimensions have 1 cell
+	double grid_origins_[SLIM_MAX_DIMENSIONALITY];			// the coordinate of the lower edge of the grid along each dimension
+	double grid_cell_scales_[SLIM_MAX_DIMENSIONALITY];		// the reciprocal of the cell size along each dimension
+	int64_t grid_cell_count_ = 0;							// the total number of cells in the grid
+	slim_popsize_t *grid_cell_starts_ = nullptr;			// grid_cell_count_ + 1 entries, giving the start of each cell in grid_entries_
+	SLiM_gridEntry *grid_entries_ = nullptr;				// individual_count_ entries, sorted by cell
+	
 	_InteractionsData(const _InteractionsData&) = delete;					// no copying
 	_InteractionsData& operator=(const _InteractionsData&) = delete;		// no copying
 	_InteractionsData(_InteractionsData&&);									// move constructor, for std::map compatibility
@@ -137,6 +166,7 @@ private:
 	double max_distance_sq_;					// the maximum distance squared, cached for speed
 	IndividualSex receiver_sex_;				// the sex of the individuals that feel the interaction
 	IndividualSex exerter_sex_;					// the sex of the individuals that exert the interaction
+	SpatialIndexType spatial_index_type_;		// the type of spatial index requested for neighbor searches
 	
 	slim_usertag_t tag_value_ = SLIM_TAG_UNSET_VALUE;	// a user-defined tag value
 	
@@ -148,8 +178,10 @@ private:
 	bool periodic_z_ = false;
 	
 	std::map<slim_objectid_t, InteractionsData> data_;		// cached data for the interaction, for each subpopulation
+	std::vector<SparseArray *> sa_fragments_;				// per-thread sparse array fragments for multithreaded distance calculation, kept for reuse
 	
 	void CalculateAllDistances(Subpopulation *p_subpop);
+	void CalculateDistancesForRows(InteractionsData &p_subpop_data, SparseArray *p_sparse_array, int p_start_row, int p_after_end_row, int p_start_exerter, int p_after_end_exerter);
 	void CalculateAllStrengths(Subpopulation *p_subpop);
 	
 	double CalculateDistance(double *p_position1, double *p_position2);
@@ -167,8 +199,15 @@ private:
 	SLiM_kdNode *MakeKDTree3_p0(SLiM_kdNode *t, int len);
 	SLiM_kdNode *MakeKDTree3_p1(SLiM_kdNode *t, int len);
 	SLiM_kdNode *MakeKDTree3_p2(SLiM_kdNode *t, int len);
+	SLiM_kdNode *MakeKDTree_Parallel(SLiM_kdNode *t, int len, int p_phase, int p_depth);
 	void EnsureKDTreePresent(InteractionsData &p_subpop_data);
 	
+	bool ConfigureGridGeometry(InteractionsData &p_subpop_data);
+	void BuildGrid(InteractionsData &p_subpop_data);
+	void EnsureSpatialIndexPresent(InteractionsData &p_subpop_data);
+	int GridCellsForCoordinate(InteractionsData &p_subpop_data, int p_dim, double p_coord, int *p_cells);
+	void GridNeighborsOfPoint(InteractionsData &p_subpop_data, double *p_point, slim_popsize_t p_focal_individual_index, int p_start_exerter, int p_after_end_exerter, std::vector<uint32_t> &p_indices, std::vector<double> &p_distances_sq);
+	
 	int CheckKDTree1_p0(SLiM_kdNode *t);
 	void CheckKDTree1_p0_r(SLiM_kdNode *t, double split, bool isLeftSubtree);
 	int CheckKDTree2_p0(SLiM_kdNode *t);
@@ -199,6 +238,7 @@ private:
 	void FindNeighborsN_2(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase);
 	void FindNeighborsN_3(SLiM_kdNode *root, double *nd, slim_popsize_t p_focal_individual_index, int p_count, SLiM_kdNode **best, double *best_dist, int p_phase);
 	void FindNeighbors(Subpopulation *p_subpop, InteractionsData &p_subpop_data, double *p_point, int p_count, EidosValue_Object_vector &p_result_vec, Individual *p_excluded_individual);
+	void FindNeighbors_Grid(Subpopulation *p_subpop, InteractionsData &p_subpop_data, double *p_point, int p_count, EidosValue_Object_vector &p_result_vec, slim_popsize_t p_focal_individual_index);
 	
 public:
 	
@@ -209,7 +249,7 @@ public:
 	InteractionType(const InteractionType&) = delete;					// no copying
 	InteractionType& operator=(const InteractionType&) = delete;		// no copying
 	InteractionType(void) = delete;										// no null construction
-	InteractionType(SLiMSim &p_sim, slim_objectid_t p_interaction_type_id, std::string p_spatiality_string, bool p_reciprocal, double p_max_distance, IndividualSex p_receiver_sex, IndividualSex p_exerter_sex);
+	InteractionType(SLiMSim &p_sim, slim_objectid_t p_interaction_type_id, std::string p_spatiality_string, bool p_reciprocal, double p_max_distance, IndividualSex p_receiver_sex, IndividualSex p_exerter_sex, SpatialIndexType p_spatial_index_type);
 	~InteractionType(void);
 	
 	void EvaluateSubpopulation(Subpopulation *p_subpop, bool p_immediate);
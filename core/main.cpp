@@ -98,7 +98,7 @@ static void PrintUsageAndDie(bool p_print_header, bool p_print_full_usage)
 	
 	SLIM_OUTSTREAM << "usage: slim -v[ersion] | -u[sage] | -testEidos | -testSLiM |" << std::endl;
 	SLIM_OUTSTREAM << "   [-l[ong] [<l>]] [-s[eed] <seed>] [-t[ime]] [-m[em]] [-M[emhist]] [-x]" << std::endl;
-	SLIM_OUTSTREAM << "   [-d[efine] <def>] [<script file>]" << std::endl;
+	SLIM_OUTSTREAM << "   [-d[efine] <def>] [-threads <n>] [-profile <file>] [<script file>]" << std::endl;
 	
 	if (p_print_full_usage)
 	{
@@ -115,6 +115,8 @@ static void PrintUsageAndDie(bool p_print_header, bool p_print_full_usage)
 		SLIM_OUTSTREAM << "   -M[emhist]       : print a histogram of SLiM's memory usage" << std::endl;
 		SLIM_OUTSTREAM << "   -x               : disable SLiM's runtime safety/consistency checks" << std::endl;
 		SLIM_OUTSTREAM << "   -d[efine] <def>  : define an Eidos constant, such as \"mu=1e-7\"" << std::endl;
+		SLIM_OUTSTREAM << "   -threads <n>     : use up to <n> threads for offspring generation and fitness evaluation (default 1)" << std::endl;
+		SLIM_OUTSTREAM << "   -profile <file>  : write a profile report, in JSON format, to <file> (requires a PROFILE=ON build)" << std::endl;
 		SLIM_OUTSTREAM << "   <script file>    : the input script file (stdin may be used instead)" << std::endl;
 	}
 	
@@ -136,6 +138,27 @@ static void clean_up_leak_false_positives(void)
 }
 #endif
 
+#if (SLIMPROFILING == 1)
+// Run one generation with profiling; this brackets the generation in the same way that SLiMgui does when profiling
+static bool RunOneGenerationWithProfiling(SLiMSim *p_sim, eidos_profile_t *p_elapsed_wall_clock, clock_t *p_elapsed_CPU_clock, slim_generation_t *p_generation_count)
+{
+	// We put the wall clock measurements on the inside since we want those to be maximally accurate,
+	// as profile report percentages are fractions of the total elapsed wall clock time.
+	clock_t startCPUClock = clock();
+	SLIM_PROFILE_BLOCK_START();
+	
+	bool still_running = p_sim->RunOneGeneration();
+	
+	SLIM_PROFILE_BLOCK_END(*p_elapsed_wall_clock);
+	clock_t endCPUClock = clock();
+	
+	*p_elapsed_CPU_clock += (endCPUClock - startCPUClock);
+	(*p_generation_count)++;
+	
+	return still_running;
+}
+#endif
+
 static void test_exit(int test_result)
 {
 #if SLIM_LEAK_CHECKING
@@ -155,6 +178,9 @@ int main(int argc, char *argv[])
 	unsigned long int override_seed = 0;					// this is the type used for seeds in the GSL
 	unsigned long int *override_seed_ptr = nullptr;			// by default, a seed is generated or supplied in the input file
 	const char *input_file = nullptr;
+#if (SLIMPROFILING == 1)
+	const char *profile_output_path = nullptr;
+#endif
 	bool keep_time = false, keep_mem = false, keep_mem_hist = false, skip_checks = false, tree_seq_checks = false;
 	std::vector<std::string> defined_constants;
 	
@@ -319,6 +345,48 @@ int main(int argc, char *argv[])
 			continue;
 		}
 		
+		// -threads <n>: allow up to n threads to be used in multithreaded code paths; results do not depend on n
+		if (strcmp(arg, "-threads") == 0)
+		{
+			if (++arg_index == argc)
+				PrintUsageAndDie(false, true);
+			
+			long thread_count = strtol(argv[arg_index], NULL, 10);
+			
+			if ((thread_count < 1) || (thread_count > 1024))
+			{
+				SLIM_ERRSTREAM << "Thread count supplied to -threads must be in [1, 1024]." << std::endl;
+				exit(0);
+			}
+			
+#ifndef _OPENMP
+			if (thread_count > 1)
+			{
+				SLIM_ERRSTREAM << "// ********** This build of SLiM does not support multithreading; -threads will be ignored" << std::endl << std::endl;
+				thread_count = 1;
+			}
+#endif
+			
+			gEidosMaxThreads = (int)thread_count;
+			
+			continue;
+		}
+		
+		// -profile <file>: profile the run, and write a report to the given file at the end of the run
+		if (strcmp(arg, "-profile") == 0)
+		{
+			if (++arg_index == argc)
+				PrintUsageAndDie(false, true);
+			
+#if (SLIMPROFILING == 1)
+			profile_output_path = argv[arg_index];
+#else
+			SLIM_ERRSTREAM << "// ********** This build of SLiM does not support profiling (build with cmake -D PROFILE=ON); -profile will be ignored" << std::endl << std::endl;
+#endif
+			
+			continue;
+		}
+		
 		// -TSXC is an undocumented command-line flag that turns on tree-sequence recording and runtime crosschecks
 		if (strcmp(arg, "-TSXC") == 0)
 		{
@@ -419,6 +487,27 @@ int main(int argc, char *argv[])
 		if (tree_seq_checks)
 			sim->TSXC_Enable();
 		
+#if (SLIMPROFILING == 1)
+		// Prepare for profiling; we open the output file now so that a bad path is caught before the run
+		std::ofstream profile_stream;
+		eidos_profile_t profile_elapsed_wall_clock = 0;
+		clock_t profile_elapsed_CPU_clock = 0;
+		slim_generation_t profile_start_generation = sim->Generation();
+		slim_generation_t profile_generation_count = 0;
+		
+		if (profile_output_path)
+		{
+			profile_stream.open(profile_output_path);
+			
+			if (!profile_stream.is_open())
+				EIDOS_TERMINATION << std::endl << "ERROR (main): could not open profile output file: " << profile_output_path << "." << EidosTerminate();
+			
+			Eidos_PrepareForProfiling();
+			gEidosProfilingClientCount++;
+			sim->StartProfiling();
+		}
+#endif
+		
 #if DO_MEMORY_CHECKS
 		// We check memory usage at the end of every 10 generations, to be able to provide the user with a decent error message
 		// if the maximum memory limit is exceeded.  Every 10 generations is a compromise; these checks do take a little time.
@@ -429,7 +518,11 @@ int main(int argc, char *argv[])
 #endif
 		
 		// Run the simulation to its natural end
+#if (SLIMPROFILING == 1)
+		while (profile_output_path ? RunOneGenerationWithProfiling(sim, &profile_elapsed_wall_clock, &profile_elapsed_CPU_clock, &profile_generation_count) : sim->RunOneGeneration())
+#else
 		while (sim->RunOneGeneration())
+#endif
 		{
 			if (keep_mem_hist)
 			{
@@ -460,6 +553,16 @@ int main(int argc, char *argv[])
 #endif
 		}
 		
+#if (SLIMPROFILING == 1)
+		// Write out the profile report
+		if (profile_output_path)
+		{
+			gEidosProfilingClientCount--;
+			sim->WriteProfileReport(profile_stream, profile_elapsed_wall_clock, profile_elapsed_CPU_clock, profile_start_generation, profile_generation_count);
+			profile_stream.close();
+		}
+#endif
+		
 		// clean up; but this is an unnecessary waste of time in the command-line context
 #if SLIM_LEAK_CHECKING
 		delete sim;
@@ -31,12 +31,16 @@
 
 // All Mutation objects get allocated out of a single shared block, for speed; see SLiM_WarmUp()
 Mutation *gSLiM_Mutation_Block = nullptr;
-MutationIndex gSLiM_Mutation_Block_Capacity = 0;
+int64_t gSLiM_Mutation_Block_Capacity = 0;	// wider than MutationIndex, since the capacity can exceed the largest valid index by one
 MutationIndex gSLiM_Mutation_FreeIndex = -1;
 MutationIndex gSLiM_Mutation_Block_LastUsedIndex = -1;
 
 slim_refcount_t *gSLiM_Mutation_Refcounts = nullptr;
 
+slim_position_t *gSLiM_Mutation_Positions = nullptr;
+slim_selcoeff_t *gSLiM_Mutation_OnePlusSel = nullptr;
+slim_selcoeff_t *gSLiM_Mutation_OnePlusDomSel = nullptr;
+
 #define SLIM_MUTATION_BLOCK_INITIAL_SIZE	16384		// makes for about a 1 MB block; not unreasonable
 
 extern std::vector<EidosValue_Object *> gEidosValue_Object_Mutation_Registry;	// this is in Eidos; see SLiM_IncreaseMutationBlockCapacity()
@@ -47,12 +51,15 @@ void SLiM_CreateMutationBlock(void)
 	gSLiM_Mutation_Block_Capacity = SLIM_MUTATION_BLOCK_INITIAL_SIZE;
 	gSLiM_Mutation_Block = (Mutation *)malloc(gSLiM_Mutation_Block_Capacity * sizeof(Mutation));
 	gSLiM_Mutation_Refcounts = (slim_refcount_t *)malloc(gSLiM_Mutation_Block_Capacity * sizeof(slim_refcount_t));
+	gSLiM_Mutation_Positions = (slim_position_t *)malloc(gSLiM_Mutation_Block_Capacity * sizeof(slim_position_t));
+	gSLiM_Mutation_OnePlusSel = (slim_selcoeff_t *)malloc(gSLiM_Mutation_Block_Capacity * sizeof(slim_selcoeff_t));
+	gSLiM_Mutation_OnePlusDomSel = (slim_selcoeff_t *)malloc(gSLiM_Mutation_Block_Capacity * sizeof(slim_selcoeff_t));
 	
 	//std::cout << "Allocating initial mutation block, " << SLIM_MUTATION_BLOCK_INITIAL_SIZE * sizeof(Mutation) << " bytes (sizeof(Mutation) == " << sizeof(Mutation) << ")" << std::endl;
 	
 	// now we need to set up our free list inside the block; initially all blocks are free
 	for (MutationIndex i = 0; i < gSLiM_Mutation_Block_Capacity - 1; ++i)
-		*(MutationIndex *)(gSLiM_Mutation_Block + i) = i + 1;
+		*(MutationIndex *)(gSLiM_Mutation_Block + i) = (MutationIndex)(i + 1);
 	
 	*(MutationIndex *)(gSLiM_Mutation_Block + gSLiM_Mutation_Block_Capacity - 1) = -1;
 	
@@ -79,22 +86,31 @@ void SLiM_IncreaseMutationBlockCapacity(void)
 	// For now we will just double in size; we don't want to waste too much memory, but we
 	// don't want to have to realloc too often, either.
 	std::uintptr_t old_mutation_block = reinterpret_cast<std::uintptr_t>(gSLiM_Mutation_Block);
-	MutationIndex old_block_capacity = gSLiM_Mutation_Block_Capacity;
+	int64_t old_block_capacity = gSLiM_Mutation_Block_Capacity;
+	
+	// The new capacity must be representable, and so must every index into it; otherwise MutationIndex would overflow
+	if (old_block_capacity * 2 - 1 > (int64_t)SLIM_MUTATION_INDEX_MAX)
+	{
+		EIDOS_TERMINATION << "ERROR (SLiM_IncreaseMutationBlockCapacity): too many mutations; there is no room in the mutation block for more than " << old_block_capacity << " mutations to exist at once." << EidosTerminate(nullptr);
+	}
 	
 	gSLiM_Mutation_Block_Capacity *= 2;
 	gSLiM_Mutation_Block = (Mutation *)realloc(gSLiM_Mutation_Block, gSLiM_Mutation_Block_Capacity * sizeof(Mutation));
 	gSLiM_Mutation_Refcounts = (slim_refcount_t *)realloc(gSLiM_Mutation_Refcounts, gSLiM_Mutation_Block_Capacity * sizeof(slim_refcount_t));
+	gSLiM_Mutation_Positions = (slim_position_t *)realloc(gSLiM_Mutation_Positions, gSLiM_Mutation_Block_Capacity * sizeof(slim_position_t));
+	gSLiM_Mutation_OnePlusSel = (slim_selcoeff_t *)realloc(gSLiM_Mutation_OnePlusSel, gSLiM_Mutation_Block_Capacity * sizeof(slim_selcoeff_t));
+	gSLiM_Mutation_OnePlusDomSel = (slim_selcoeff_t *)realloc(gSLiM_Mutation_OnePlusDomSel, gSLiM_Mutation_Block_Capacity * sizeof(slim_selcoeff_t));
 	
 	std::uintptr_t new_mutation_block = reinterpret_cast<std::uintptr_t>(gSLiM_Mutation_Block);
 	
 	// Set up the free list to extend into the new portion of the buffer.  If we are called when
 	// gSLiM_Mutation_FreeIndex != -1, the free list will start with the new region.
-	for (MutationIndex i = old_block_capacity; i < gSLiM_Mutation_Block_Capacity - 1; ++i)
-		*(MutationIndex *)(gSLiM_Mutation_Block + i) = i + 1;
+	for (MutationIndex i = (MutationIndex)old_block_capacity; i < gSLiM_Mutation_Block_Capacity - 1; ++i)
+		*(MutationIndex *)(gSLiM_Mutation_Block + i) = (MutationIndex)(i + 1);
 	
 	*(MutationIndex *)(gSLiM_Mutation_Block + gSLiM_Mutation_Block_Capacity - 1) = gSLiM_Mutation_FreeIndex;
 	
-	gSLiM_Mutation_FreeIndex = old_block_capacity;
+	gSLiM_Mutation_FreeIndex = (MutationIndex)old_block_capacity;
 	
 	// Now we go out and fix Mutation * references in EidosValue_Object in all symbol tables
 	if (new_mutation_block != old_mutation_block)
@@ -170,6 +186,11 @@ size_t SLiM_MemoryUsageForMutationRefcounts(void)
 	return gSLiM_Mutation_Block_Capacity * sizeof(slim_refcount_t);
 }
 
+size_t SLiM_MemoryUsageForMutationHotBuffers(void)
+{
+	return gSLiM_Mutation_Block_Capacity * (sizeof(slim_position_t) + sizeof(slim_selcoeff_t) + sizeof(slim_selcoeff_t));
+}
+
 
 #pragma mark -
 #pragma mark Mutation
@@ -187,6 +208,8 @@ mutation_type_ptr_(p_mutation_type_ptr), position_(p_position), selection_coeff_
 	// cache values used by the fitness calculation code for speed; see header
 	cached_one_plus_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + selection_coeff_);
 	cached_one_plus_dom_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + mutation_type_ptr_->dominance_coeff_ * selection_coeff_);
+	SyncHotBuffers();
+	gSLiM_Mutation_Positions[BlockIndex()] = position_;
 	
 	// zero out our refcount, which is now kept in a separate buffer
 	gSLiM_Mutation_Refcounts[BlockIndex()] = 0;
@@ -239,6 +262,8 @@ mutation_type_ptr_(p_mutation_type_ptr), position_(p_position), selection_coeff_
 	// cache values used by the fitness calculation code for speed; see header
 	cached_one_plus_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + selection_coeff_);
 	cached_one_plus_dom_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + mutation_type_ptr_->dominance_coeff_ * selection_coeff_);
+	SyncHotBuffers();
+	gSLiM_Mutation_Positions[BlockIndex()] = position_;
 	
 	// zero out our refcount, which is now kept in a separate buffer
 	gSLiM_Mutation_Refcounts[BlockIndex()] = 0;
@@ -624,6 +649,7 @@ EidosValue_SP Mutation::ExecuteMethod_setSelectionCoeff(EidosGlobalStringID p_me
 	// cache values used by the fitness calculation code for speed; see header
 	cached_one_plus_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + selection_coeff_);
 	cached_one_plus_dom_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + mutation_type_ptr_->dominance_coeff_ * selection_coeff_);
+	SyncHotBuffers();
 	
 	return gStaticEidosValueVOID;
 }
@@ -651,6 +677,7 @@ EidosValue_SP Mutation::ExecuteMethod_setMutationType(EidosGlobalStringID p_meth
 	// cache values used by the fitness calculation code for speed; see header
 	cached_one_plus_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + selection_coeff_);
 	cached_one_plus_dom_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + mutation_type_ptr_->dominance_coeff_ * selection_coeff_);
+	SyncHotBuffers();
 	
 	return gStaticEidosValueVOID;
 }
@@ -46,16 +46,28 @@ extern slim_mutationid_t gSLiM_next_mutation_id;
 // Note that type int32_t is used instead of uint32_t so that -1 can be used as a "null pointer"; perhaps UINT32_MAX would be
 // better, but on the other hand using int32_t has the virtue that if we run out of room we will probably crash hard rather
 // than perhaps just silently overrunning gSLiM_Mutation_Block with mysterious memory corruption bugs that are hard to catch.
-// For small simulations, defining this as int16_t instead can produce a substantial speedup (as much as 25%), but there are no
-// safeguards in the code to check for running out of indices, so doing that is quite dangerous at present.  A way to make
-// simulations switch from 16-bit to 32-bit at runtime, to get that speedup when possible, would be nice but in practice is very
-// difficult to code since MutationRun's internal buffer of MutationIndex is accessible and used directly by many clients.
+// For small simulations, defining this as int16_t instead can produce a substantial speedup (as much as 25%).  The index width
+// is not a build option, however: SLiM_IncreaseMutationBlockCapacity() does check that the mutation block never outgrows the
+// range of MutationIndex, but a model that needed more than 32768 mutations at once would then stop with an error rather than
+// continuing.  A way to make simulations switch from 16-bit to 32-bit at runtime, to get that speedup when possible, would be
+// nice but in practice is very difficult to code since MutationRun's internal buffer of MutationIndex is accessible and used
+// directly by many clients.
 typedef int32_t MutationIndex;
+#define SLIM_MUTATION_INDEX_MAX		INT32_MAX
 
 // forward declaration of Mutation block allocation; see bottom of header
 class Mutation;
 extern Mutation *gSLiM_Mutation_Block;
 
+// "Hot" side buffers, parallel to gSLiM_Mutation_Block, holding the fields read by the core loops (merging mutation runs by
+// position, and multiplying fitness effects).  Keeping these in separate dense arrays means those loops touch 4-byte entries
+// instead of pulling whole Mutation objects into cache.  The fields in Mutation remain authoritative; whoever writes one of
+// them must write the corresponding side buffer entry as well (see Mutation::SyncHotBuffers()).  They cost 16 bytes per slot in
+// the mutation block, beside sizeof(Mutation); outputUsage() reports them separately from the refcount buffer.
+extern slim_position_t *gSLiM_Mutation_Positions;
+extern slim_selcoeff_t *gSLiM_Mutation_OnePlusSel;
+extern slim_selcoeff_t *gSLiM_Mutation_OnePlusDomSel;
+
 
 class Mutation : public SLiMEidosDictionary
 {
@@ -104,6 +116,15 @@ public:
 	
 	inline __attribute__((always_inline)) MutationIndex BlockIndex(void) const			{ return (MutationIndex)(this - gSLiM_Mutation_Block); }
 	
+	// copy the cached fitness effects into the hot side buffers; must be called whenever the cached values change
+	inline __attribute__((always_inline)) void SyncHotBuffers(void) const
+	{
+		MutationIndex block_index = BlockIndex();
+		
+		gSLiM_Mutation_OnePlusSel[block_index] = cached_one_plus_sel_;
+		gSLiM_Mutation_OnePlusDomSel[block_index] = cached_one_plus_dom_sel_;
+	}
+	
 	//
 	// Eidos support
 	//
@@ -166,12 +187,13 @@ extern MutationIndex gSLiM_Mutation_FreeIndex;
 extern MutationIndex gSLiM_Mutation_Block_LastUsedIndex;
 
 extern slim_refcount_t *gSLiM_Mutation_Refcounts;	// an auxiliary buffer, parallel to gSLiM_Mutation_Block, to increase memory cache efficiency
-													// note that I tried keeping the fitness cache values and positions in separate buffers too, not a win
+													// positions and fitness caches are also mirrored in side buffers; see gSLiM_Mutation_Positions above
 void SLiM_CreateMutationBlock(void);
 void SLiM_IncreaseMutationBlockCapacity(void);
 void SLiM_ZeroRefcountBlock(MutationRun &p_mutation_registry);
 size_t SLiM_MemoryUsageForMutationBlock(void);
 size_t SLiM_MemoryUsageForMutationRefcounts(void);
+size_t SLiM_MemoryUsageForMutationHotBuffers(void);
 
 inline __attribute__((always_inline)) MutationIndex SLiM_NewMutationFromBlock(void)
 {
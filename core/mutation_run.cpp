@@ -257,8 +257,15 @@ const std::vector<Mutation *> *MutationRun::derived_mutation_ids_at_position(sli
 {
 	static std::vector<Mutation *> return_vec;
 	
+	derived_mutation_ids_at_position(p_position, return_vec);
+	
+	return &return_vec;
+}
+
+void MutationRun::derived_mutation_ids_at_position(slim_position_t p_position, std::vector<Mutation *> &p_derived_mutations) const
+{
 	// First clear out whatever might be left over from last time
-	return_vec.clear();
+	p_derived_mutations.clear();
 	
 	// Then fill in all the mutation IDs at the given position.  We search backward from the end since usually we are called
 	// when a new mutation has just been added to the end; this will be slow for addNew[Drawn]Mutation() and removeMutations(),
@@ -273,12 +280,10 @@ const std::vector<Mutation *> *MutationRun::derived_mutation_ids_at_position(sli
 		slim_position_t mut_position = mut->position_;
 		
 		if (mut_position == p_position)
-			return_vec.push_back(mut);
+			p_derived_mutations.push_back(mut);
 		else if (mut_position < p_position)
 			break;
 	}
-	
-	return &return_vec;
 }
 
 void MutationRun::_RemoveFixedMutations(void)
@@ -302,7 +307,9 @@ void MutationRun::_RemoveFixedMutations(void)
 			continue;
 		
 		// Fixed mutation; we want to omit it, so we skip it in genome_backfill_iter and transition to the second loop
+		// our contents are changing in place, so if we are interned we need to leave our intern table now
 		genome_backfill_iter = genome_iter - 1;
+		Unintern();
 		break;
 	}
 	
@@ -687,49 +694,159 @@ size_t MutationRun::MemoryUsageForNonneutralCaches(void)
 	return nonneutral_mutation_capacity_ * sizeof(MutationIndex);
 }
 
+void MutationRun::_Unintern(void)
+{
+	intern_table_->Remove(this);
+}
 
 
+//
+//	MutationRunInternTable
+//
+#pragma mark -
+#pragma mark MutationRunInternTable
+#pragma mark -
 
+MutationRunInternTable::~MutationRunInternTable(void)
+{
+	// Runs can outlive the table (they are freed when the last genome referring to them goes away), so they must forget us
+	RemoveAll();
+	
+	if (entries_)
+	{
+		free(entries_);
+		entries_ = nullptr;
+	}
+}
 
+void MutationRunInternTable::ResizeTable(size_t p_new_capacity)
+{
+	MutationRunInternEntry *old_entries = entries_;
+	size_t old_capacity = capacity_;
+	
+	entries_ = (MutationRunInternEntry *)calloc(p_new_capacity, sizeof(MutationRunInternEntry));
+	if (!entries_)
+		EIDOS_TERMINATION << "ERROR (MutationRunInternTable::ResizeTable): allocation failed; you may need to raise the memory limit for SLiM." << EidosTerminate(nullptr);
+	
+	capacity_ = p_new_capacity;
+	capacity_shift_ = 64;
+	
+	for (size_t capacity = p_new_capacity; capacity > 1; capacity >>= 1)
+		capacity_shift_--;
+	
+	// Re-enter the existing entries; they are all distinct, so there is no need to check for duplicates
+	size_t mask = capacity_ - 1;
+	
+	for (size_t old_index = 0; old_index < old_capacity; ++old_index)
+	{
+		MutationRunInternEntry &old_entry = old_entries[old_index];
+		
+		if (old_entry.run_)
+		{
+			size_t slot = HomeSlot(old_entry.hash_);
+			
+			while (entries_[slot].run_)
+				slot = (slot + 1) & mask;
+			
+			entries_[slot] = old_entry;
+		}
+	}
+	
+	if (old_entries)
+		free(old_entries);
+}
 
+MutationRun *MutationRunInternTable::Intern(MutationRun *p_run)
+{
+#if DEBUG
+	if (p_run->intern_table_)
+		EIDOS_TERMINATION << "ERROR (MutationRunInternTable::Intern): (internal error) run is already interned." << EidosTerminate();
+#endif
+	
+	// keep the load factor at or below one half, so probe sequences stay short
+	if ((count_ + 1) * 2 > capacity_)
+		ResizeTable(capacity_ ? capacity_ * 2 : 1024);
+	
+	int64_t hash = p_run->Hash();
+	size_t mask = capacity_ - 1;
+	size_t slot = HomeSlot(hash);
+	
+	while (true)
+	{
+		MutationRunInternEntry &entry = entries_[slot];
+		MutationRun *entry_run = entry.run_;
+		
+		if (!entry_run)
+			break;
+		
+		if ((entry.hash_ == hash) && entry_run->Identical(*p_run))
+			return entry_run;
+		
+		slot = (slot + 1) & mask;
+	}
+	
+	entries_[slot].hash_ = hash;
+	entries_[slot].run_ = p_run;
+	count_++;
+	
+	p_run->intern_table_ = this;
+	p_run->intern_hash_ = hash;
+	
+	return p_run;
+}
 
+void MutationRunInternTable::Remove(MutationRun *p_run)
+{
+	size_t mask = capacity_ - 1;
+	size_t slot = HomeSlot(p_run->intern_hash_);
+	
+	while (entries_[slot].run_ != p_run)
+	{
+#if DEBUG
+		if (!entries_[slot].run_)
+			EIDOS_TERMINATION << "ERROR (MutationRunInternTable::Remove): (internal error) interned run not found." << EidosTerminate();
+#endif
+		slot = (slot + 1) & mask;
+	}
+	
+	p_run->intern_table_ = nullptr;
+	count_--;
+	
+	// Backward-shift deletion: move later entries in the probe sequence back into the hole, if their home slot allows it
+	size_t hole = slot;
+	size_t scan = (slot + 1) & mask;
+	
+	while (entries_[scan].run_)
+	{
+		size_t home = HomeSlot(entries_[scan].hash_);
+		
+		// the entry at scan can fill the hole only if its home slot is not cyclically within (hole, scan]
+		bool home_in_range = (hole <= scan) ? ((hole < home) && (home <= scan)) : ((hole < home) || (home <= scan));
+		
+		if (!home_in_range)
+		{
+			entries_[hole] = entries_[scan];
+			hole = scan;
+		}
+		
+		scan = (scan + 1) & mask;
+	}
+	
+	entries_[hole].run_ = nullptr;
+}
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+void MutationRunInternTable::RemoveAll(void)
+{
+	for (size_t index = 0; index < capacity_; ++index)
+	{
+		MutationRun *run = entries_[index].run_;
+		
+		if (run)
+		{
+			run->intern_table_ = nullptr;
+			entries_[index].run_ = nullptr;
+		}
+	}
+	
+	count_ = 0;
+}
@@ -39,6 +39,7 @@
 
 
 class MutationRun;
+class MutationRunInternTable;
 
 typedef Eidos_intrusive_ptr<MutationRun>	MutationRun_SP;
 
@@ -143,15 +144,22 @@ private:
 	
 	int32_t nonneutral_change_validation_ = 0;					// compared to sim.nonneutral_change_counter_ to detect changes
 
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 // PROFILING
 	
 	bool recached_run_ = false;
 	
-#endif	// defined(SLIMGUI) && (SLIMPROFILING == 1)
+#endif	// (SLIMPROFILING == 1)
 	
 #endif	// SLIM_USE_NONNEUTRAL_CACHES
 	
+	// Interning: a run that has been entered into a MutationRunInternTable records the table, and the hash it was entered under,
+	// so that it can remove itself when it is freed or modified in place.  An interned run's contents always match that hash.
+	MutationRunInternTable *intern_table_ = nullptr;			// NOT OWNED: the table this run is interned in, or nullptr
+	int64_t intern_hash_ = 0;									// the Hash() value this run was interned with
+	
+	void _Unintern(void);
+	
 public:
 	
 	int64_t operation_id_ = 0;		// used to mark the MutationRun objects that have been handled by a global operation
@@ -181,6 +189,9 @@ public:
 		// We return mutation runs to the free list in a valid, reuseable state.  We do not free its buffers, avoiding that
 		// free/alloc thrash is one of the big wins of recycling mutation run objects, in fact.
 		
+		if (p_run->intern_table_)
+			p_run->_Unintern();						// a freed run must not remain findable in its intern table
+		
 		p_run->mutation_count_ = 0;						// empty the mutation buffer
 		
 #if SLIM_USE_NONNEUTRAL_CACHES
@@ -232,8 +243,14 @@ public:
 #if SLIM_USE_NONNEUTRAL_CACHES
 		nonneutral_mutations_count_ = -1;		// invalidate the nonneutral cache since the run is changing
 #endif
+		
+		if (intern_table_)
+			_Unintern();						// the run's contents will no longer match the hash it was interned with
 	}
 	
+	inline __attribute__((always_inline)) bool IsInterned(void) const { return (intern_table_ != nullptr); }
+	inline __attribute__((always_inline)) void Unintern(void) { if (intern_table_) _Unintern(); }
+	
 	inline __attribute__((always_inline)) MutationIndex const & operator[] (int p_index) const {	// [] returns a reference to a pointer to Mutation; this is the const-pointer variant
 		return mutations_[p_index];
 	}
@@ -382,13 +399,14 @@ public:
 		if (mutation_count_ == 1)
 			return;
 		
-		// then find the proper position for it
-		Mutation *mut_ptr_to_insert = gSLiM_Mutation_Block + p_mutation_index;
+		// then find the proper position for it; positions are read from the side buffer, which is denser than the Mutation block
+		const slim_position_t *position_block_ptr = gSLiM_Mutation_Positions;
+		slim_position_t position_to_insert = position_block_ptr[p_mutation_index];
 		MutationIndex *sort_position = begin_pointer();
 		const MutationIndex *end_position = end_pointer_const() - 1;		// the position of the newly added element
 		
 		for ( ; sort_position != end_position; ++sort_position)
-			if (CompareMutations(mut_ptr_to_insert, gSLiM_Mutation_Block + *sort_position))	// if (p_mutation->position_ < (*sort_position)->position_)
+			if (position_to_insert < position_block_ptr[*sort_position])
 				break;
 		
 		// if we got all the way to the end, then the mutation belongs at the end, so we're done
@@ -453,14 +471,15 @@ public:
 		if (mutation_count_ == 1)
 			return;
 		
-		// then find the proper position for it
-		Mutation *mut_ptr_to_insert = gSLiM_Mutation_Block + p_mutation_index;
+		// then find the proper position for it; positions are read from the side buffer, which is denser than the Mutation block
+		const slim_position_t *position_block_ptr = gSLiM_Mutation_Positions;
+		slim_position_t position_to_insert = position_block_ptr[p_mutation_index];
 		MutationIndex *sort_position = begin_pointer();
 		const MutationIndex *end_position = end_pointer_const() - 1;		// the position of the newly added element
 		
 		for ( ; sort_position != end_position; ++sort_position)
 		{
-			if (CompareMutations(mut_ptr_to_insert, gSLiM_Mutation_Block + *sort_position))	// if (p_mutation->position_ < (*sort_position)->position_)
+			if (position_to_insert < position_block_ptr[*sort_position])
 			{
 				break;
 			}
@@ -520,6 +539,10 @@ public:
 	// Note that the vector returned is cached internally and reused with each call, for speed.
 	const std::vector<Mutation *> *derived_mutation_ids_at_position(slim_position_t p_position) const;
 	
+	// A variant of derived_mutation_ids_at_position() that fills a vector supplied by the caller; unlike the method above,
+	// this is safe to call from multiple threads at once (on different runs), as parallel offspring generation does.
+	void derived_mutation_ids_at_position(slim_position_t p_position, std::vector<Mutation *> &p_derived_mutations) const;
+	
 	inline __attribute__((always_inline)) const MutationIndex *begin_pointer_const(void) const
 	{
 		return mutations_;
@@ -555,7 +578,7 @@ public:
 		}
 	}
 	
-	// Hash and comparison functions used by UniqueMutationRuns() to unique mutation runs
+	// Hash and comparison functions used by MutationRunInternTable (and thus UniqueMutationRuns()) to unique mutation runs
 	inline __attribute__((always_inline)) int64_t Hash(void)
 	{
 		uint64_t hash = mutation_count_;
@@ -647,7 +670,7 @@ public:
 				case 3: cache_nonneutral_mutations_REGIME_3(); break;
 			}
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			recached_run_ = true;
 #endif
@@ -662,7 +685,7 @@ public:
 		*p_mutptr_max = nonneutral_mutations_ + nonneutral_mutations_count_;
 	}
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	inline __attribute__((always_inline)) void tally_nonneutral_mutations(int64_t *p_mutation_count, int64_t *p_nonneutral_count, int64_t *p_recached_count)
 	{
@@ -677,7 +700,7 @@ public:
 			recached_run_ = false;
 		}
 	}
-#endif	// defined(SLIMGUI) && (SLIMPROFILING == 1)
+#endif	// (SLIMPROFILING == 1)
 	
 #endif	// SLIM_USE_NONNEUTRAL_CACHES
 	
@@ -689,7 +712,60 @@ public:
 	inline __attribute__((always_inline)) uint32_t UseCount() const { return intrusive_ref_count_; }
 	
 	friend void Eidos_intrusive_ptr_add_ref(const MutationRun *p_value);
+	friend void Eidos_intrusive_ptr_add_ref_atomic(const MutationRun *p_value);
 	friend void Eidos_intrusive_ptr_release(const MutationRun *p_value);
+	
+	friend class MutationRunInternTable;
+};
+
+// MutationRunInternTable is a hash set of mutation runs keyed by their contents, used to share identical runs among genomes.
+// Population keeps one, and enters newly generated child runs into it; a run identical to one already in the table is then
+// discarded in favor of the existing run.  This used to be done only by a periodic pass over all genomes in UniqueMutationRuns(),
+// which still exists but now uses this table, and so finds most runs already interned.  The table uses open addressing with
+// linear probing and backward-shift deletion, so there are no tombstones.  Runs remove themselves from the table when they are
+// freed or modified in place (see MutationRun::will_modify_run()); the table itself never retains a reference to a run.
+class MutationRunInternTable
+{
+	//	This class has its copy constructor and assignment operator disabled, to prevent accidental copying.
+	
+private:
+	
+	typedef struct {
+		int64_t hash_;
+		MutationRun *run_;			// nullptr for an empty slot
+	} MutationRunInternEntry;
+	
+	MutationRunInternEntry *entries_ = nullptr;		// OWNED POINTER: capacity_ entries
+	size_t capacity_ = 0;							// always zero or a power of two
+	int capacity_shift_ = 64;						// 64 - log2(capacity_), for Fibonacci hashing into the table
+	size_t count_ = 0;
+	
+	inline __attribute__((always_inline)) size_t HomeSlot(int64_t p_hash) const
+	{
+		// Hash() is not well-mixed in its low bits, so we take the high bits of a multiplicative hash
+		return (size_t)(((uint64_t)p_hash * 0x9E3779B97F4A7C15ULL) >> capacity_shift_);
+	}
+	
+	void ResizeTable(size_t p_new_capacity);
+	
+public:
+	
+	MutationRunInternTable(const MutationRunInternTable&) = delete;					// no copying
+	MutationRunInternTable& operator=(const MutationRunInternTable&) = delete;		// no copying
+	MutationRunInternTable(void) { }
+	~MutationRunInternTable(void);
+	
+	// Returns a run identical to p_run from the table if there is one; otherwise, interns p_run and returns it
+	MutationRun *Intern(MutationRun *p_run);
+	
+	// Removes p_run, which must be interned in this table
+	void Remove(MutationRun *p_run);
+	
+	// Uninterns all runs, leaving the table empty
+	void RemoveAll(void);
+	
+	inline __attribute__((always_inline)) size_t Count(void) const { return count_; }
+	size_t MemoryUsage(void) const { return capacity_ * sizeof(MutationRunInternEntry); }
 };
 
 // Eidos_intrusive_ptr support
@@ -698,6 +774,13 @@ inline __attribute__((always_inline)) void Eidos_intrusive_ptr_add_ref(const Mut
 	++(p_value->intrusive_ref_count_);
 }
 
+// This is used when multiple threads may be taking references to the same run at once, as in parallel offspring generation;
+// releases are never done concurrently, so there is no atomic counterpart to Eidos_intrusive_ptr_release()
+inline __attribute__((always_inline)) void Eidos_intrusive_ptr_add_ref_atomic(const MutationRun *p_value)
+{
+	__atomic_add_fetch(&p_value->intrusive_ref_count_, 1, __ATOMIC_RELAXED);
+}
+
 inline __attribute__((always_inline)) void Eidos_intrusive_ptr_release(const MutationRun *p_value)
 {
 	if ((--(p_value->intrusive_ref_count_)) == 0)
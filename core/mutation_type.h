@@ -91,6 +91,7 @@ public:
 	bool nucleotide_based_;						// if true, the mutation type is nucleotide-based (i.e. mutations keep associated nucleotides)
 	
 	bool convert_to_substitution_;				// if true (the default in WF models), mutations of this type are converted to substitutions
+	bool overlay_ = false;						// if true, mutations of this type are not simulated, but overlaid on the tree sequence at output; see initializeTreeSeq()
 	MutationStackPolicy stack_policy_;			// the mutation stacking policy; see above (kStack is the default)
 	int64_t stack_group_;						// the mutation stacking group this mutation type is in (== mutation_type_id_ is default)
 	
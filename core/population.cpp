@@ -35,6 +35,10 @@
 #include "polymorphism.h"
 #include "subpopulation.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 Population::Population(SLiMSim &p_sim) : sim_(p_sim)
 {
@@ -64,6 +68,14 @@ Population::~Population(void)
 		delete removed_subpop;
 	
 	removed_subpops_.clear();
+	
+	// free our buffers for multithreaded tallying
+	if (tally_thread_refcounts_)
+	{
+		free(tally_thread_refcounts_);
+		tally_thread_refcounts_ = nullptr;
+		tally_thread_refcounts_size_ = 0;
+	}
 }
 
 void Population::RemoveAllSubpopulationInfo(void)
@@ -387,7 +399,7 @@ void Population::ExecuteScript(SLiMEidosBlock *p_script_block, slim_generation_t
 // apply mateChoice() callbacks to a mating event with a chosen first parent; the return is the second parent index, or -1 to force a redraw
 slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_index, Subpopulation *p_subpop, Subpopulation *p_source_subpop, std::vector<SLiMEidosBlock*> &p_mate_choice_callbacks)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -566,7 +578,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 				
 				sim_.executing_block_type_ = old_executing_block_type;
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)]);
 #endif
@@ -592,7 +604,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 		
 		sim_.executing_block_type_ = old_executing_block_type;
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)]);
 #endif
@@ -639,7 +651,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 			
 			sim_.executing_block_type_ = old_executing_block_type;
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)]);
 #endif
@@ -713,7 +725,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 		
 		sim_.executing_block_type_ = old_executing_block_type;
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)]);
 #endif
@@ -723,7 +735,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 	
 	sim_.executing_block_type_ = old_executing_block_type;
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosMateChoiceCallback)]);
 #endif
@@ -736,7 +748,7 @@ slim_popsize_t Population::ApplyMateChoiceCallbacks(slim_popsize_t p_parent1_ind
 // apply modifyChild() callbacks to a generated child; a return of false means "do not use this child, generate a new one"
 bool Population::ApplyModifyChildCallbacks(Individual *p_child, Genome *p_child_genome1, Genome *p_child_genome2, IndividualSex p_child_sex, Individual *p_parent1, Genome *p_parent1Genome1, Genome *p_parent1Genome2, Individual *p_parent2, Genome *p_parent2Genome1, Genome *p_parent2Genome2, bool p_is_selfing, bool p_is_cloning, Subpopulation *p_target_subpop, Subpopulation *p_source_subpop, std::vector<SLiMEidosBlock*> &p_modify_child_callbacks)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -830,7 +842,7 @@ bool Population::ApplyModifyChildCallbacks(Individual *p_child, Genome *p_child_
 					sim_.executing_block_type_ = old_executing_block_type;
 					sim_.focal_modification_child_ = nullptr;
 					
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 					// PROFILING
 					SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosModifyChildCallback)]);
 #endif
@@ -851,7 +863,7 @@ bool Population::ApplyModifyChildCallbacks(Individual *p_child, Genome *p_child_
 	sim_.executing_block_type_ = old_executing_block_type;
 	sim_.focal_modification_child_ = nullptr;
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosModifyChildCallback)]);
 #endif
@@ -1707,6 +1719,15 @@ void Population::EvolveSubpopulation(Subpopulation &p_subpop, bool p_mate_choice
 		// some setup overhead, including the gsl_ran_shuffle() call.  All code that accesses individuals within a subpopulation needs to be aware of
 		// the fact that the individuals might be in a non-random order, because of this code path.  BEWARE!
 		
+		// PARALLEL OFFSPRING GENERATION: if we are allowed more than one thread, child genomes are generated in two phases.  First,
+		// all random draws (parents, breakpoints, new mutations) are made serially, in exactly the same order as in the loops below,
+		// but the child genomes are not assembled; DoCrossoverMutation() just records what needs to be done.  Then the child genomes
+		// are assembled in parallel, and the new mutations are added to the registry serially; see AssembleDeferredChildGenomes().
+		// Results are therefore identical regardless of the number of threads used.  Complex gene conversion tracts are excluded,
+		// since heteroduplex repair makes random draws after assembly; clonal offspring are excluded too, for simplicity.
+		Chromosome &chromosome = sim_.TheChromosome();
+		bool parallel_assembly = (gEidosMaxThreads > 1) && !(chromosome.using_DSB_model_ && (chromosome.simple_conversion_fraction_ != 1.0));
+		
 		// We loop to generate females first (sex_index == 0) and males second (sex_index == 1).
 		// In nonsexual simulations number_of_sexes == 1 and this loops just once.
 		slim_popsize_t child_count = 0;	// counter over all subpop_size_ children
@@ -1767,6 +1788,7 @@ void Population::EvolveSubpopulation(Subpopulation &p_subpop, bool p_mate_choice
 					
 					// generate all selfed, cloned, and autogamous offspring in one shared loop
 					slim_popsize_t migrant_count = 0;
+					bool defer_assembly = parallel_assembly && (number_to_clone == 0);
 					
 					if ((number_to_self == 0) && (number_to_clone == 0))
 					{
@@ -1789,8 +1811,8 @@ void Population::EvolveSubpopulation(Subpopulation &p_subpop, bool p_mate_choice
 									sim_.SetCurrentNewIndividual(new_child);
 								
 								// recombination, gene-conversion, mutation
-								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count], parent1, child_sex, IndividualSex::kFemale, nullptr, nullptr);
-								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count + 1], parent2, child_sex, IndividualSex::kMale, nullptr, nullptr);
+								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count], parent1, child_sex, IndividualSex::kFemale, nullptr, nullptr, defer_assembly);
+								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count + 1], parent2, child_sex, IndividualSex::kMale, nullptr, nullptr, defer_assembly);
 								
 								migrant_count++;
 								child_count++;
@@ -1818,8 +1840,8 @@ void Population::EvolveSubpopulation(Subpopulation &p_subpop, bool p_mate_choice
 									sim_.SetCurrentNewIndividual(new_child);
 								
 								// recombination, gene-conversion, mutation
-								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count], parent1, child_sex, IndividualSex::kHermaphrodite, nullptr, nullptr);
-								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count + 1], parent2, child_sex, IndividualSex::kHermaphrodite, nullptr, nullptr);
+								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count], parent1, child_sex, IndividualSex::kHermaphrodite, nullptr, nullptr, defer_assembly);
+								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count + 1], parent2, child_sex, IndividualSex::kHermaphrodite, nullptr, nullptr, defer_assembly);
 								
 								migrant_count++;
 								child_count++;
@@ -1916,8 +1938,8 @@ void Population::EvolveSubpopulation(Subpopulation &p_subpop, bool p_mate_choice
 									sim_.SetCurrentNewIndividual(new_child);
 								
 								// recombination, gene-conversion, mutation
-								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count], parent1, child_sex, parent1_sex, nullptr, nullptr);
-								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count + 1], parent2, child_sex, parent2_sex, nullptr, nullptr);
+								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count], parent1, child_sex, parent1_sex, nullptr, nullptr, defer_assembly);
+								DoCrossoverMutation(&source_subpop, *p_subpop.child_genomes_[2 * child_count + 1], parent2, child_sex, parent2_sex, nullptr, nullptr, defer_assembly);
 							}
 							
 							// change counters
@@ -1925,17 +1947,244 @@ void Population::EvolveSubpopulation(Subpopulation &p_subpop, bool p_mate_choice
 							child_count++;
 						}
 					}
+					
+					if (defer_assembly)
+						AssembleDeferredChildGenomes();
+				}
+			}
+		}
+	}
+}
+
+// Record a child genome whose random draws have been made by DoCrossoverMutation(), to be assembled later by AssembleDeferredChildGenomes().
+// The mutation runs the assembly will need are taken from the free list here, since that is not thread-safe; we take one run for each
+// breakpoint and each new mutation, which is an upper bound on the number of runs that will be created, and return the rest afterwards.
+void Population::DeferChildGenomeAssembly(Genome &p_child_genome, Genome *p_parent_genome_1, Genome *p_parent_genome_2, std::vector<slim_position_t> &p_breakpoints, MutationRun *p_new_mutations)
+{
+	DeferredChildGenome deferred_genome;
+	int32_t new_mutation_count = (p_new_mutations ? p_new_mutations->size() : 0);
+	int32_t run_count = std::min((int32_t)p_breakpoints.size() + new_mutation_count, p_child_genome.mutrun_count_);
+	
+	deferred_genome.child_genome_ = &p_child_genome;
+	deferred_genome.parent_genome_1_ = p_parent_genome_1;
+	deferred_genome.parent_genome_2_ = p_parent_genome_2;
+	deferred_genome.breakpoints_start_ = (int32_t)deferred_breakpoints_.size();
+	deferred_genome.breakpoints_count_ = (int32_t)p_breakpoints.size();
+	deferred_genome.new_mutations_start_ = (int32_t)deferred_new_mutations_.size();
+	deferred_genome.new_mutations_count_ = new_mutation_count;
+	deferred_genome.runs_start_ = (int32_t)deferred_runs_.size();
+	deferred_genome.runs_count_ = run_count;
+	deferred_genome.runs_used_ = 0;
+	
+	deferred_breakpoints_.insert(deferred_breakpoints_.end(), p_breakpoints.begin(), p_breakpoints.end());
+	
+	if (new_mutation_count)
+		deferred_new_mutations_.insert(deferred_new_mutations_.end(), p_new_mutations->begin_pointer_const(), p_new_mutations->end_pointer_const());
+	
+	for (int32_t run_index = 0; run_index < run_count; ++run_index)
+		deferred_runs_.emplace_back(MutationRun::NewMutationRun());
+	
+	deferred_genomes_.emplace_back(deferred_genome);
+}
+
+// Assemble one deferred child genome from its parental genomes, breakpoints, and new mutations.  This is called in parallel, so it must
+// not touch any shared state except by reading; it makes the same child genome as DoCrossoverMutation() would, but with one general loop
+// over mutation runs rather than that method's special cases.  Runs without breakpoints or new mutations are shared from the parent, and
+// other runs are built by merging, within each segment between breakpoints, the active parental strand with the new mutations (parental
+// mutations go first at a given position, as in DoCrossoverMutation()).  New mutations are checked against the stacking policy, but are
+// not added to the registry; AssembleDeferredChildGenomes() does that afterwards, serially, using the flags we leave behind.
+void Population::AssembleDeferredChildGenome(DeferredChildGenome &p_deferred_genome)
+{
+	Genome &child_genome = *p_deferred_genome.child_genome_;
+	Genome *parent_genomes[2] = {p_deferred_genome.parent_genome_1_, p_deferred_genome.parent_genome_2_};
+	const slim_position_t *breakpoint_iter = deferred_breakpoints_.data() + p_deferred_genome.breakpoints_start_;
+	const slim_position_t *breakpoint_iter_max = breakpoint_iter + p_deferred_genome.breakpoints_count_;
+	const MutationIndex *mutation_iter = deferred_new_mutations_.data() + p_deferred_genome.new_mutations_start_;
+	const MutationIndex *mutation_iter_max = mutation_iter + p_deferred_genome.new_mutations_count_;
+	uint8_t *accepted_iter = deferred_mutation_accepted_.data() + p_deferred_genome.new_mutations_start_;
+	std::vector<Mutation *> *derived_state_iter = deferred_derived_states_.data() + p_deferred_genome.new_mutations_start_;
+	MutationRun **run_iter = deferred_runs_.data() + p_deferred_genome.runs_start_;
+	bool recording_tree_sequence_mutations = sim_.RecordingTreeSequenceMutations();
+	Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+	const slim_position_t *position_block_ptr = gSLiM_Mutation_Positions;
+	slim_position_t mutrun_length = child_genome.mutrun_length_;
+	int mutrun_count = child_genome.mutrun_count_;
+	int strand = 0;
+	
+#if DEBUG
+	child_genome.check_cleared_to_nullptr();
+#endif
+	
+	for (int run_index = 0; run_index < mutrun_count; ++run_index)
+	{
+		slim_position_t run_start = run_index * mutrun_length;
+		slim_position_t run_end = run_start + mutrun_length;
+		
+		// breakpoints at the start of the run fall between runs, and just switch strands
+		while ((breakpoint_iter != breakpoint_iter_max) && (*breakpoint_iter <= run_start))
+		{
+			strand ^= 1;
+			breakpoint_iter++;
+		}
+		
+		bool run_has_breakpoint = ((breakpoint_iter != breakpoint_iter_max) && (*breakpoint_iter < run_end));
+		bool run_has_new_mutation = ((mutation_iter != mutation_iter_max) && (position_block_ptr[*mutation_iter] < run_end));
+		
+		if (!run_has_breakpoint && !run_has_new_mutation)
+		{
+			// nothing happens in this run, so it is shared with the active parental strand; note we never touch the second strand
+			// unless there is a breakpoint, since it could be null
+			child_genome.ShareRunAtomic(run_index, parent_genomes[strand]->mutruns_[run_index].get());
+			continue;
+		}
+		
+		MutationRun *child_mutrun = *(run_iter++);
+		
+		child_genome.mutruns_[run_index].reset(child_mutrun);
+		
+		const MutationRun *parent_mutrun = parent_genomes[strand]->mutruns_[run_index].get();
+		const MutationIndex *parent_iter = parent_mutrun->begin_pointer_const();
+		const MutationIndex *parent_iter_max = parent_mutrun->end_pointer_const();
+		
+		while (true)
+		{
+			// the current segment extends to the next breakpoint within the run, or to the end of the run
+			slim_position_t segment_end = ((breakpoint_iter != breakpoint_iter_max) && (*breakpoint_iter < run_end)) ? *breakpoint_iter : run_end;
+			
+			while (true)
+			{
+				slim_position_t new_mutation_pos = ((mutation_iter != mutation_iter_max) ? position_block_ptr[*mutation_iter] : SLIM_INF_BASE_POSITION);
+				
+				if (parent_iter != parent_iter_max)
+				{
+					MutationIndex current_mutation = *parent_iter;
+					slim_position_t current_mutation_pos = position_block_ptr[current_mutation];
+					
+					if ((current_mutation_pos < segment_end) && (current_mutation_pos <= new_mutation_pos))
+					{
+						// add the old mutation; no need to check for a duplicate here since the parental genome is already duplicate-free
+						child_mutrun->emplace_back(current_mutation);
+						parent_iter++;
+						continue;
+					}
+				}
+				
+				if (new_mutation_pos >= segment_end)
+					break;
+				
+				// add the new mutation, which might overlap with the last added old mutation, if the stacking policy allows it
+				Mutation *new_mut = mut_block_ptr + *mutation_iter;
+				
+				if (child_mutrun->enforce_stack_policy_for_addition(new_mut->position_, new_mut->mutation_type_ptr_))
+				{
+					child_mutrun->emplace_back(*mutation_iter);
+					*accepted_iter = true;
+					
+					// TREE SEQUENCE RECORDING
+					if (recording_tree_sequence_mutations)
+						child_mutrun->derived_mutation_ids_at_position(new_mut->position_, *derived_state_iter);
 				}
+				else
+				{
+					*accepted_iter = false;
+				}
+				
+				mutation_iter++;
+				accepted_iter++;
+				derived_state_iter++;
 			}
+			
+			if (segment_end == run_end)
+				break;
+			
+			// we have reached a breakpoint inside the run, so switch strands, and skip over anything in the new strand that occurs
+			// prior to the breakpoint; it was not the active strand
+			strand ^= 1;
+			breakpoint_iter++;
+			
+			parent_mutrun = parent_genomes[strand]->mutruns_[run_index].get();
+			parent_iter = parent_mutrun->begin_pointer_const();
+			parent_iter_max = parent_mutrun->end_pointer_const();
+			
+			while ((parent_iter != parent_iter_max) && (position_block_ptr[*parent_iter] < segment_end))
+				parent_iter++;
 		}
 	}
+	
+	p_deferred_genome.runs_used_ = (int32_t)(run_iter - (deferred_runs_.data() + p_deferred_genome.runs_start_));
+}
+
+// Assemble all child genomes recorded by DeferChildGenomeAssembly(), in parallel; then, serially and in the order the child genomes were
+// generated, add their new mutations to the registry (or dispose of them, if the stacking policy rejected them), record their derived
+// states, and return unused mutation runs to the free list.  The end result is the same as generating the children serially.
+void Population::AssembleDeferredChildGenomes(void)
+{
+	int64_t deferred_genome_count = (int64_t)deferred_genomes_.size();
+	size_t new_mutation_count = deferred_new_mutations_.size();
+	bool recording_tree_sequence_mutations = sim_.RecordingTreeSequenceMutations();
+	
+	// the derived-state buffers are kept across generations, so their capacity gets reused; they are only filled when recording
+	deferred_mutation_accepted_.resize(new_mutation_count);
+	
+	if (deferred_derived_states_.size() < new_mutation_count)
+		deferred_derived_states_.resize(new_mutation_count);
+	
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) num_threads(gEidosMaxThreads)
+#endif
+	for (int64_t genome_index = 0; genome_index < deferred_genome_count; ++genome_index)
+		AssembleDeferredChildGenome(deferred_genomes_[genome_index]);
+	
+	Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+	
+	for (DeferredChildGenome &deferred_genome : deferred_genomes_)
+	{
+		for (int32_t new_mutation_index = deferred_genome.new_mutations_start_; new_mutation_index < deferred_genome.new_mutations_start_ + deferred_genome.new_mutations_count_; ++new_mutation_index)
+		{
+			MutationIndex new_mutation = deferred_new_mutations_[new_mutation_index];
+			Mutation *new_mut = mut_block_ptr + new_mutation;
+			
+			if (deferred_mutation_accepted_[new_mutation_index])
+			{
+				// The mutation was passed by the stacking policy, so we can add it to the registry
+				mutation_registry_.emplace_back(new_mutation);
+				
+#ifdef SLIM_KEEP_MUTTYPE_REGISTRIES
+				MutationType *new_mut_type = new_mut->mutation_type_ptr_;
+				
+				if (keeping_muttype_registries_ && new_mut_type->keeping_muttype_registry_)
+					new_mut_type->muttype_registry_.emplace_back(new_mutation);
+#endif
+				
+				// TREE SEQUENCE RECORDING
+				if (recording_tree_sequence_mutations)
+					sim_.RecordNewDerivedState(deferred_genome.child_genome_, new_mut->position_, deferred_derived_states_[new_mutation_index]);
+			}
+			else
+			{
+				// The mutation was rejected by the stacking policy, so we have to dispose of it
+				new_mut->~Mutation();
+				SLiM_DisposeMutationToBlock(new_mutation);
+			}
+		}
+		
+		for (int32_t run_index = deferred_genome.runs_used_; run_index < deferred_genome.runs_count_; ++run_index)
+			MutationRun::FreeMutationRun(deferred_runs_[deferred_genome.runs_start_ + run_index]);
+		
+		InternGenomeRuns(*deferred_genome.child_genome_);
+	}
+	
+	deferred_genomes_.clear();
+	deferred_breakpoints_.clear();
+	deferred_new_mutations_.clear();
+	deferred_runs_.clear();
 }
 #endif	// SLIM_WF_ONLY
 
 // apply recombination() callbacks to a generated child; a return of true means breakpoints were changed
 bool Population::ApplyRecombinationCallbacks(slim_popsize_t p_parent_index, Genome *p_genome1, Genome *p_genome2, Subpopulation *p_source_subpop, std::vector<slim_position_t> &p_crossovers, std::vector<SLiMEidosBlock*> &p_recombination_callbacks)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -2052,7 +2301,7 @@ bool Population::ApplyRecombinationCallbacks(slim_popsize_t p_parent_index, Geno
 	
 	sim_.executing_block_type_ = old_executing_block_type;
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosRecombinationCallback)]);
 #endif
@@ -2061,7 +2310,7 @@ bool Population::ApplyRecombinationCallbacks(slim_popsize_t p_parent_index, Geno
 }
 
 // generate a child genome from parental genomes, with recombination, gene conversion, and mutation
-void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_child_genome, slim_popsize_t p_parent_index, IndividualSex p_child_sex, IndividualSex p_parent_sex, std::vector<SLiMEidosBlock*> *p_recombination_callbacks, std::vector<SLiMEidosBlock*> *p_mutation_callbacks)
+void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_child_genome, slim_popsize_t p_parent_index, IndividualSex p_child_sex, IndividualSex p_parent_sex, std::vector<SLiMEidosBlock*> *p_recombination_callbacks, std::vector<SLiMEidosBlock*> *p_mutation_callbacks, bool p_defer_assembly)
 {
 	slim_popsize_t parent_genome_1_index = p_parent_index * 2;
 	slim_popsize_t parent_genome_2_index = parent_genome_1_index + 1;
@@ -2336,6 +2585,14 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 	// mutations are usually rare, so let's streamline the case where none occur
 	if (num_mutations == 0)
 	{
+#ifdef SLIM_WF_ONLY
+		if (p_defer_assembly)
+		{
+			DeferChildGenomeAssembly(p_child_genome, parent_genome_1, parent_genome_2, all_breakpoints, nullptr);
+			return;
+		}
+#endif
+		
 		if (num_breakpoints == 0)
 		{
 			//
@@ -2355,7 +2612,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 			p_child_genome.check_cleared_to_nullptr();
 #endif
 			
-			Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+			const slim_position_t *position_block_ptr = gSLiM_Mutation_Positions;
 			Genome *parent_genome = parent_genome_1;
 			slim_position_t mutrun_length = p_child_genome.mutrun_length_;
 			int mutrun_count = p_child_genome.mutrun_count_;
@@ -2401,7 +2658,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 						{
 							MutationIndex current_mutation = *parent_iter;
 							
-							if ((mut_block_ptr + current_mutation)->position_ >= breakpoint)
+							if (position_block_ptr[current_mutation] >= breakpoint)
 								break;
 							
 							// add the old mutation; no need to check for a duplicate here since the parental genome is already duplicate-free
@@ -2416,7 +2673,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 						parent_iter = parent1_iter;		parent_iter_max = parent1_iter_max;		parent_genome = parent_genome_1;
 						
 						// skip over anything in the new parent that occurs prior to the breakpoint; it was not the active strand
-						while (parent_iter != parent_iter_max && (mut_block_ptr + *parent_iter)->position_ < breakpoint)
+						while (parent_iter != parent_iter_max && position_block_ptr[*parent_iter] < breakpoint)
 							parent_iter++;
 						
 						// we have now handled the current breakpoint, so move on to the next breakpoint; advance the enclosing for loop here
@@ -2518,7 +2775,17 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 			throw;
 		}
 		
+#ifdef SLIM_WF_ONLY
+		if (p_defer_assembly)
+		{
+			DeferChildGenomeAssembly(p_child_genome, parent_genome_1, parent_genome_2, all_breakpoints, &mutations_to_add);
+			MutationRun::FreeMutationRun(&mutations_to_add);
+			return;
+		}
+#endif
+		
 		Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+		const slim_position_t *position_block_ptr = gSLiM_Mutation_Positions;
 		const MutationIndex *mutation_iter		= mutations_to_add.begin_pointer_const();
 		const MutationIndex *mutation_iter_max	= mutations_to_add.end_pointer_const();
 		
@@ -2527,7 +2794,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 		
 		if (mutation_iter != mutation_iter_max) {
 			mutation_iter_mutation_index = *mutation_iter;
-			mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+			mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 		} else {
 			mutation_iter_mutation_index = -1;
 			mutation_iter_pos = SLIM_INF_BASE_POSITION;
@@ -2572,7 +2839,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 					while (parent_iter != parent_iter_max)
 					{
 						MutationIndex current_mutation = *parent_iter;
-						slim_position_t current_mutation_pos = (mut_block_ptr + current_mutation)->position_;
+						slim_position_t current_mutation_pos = position_block_ptr[current_mutation];
 						
 						if (current_mutation_pos > mutation_iter_pos)
 							break;
@@ -2610,7 +2877,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 					
 					if (++mutation_iter != mutation_iter_max) {
 						mutation_iter_mutation_index = *mutation_iter;
-						mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+						mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 					} else {
 						mutation_iter_mutation_index = -1;
 						mutation_iter_pos = SLIM_INF_BASE_POSITION;
@@ -2721,7 +2988,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 							while (parent_iter != parent_iter_max)
 							{
 								MutationIndex current_mutation = *parent_iter;
-								slim_position_t current_mutation_pos = (mut_block_ptr + current_mutation)->position_;
+								slim_position_t current_mutation_pos = position_block_ptr[current_mutation];
 								
 								if (current_mutation_pos >= breakpoint)
 									break;
@@ -2757,7 +3024,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 									
 									if (++mutation_iter != mutation_iter_max) {
 										mutation_iter_mutation_index = *mutation_iter;
-										mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+										mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 									} else {
 										mutation_iter_mutation_index = -1;
 										mutation_iter_pos = SLIM_INF_BASE_POSITION;
@@ -2803,7 +3070,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 								
 								if (++mutation_iter != mutation_iter_max) {
 									mutation_iter_mutation_index = *mutation_iter;
-									mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+									mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 								} else {
 									mutation_iter_mutation_index = -1;
 									mutation_iter_pos = SLIM_INF_BASE_POSITION;
@@ -2823,7 +3090,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 							parent_iter = parent1_iter;		parent_iter_max = parent1_iter_max;		parent_genome = parent_genome_1;
 							
 							// skip over anything in the new parent that occurs prior to the breakpoint; it was not the active strand
-							while (parent_iter != parent_iter_max && (mut_block_ptr + *parent_iter)->position_ < breakpoint)
+							while (parent_iter != parent_iter_max && position_block_ptr[*parent_iter] < breakpoint)
 								parent_iter++;
 							
 							// we have now handled the current breakpoint, so move on; if we just handled the last breakpoint, then we are done
@@ -2855,7 +3122,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 							{
 								MutationIndex current_mutation = *parent_iter;
 								
-								if ((mut_block_ptr + current_mutation)->position_ >= breakpoint)
+								if (position_block_ptr[current_mutation] >= breakpoint)
 									break;
 								
 								// add the old mutation; no need to check for a duplicate here since the parental genome is already duplicate-free
@@ -2870,7 +3137,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 							parent_iter = parent1_iter;		parent_iter_max = parent1_iter_max;		parent_genome = parent_genome_1;
 							
 							// skip over anything in the new parent that occurs prior to the breakpoint; it was not the active strand
-							while (parent_iter != parent_iter_max && (mut_block_ptr + *parent_iter)->position_ < breakpoint)
+							while (parent_iter != parent_iter_max && position_block_ptr[*parent_iter] < breakpoint)
 								parent_iter++;
 							
 							// we have now handled the current breakpoint, so move on; if we just handled the last breakpoint, then we are done
@@ -2912,7 +3179,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 						while (parent_iter != parent_iter_max)
 						{
 							MutationIndex current_mutation = *parent_iter;
-							slim_position_t current_mutation_pos = (mut_block_ptr + current_mutation)->position_;
+							slim_position_t current_mutation_pos = position_block_ptr[current_mutation];
 							
 							if (current_mutation_pos > mutation_iter_pos)
 								break;
@@ -2950,7 +3217,7 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 						
 						if (++mutation_iter != mutation_iter_max) {
 							mutation_iter_mutation_index = *mutation_iter;
-							mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+							mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 						} else {
 							mutation_iter_mutation_index = -1;
 							mutation_iter_pos = SLIM_INF_BASE_POSITION;
@@ -2986,6 +3253,8 @@ void Population::DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_c
 	
 	if (heteroduplex.size() > 0)
 		DoHeteroduplexRepair(heteroduplex, all_breakpoints, parent_genome_1, parent_genome_2, &p_child_genome);
+	
+	InternGenomeRuns(p_child_genome);
 }
 
 void Population::DoHeteroduplexRepair(std::vector<slim_position_t> &p_heteroduplex, std::vector<slim_position_t> &p_breakpoints, Genome *p_parent_genome_1, Genome *p_parent_genome_2, Genome *p_child_genome)
@@ -3402,7 +3671,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 		p_child_genome.check_cleared_to_nullptr();
 #endif
 		
-		Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+		const slim_position_t *position_block_ptr = gSLiM_Mutation_Positions;
 		Genome *parent_genome = p_parent_genome_1;
 		slim_position_t mutrun_length = p_child_genome.mutrun_length_;
 		int mutrun_count = p_child_genome.mutrun_count_;
@@ -3448,7 +3717,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 					{
 						MutationIndex current_mutation = *parent_iter;
 						
-						if ((mut_block_ptr + current_mutation)->position_ >= breakpoint)
+						if (position_block_ptr[current_mutation] >= breakpoint)
 							break;
 						
 						// add the old mutation; no need to check for a duplicate here since the parental genome is already duplicate-free
@@ -3463,7 +3732,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 					parent_iter = parent1_iter;		parent_iter_max = parent1_iter_max;		parent_genome = p_parent_genome_1;
 					
 					// skip over anything in the new parent that occurs prior to the breakpoint; it was not the active strand
-					while (parent_iter != parent_iter_max && (mut_block_ptr + *parent_iter)->position_ < breakpoint)
+					while (parent_iter != parent_iter_max && position_block_ptr[*parent_iter] < breakpoint)
 						parent_iter++;
 					
 					// we have now handled the current breakpoint, so move on to the next breakpoint; advance the enclosing for loop here
@@ -3565,6 +3834,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 		}
 		
 		Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+		const slim_position_t *position_block_ptr = gSLiM_Mutation_Positions;
 		const MutationIndex *mutation_iter		= mutations_to_add.begin_pointer_const();
 		const MutationIndex *mutation_iter_max	= mutations_to_add.end_pointer_const();
 		
@@ -3573,7 +3843,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 		
 		if (mutation_iter != mutation_iter_max) {
 			mutation_iter_mutation_index = *mutation_iter;
-			mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+			mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 		} else {
 			mutation_iter_mutation_index = -1;
 			mutation_iter_pos = SLIM_INF_BASE_POSITION;
@@ -3666,7 +3936,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 						while (parent_iter != parent_iter_max)
 						{
 							MutationIndex current_mutation = *parent_iter;
-							slim_position_t current_mutation_pos = (mut_block_ptr + current_mutation)->position_;
+							slim_position_t current_mutation_pos = position_block_ptr[current_mutation];
 							
 							if (current_mutation_pos >= breakpoint)
 								break;
@@ -3702,7 +3972,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 								
 								if (++mutation_iter != mutation_iter_max) {
 									mutation_iter_mutation_index = *mutation_iter;
-									mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+									mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 								} else {
 									mutation_iter_mutation_index = -1;
 									mutation_iter_pos = SLIM_INF_BASE_POSITION;
@@ -3748,7 +4018,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 							
 							if (++mutation_iter != mutation_iter_max) {
 								mutation_iter_mutation_index = *mutation_iter;
-								mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+								mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 							} else {
 								mutation_iter_mutation_index = -1;
 								mutation_iter_pos = SLIM_INF_BASE_POSITION;
@@ -3768,7 +4038,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 						parent_iter = parent1_iter;		parent_iter_max = parent1_iter_max;		parent_genome = p_parent_genome_1;
 						
 						// skip over anything in the new parent that occurs prior to the breakpoint; it was not the active strand
-						while (parent_iter != parent_iter_max && (mut_block_ptr + *parent_iter)->position_ < breakpoint)
+						while (parent_iter != parent_iter_max && position_block_ptr[*parent_iter] < breakpoint)
 							parent_iter++;
 						
 						// we have now handled the current breakpoint, so move on; if we just handled the last breakpoint, then we are done
@@ -3800,7 +4070,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 						{
 							MutationIndex current_mutation = *parent_iter;
 							
-							if ((mut_block_ptr + current_mutation)->position_ >= breakpoint)
+							if (position_block_ptr[current_mutation] >= breakpoint)
 								break;
 							
 							// add the old mutation; no need to check for a duplicate here since the parental genome is already duplicate-free
@@ -3815,7 +4085,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 						parent_iter = parent1_iter;		parent_iter_max = parent1_iter_max;		parent_genome = p_parent_genome_1;
 						
 						// skip over anything in the new parent that occurs prior to the breakpoint; it was not the active strand
-						while (parent_iter != parent_iter_max && (mut_block_ptr + *parent_iter)->position_ < breakpoint)
+						while (parent_iter != parent_iter_max && position_block_ptr[*parent_iter] < breakpoint)
 							parent_iter++;
 						
 						// we have now handled the current breakpoint, so move on; if we just handled the last breakpoint, then we are done
@@ -3857,7 +4127,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 					while (parent_iter != parent_iter_max)
 					{
 						MutationIndex current_mutation = *parent_iter;
-						slim_position_t current_mutation_pos = (mut_block_ptr + current_mutation)->position_;
+						slim_position_t current_mutation_pos = position_block_ptr[current_mutation];
 						
 						if (current_mutation_pos > mutation_iter_pos)
 							break;
@@ -3895,7 +4165,7 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 					
 					if (++mutation_iter != mutation_iter_max) {
 						mutation_iter_mutation_index = *mutation_iter;
-						mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+						mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 					} else {
 						mutation_iter_mutation_index = -1;
 						mutation_iter_pos = SLIM_INF_BASE_POSITION;
@@ -3927,6 +4197,8 @@ void Population::DoRecombinantMutation(Subpopulation *p_mutorigin_subpop, Genome
 		if (child_genome.mutruns_[i].get() == nullptr)
 			EIDOS_TERMINATION << "ERROR (Population::DoRecombinantMutation): (internal error) null mutation run left at end of recombination-mutation." << EidosTerminate();
 #endif
+	
+	InternGenomeRuns(p_child_genome);
 }
 
 void Population::DoClonalMutation(Subpopulation *p_mutorigin_subpop, Genome &p_child_genome, Genome &p_parent_genome, IndividualSex p_child_sex, std::vector<SLiMEidosBlock*> *p_mutation_callbacks)
@@ -4038,6 +4310,7 @@ void Population::DoClonalMutation(Subpopulation *p_mutorigin_subpop, Genome &p_c
 		
 		// loop over mutation runs and either (1) copy the mutrun pointer from the parent, or (2) make a new mutrun by modifying that of the parent
 		Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+		const slim_position_t *position_block_ptr = gSLiM_Mutation_Positions;
 		
 		int mutrun_count = p_child_genome.mutrun_count_;
 		slim_position_t mutrun_length = p_child_genome.mutrun_length_;
@@ -4045,7 +4318,7 @@ void Population::DoClonalMutation(Subpopulation *p_mutorigin_subpop, Genome &p_c
 		const MutationIndex *mutation_iter		= mutations_to_add.begin_pointer_const();
 		const MutationIndex *mutation_iter_max	= mutations_to_add.end_pointer_const();
 		MutationIndex mutation_iter_mutation_index = *mutation_iter;
-		slim_position_t mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+		slim_position_t mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 		slim_mutrun_index_t mutation_iter_mutrun_index = (slim_mutrun_index_t)(mutation_iter_pos / mutrun_length);
 		
 		for (int run_index = 0; run_index < mutrun_count; ++run_index)
@@ -4067,7 +4340,7 @@ void Population::DoClonalMutation(Subpopulation *p_mutorigin_subpop, Genome &p_c
 				do
 				{
 					// while an old mutation in the parent is before or at the next new mutation...
-					while ((parent_iter != parent_iter_max) && ((mut_block_ptr + *parent_iter)->position_ <= mutation_iter_pos))
+					while ((parent_iter != parent_iter_max) && (position_block_ptr[*parent_iter] <= mutation_iter_pos))
 					{
 						// we know the mutation is not already present, since mutations on the parent strand are already uniqued,
 						// and new mutations are, by definition, new and thus cannot match the existing mutations
@@ -4076,7 +4349,7 @@ void Population::DoClonalMutation(Subpopulation *p_mutorigin_subpop, Genome &p_c
 					}
 					
 					// while a new mutation in this run is before the next old mutation in the parent... (which we know is true when we first reach here)
-					slim_position_t parent_iter_pos = (parent_iter == parent_iter_max) ? (SLIM_INF_BASE_POSITION) : (mut_block_ptr + *parent_iter)->position_;
+					slim_position_t parent_iter_pos = (parent_iter == parent_iter_max) ? (SLIM_INF_BASE_POSITION) : position_block_ptr[*parent_iter];
 					
 					do
 					{
@@ -4119,7 +4392,7 @@ void Population::DoClonalMutation(Subpopulation *p_mutorigin_subpop, Genome &p_c
 						else
 						{
 							mutation_iter_mutation_index = *mutation_iter;
-							mutation_iter_pos = (mut_block_ptr + mutation_iter_mutation_index)->position_;
+							mutation_iter_pos = position_block_ptr[mutation_iter_mutation_index];
 						}
 						
 						mutation_iter_mutrun_index = (slim_mutrun_index_t)(mutation_iter_pos / mutrun_length);
@@ -4145,6 +4418,8 @@ void Population::DoClonalMutation(Subpopulation *p_mutorigin_subpop, Genome &p_c
 		}
 		
 		MutationRun::FreeMutationRun(&mutations_to_add);
+		
+		InternGenomeRuns(p_child_genome);
 	}
 }
 
@@ -4287,6 +4562,7 @@ void Population::ValidateMutationFitnessCaches(void)
 		
 		mut->cached_one_plus_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + sel_coeff);
 		mut->cached_one_plus_dom_sel_ = (slim_selcoeff_t)std::max(0.0, 1.0 + dom_coeff * sel_coeff);
+		mut->SyncHotBuffers();
 	}
 }
 
@@ -4570,14 +4846,34 @@ void Population::ClearParentalGenomes(void)
 }
 #endif	// SLIM_WF_ONLY
 
+// Intern the mutation runs of a newly generated genome, replacing any run that duplicates an interned run with that run
+void Population::InternGenomeRuns(Genome &p_genome)
+{
+	int32_t mutrun_count = p_genome.mutrun_count_;
+	
+	for (int mutrun_index = 0; mutrun_index < mutrun_count; ++mutrun_index)
+	{
+		MutationRun_SP &mutrun_sp = p_genome.mutruns_[mutrun_index];
+		MutationRun *mutrun = mutrun_sp.get();
+		
+		// runs shared from parental genomes are usually interned already; the rest are new, or were missed by interning
+		if (mutrun && !mutrun->IsInterned())
+		{
+			MutationRun *interned_run = mutrun_intern_table_.Intern(mutrun);
+			
+			if (interned_run != mutrun)
+				mutrun_sp.reset(interned_run);
+		}
+	}
+}
+
 // Scan through all mutation runs in the simulation and unique them
 void Population::UniqueMutationRuns(void)
 {
 #if SLIM_DEBUG_MUTATION_RUNS
 	clock_t begin = clock();
 #endif
-	std::multimap<int64_t, MutationRun *> runmap;
-	int64_t total_mutruns = 0, total_hash_collisions = 0, total_identical = 0, total_uniqued_away = 0, total_preexisting = 0, total_final = 0;
+	int64_t total_mutruns = 0, total_already_interned = 0, total_interned = 0, total_uniqued_away = 0, total_preexisting = 0;
 	
 	int64_t operation_id = ++gSLiM_MutationRun_OperationID;
 	
@@ -4598,8 +4894,6 @@ void Population::UniqueMutationRuns(void)
 				
 				if (mut_run)
 				{
-					bool first_sight_of_this_mutrun = false;
-					
 					total_mutruns++;
 					
 					if (mut_run->operation_id_ != operation_id)
@@ -4607,61 +4901,28 @@ void Population::UniqueMutationRuns(void)
 						// Mark each new run we encounter with the operation ID, to count the preexisting number of runs
 						total_preexisting++;
 						mut_run->operation_id_ = operation_id;
-						first_sight_of_this_mutrun = true;
 					}
 					
-					// Calculate a hash for this mutrun.  Note that we could store computed hashes into the runs above, so that
-					// we only hash each pre-existing run once; but that would require an int64_t more storage per mutrun, and
-					// the memory overhead doesn't presently seem worth the very slight performance gain it would usually provide
-					int64_t hash = mut_run->Hash();
+					// Runs that are already interned are unique with respect to all other interned runs, so there is nothing to do.
+					// Runs generated by InternGenomeRuns() will usually be in this state; the runs not yet interned are generally
+					// those that were modified in place (by removal of fixed mutations, or by script), or created by other means.
+					if (mut_run->IsInterned())
+					{
+						total_already_interned++;
+						continue;
+					}
 					
-					// See if we have any mutruns already defined with this hash.  Note that we actually want to do this search
-					// even when first_sight_of_this_mutrun = true, because we want to find hash collisions, which may be other
-					// runs that are identical to us despite being separate objects.  That is, in fact, kind of the point.
-					auto range = runmap.equal_range(hash);		// pair<Iter, Iter>
+					MutationRun *interned_run = mutrun_intern_table_.Intern(mut_run);
 					
-					if (range.first == range.second)
+					if (interned_run == mut_run)
 					{
-						// No previous mutrun found with this hash, so add this mutrun to the multimap
-						runmap.insert(std::pair<int64_t, MutationRun *>(hash, mut_run));
-						total_final++;
+						total_interned++;
 					}
 					else
 					{
-						// There is at least one hit; first cycle through the hits and see if any of them are pointer-identical
-						for (auto hash_iter = range.first; hash_iter != range.second; ++hash_iter)
-						{
-							if (mut_run == hash_iter->second)
-							{
-								total_identical++;
-								goto is_identical;
-							}
-						}
-						
-						// OK, we have no pointer-identical matches; check for a duplicate using Identical()
-						for (auto hash_iter = range.first; hash_iter != range.second; ++hash_iter)
-						{
-							MutationRun *hash_run = hash_iter->second;
-							
-							if (mut_run->Identical(*hash_run))
-							{
-								genome.mutruns_[mutrun_index].reset(hash_run);
-								total_identical++;
-								
-								// We will unique away all references to this mutrun, but we only want to count it once
-								if (first_sight_of_this_mutrun)
-									total_uniqued_away++;
-								goto is_identical;
-							}
-						}
-						
-						// If there was no identical match, then we have a hash collision; put it in the multimap
-						runmap.insert(std::pair<int64_t, MutationRun *>(hash, mut_run));
-						total_hash_collisions++;
-						total_final++;
-						
-					is_identical:
-						;
+						// Replace the duplicate with the interned run; the duplicate's other references will be found in turn
+						genome.mutruns_[mutrun_index].reset(interned_run);
+						total_uniqued_away++;
 					}
 				}
 			}
@@ -4672,10 +4933,10 @@ void Population::UniqueMutationRuns(void)
 	clock_t end = clock();
 	double time_spent = static_cast<double>(end - begin) / CLOCKS_PER_SEC;
 	
-	std::cout << "UniqueMutationRuns(): \n   " << total_mutruns << " run pointers analyzed\n   " << total_preexisting << " runs pre-existing\n   " << total_uniqued_away << " duplicate runs discovered and uniqued away\n   " << (total_mutruns - total_identical) << " final uniqued mutation runs\n   " << total_hash_collisions << " hash collisions\n   " << time_spent << " seconds elapsed" << std::endl;
+	std::cout << "UniqueMutationRuns(): \n   " << total_mutruns << " run pointers analyzed\n   " << total_preexisting << " runs pre-existing\n   " << total_interned << " runs newly interned\n   " << total_uniqued_away << " duplicate run references uniqued away\n   " << mutrun_intern_table_.Count() << " interned runs\n   " << time_spent << " seconds elapsed" << std::endl;
 #endif
 	
-	if (total_final != total_mutruns - total_identical)
+	if (total_already_interned + total_interned + total_uniqued_away != total_mutruns)
 		EIDOS_TERMINATION << "ERROR (Population::UniqueMutationRuns): (internal error) bookkeeping error in mutation run uniquing." << EidosTerminate();
 }
 
@@ -5186,6 +5447,14 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 					for (int run_index = 0; run_index < mutrun_count; ++run_index)
 					{
 						MutationRun *mutrun = genome.mutruns_[run_index].get();
+						
+						if (gEidosMaxThreads > 1)
+						{
+							// tally later, in parallel
+							tally_mutruns_.emplace_back(mutrun, 1);
+							continue;
+						}
+						
 						const MutationIndex *genome_iter = mutrun->begin_pointer_const();
 						const MutationIndex *genome_end_iter = mutrun->end_pointer_const();
 						
@@ -5198,6 +5467,9 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 			}
 		}
 		
+		if (tally_mutruns_.size())
+			TallyMutationRunReferences_Parallel();
+		
 		// set up the cache info
 		last_tallied_subpops_ = *p_subpops_to_tally;
 		cached_tally_genome_count_ = total_genome_count;
@@ -5405,6 +5677,14 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 							for (int run_index = 0; run_index < mutrun_count; ++run_index)
 							{
 								MutationRun *mutrun = genome.mutruns_[run_index].get();
+								
+								if (gEidosMaxThreads > 1)
+								{
+									// tally later, in parallel
+									tally_mutruns_.emplace_back(mutrun, 1);
+									continue;
+								}
+								
 								const MutationIndex *genome_iter = mutrun->begin_pointer_const();
 								const MutationIndex *genome_end_iter = mutrun->end_pointer_const();
 								
@@ -5440,6 +5720,9 @@ slim_refcount_t Population::TallyMutationReferences(std::vector<Subpopulation*>
 				}
 			}
 			
+			if (tally_mutruns_.size())
+				TallyMutationRunReferences_Parallel();
+			
 			// set up the cache info
 			last_tallied_subpops_.clear();
 			cached_tally_genome_count_ = total_genome_count;
@@ -5484,6 +5767,45 @@ slim_refcount_t Population::TallyMutationReferences_FAST(void)
 	slim_refcount_t total_genome_count = 0;
 	int64_t operation_id = ++gSLiM_MutationRun_OperationID;
 	
+	if (gEidosMaxThreads > 1)
+	{
+		// With multiple threads, we gather the unique mutation runs serially, marking them with operation_id as
+		// TallyGenomeMutationReferences() does, and then tally them in parallel, weighted by their use counts
+		for (const std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : subpops_)
+		{
+			Subpopulation *subpop = subpop_pair.second;
+			slim_popsize_t subpop_genome_count = subpop->CurrentGenomeCount();
+			std::vector<Genome *> &subpop_genomes = subpop->CurrentGenomes();
+			
+			for (slim_popsize_t i = 0; i < subpop_genome_count; i++)
+			{
+				Genome &genome = *subpop_genomes[i];
+				
+				if (!genome.IsNull())
+				{
+					int mutrun_count = genome.mutrun_count_;
+					
+					for (int run_index = 0; run_index < mutrun_count; ++run_index)
+					{
+						MutationRun *mutrun = genome.mutruns_[run_index].get();
+						
+						if (mutrun->operation_id_ != operation_id)
+						{
+							mutrun->operation_id_ = operation_id;
+							tally_mutruns_.emplace_back(mutrun, (slim_refcount_t)mutrun->UseCount());
+						}
+					}
+					
+					total_genome_count++;	// count only non-null genomes to determine fixation
+				}
+			}
+		}
+		
+		TallyMutationRunReferences_Parallel();
+		
+		return total_genome_count;
+	}
+	
 	for (const std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : subpops_)
 	{
 		Subpopulation *subpop = subpop_pair.second;
@@ -5521,6 +5843,85 @@ slim_refcount_t Population::TallyMutationReferences_FAST(void)
 	return total_genome_count;
 }
 
+// Tally the mutation runs in tally_mutruns_ into gSLiM_Mutation_Refcounts, which must already be zeroed for all mutations in the registry.
+// Each thread tallies a share of the runs into its own refcount buffer (the first thread uses gSLiM_Mutation_Refcounts itself), and then
+// the buffers are summed into gSLiM_Mutation_Refcounts, again in parallel, over the registry.  The per-thread buffers are zeroed and summed
+// only for mutations in the registry, so their cost scales with the number of segregating mutations, not with the mutation block size.
+void Population::TallyMutationRunReferences_Parallel(void)
+{
+#ifdef _OPENMP
+	int thread_count = gEidosMaxThreads;
+	MutationIndex buffer_stride = gSLiM_Mutation_Block_LastUsedIndex + 1;		// the buffers need to cover only the used part of the block
+	size_t buffer_size = (size_t)(thread_count - 1) * (size_t)buffer_stride;
+	
+	if (tally_thread_refcounts_size_ < buffer_size)
+	{
+		tally_thread_refcounts_ = (slim_refcount_t *)realloc(tally_thread_refcounts_, buffer_size * sizeof(slim_refcount_t));
+		tally_thread_refcounts_size_ = buffer_size;
+	}
+	
+	slim_refcount_t *refcount_block_ptr = gSLiM_Mutation_Refcounts;
+	slim_refcount_t *thread_refcounts = tally_thread_refcounts_;
+	const MutationIndex *registry_ptr = mutation_registry_.begin_pointer_const();
+	int64_t registry_count = mutation_registry_.size();
+	const std::pair<const MutationRun *, slim_refcount_t> *tally_mutruns = tally_mutruns_.data();
+	int64_t tally_mutrun_count = (int64_t)tally_mutruns_.size();
+	
+#pragma omp parallel num_threads(thread_count)
+	{
+		int thread_num = omp_get_thread_num();
+		int team_size = omp_get_num_threads();
+		slim_refcount_t *refcounts = (thread_num == 0) ? refcount_block_ptr : (thread_refcounts + (size_t)(thread_num - 1) * buffer_stride);
+		
+		if (thread_num > 0)
+			for (int64_t registry_index = 0; registry_index < registry_count; ++registry_index)
+				refcounts[registry_ptr[registry_index]] = 0;
+		
+#pragma omp for schedule(dynamic, 16)
+		for (int64_t tally_index = 0; tally_index < tally_mutrun_count; ++tally_index)
+		{
+			const MutationRun *mutrun = tally_mutruns[tally_index].first;
+			slim_refcount_t weight = tally_mutruns[tally_index].second;
+			const MutationIndex *mutrun_iter = mutrun->begin_pointer_const();
+			const MutationIndex *mutrun_end_iter = mutrun->end_pointer_const();
+			
+			while (mutrun_iter != mutrun_end_iter)
+				refcounts[*mutrun_iter++] += weight;
+		}
+		
+		// the implicit barrier at the end of the loop above guarantees that all tallies are complete before we sum them
+#pragma omp for schedule(static)
+		for (int64_t registry_index = 0; registry_index < registry_count; ++registry_index)
+		{
+			MutationIndex mut_index = registry_ptr[registry_index];
+			slim_refcount_t total = 0;
+			
+			for (int other_thread_num = 1; other_thread_num < team_size; ++other_thread_num)
+				total += thread_refcounts[(size_t)(other_thread_num - 1) * buffer_stride + mut_index];
+			
+			refcount_block_ptr[mut_index] += total;
+		}
+	}
+#else
+	// without OpenMP, main() forces gEidosMaxThreads to 1 so we should not be called, but if gEidosMaxThreads has been set some other way
+	// (e.g. by the self-tests), we just tally serially into gSLiM_Mutation_Refcounts
+	slim_refcount_t *refcount_block_ptr = gSLiM_Mutation_Refcounts;
+	
+	for (const std::pair<const MutationRun *, slim_refcount_t> &tally_pair : tally_mutruns_)
+	{
+		const MutationRun *mutrun = tally_pair.first;
+		slim_refcount_t weight = tally_pair.second;
+		const MutationIndex *mutrun_iter = mutrun->begin_pointer_const();
+		const MutationIndex *mutrun_end_iter = mutrun->end_pointer_const();
+		
+		while (mutrun_iter != mutrun_end_iter)
+			refcount_block_ptr[*mutrun_iter++] += weight;
+	}
+#endif
+	
+	tally_mutruns_.clear();
+}
+
 // handle negative fixation (remove from the registry) and positive fixation (convert to Substitution), using reference counts from TallyMutationReferences()
 // TallyMutationReferences() must have cached tallies across the whole population before this is called, or it will malfunction!
 void Population::RemoveAllFixedMutations(void)
@@ -57,6 +57,25 @@ typedef struct {
 #endif
 
 
+#ifdef SLIM_WF_ONLY
+// This struct records the outcome of the serial first phase of parallel offspring generation for one child genome: the
+// parental strands to copy from (after the initial strand swap), and slices of the flat buffers in Population that hold
+// the genome's breakpoints, its new mutations, and the mutation runs preallocated for it.  See EvolveSubpopulation().
+typedef struct {
+	Genome *child_genome_;
+	Genome *parent_genome_1_;
+	Genome *parent_genome_2_;
+	int32_t breakpoints_start_;
+	int32_t breakpoints_count_;
+	int32_t new_mutations_start_;
+	int32_t new_mutations_count_;
+	int32_t runs_start_;
+	int32_t runs_count_;
+	int32_t runs_used_;					// set by AssembleDeferredChildGenome(); the rest are returned to the free list
+} DeferredChildGenome;
+#endif	// SLIM_WF_ONLY
+
+
 class Population
 {
 	//	This class has its copy constructor and assignment operator disabled, to prevent accidental copying.
@@ -82,11 +101,27 @@ public:
 	std::vector<Subpopulation*> last_tallied_subpops_;		// NOT OWNED POINTERS
 	slim_refcount_t cached_tally_genome_count_ = 0;
 	
+	// Buffers for multithreaded tallying; see TallyMutationRunReferences_Parallel()
+	std::vector<std::pair<const MutationRun *, slim_refcount_t>> tally_mutruns_;	// mutation runs to be tallied, with the weight of each
+	slim_refcount_t *tally_thread_refcounts_ = nullptr;		// OWNED; a refcount buffer parallel to gSLiM_Mutation_Refcounts for each thread after the first
+	size_t tally_thread_refcounts_size_ = 0;
+	
+	// Interning of mutation runs, so that identical runs are shared among genomes; see MutationRunInternTable and InternGenomeRuns()
+	MutationRunInternTable mutrun_intern_table_;
+	
 	std::vector<Substitution*> substitutions_;				// OWNED POINTERS: Substitution objects for all fixed mutations
 	std::unordered_multimap<slim_position_t, Substitution*> treeseq_substitutions_map_;	// TREE SEQUENCE RECORDING; keeps all fixed mutations, hashed by position
 
 #ifdef SLIM_WF_ONLY
 	bool child_generation_valid_ = false;					// this keeps track of whether children have been generated by EvolveSubpopulation() yet, or whether the parents are still in charge
+	
+	// Buffers for parallel offspring generation; the child genomes are planned serially, and then assembled in parallel
+	std::vector<DeferredChildGenome> deferred_genomes_;
+	std::vector<slim_position_t> deferred_breakpoints_;
+	std::vector<MutationIndex> deferred_new_mutations_;
+	std::vector<uint8_t> deferred_mutation_accepted_;		// per new mutation, whether the stacking policy allowed it
+	std::vector<std::vector<Mutation *>> deferred_derived_states_;	// per new mutation, its derived state, for tree-seq recording
+	std::vector<MutationRun *> deferred_runs_;
 #endif
 	
 	std::vector<Subpopulation*> removed_subpops_;			// OWNED POINTERS: Subpops which are set to size 0 (and thus removed) are kept here until the end of the generation
@@ -123,8 +158,9 @@ public:
 	// apply recombination() callbacks to a generated child; a return of true means the breakpoints were changed
 	bool ApplyRecombinationCallbacks(slim_popsize_t p_parent_index, Genome *p_genome1, Genome *p_genome2, Subpopulation *p_source_subpop, std::vector<slim_position_t> &p_crossovers, std::vector<SLiMEidosBlock*> &p_recombination_callbacks);
 	
-	// generate a child genome from parental genomes, with recombination, gene conversion, and mutation
-	void DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_child_genome, slim_popsize_t p_parent_index, IndividualSex p_child_sex, IndividualSex p_parent_sex, std::vector<SLiMEidosBlock*> *p_recombination_callbacks, std::vector<SLiMEidosBlock*> *p_mutation_callbacks);
+	// generate a child genome from parental genomes, with recombination, gene conversion, and mutation; if p_defer_assembly is true,
+	// all random draws are made but the child genome is not assembled; that is left to AssembleDeferredChildGenomes() (WF only)
+	void DoCrossoverMutation(Subpopulation *p_source_subpop, Genome &p_child_genome, slim_popsize_t p_parent_index, IndividualSex p_child_sex, IndividualSex p_parent_sex, std::vector<SLiMEidosBlock*> *p_recombination_callbacks, std::vector<SLiMEidosBlock*> *p_mutation_callbacks, bool p_defer_assembly = false);
 	void DoHeteroduplexRepair(std::vector<slim_position_t> &p_heteroduplex, std::vector<slim_position_t> &p_breakpoints, Genome *p_parent_genome_1, Genome *p_parent_genome_2, Genome *p_child_genome);
 	
 	// generate a child genome from parental genomes, with predetermined recombination and mutation
@@ -139,7 +175,9 @@ public:
 	// Recalculate all fitness values for the parental generation, including the use of fitness() callbacks
 	void RecalculateFitness(slim_generation_t p_generation);
 	
-	// Scan through all mutation runs in the simulation and unique them
+	// Share identical mutation runs among genomes, using mutrun_intern_table_; InternGenomeRuns() does this for the runs of one new genome,
+	// as they are generated, while UniqueMutationRuns() scans through all mutation runs in the simulation, catching any that were missed
+	void InternGenomeRuns(Genome &p_genome);
 	void UniqueMutationRuns(void);
 	
 	// Scan through all genomes and either split or join their mutation runs, to double or halve the number of runs per genome
@@ -152,6 +190,7 @@ public:
 	// count the total number of times that each Mutation in the registry is referenced by a population, and set total_genome_count_ to the maximum possible number of references (i.e. fixation)
 	slim_refcount_t TallyMutationReferences(std::vector<Subpopulation*> *p_subpops_to_tally, bool p_force_recache);
 	slim_refcount_t TallyMutationReferences_FAST(void);
+	void TallyMutationRunReferences_Parallel(void);		// tally the runs in tally_mutruns_ using gEidosMaxThreads threads, and clear tally_mutruns_
 	
 	// handle negative fixation (remove from the registry) and positive fixation (convert to Substitution), using reference counts from TallyMutationReferences()
 	void RemoveAllFixedMutations(void);
@@ -178,6 +217,11 @@ public:
 	// generate children for subpopulation p_subpop_id, drawing from all source populations, handling crossover and mutation
 	void EvolveSubpopulation(Subpopulation &p_subpop, bool p_mate_choice_callbacks_present, bool p_modify_child_callbacks_present, bool p_recombination_callbacks_present, bool p_mutation_callbacks_present);
 	
+	// parallel offspring generation: record a child genome to be assembled later, and then assemble all such genomes in parallel
+	void DeferChildGenomeAssembly(Genome &p_child_genome, Genome *p_parent_genome_1, Genome *p_parent_genome_2, std::vector<slim_position_t> &p_breakpoints, MutationRun *p_new_mutations);
+	void AssembleDeferredChildGenome(DeferredChildGenome &p_deferred_genome);
+	void AssembleDeferredChildGenomes(void);
+	
 	// step forward a generation: make the children become the parents
 	void SwapGenerations(void);
 	
@@ -225,7 +225,7 @@ EidosASTNode *SLiMEidosScript::Parse_SLiMEidosBlock(void)
 						callback_info_node->AddChild(bad_node);
 					}
 					
-					if (current_token_type_ == EidosTokenType::kTokenComma)
+					if ((current_token_type_ == EidosTokenType::kTokenComma) && !CommaAndNamedParameterFollow(gStr_vectorized))
 					{
 						// A (optional) subpopulation id is present; add it
 						Match(EidosTokenType::kTokenComma, "SLiM fitness() callback");
@@ -248,6 +248,38 @@ EidosASTNode *SLiMEidosScript::Parse_SLiMEidosBlock(void)
 						}
 					}
 					
+					if (CommaAndNamedParameterFollow(gStr_vectorized))
+					{
+						// A (optional) vectorized=T/F flag is present; add it as an assignment node with the name and value as children
+						Match(EidosTokenType::kTokenComma, "SLiM fitness() callback");
+						
+						EidosASTNode *name_node = new (gEidosASTNodePool->AllocateChunk()) EidosASTNode(current_token_);
+						
+						Match(EidosTokenType::kTokenIdentifier, "SLiM fitness() callback");
+						
+						EidosASTNode *flag_node = new (gEidosASTNodePool->AllocateChunk()) EidosASTNode(current_token_, name_node);
+						callback_info_node->AddChild(flag_node);
+						
+						Match(EidosTokenType::kTokenAssign, "SLiM fitness() callback");
+						
+						if (current_token_type_ == EidosTokenType::kTokenIdentifier)
+						{
+							flag_node->AddChild(new (gEidosASTNodePool->AllocateChunk()) EidosASTNode(current_token_));
+							
+							Match(EidosTokenType::kTokenIdentifier, "SLiM fitness() callback");
+						}
+						else
+						{
+							if (!parse_make_bad_nodes_)
+								EIDOS_TERMINATION << "ERROR (SLiMEidosScript::Parse_SLiMEidosBlock): unexpected token " << *current_token_ << "; T or F expected for vectorized." << EidosTerminate(current_token_);
+							
+							// Make a placeholder bad node, to be error-tolerant
+							EidosToken *bad_token = new EidosToken(EidosTokenType::kTokenBad, gEidosStr_empty_string, 0, 0, 0, 0);
+							EidosASTNode *bad_node = new (gEidosASTNodePool->AllocateChunk()) EidosASTNode(bad_token, true);
+							flag_node->AddChild(bad_node);
+						}
+					}
+					
 					Match(EidosTokenType::kTokenRParen, "SLiM fitness() callback");
 				}
 				else if (current_token_->token_string_.compare(gStr_mutation) == 0)
@@ -512,6 +544,17 @@ void SLiMEidosScript::ParseSLiMFileToAST(bool p_make_bad_nodes)
 	parse_make_bad_nodes_ = false;
 }
 
+bool SLiMEidosScript::CommaAndNamedParameterFollow(const std::string &p_name)
+{
+	if ((current_token_type_ != EidosTokenType::kTokenComma) || (parse_index_ + 2 >= (int)token_stream_.size()))
+		return false;
+	
+	const EidosToken &name_token = token_stream_[parse_index_ + 1];
+	const EidosToken &assign_token = token_stream_[parse_index_ + 2];
+	
+	return ((name_token.token_type_ == EidosTokenType::kTokenIdentifier) && (name_token.token_string_ == p_name) && (assign_token.token_type_ == EidosTokenType::kTokenAssign));
+}
+
 bool SLiMEidosScript::StringIsIDWithPrefix(const std::string &p_identifier_string, char p_prefix_char)
 {
 	const char *id_cstr = p_identifier_string.c_str();
@@ -557,6 +600,662 @@ slim_objectid_t SLiMEidosScript::ExtractIDFromStringWithPrefix(const std::string
 //
 //	SLiMEidosBlock
 //
+#pragma mark -
+#pragma mark SLiMFitnessExpression
+#pragma mark -
+
+int SLiMFitnessExpression::_AddNode(SLiMFitnessExprOp p_op, SLiMFitnessExprType p_type, int p_child1, int p_child2, int p_child3)
+{
+	if (nodes_.size() >= SLIM_FITNESS_EXPR_MAX_NODES)
+		return -1;
+	
+	SLiMFitnessExprNode node;
+	
+	node.op_ = p_op;
+	node.type_ = p_type;
+	node.operand_type_ = p_type;
+	node.child1_ = (int16_t)p_child1;
+	node.child2_ = (int16_t)p_child2;
+	node.child3_ = (int16_t)p_child3;
+	node.constant_float_ = 0.0;
+	node.constant_int_ = 0;
+	node.mutation_type_id_ = -1;
+	node.mutation_type_ptr_ = nullptr;
+	
+	nodes_.emplace_back(node);
+	
+	return (int)nodes_.size() - 1;
+}
+
+int SLiMFitnessExpression::_CompileIndividualAccess(const EidosASTNode *p_node)
+{
+	// p_node is a kTokenDot node; we accept only properties of "individual", since that is the only object we can see
+	if (p_node->children_.size() != 2)
+		return -1;
+	
+	const EidosASTNode *object_node = p_node->children_[0];
+	const EidosASTNode *property_node = p_node->children_[1];
+	
+	if ((object_node->token_->token_type_ != EidosTokenType::kTokenIdentifier) || (object_node->token_->token_string_ != gStr_individual))
+		return -1;
+	if (property_node->token_->token_type_ != EidosTokenType::kTokenIdentifier)
+		return -1;
+	
+	const std::string &property_name = property_node->token_->token_string_;
+	
+	if (property_name == gStr_tag)
+		return _AddNode(SLiMFitnessExprOp::kIndividualTag, SLiMFitnessExprType::kInt);
+	if (property_name == gStr_tagF)
+		return _AddNode(SLiMFitnessExprOp::kIndividualTagF, SLiMFitnessExprType::kFloat);
+	if ((property_name == gEidosStr_x) || (property_name == gEidosStr_y) || (property_name == gEidosStr_z))
+	{
+		int node_index = _AddNode(SLiMFitnessExprOp::kIndividualCoordinate, SLiMFitnessExprType::kFloat);
+		
+		if (node_index != -1)
+			nodes_[node_index].constant_int_ = ((property_name == gEidosStr_x) ? 0 : ((property_name == gEidosStr_y) ? 1 : 2));
+		
+		return node_index;
+	}
+	if (property_name == gStr_spatialPosition)
+	{
+		// the whole spatialPosition vector is a singleton only in 1D; that is checked at evaluation time
+		int node_index = _AddNode(SLiMFitnessExprOp::kIndividualSpatial, SLiMFitnessExprType::kFloat);
+		
+		if (node_index != -1)
+			nodes_[node_index].constant_int_ = -1;
+		
+		return node_index;
+	}
+	
+	return -1;
+}
+
+// Matches the arguments of a call against the parameter names given, in the way the interpreter does: positional arguments
+// first, then named arguments in signature order.  Omitted arguments are left nullptr; the caller supplies defaults.
+static bool SLiM_MatchFitnessExprArguments(const EidosASTNode *p_call_node, const std::vector<std::string> &p_param_names, std::vector<const EidosASTNode *> &p_args)
+{
+	size_t param_count = p_param_names.size();
+	size_t param_index = 0;
+	
+	p_args.assign(param_count, nullptr);
+	
+	for (size_t child_index = 1; child_index < p_call_node->children_.size(); ++child_index)
+	{
+		const EidosASTNode *arg_node = p_call_node->children_[child_index];
+		
+		if (arg_node->token_->token_type_ == EidosTokenType::kTokenAssign)
+		{
+			if ((arg_node->children_.size() != 2) || (arg_node->children_[0]->token_->token_type_ != EidosTokenType::kTokenIdentifier))
+				return false;
+			
+			const std::string &arg_name = arg_node->children_[0]->token_->token_string_;
+			
+			while ((param_index < param_count) && (p_param_names[param_index] != arg_name))
+				param_index++;
+			
+			arg_node = arg_node->children_[1];
+		}
+		
+		if (param_index >= param_count)
+			return false;
+		
+		p_args[param_index++] = arg_node;
+	}
+	
+	return true;
+}
+
+int SLiMFitnessExpression::_CompileCall(const EidosASTNode *p_node)
+{
+	if (p_node->children_.size() < 1)
+		return -1;
+	
+	const EidosASTNode *call_node = p_node->children_[0];
+	std::vector<const EidosASTNode *> args;
+	
+	if (call_node->token_->token_type_ == EidosTokenType::kTokenDot)
+	{
+		// individual.sumOfMutationsOfType(mN), with the mutation type given by its symbol or by a constant integer id
+		if ((call_node->children_.size() != 2) || (call_node->children_[0]->token_->token_type_ != EidosTokenType::kTokenIdentifier) || (call_node->children_[0]->token_->token_string_ != gStr_individual))
+			return -1;
+		if ((call_node->children_[1]->token_->token_type_ != EidosTokenType::kTokenIdentifier) || (call_node->children_[1]->token_->token_string_ != gStr_sumOfMutationsOfType))
+			return -1;
+		if (!SLiM_MatchFitnessExprArguments(p_node, std::vector<std::string>{"mutType"}, args) || !args[0])
+			return -1;
+		
+		const EidosASTNode *mutType_node = args[0];
+		slim_objectid_t mutation_type_id;
+		
+		if ((mutType_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && SLiMEidosScript::StringIsIDWithPrefix(mutType_node->token_->token_string_, 'm'))
+			mutation_type_id = SLiMEidosScript::ExtractIDFromStringWithPrefix(mutType_node->token_->token_string_, 'm', mutType_node->token_);
+		else if ((mutType_node->token_->token_type_ == EidosTokenType::kTokenNumber) && mutType_node->cached_literal_value_ && (mutType_node->cached_literal_value_->Type() == EidosValueType::kValueInt) && (mutType_node->cached_literal_value_->Count() == 1))
+			mutation_type_id = SLiMCastToObjectidTypeOrRaise(mutType_node->cached_literal_value_->IntAtIndex(0, nullptr));
+		else
+			return -1;
+		
+		int node_index = _AddNode(SLiMFitnessExprOp::kSumOfMutationsOfType, SLiMFitnessExprType::kFloat);
+		
+		if (node_index != -1)
+			nodes_[node_index].mutation_type_id_ = mutation_type_id;
+		
+		return node_index;
+	}
+	
+	if (call_node->token_->token_type_ != EidosTokenType::kTokenIdentifier)
+		return -1;
+	
+	const std::string &function_name = call_node->token_->token_string_;
+	
+	if ((function_name == "exp") || (function_name == "log"))
+	{
+		if (!SLiM_MatchFitnessExprArguments(p_node, std::vector<std::string>{"x"}, args) || !args[0])
+			return -1;
+		
+		int x_index = _CompileNode(args[0]);
+		
+		if ((x_index == -1) || (nodes_[x_index].type_ == SLiMFitnessExprType::kLogical))
+			return -1;
+		
+		return _AddNode((function_name == "exp") ? SLiMFitnessExprOp::kExp : SLiMFitnessExprOp::kLog, SLiMFitnessExprType::kFloat, x_index);
+	}
+	else if (function_name == "dnorm")
+	{
+		if (!SLiM_MatchFitnessExprArguments(p_node, std::vector<std::string>{"x", "mean", "sd"}, args) || !args[0])
+			return -1;
+		
+		// x is declared float, so an integer x is an error in the interpreter; mean and sd are numeric, with defaults
+		int x_index = _CompileNode(args[0]);
+		
+		if ((x_index == -1) || (nodes_[x_index].type_ != SLiMFitnessExprType::kFloat))
+			return -1;
+		
+		int param_indices[2];
+		
+		for (int param = 0; param < 2; ++param)
+		{
+			if (args[param + 1])
+			{
+				param_indices[param] = _CompileNode(args[param + 1]);
+				
+				if ((param_indices[param] == -1) || (nodes_[param_indices[param]].type_ == SLiMFitnessExprType::kLogical))
+					return -1;
+			}
+			else
+			{
+				param_indices[param] = _AddNode(SLiMFitnessExprOp::kConstant, SLiMFitnessExprType::kFloat);
+				
+				if (param_indices[param] == -1)
+					return -1;
+				
+				nodes_[param_indices[param]].constant_float_ = ((param == 0) ? 0.0 : 1.0);
+			}
+		}
+		
+		return _AddNode(SLiMFitnessExprOp::kDnorm, SLiMFitnessExprType::kFloat, x_index, param_indices[0], param_indices[1]);
+	}
+	else if (function_name == "ifelse")
+	{
+		if (!SLiM_MatchFitnessExprArguments(p_node, std::vector<std::string>{"test", "trueValues", "falseValues"}, args) || !args[0] || !args[1] || !args[2])
+			return -1;
+		
+		int test_index = _CompileNode(args[0]);
+		int true_index = (test_index == -1) ? -1 : _CompileNode(args[1]);
+		int false_index = (true_index == -1) ? -1 : _CompileNode(args[2]);
+		
+		if ((false_index == -1) || (nodes_[test_index].type_ != SLiMFitnessExprType::kLogical) || (nodes_[true_index].type_ != nodes_[false_index].type_))
+			return -1;
+		
+		return _AddNode(SLiMFitnessExprOp::kConditional, nodes_[true_index].type_, test_index, true_index, false_index);
+	}
+	
+	return -1;
+}
+
+int SLiMFitnessExpression::_CompileNode(const EidosASTNode *p_node)
+{
+	EidosTokenType token_type = p_node->token_->token_type_;
+	size_t child_count = p_node->children_.size();
+	
+	switch (token_type)
+	{
+		case EidosTokenType::kTokenNumber:
+		case EidosTokenType::kTokenIdentifier:
+		{
+			// numbers, and the constants T, F, PI, E, INF, and NAN, have cached values from EidosASTNode::_OptimizeConstants()
+			EidosValue *literal = p_node->cached_literal_value_.get();
+			
+			if (literal)
+			{
+				if (literal->Count() != 1)
+					return -1;
+				
+				EidosValueType literal_type = literal->Type();
+				int node_index;
+				
+				if (literal_type == EidosValueType::kValueFloat)
+				{
+					node_index = _AddNode(SLiMFitnessExprOp::kConstant, SLiMFitnessExprType::kFloat);
+					if (node_index != -1)
+						nodes_[node_index].constant_float_ = literal->FloatAtIndex(0, nullptr);
+				}
+				else if ((literal_type == EidosValueType::kValueInt) || (literal_type == EidosValueType::kValueLogical))
+				{
+					node_index = _AddNode(SLiMFitnessExprOp::kConstant, (literal_type == EidosValueType::kValueInt) ? SLiMFitnessExprType::kInt : SLiMFitnessExprType::kLogical);
+					if (node_index != -1)
+						nodes_[node_index].constant_int_ = literal->IntAtIndex(0, nullptr);
+				}
+				else
+					return -1;
+				
+				return node_index;
+			}
+			
+			if (token_type != EidosTokenType::kTokenIdentifier)
+				return -1;
+			
+			const std::string &identifier = p_node->token_->token_string_;
+			
+			if (identifier == gStr_relFitness)
+				return _AddNode(SLiMFitnessExprOp::kRelFitness, SLiMFitnessExprType::kFloat);
+			if ((identifier == gStr_homozygous) && !global_callback_)		// always NULL in global callbacks
+				return _AddNode(SLiMFitnessExprOp::kHomozygous, SLiMFitnessExprType::kLogical);
+			
+			return -1;
+		}
+		case EidosTokenType::kTokenLParen:
+			return _CompileCall(p_node);
+		case EidosTokenType::kTokenDot:
+			return _CompileIndividualAccess(p_node);
+		case EidosTokenType::kTokenLBracket:
+		{
+			// individual.spatialPosition[k], for a constant integer k; the bounds check against the dimensionality is done at evaluation time
+			if (child_count != 2)
+				return -1;
+			
+			const EidosASTNode *target_node = p_node->children_[0];
+			const EidosASTNode *subscript_node = p_node->children_[1];
+			EidosValue *subscript = subscript_node->cached_literal_value_.get();
+			
+			if ((target_node->token_->token_type_ != EidosTokenType::kTokenDot) || (target_node->children_.size() != 2) || (target_node->children_[1]->token_->token_string_ != gStr_spatialPosition))
+				return -1;
+			if ((subscript_node->token_->token_type_ != EidosTokenType::kTokenNumber) || !subscript || (subscript->Type() != EidosValueType::kValueInt) || (subscript->Count() != 1))
+				return -1;
+			
+			int64_t subscript_value = subscript->IntAtIndex(0, nullptr);
+			
+			if ((subscript_value < 0) || (subscript_value > 2))
+				return -1;
+			
+			int node_index = _CompileIndividualAccess(target_node);
+			
+			if (node_index != -1)
+				nodes_[node_index].constant_int_ = subscript_value;
+			
+			return node_index;
+		}
+		case EidosTokenType::kTokenPlus:
+		case EidosTokenType::kTokenMinus:
+		case EidosTokenType::kTokenMult:
+		case EidosTokenType::kTokenDiv:
+		case EidosTokenType::kTokenMod:
+		case EidosTokenType::kTokenExp:
+		{
+			// arithmetic operators do not accept logical operands; +, -, and * preserve integer type, the others always produce float
+			if ((child_count == 1) && ((token_type == EidosTokenType::kTokenPlus) || (token_type == EidosTokenType::kTokenMinus)))
+			{
+				int operand_index = _CompileNode(p_node->children_[0]);
+				
+				if ((operand_index == -1) || (nodes_[operand_index].type_ == SLiMFitnessExprType::kLogical))
+					return -1;
+				if (token_type == EidosTokenType::kTokenPlus)
+					return operand_index;
+				
+				return _AddNode(SLiMFitnessExprOp::kNegate, nodes_[operand_index].type_, operand_index);
+			}
+			
+			if (child_count != 2)
+				return -1;
+			
+			int left_index = _CompileNode(p_node->children_[0]);
+			int right_index = (left_index == -1) ? -1 : _CompileNode(p_node->children_[1]);
+			
+			if ((right_index == -1) || (nodes_[left_index].type_ == SLiMFitnessExprType::kLogical) || (nodes_[right_index].type_ == SLiMFitnessExprType::kLogical))
+				return -1;
+			
+			bool both_int = ((nodes_[left_index].type_ == SLiMFitnessExprType::kInt) && (nodes_[right_index].type_ == SLiMFitnessExprType::kInt));
+			SLiMFitnessExprType arithmetic_type = both_int ? SLiMFitnessExprType::kInt : SLiMFitnessExprType::kFloat;
+			SLiMFitnessExprOp op;
+			
+			switch (token_type)
+			{
+				case EidosTokenType::kTokenPlus:	op = SLiMFitnessExprOp::kAdd; break;
+				case EidosTokenType::kTokenMinus:	op = SLiMFitnessExprOp::kSubtract; break;
+				case EidosTokenType::kTokenMult:	op = SLiMFitnessExprOp::kMultiply; break;
+				case EidosTokenType::kTokenDiv:		op = SLiMFitnessExprOp::kDivide; arithmetic_type = SLiMFitnessExprType::kFloat; break;
+				case EidosTokenType::kTokenMod:		op = SLiMFitnessExprOp::kMod; arithmetic_type = SLiMFitnessExprType::kFloat; break;
+				default:							op = SLiMFitnessExprOp::kPower; arithmetic_type = SLiMFitnessExprType::kFloat; break;
+			}
+			
+			return _AddNode(op, arithmetic_type, left_index, right_index);
+		}
+		case EidosTokenType::kTokenAnd:
+		case EidosTokenType::kTokenOr:
+		{
+			// & and | are n-ary in the AST; we chain them pairwise, which is equivalent since none of our operands have side effects
+			if (child_count < 2)
+				return -1;
+			
+			int result_index = -1;
+			
+			for (size_t child_index = 0; child_index < child_count; ++child_index)
+			{
+				int operand_index = _CompileNode(p_node->children_[child_index]);
+				
+				if ((operand_index == -1) || (nodes_[operand_index].type_ != SLiMFitnessExprType::kLogical))
+					return -1;
+				
+				if (child_index == 0)
+					result_index = operand_index;
+				else
+					result_index = _AddNode((token_type == EidosTokenType::kTokenAnd) ? SLiMFitnessExprOp::kAnd : SLiMFitnessExprOp::kOr, SLiMFitnessExprType::kLogical, result_index, operand_index);
+				
+				if (result_index == -1)
+					return -1;
+			}
+			
+			return result_index;
+		}
+		case EidosTokenType::kTokenNot:
+		{
+			if (child_count != 1)
+				return -1;
+			
+			int operand_index = _CompileNode(p_node->children_[0]);
+			
+			if ((operand_index == -1) || (nodes_[operand_index].type_ != SLiMFitnessExprType::kLogical))
+				return -1;
+			
+			return _AddNode(SLiMFitnessExprOp::kNot, SLiMFitnessExprType::kLogical, operand_index);
+		}
+		case EidosTokenType::kTokenEq:
+		case EidosTokenType::kTokenNotEq:
+		case EidosTokenType::kTokenLt:
+		case EidosTokenType::kTokenLtEq:
+		case EidosTokenType::kTokenGt:
+		case EidosTokenType::kTokenGtEq:
+		{
+			if (child_count != 2)
+				return -1;
+			
+			int left_index = _CompileNode(p_node->children_[0]);
+			int right_index = (left_index == -1) ? -1 : _CompileNode(p_node->children_[1]);
+			
+			if (right_index == -1)
+				return -1;
+			
+			SLiMFitnessExprOp op;
+			
+			switch (token_type)
+			{
+				case EidosTokenType::kTokenEq:		op = SLiMFitnessExprOp::kEqual; break;
+				case EidosTokenType::kTokenNotEq:	op = SLiMFitnessExprOp::kNotEqual; break;
+				case EidosTokenType::kTokenLt:		op = SLiMFitnessExprOp::kLess; break;
+				case EidosTokenType::kTokenLtEq:	op = SLiMFitnessExprOp::kLessEqual; break;
+				case EidosTokenType::kTokenGt:		op = SLiMFitnessExprOp::kGreater; break;
+				default:							op = SLiMFitnessExprOp::kGreaterEqual; break;
+			}
+			
+			int node_index = _AddNode(op, SLiMFitnessExprType::kLogical, left_index, right_index);
+			
+			// operands are promoted to the higher of their types, logical < integer < float, as in Eidos_GetCompareFunctionForTypes()
+			if (node_index != -1)
+				nodes_[node_index].operand_type_ = std::max(nodes_[left_index].type_, nodes_[right_index].type_);
+			
+			return node_index;
+		}
+		case EidosTokenType::kTokenConditional:
+		{
+			if (child_count != 3)
+				return -1;
+			
+			int test_index = _CompileNode(p_node->children_[0]);
+			int true_index = (test_index == -1) ? -1 : _CompileNode(p_node->children_[1]);
+			int false_index = (true_index == -1) ? -1 : _CompileNode(p_node->children_[2]);
+			
+			if ((false_index == -1) || (nodes_[test_index].type_ != SLiMFitnessExprType::kLogical) || (nodes_[true_index].type_ != nodes_[false_index].type_))
+				return -1;
+			
+			return _AddNode(SLiMFitnessExprOp::kConditional, nodes_[true_index].type_, test_index, true_index, false_index);
+		}
+		default:
+			return -1;
+	}
+}
+
+SLiMFitnessExpression *SLiMFitnessExpression::CompileCallback(const EidosASTNode *p_compound_statement_node, bool p_global_callback)
+{
+	// We handle only callbacks of the form { return <expr>; }, where <expr> produces a float
+	if ((p_compound_statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace) || (p_compound_statement_node->children_.size() != 1))
+		return nullptr;
+	
+	const EidosASTNode *return_node = p_compound_statement_node->children_[0];
+	
+	if ((return_node->token_->token_type_ != EidosTokenType::kTokenReturn) || (return_node->children_.size() != 1))
+		return nullptr;
+	
+	SLiMFitnessExpression *expression = new SLiMFitnessExpression(p_global_callback);
+	int root_index = expression->_CompileNode(return_node->children_[0]);
+	
+	if ((root_index == -1) || (root_index != (int)expression->nodes_.size() - 1) || (expression->nodes_[root_index].type_ != SLiMFitnessExprType::kFloat))
+	{
+		delete expression;
+		return nullptr;
+	}
+	
+	return expression;
+}
+
+static inline __attribute__((always_inline)) double SLiM_FitnessExprFloat(const SLiMFitnessExprNode *p_nodes, const double *p_float_values, const int64_t *p_int_values, int p_index)
+{
+	return (p_nodes[p_index].type_ == SLiMFitnessExprType::kFloat) ? p_float_values[p_index] : (double)p_int_values[p_index];
+}
+
+bool SLiMFitnessExpression::Evaluate(Individual *p_individual, double p_rel_fitness, int p_homozygous, double *p_result) const
+{
+	// Each node's value goes into float_values or int_values (the latter also holding logical values as 0/1) according to
+	// its static type; since children always precede their parents, a single forward pass evaluates the whole expression
+	double float_values[SLIM_FITNESS_EXPR_MAX_NODES];
+	int64_t int_values[SLIM_FITNESS_EXPR_MAX_NODES];
+	const SLiMFitnessExprNode *nodes = nodes_.data();
+	int node_count = (int)nodes_.size();
+	
+	for (int node_index = 0; node_index < node_count; ++node_index)
+	{
+		const SLiMFitnessExprNode &node = nodes[node_index];
+		
+		switch (node.op_)
+		{
+			case SLiMFitnessExprOp::kConstant:
+				float_values[node_index] = node.constant_float_;
+				int_values[node_index] = node.constant_int_;
+				break;
+			case SLiMFitnessExprOp::kRelFitness:
+				float_values[node_index] = p_rel_fitness;
+				break;
+			case SLiMFitnessExprOp::kHomozygous:
+				if (p_homozygous == -1)
+					return false;
+				int_values[node_index] = (p_homozygous != 0);
+				break;
+			case SLiMFitnessExprOp::kIndividualTag:
+				if (p_individual->tag_value_ == SLIM_TAG_UNSET_VALUE)
+					return false;
+				int_values[node_index] = p_individual->tag_value_;
+				break;
+			case SLiMFitnessExprOp::kIndividualTagF:
+				if (p_individual->tagF_value_ == SLIM_TAGF_UNSET_VALUE)
+					return false;
+				float_values[node_index] = p_individual->tagF_value_;
+				break;
+			case SLiMFitnessExprOp::kIndividualSpatial:
+			{
+				int dimensionality = p_individual->subpopulation_.population_.sim_.SpatialDimensionality();
+				int64_t spatial_index = node.constant_int_;
+				
+				if (spatial_index == -1)
+				{
+					if (dimensionality != 1)
+						return false;
+					spatial_index = 0;
+				}
+				else if (spatial_index >= dimensionality)
+					return false;
+				
+				float_values[node_index] = ((spatial_index == 0) ? p_individual->spatial_x_ : ((spatial_index == 1) ? p_individual->spatial_y_ : p_individual->spatial_z_));
+				break;
+			}
+			case SLiMFitnessExprOp::kIndividualCoordinate:
+				float_values[node_index] = ((node.constant_int_ == 0) ? p_individual->spatial_x_ : ((node.constant_int_ == 1) ? p_individual->spatial_y_ : p_individual->spatial_z_));
+				break;
+			case SLiMFitnessExprOp::kSumOfMutationsOfType:
+			{
+				MutationType *mutation_type_ptr = node.mutation_type_ptr_;
+				
+				if (!mutation_type_ptr)
+				{
+					const std::map<slim_objectid_t,MutationType*> &mutation_types = p_individual->subpopulation_.population_.sim_.MutationTypes();
+					auto found_muttype_pair = mutation_types.find(node.mutation_type_id_);
+					
+					if (found_muttype_pair == mutation_types.end())
+						return false;
+					
+					mutation_type_ptr = found_muttype_pair->second;
+					node.mutation_type_ptr_ = mutation_type_ptr;
+				}
+				
+				float_values[node_index] = p_individual->SumOfMutationsOfType(mutation_type_ptr);
+				break;
+			}
+			case SLiMFitnessExprOp::kNegate:
+				if (node.type_ == SLiMFitnessExprType::kFloat)
+					float_values[node_index] = -float_values[node.child1_];
+				else
+				{
+					if (Eidos_sub_overflow((int64_t)0, int_values[node.child1_], &int_values[node_index]))
+						return false;
+				}
+				break;
+			case SLiMFitnessExprOp::kNot:
+				int_values[node_index] = !int_values[node.child1_];
+				break;
+			case SLiMFitnessExprOp::kAdd:
+			case SLiMFitnessExprOp::kSubtract:
+			case SLiMFitnessExprOp::kMultiply:
+				if (node.type_ == SLiMFitnessExprType::kInt)
+				{
+					int64_t left = int_values[node.child1_], right = int_values[node.child2_];
+					bool overflow;
+					
+					if (node.op_ == SLiMFitnessExprOp::kAdd)			overflow = Eidos_add_overflow(left, right, &int_values[node_index]);
+					else if (node.op_ == SLiMFitnessExprOp::kSubtract)	overflow = Eidos_sub_overflow(left, right, &int_values[node_index]);
+					else												overflow = Eidos_mul_overflow(left, right, &int_values[node_index]);
+					
+					if (overflow)
+						return false;
+				}
+				else
+				{
+					double left = SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child1_);
+					double right = SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child2_);
+					
+					if (node.op_ == SLiMFitnessExprOp::kAdd)			float_values[node_index] = left + right;
+					else if (node.op_ == SLiMFitnessExprOp::kSubtract)	float_values[node_index] = left - right;
+					else												float_values[node_index] = left * right;
+				}
+				break;
+			case SLiMFitnessExprOp::kDivide:
+				float_values[node_index] = SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child1_) / SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child2_);
+				break;
+			case SLiMFitnessExprOp::kMod:
+				float_values[node_index] = fmod(SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child1_), SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child2_));
+				break;
+			case SLiMFitnessExprOp::kPower:
+				float_values[node_index] = pow(SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child1_), SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child2_));
+				break;
+			case SLiMFitnessExprOp::kAnd:
+				int_values[node_index] = (int_values[node.child1_] && int_values[node.child2_]);
+				break;
+			case SLiMFitnessExprOp::kOr:
+				int_values[node_index] = (int_values[node.child1_] || int_values[node.child2_]);
+				break;
+			case SLiMFitnessExprOp::kEqual:
+			case SLiMFitnessExprOp::kNotEqual:
+			case SLiMFitnessExprOp::kLess:
+			case SLiMFitnessExprOp::kLessEqual:
+			case SLiMFitnessExprOp::kGreater:
+			case SLiMFitnessExprOp::kGreaterEqual:
+			{
+				// compare as Eidos does: -1, 0, or 1, with NAN comparing equal to NAN and less than any other value
+				int compare;
+				
+				if (node.operand_type_ == SLiMFitnessExprType::kFloat)
+				{
+					double left = SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child1_);
+					double right = SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child2_);
+					
+					compare = ((left < right) ? -1 : ((left > right) ? 1 : 0));
+				}
+				else
+				{
+					int64_t left = int_values[node.child1_], right = int_values[node.child2_];
+					
+					compare = ((left < right) ? -1 : ((left > right) ? 1 : 0));
+				}
+				
+				switch (node.op_)
+				{
+					case SLiMFitnessExprOp::kEqual:			int_values[node_index] = (compare == 0); break;
+					case SLiMFitnessExprOp::kNotEqual:		int_values[node_index] = (compare != 0); break;
+					case SLiMFitnessExprOp::kLess:			int_values[node_index] = (compare == -1); break;
+					case SLiMFitnessExprOp::kLessEqual:		int_values[node_index] = (compare != 1); break;
+					case SLiMFitnessExprOp::kGreater:		int_values[node_index] = (compare == 1); break;
+					default:								int_values[node_index] = (compare != -1); break;
+				}
+				break;
+			}
+			case SLiMFitnessExprOp::kConditional:
+			{
+				int chosen_index = (int_values[node.child1_] ? node.child2_ : node.child3_);
+				
+				float_values[node_index] = float_values[chosen_index];
+				int_values[node_index] = int_values[chosen_index];
+				break;
+			}
+			case SLiMFitnessExprOp::kExp:
+				float_values[node_index] = exp(SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child1_));
+				break;
+			case SLiMFitnessExprOp::kLog:
+				float_values[node_index] = log(SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child1_));
+				break;
+			case SLiMFitnessExprOp::kDnorm:
+			{
+				double mu = SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child2_);
+				double sigma = SLiM_FitnessExprFloat(nodes, float_values, int_values, node.child3_);
+				
+				if (sigma <= 0.0)
+					return false;
+				
+				float_values[node_index] = gsl_ran_gaussian_pdf(float_values[node.child1_] - mu, sigma);
+				break;
+			}
+		}
+	}
+	
+	*p_result = float_values[node_count - 1];
+	return true;
+}
+
+
 #pragma mark -
 #pragma mark SLiMEidosBlock
 #pragma mark -
@@ -697,6 +1396,12 @@ SLiMEidosBlock::SLiMEidosBlock(EidosASTNode *p_root_node) :
 				}
 				else if ((callback_type == EidosTokenType::kTokenIdentifier) && (callback_name.compare(gStr_fitness) == 0))
 				{
+					// a trailing vectorized=T/F flag is an assignment node; see SLiMEidosScript::Parse_SLiMEidosBlock()
+					const EidosASTNode *vectorized_node = nullptr;
+					
+					if ((n_callback_children >= 1) && (callback_children[n_callback_children - 1]->token_->token_type_ == EidosTokenType::kTokenAssign))
+						vectorized_node = callback_children[--n_callback_children];
+					
 					if ((n_callback_children != 1) && (n_callback_children != 2))
 						EIDOS_TERMINATION << "ERROR (SLiMEidosBlock::SLiMEidosBlock): fitness() callback needs 1 or 2 parameters." << EidosTerminate(callback_token);
 					
@@ -719,6 +1424,21 @@ SLiMEidosBlock::SLiMEidosBlock(EidosASTNode *p_root_node) :
 						
 						subpopulation_id_ = SLiMEidosScript::ExtractIDFromStringWithPrefix(subpop_id_token->token_string_, 'p', subpop_id_token);
 					}
+					
+					if (vectorized_node)
+					{
+						EidosToken *vectorized_token = vectorized_node->children_[1]->token_;
+						
+						if ((vectorized_token->token_type_ == EidosTokenType::kTokenIdentifier) && (vectorized_token->token_string_ == gEidosStr_T))
+							vectorized_ = true;
+						else if ((vectorized_token->token_type_ == EidosTokenType::kTokenIdentifier) && (vectorized_token->token_string_ == gEidosStr_F))
+							vectorized_ = false;
+						else
+							EIDOS_TERMINATION << "ERROR (SLiMEidosBlock::SLiMEidosBlock): fitness() callback needs a value for vectorized of T or F." << EidosTerminate(vectorized_token);
+						
+						if (vectorized_ && (type_ != SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback))
+							EIDOS_TERMINATION << "ERROR (SLiMEidosBlock::SLiMEidosBlock): vectorized=T is supported only for global fitness(NULL) callbacks." << EidosTerminate(vectorized_token);
+					}
 				}
 				else if ((callback_type == EidosTokenType::kTokenIdentifier) && (callback_name.compare(gStr_mutation) == 0))
 				{
@@ -873,6 +1593,9 @@ SLiMEidosBlock::SLiMEidosBlock(slim_objectid_t p_id, const std::string &p_script
 SLiMEidosBlock::~SLiMEidosBlock(void)
 {
 	delete script_;
+	
+	delete cached_fitness_expr_;
+	cached_fitness_expr_ = nullptr;
 }
 
 void SLiMEidosBlock::TokenizeAndParse(void)
@@ -1382,7 +2105,7 @@ EidosTypeSpecifier SLiMTypeInterpreter::_TypeEvaluate_MethodCall_Internal(const
 			
 			const std::string &function_name = p_method_signature->call_name_;
 			
-			if (((function_name == "addSubpop") || (function_name == "addSubpopSplit")) && (argument_count >= 1))
+			if (((function_name == "addSubpop") || (function_name == "addSubpopSplit") || (function_name == "addSubpopFromCoalescent")) && (argument_count >= 1))
 			{
 				_SetTypeForISArgumentOfClass(p_arguments[0], 'p', gSLiM_Subpopulation_Class);
 			}
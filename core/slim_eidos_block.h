@@ -77,6 +77,9 @@ public:
 	EidosASTNode *Parse_SLiMFile(void);
 	EidosASTNode *Parse_SLiMEidosBlock(void);
 	
+	// Returns true if the current token is a comma followed by "<p_name> =", for named parameters in callback declarations
+	bool CommaAndNamedParameterFollow(const std::string &p_name);
+	
 	// A utility method for extracting the numeric component of an identifier like 'p2', 's3', 'm17', or 'g5'
 	// This raises if the expected character prefix is not present, or if anything but numeric digits are present, or if the ID is out of range
 	// The token-based API uses the token for error tracking if an exception is raised; the string-based API just calls EidosTerminate(), and
@@ -96,6 +99,101 @@ public:
 };
 
 
+#pragma mark -
+#pragma mark SLiMFitnessExpression
+#pragma mark -
+
+// SLiMFitnessExpression is a compiled form of a fitness() callback whose body is a single "return <expr>;" statement, where
+// <expr> uses only arithmetic, comparison, and logical operators, ifelse() and the ternary conditional, exp()/log()/dnorm(),
+// numeric and logical constants, the relFitness and homozygous parameters, and the individual properties tag, tagF, x, y, z,
+// and spatialPosition and method sumOfMutationsOfType().  This covers the common quantitative-trait callbacks such as Gaussian
+// stabilizing selection on tagF.  The expression is flattened into postorder, so evaluation is one pass over a small array
+// with no recursion and no EidosValue allocation.  Anything the compiler is not sure of is left to the interpreter.
+
+class Individual;
+class MutationType;
+
+#define SLIM_FITNESS_EXPR_MAX_NODES		64
+
+enum class SLiMFitnessExprType : uint8_t {
+	kLogical = 0,
+	kInt,
+	kFloat
+};
+
+enum class SLiMFitnessExprOp : uint8_t {
+	kConstant = 0,				// constant_float_ / constant_int_, depending on type_
+	kRelFitness,				// relFitness; 1.0 for global callbacks
+	kHomozygous,				// homozygous; NULL (opposed by a null genome) fails
+	kIndividualTag,				// individual.tag
+	kIndividualTagF,			// individual.tagF
+	kIndividualSpatial,			// individual.spatialPosition[constant_int_], or individual.spatialPosition in 1D if constant_int_ == -1
+	kIndividualCoordinate,		// individual.x, individual.y, or individual.z, for constant_int_ 0, 1, or 2
+	kSumOfMutationsOfType,		// individual.sumOfMutationsOfType(m<mutation_type_id_>)
+	kNegate,
+	kNot,
+	kAdd,
+	kSubtract,
+	kMultiply,
+	kDivide,
+	kMod,
+	kPower,
+	kAnd,
+	kOr,
+	kEqual,
+	kNotEqual,
+	kLess,
+	kLessEqual,
+	kGreater,
+	kGreaterEqual,
+	kConditional,				// ifelse(child1_, child2_, child3_) or child1_ ? child2_ else child3_
+	kExp,
+	kLog,
+	kDnorm						// dnorm(child1_, child2_, child3_)
+};
+
+struct SLiMFitnessExprNode
+{
+	SLiMFitnessExprOp op_;
+	SLiMFitnessExprType type_;					// the static result type of this node
+	SLiMFitnessExprType operand_type_;			// the promoted type in which a binary operator works
+	int16_t child1_, child2_, child3_;			// indices of earlier nodes; -1 if unused
+	double constant_float_;
+	int64_t constant_int_;
+	slim_objectid_t mutation_type_id_;
+	mutable MutationType *mutation_type_ptr_;	// resolved lazily, since mutation types may be defined after the callback
+};
+
+class SLiMFitnessExpression
+{
+	//	This class has its copy constructor and assignment operator disabled, to prevent accidental copying.
+private:
+	
+	std::vector<SLiMFitnessExprNode> nodes_;		// postorder; the root is the last node
+	bool global_callback_;							// true for fitness(NULL) callbacks, which have no homozygous value
+	
+	int _AddNode(SLiMFitnessExprOp p_op, SLiMFitnessExprType p_type, int p_child1 = -1, int p_child2 = -1, int p_child3 = -1);
+	int _CompileNode(const EidosASTNode *p_node);
+	int _CompileCall(const EidosASTNode *p_node);
+	int _CompileIndividualAccess(const EidosASTNode *p_node);
+	
+public:
+	
+	SLiMFitnessExpression(const SLiMFitnessExpression&) = delete;					// no copying
+	SLiMFitnessExpression& operator=(const SLiMFitnessExpression&) = delete;		// no copying
+	SLiMFitnessExpression(void) = delete;											// no null construction
+	explicit SLiMFitnessExpression(bool p_global_callback) : global_callback_(p_global_callback) {};
+	
+	// Returns a new expression for a fitness() callback body, or nullptr if the body is not of a form we can compile
+	static SLiMFitnessExpression *CompileCallback(const EidosASTNode *p_compound_statement_node, bool p_global_callback);
+	
+	// Evaluates the expression for one individual; returns false, without raising, if the interpreter would produce
+	// something other than a float result here (an error, an unset tag, integer overflow, etc.), in which case the
+	// caller should run the callback through the interpreter to get the true result or error.
+	bool Evaluate(Individual *p_individual, double p_rel_fitness, int p_homozygous, double *p_result) const;
+};
+
+
 #pragma mark -
 #pragma mark SLiMEidosBlock
 #pragma mark -
@@ -124,6 +222,7 @@ public:
 	slim_objectid_t subpopulation_id_ = -1;						// -1 if not limited by this
 	slim_objectid_t interaction_type_id_ = -1;					// -1 if not limited by this
 	IndividualSex sex_specificity_ = IndividualSex::kUnspecified;	// IndividualSex::kUnspecified if not limited by this
+	bool vectorized_ = false;									// fitness(NULL) callbacks only: called once per subpopulation for all individuals
 	
 	EidosScript *script_ = nullptr;								// OWNED: nullptr indicates that we are derived from the input file script
 	const EidosASTNode *root_node_ = nullptr;					// NOT OWNED: the root node for the whole block, including its generation range and type nodes
@@ -168,14 +267,9 @@ public:
 	bool contains_originalNuc_ = false;			// "originalNuc" (mutation callback parameter)
 	
 	// Special-case optimizations for particular common callback types.  If a callback can be substituted by C++ code,
-	// has_cached_optimization_ will be true and the flags and values below will indicate exactly how to do so.
+	// has_cached_optimization_ will be true and the ivars below will indicate exactly how to do so.
 	bool has_cached_optimization_ = false;
-	bool has_cached_opt_dnorm1_ = false;
-	bool has_cached_opt_reciprocal = false;
-	double cached_opt_A_ = 0.0;
-	double cached_opt_B_ = 0.0;
-	double cached_opt_C_ = 0.0;
-	double cached_opt_D_ = 0.0;
+	SLiMFitnessExpression *cached_fitness_expr_ = nullptr;		// OWNED; a compiled fitness() callback body, see SLiMSim::OptimizeScriptBlock()
 	
 	
 	SLiMEidosBlock(const SLiMEidosBlock&) = delete;					// no copying
@@ -33,6 +33,7 @@ EidosValue_String_SP gStaticEidosValue_StringA;
 EidosValue_String_SP gStaticEidosValue_StringC;
 EidosValue_String_SP gStaticEidosValue_StringG;
 EidosValue_String_SP gStaticEidosValue_StringT;
+EidosValue_String_SP gStaticEidosValue_StringKDTree;
 
 
 void TestSparseArray(void);
@@ -308,6 +309,7 @@ void SLiM_WarmUp(void)
 		gStaticEidosValue_StringC = EidosValue_String_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton(gStr_C));
 		gStaticEidosValue_StringG = EidosValue_String_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton(gStr_G));
 		gStaticEidosValue_StringT = EidosValue_String_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton(gStr_T));
+		gStaticEidosValue_StringKDTree = EidosValue_String_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_singleton("kdtree"));
 		
 #if DO_MEMORY_CHECKS
 		// Check for a memory limit and prepare for memory-limit testing
@@ -1077,6 +1079,7 @@ const std::string gStr_pedigreeGrandparentIDs = "pedigreeGrandparentIDs";
 const std::string gStr_genomePedigreeID = "genomePedigreeID";
 const std::string gStr_reciprocal = "reciprocal";
 const std::string gStr_sexSegregation = "sexSegregation";
+const std::string gStr_spatialIndex = "spatialIndex";
 const std::string gStr_dimensionality = "dimensionality";
 const std::string gStr_periodicity = "periodicity";
 const std::string gStr_spatiality = "spatiality";
@@ -1116,6 +1119,7 @@ const std::string gStr_drawSelectionCoefficient = "drawSelectionCoefficient";
 const std::string gStr_setDistribution = "setDistribution";
 const std::string gStr_addSubpop = "addSubpop";
 const std::string gStr_addSubpopSplit = "addSubpopSplit";
+const std::string gStr_addSubpopFromCoalescent = "addSubpopFromCoalescent";
 const std::string gStr_deregisterScriptBlock = "deregisterScriptBlock";
 const std::string gStr_mutationFrequencies = "mutationFrequencies";
 const std::string gStr_mutationCounts = "mutationCounts";
@@ -1139,6 +1143,7 @@ const std::string gStr_registerReproductionCallback = "registerReproductionCallb
 const std::string gStr_rescheduleScriptBlock = "rescheduleScriptBlock";
 const std::string gStr_simulationFinished = "simulationFinished";
 const std::string gStr_treeSeqCoalesced = "treeSeqCoalesced";
+const std::string gStr_treeSeqCrosscheckCounts = "treeSeqCrosscheckCounts";
 const std::string gStr_treeSeqSimplify = "treeSeqSimplify";
 const std::string gStr_treeSeqRememberIndividuals = "treeSeqRememberIndividuals";
 const std::string gStr_treeSeqOutput = "treeSeqOutput";
@@ -1265,6 +1270,7 @@ const std::string gStr_modifyChild = "modifyChild";
 const std::string gStr_recombination = "recombination";
 const std::string gStr_mutation = "mutation";
 const std::string gStr_reproduction = "reproduction";
+const std::string gStr_vectorized = "vectorized";
 
 
 void SLiM_ConfigureContext(void)
@@ -1420,6 +1426,7 @@ void SLiM_RegisterGlobalStringsAndIDs(void)
 		Eidos_RegisterStringForGlobalID(gStr_genomePedigreeID, gID_genomePedigreeID);
 		Eidos_RegisterStringForGlobalID(gStr_reciprocal, gID_reciprocal);
 		Eidos_RegisterStringForGlobalID(gStr_sexSegregation, gID_sexSegregation);
+		Eidos_RegisterStringForGlobalID(gStr_spatialIndex, gID_spatialIndex);
 		Eidos_RegisterStringForGlobalID(gStr_dimensionality, gID_dimensionality);
 		Eidos_RegisterStringForGlobalID(gStr_periodicity, gID_periodicity);
 		Eidos_RegisterStringForGlobalID(gStr_spatiality, gID_spatiality);
@@ -1458,6 +1465,7 @@ void SLiM_RegisterGlobalStringsAndIDs(void)
 		Eidos_RegisterStringForGlobalID(gStr_setDistribution, gID_setDistribution);
 		Eidos_RegisterStringForGlobalID(gStr_addSubpop, gID_addSubpop);
 		Eidos_RegisterStringForGlobalID(gStr_addSubpopSplit, gID_addSubpopSplit);
+		Eidos_RegisterStringForGlobalID(gStr_addSubpopFromCoalescent, gID_addSubpopFromCoalescent);
 		Eidos_RegisterStringForGlobalID(gStr_deregisterScriptBlock, gID_deregisterScriptBlock);
 		Eidos_RegisterStringForGlobalID(gStr_mutationFrequencies, gID_mutationFrequencies);
 		Eidos_RegisterStringForGlobalID(gStr_mutationCounts, gID_mutationCounts);
@@ -1479,6 +1487,7 @@ void SLiM_RegisterGlobalStringsAndIDs(void)
 		Eidos_RegisterStringForGlobalID(gStr_rescheduleScriptBlock, gID_rescheduleScriptBlock);
 		Eidos_RegisterStringForGlobalID(gStr_simulationFinished, gID_simulationFinished);
 		Eidos_RegisterStringForGlobalID(gStr_treeSeqCoalesced, gID_treeSeqCoalesced);
+		Eidos_RegisterStringForGlobalID(gStr_treeSeqCrosscheckCounts, gID_treeSeqCrosscheckCounts);
 		Eidos_RegisterStringForGlobalID(gStr_treeSeqSimplify, gID_treeSeqSimplify);
 		Eidos_RegisterStringForGlobalID(gStr_treeSeqRememberIndividuals, gID_treeSeqRememberIndividuals);
 		Eidos_RegisterStringForGlobalID(gStr_treeSeqOutput, gID_treeSeqOutput);
@@ -1595,6 +1604,7 @@ void SLiM_RegisterGlobalStringsAndIDs(void)
 		Eidos_RegisterStringForGlobalID(gStr_recombination, gID_recombination);
 		Eidos_RegisterStringForGlobalID(gStr_mutation, gID_mutation);
 		Eidos_RegisterStringForGlobalID(gStr_reproduction, gID_reproduction);
+		Eidos_RegisterStringForGlobalID(gStr_vectorized, gID_vectorized);
 	}
 }
 
@@ -340,6 +340,7 @@ extern EidosValue_String_SP gStaticEidosValue_StringA;
 extern EidosValue_String_SP gStaticEidosValue_StringC;
 extern EidosValue_String_SP gStaticEidosValue_StringG;
 extern EidosValue_String_SP gStaticEidosValue_StringT;
+extern EidosValue_String_SP gStaticEidosValue_StringKDTree;
 
 
 // *******************************************************************************************************************
@@ -354,6 +355,8 @@ extern EidosValue_String_SP gStaticEidosValue_StringT;
 #define SLIM_TSK_INDIVIDUAL_REMEMBERED  ((uint32_t)(1 << 17))
 #define SLIM_TSK_INDIVIDUAL_FIRST_GEN   ((uint32_t)(1 << 18))
 
+#define SLIM_TSK_NODE_COALESCENT        ((uint32_t)(1 << 16))	// ancestral nodes generated by addSubpopFromCoalescent(); never written out
+
 
 // *******************************************************************************************************************
 //
@@ -562,6 +565,7 @@ extern const std::string gStr_pedigreeGrandparentIDs;
 extern const std::string gStr_genomePedigreeID;
 extern const std::string gStr_reciprocal;
 extern const std::string gStr_sexSegregation;
+extern const std::string gStr_spatialIndex;
 extern const std::string gStr_dimensionality;
 extern const std::string gStr_periodicity;
 extern const std::string gStr_spatiality;
@@ -600,6 +604,7 @@ extern const std::string gStr_drawSelectionCoefficient;
 extern const std::string gStr_setDistribution;
 extern const std::string gStr_addSubpop;
 extern const std::string gStr_addSubpopSplit;
+extern const std::string gStr_addSubpopFromCoalescent;
 extern const std::string gStr_deregisterScriptBlock;
 extern const std::string gStr_mutationFrequencies;
 extern const std::string gStr_mutationCounts;
@@ -623,6 +628,7 @@ extern const std::string gStr_registerReproductionCallback;
 extern const std::string gStr_rescheduleScriptBlock;
 extern const std::string gStr_simulationFinished;
 extern const std::string gStr_treeSeqCoalesced;
+extern const std::string gStr_treeSeqCrosscheckCounts;
 extern const std::string gStr_treeSeqSimplify;
 extern const std::string gStr_treeSeqRememberIndividuals;
 extern const std::string gStr_treeSeqOutput;
@@ -745,6 +751,7 @@ extern const std::string gStr_modifyChild;
 extern const std::string gStr_mutation;
 extern const std::string gStr_recombination;
 extern const std::string gStr_reproduction;
+extern const std::string gStr_vectorized;
 
 
 enum _SLiMGlobalStringID : int {
@@ -865,6 +872,7 @@ enum _SLiMGlobalStringID : int {
 	gID_genomePedigreeID,
 	gID_reciprocal,
 	gID_sexSegregation,
+	gID_spatialIndex,
 	gID_dimensionality,
 	gID_periodicity,
 	gID_spatiality,
@@ -903,6 +911,7 @@ enum _SLiMGlobalStringID : int {
 	gID_setDistribution,
 	gID_addSubpop,
 	gID_addSubpopSplit,
+	gID_addSubpopFromCoalescent,
 	gID_deregisterScriptBlock,
 	gID_mutationFrequencies,
 	gID_mutationCounts,
@@ -926,6 +935,7 @@ enum _SLiMGlobalStringID : int {
 	gID_rescheduleScriptBlock,
 	gID_simulationFinished,
 	gID_treeSeqCoalesced,
+	gID_treeSeqCrosscheckCounts,
 	gID_treeSeqSimplify,
 	gID_treeSeqRememberIndividuals,
 	gID_treeSeqOutput,
@@ -1044,6 +1054,7 @@ enum _SLiMGlobalStringID : int {
 	gID_recombination,
 	gID_mutation,
 	gID_reproduction,
+	gID_vectorized,
 	
 	gID_LastSLiMEntry	// must come last
 };
@@ -47,6 +47,8 @@
 
 //TREE SEQUENCE
 #include <stdio.h>
+#include <string.h>
+#include <errno.h>
 #include <stdlib.h>
 #include "json.hpp"
 #include <sys/utsname.h>
@@ -152,6 +154,9 @@ SLiMSim::~SLiMSim(void)
 	// TREE SEQUENCE RECORDING
 	if (RecordingTreeSequence())
 		FreeTreeSequence();
+	
+	Eidos_FreeRNG(crosscheck_rng_);
+	Eidos_FreeRNG(overlay_rng_);
 }
 
 void SLiMSim::InitializeRNGFromSeed(unsigned long int *p_override_seed_ptr)
@@ -1738,232 +1743,25 @@ std::vector<SLiMEidosBlock*> &SLiMSim::AllScriptBlocks()
 void SLiMSim::OptimizeScriptBlock(SLiMEidosBlock *p_script_block)
 {
 	// The goal here is to look for specific structures in callbacks that we are able to optimize by short-circuiting
-	// the callback interpretation entirely and replacing it with equivalent C++ code.  This is extremely messy, so
-	// we're not going to do this for very many cases, but sometimes it is worth it.
+	// the callback interpretation entirely and replacing it with equivalent C++ code.  For fitness() callbacks, this
+	// is done by SLiMFitnessExpression, which compiles callbacks of the form { return <expr>; } for a fairly broad
+	// class of expressions; see slim_eidos_block.h.  Anything it declines is simply interpreted as usual.
 	if (!p_script_block->has_cached_optimization_)
 	{
-		if (p_script_block->type_ == SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback)
+		if ((p_script_block->type_ == SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback) || (p_script_block->type_ == SLiMEidosBlockType::SLiMEidosFitnessCallback))
 		{
+			// a constant body such as { return 1.1; } is handled by cached_return_value_ already, so we leave those alone; vectorized
+			// callbacks see a vector of individuals, which SLiMFitnessExpression does not model, so we leave them alone too
 			const EidosASTNode *base_node = p_script_block->compound_statement_node_;
 			
-			if ((base_node->token_->token_type_ == EidosTokenType::kTokenLBrace) && (base_node->children_.size() == 1))
+			if (!base_node->cached_return_value_ && !p_script_block->vectorized_)
 			{
-				bool opt_dnorm1_candidate = true;
-				const EidosASTNode *expr_node = base_node->children_[0];
+				bool global_callback = (p_script_block->type_ == SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback);
 				
-				// we must have an intervening "return", which we jump down through
-				if ((expr_node->token_->token_type_ == EidosTokenType::kTokenReturn) && (expr_node->children_.size() == 1))
-				{
-					expr_node = expr_node->children_[0];
-					
-					// parse an optional constant at the beginning, like 1.0 + ...
-					double added_constant = NAN;
-					
-					if ((expr_node->token_->token_type_ == EidosTokenType::kTokenPlus) && (expr_node->children_.size() == 2))
-					{
-						const EidosASTNode *constant_node = expr_node->children_[0];
-						const EidosASTNode *rhs_node = expr_node->children_[1];
-						
-						if (constant_node->HasCachedNumericValue())
-						{
-							added_constant = constant_node->CachedNumericValue();
-							expr_node = rhs_node;
-						}
-						else
-							opt_dnorm1_candidate = false;
-					}
-					else
-					{
-						added_constant = 0.0;
-					}
-					
-					// parse an optional divisor at the end, ... / div
-					double denominator = NAN;
-					
-					if ((expr_node->token_->token_type_ == EidosTokenType::kTokenDiv) && (expr_node->children_.size() == 2))
-					{
-						const EidosASTNode *numerator_node = expr_node->children_[0];
-						const EidosASTNode *denominator_node = expr_node->children_[1];
-						
-						if (denominator_node->HasCachedNumericValue())
-						{
-							denominator = denominator_node->CachedNumericValue();
-							expr_node = numerator_node;
-						}
-						else
-							opt_dnorm1_candidate = false;
-					}
-					else
-					{
-						denominator = 1.0;
-					}
-					
-					// parse the dnorm() function call
-					if (opt_dnorm1_candidate && (expr_node->token_->token_type_ == EidosTokenType::kTokenLParen) && (expr_node->children_.size() >= 2))
-					{
-						const EidosASTNode *call_node = expr_node->children_[0];
-						
-						if ((call_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && (call_node->token_->token_string_ == "dnorm"))
-						{
-							int child_count = (int)expr_node->children_.size();
-							const EidosASTNode *x_node = expr_node->children_[1];
-							const EidosASTNode *mean_node = (child_count >= 3) ? expr_node->children_[2] : nullptr;
-							const EidosASTNode *sd_node = (child_count >= 4) ? expr_node->children_[3] : nullptr;
-							double mean_value = 0.0, sd_value = 1.0;
-							
-							// resolve named arguments
-							if ((x_node->token_->token_type_ == EidosTokenType::kTokenAssign) && (x_node->children_.size() == 2))
-							{
-								const EidosASTNode *name_node = x_node->children_[0];
-								const EidosASTNode *value_node = x_node->children_[1];
-								
-								if ((name_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && (name_node->token_->token_string_ == "x"))
-									x_node = value_node;
-								else
-									opt_dnorm1_candidate = false;
-							}
-							if (mean_node && (mean_node->token_->token_type_ == EidosTokenType::kTokenAssign) && (mean_node->children_.size() == 2))
-							{
-								const EidosASTNode *name_node = mean_node->children_[0];
-								const EidosASTNode *value_node = mean_node->children_[1];
-								
-								if ((name_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && (name_node->token_->token_string_ == "mean"))
-									mean_node = value_node;
-								else
-									opt_dnorm1_candidate = false;
-							}
-							if (sd_node && (sd_node->token_->token_type_ == EidosTokenType::kTokenAssign) && (sd_node->children_.size() == 2))
-							{
-								const EidosASTNode *name_node = sd_node->children_[0];
-								const EidosASTNode *value_node = sd_node->children_[1];
-								
-								if ((name_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && (name_node->token_->token_string_ == "sd"))
-									sd_node = value_node;
-								else
-									opt_dnorm1_candidate = false;
-							}
-							
-							// the mean and sd parameters of dnorm can be omitted in the below calls, but if they are given, get their values
-							if (mean_node)
-							{
-								if (mean_node->HasCachedNumericValue())
-									mean_value = mean_node->CachedNumericValue();
-								else
-									opt_dnorm1_candidate = false;
-							}
-							
-							if (sd_node)
-							{
-								if (sd_node->HasCachedNumericValue())
-									sd_value = sd_node->CachedNumericValue();
-								else
-									opt_dnorm1_candidate = false;
-							}
-							
-							// parse the x argument to dnorm, which can take several different forms
-							if (opt_dnorm1_candidate)
-							{
-								if ((x_node->token_->token_type_ == EidosTokenType::kTokenMinus) && (x_node->children_.size() == 2) && (mean_value == 0.0))
-								{
-									const EidosASTNode *lhs_node = x_node->children_[0];
-									const EidosASTNode *rhs_node = x_node->children_[1];
-									const EidosASTNode *dot_node = nullptr, *constant_node = nullptr;
-									
-									if (lhs_node->token_->token_type_ == EidosTokenType::kTokenDot)
-									{
-										dot_node = lhs_node;
-										constant_node = rhs_node;
-									}
-									else if (rhs_node->token_->token_type_ == EidosTokenType::kTokenDot)
-									{
-										dot_node = rhs_node;
-										constant_node = lhs_node;
-									}
-									
-									if (dot_node && constant_node && (dot_node->children_.size() == 2) && constant_node->HasCachedNumericValue())
-									{
-										const EidosASTNode *var_node = dot_node->children_[0];
-										const EidosASTNode *prop_node = dot_node->children_[1];
-										
-										mean_value = constant_node->CachedNumericValue();
-										
-										if ((var_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && (var_node->token_->token_string_ == "individual")
-											&& (prop_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && (prop_node->token_->token_string_ == "tagF"))
-										{
-											// callback of the form { return D + dnorm(individual.tagF - A, 0.0, B) / C; }
-											// callback of the form { return D + dnorm(individual.tagF - A, 0.0, B); }
-											// callback of the form { return D + dnorm(A - individual.tagF, 0.0, B) / C; }
-											// callback of the form { return D + dnorm(A - individual.tagF, 0.0, B); }
-											p_script_block->has_cached_optimization_ = true;
-											p_script_block->has_cached_opt_dnorm1_ = true;
-											p_script_block->cached_opt_A_ = mean_value;
-											p_script_block->cached_opt_B_ = sd_value;
-											p_script_block->cached_opt_C_ = denominator;
-											p_script_block->cached_opt_D_ = added_constant;
-										}
-									}
-								}
-								else if ((x_node->token_->token_type_ == EidosTokenType::kTokenDot) && (x_node->children_.size() == 2))
-								{
-									const EidosASTNode *var_node = x_node->children_[0];
-									const EidosASTNode *prop_node = x_node->children_[1];
-									
-									if ((var_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && (var_node->token_->token_string_ == "individual")
-										&& (prop_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && (prop_node->token_->token_string_ == "tagF"))
-									{
-										// callback of the form { return D + dnorm(individual.tagF, A, B) / C; }
-										// callback of the form { return D + dnorm(individual.tagF, A, B); }
-										p_script_block->has_cached_optimization_ = true;
-										p_script_block->has_cached_opt_dnorm1_ = true;
-										p_script_block->cached_opt_A_ = mean_value;
-										p_script_block->cached_opt_B_ = sd_value;
-										p_script_block->cached_opt_C_ = denominator;
-										p_script_block->cached_opt_D_ = added_constant;
-									}
-								}
-							}
-						}
-					}
-				}
-			}
-			
-//			if (p_script_block->has_cached_optimization_)
-//				std::cout << "optimized:" << std::endl << "   " << base_node->token_->token_string_ << std::endl;
-//			else
-//				std::cout << "NOT OPTIMIZED:" << std::endl << "   " << base_node->token_->token_string_ << std::endl;
-		}
-		else if (p_script_block->type_ == SLiMEidosBlockType::SLiMEidosFitnessCallback)
-		{
-			const EidosASTNode *base_node = p_script_block->compound_statement_node_;
-			
-			if ((base_node->token_->token_type_ == EidosTokenType::kTokenLBrace) && (base_node->children_.size() == 1))
-			{
-				const EidosASTNode *expr_node = base_node->children_[0];
+				p_script_block->cached_fitness_expr_ = SLiMFitnessExpression::CompileCallback(base_node, global_callback);
 				
-				// we must have an intervening "return", which we jump down through
-				if ((expr_node->token_->token_type_ == EidosTokenType::kTokenReturn) && (expr_node->children_.size() == 1))
-				{
-					expr_node = expr_node->children_[0];
-					
-					if ((expr_node->token_->token_type_ == EidosTokenType::kTokenDiv) && (expr_node->children_.size() == 2))
-					{
-						const EidosASTNode *numerator_node = expr_node->children_[0];
-						const EidosASTNode *denominator_node = expr_node->children_[1];
-						
-						if (numerator_node->HasCachedNumericValue())
-						{
-							double numerator = numerator_node->CachedNumericValue();
-							
-							if ((denominator_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && (denominator_node->token_->token_string_ == "relFitness"))
-							{
-								// callback of the form { return A/relFitness; }
-								p_script_block->has_cached_optimization_ = true;
-								p_script_block->has_cached_opt_reciprocal = true;
-								p_script_block->cached_opt_A_ = numerator;
-							}
-						}
-					}
-				}
+				if (p_script_block->cached_fitness_expr_)
+					p_script_block->has_cached_optimization_ = true;
 			}
 			
 //			if (p_script_block->has_cached_optimization_)
@@ -2199,14 +1997,14 @@ void SLiMSim::RunInitializeCallbacks(void)
 	{
 		if (script_block->active_)
 		{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_START();
 #endif
 			
 			population_.ExecuteScript(script_block, generation_, chromosome_);
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_END(profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosInitializeCallback)]);
 #endif
@@ -2305,6 +2103,9 @@ void SLiMSim::RunInitializeCallbacks(void)
 		CreateNucleotideMutationRateMap();
 	}
 	
+	// Mark overlaid mutation types, now that they are all defined; this must precede chromosome_.InitializeDraws() below
+	ResolveOverlayMutationTypes();
+	
 	// Defining a neutral mutation type when tree-recording is on (with mutation recording) and the mutation rate is non-zero is legal, but causes a warning
 	// I'm not sure this is a good idea, but maybe it will help people avoid doing dumb things; added at the suggestion of Peter Ralph...
 	if (recording_tree_ && recording_mutations_)
@@ -2326,7 +2127,7 @@ void SLiMSim::RunInitializeCallbacks(void)
 			{
 				MutationType *muttype = muttype_iter.second;
 				
-				if ((muttype->dfe_type_ == DFEType::kFixed) && (muttype->dfe_parameters_.size() == 1) && (muttype->dfe_parameters_[0] == 0.0))
+				if (!muttype->overlay_ && (muttype->dfe_type_ == DFEType::kFixed) && (muttype->dfe_parameters_.size() == 1) && (muttype->dfe_parameters_[0] == 0.0))
 					if (!gEidosSuppressWarnings)
 						SLIM_OUTSTREAM << "#WARNING (SLiMSim::RunInitializeCallbacks): with tree-sequence recording enabled and a non-zero mutation rate, a neutral mutation type was defined; this is legal, but usually undesirable, since neutral mutations can be overlaid later using the tree-sequence information." << std::endl;
 			}
@@ -2837,7 +2638,7 @@ void SLiMSim::MaintainMutationRunExperiments(double p_last_gen_runtime)
 	}
 }
 
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 // PROFILING
 #if SLIM_USE_NONNEUTRAL_CACHES
 void SLiMSim::CollectSLiMguiMutationProfileInfo(void)
@@ -2963,14 +2764,14 @@ bool SLiMSim::_RunOneGeneration(void)
 	{
 		// The zero generation is handled here by shared code, since it is the same for WF and nonWF models
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
 		
 		RunInitializeCallbacks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[0]);
 #endif
@@ -2979,7 +2780,7 @@ bool SLiMSim::_RunOneGeneration(void)
 		gEidosCurrentScript = nullptr;
 		gEidosExecutingRuntimeScript = false;
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		if (gEidosProfilingClientCount)
 			CollectSLiMguiMemoryUsageProfileInfo();
@@ -3021,7 +2822,7 @@ bool SLiMSim::_RunOneGeneration(void)
 //
 bool SLiMSim::_RunOneGenerationWF(void)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 #if SLIM_USE_NONNEUTRAL_CACHES
 	if (gEidosProfilingClientCount)
@@ -3038,7 +2839,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 1: Execute early() script events for the current generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3056,14 +2857,14 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		{
 			if (script_block->active_)
 			{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_START_NESTED();
 #endif
 				
 				population_.ExecuteScript(script_block, generation_, chromosome_);
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END_NESTED(profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosEventEarly)]);
 #endif
@@ -3075,7 +2876,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		// the stage is done, so deregister script blocks as requested
 		DeregisterScheduledScriptBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[1]);
 #endif
@@ -3093,7 +2894,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 2: Generate offspring: evolve all subpopulations
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3230,7 +3031,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		// the stage is done, so deregister script blocks as requested
 		DeregisterScheduledScriptBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[2]);
 #endif
@@ -3248,7 +3049,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 3: Remove fixed mutations and associated tasks
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3274,7 +3075,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		// Deregister any interaction() callbacks that have been scheduled for deregistration, since it is now safe to do so
 		DeregisterScheduledInteractionBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[3]);
 #endif
@@ -3292,7 +3093,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 4: Swap generations
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3301,7 +3102,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		
 		population_.SwapGenerations();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[4]);
 #endif
@@ -3319,7 +3120,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 5: Execute late() script events for the current generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3337,14 +3138,14 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		{
 			if (script_block->active_)
 			{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_START_NESTED();
 #endif
 				
 				population_.ExecuteScript(script_block, generation_, chromosome_);
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END_NESTED(profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosEventLate)]);
 #endif
@@ -3356,7 +3157,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		// the stage is done, so deregister script blocks as requested
 		DeregisterScheduledScriptBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[5]);
 #endif
@@ -3374,7 +3175,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 	// Stage 6: Calculate fitness values for the new parental generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3390,7 +3191,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		if (x_experiments_enabled_)
 			MaintainMutationRunExperiments((clock() - x_clock0) / (double)CLOCKS_PER_SEC);
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[6]);
 #endif
@@ -3424,9 +3225,16 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		{
 			CheckAutoSimplification();
 			
+			// checkpointing simplifies too, but it also resets the auto-simplification schedule, so it does not confuse it
+			if (!checkpoint_path_.empty() && (generation_ % checkpoint_interval_ == 0))
+				WriteTreeSequenceCheckpoint();
+			
 			// note that this causes simplification, so it will confuse the auto-simplification code
 			if (running_treeseq_crosschecks_ && (generation_ % treeseq_crosschecks_interval_ == 0))
 				CrosscheckTreeSeqIntegrity();
+			
+			if (crosscheck_sample_size_ > 0)
+				SampledCrosscheckTreeSeqIntegrity();
 		}
 		
 		cached_value_generation_.reset();
@@ -3437,7 +3245,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 		gEidosCurrentScript = nullptr;
 		gEidosExecutingRuntimeScript = false;
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		if (gEidosProfilingClientCount)
 			CollectSLiMguiMemoryUsageProfileInfo();
@@ -3466,7 +3274,7 @@ bool SLiMSim::_RunOneGenerationWF(void)
 //
 bool SLiMSim::_RunOneGenerationNonWF(void)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 #if SLIM_USE_NONNEUTRAL_CACHES
 	if (gEidosProfilingClientCount)
@@ -3506,7 +3314,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		}
 #endif
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3602,7 +3410,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		// the stage is done, so deregister script blocks as requested
 		DeregisterScheduledScriptBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[1]);
 #endif
@@ -3620,7 +3428,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 	// Stage 2: Execute early() script events for the current generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3638,14 +3446,14 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		{
 			if (script_block->active_)
 			{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_START_NESTED();
 #endif
 				
 				population_.ExecuteScript(script_block, generation_, chromosome_);
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END_NESTED(profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosEventEarly)]);
 #endif
@@ -3657,7 +3465,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		// the stage is done, so deregister script blocks as requested
 		DeregisterScheduledScriptBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[2]);
 #endif
@@ -3675,7 +3483,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 	// Stage 3: Calculate fitness values for the new generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3694,7 +3502,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		// Deregister any interaction() callbacks that have been scheduled for deregistration, since it is now safe to do so
 		DeregisterScheduledInteractionBlocks();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[3]);
 #endif
@@ -3706,7 +3514,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 	// Stage 4: Viability/survival selection
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3716,7 +3524,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		for (std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : population_.subpops_)
 			subpop_pair.second->ViabilitySelection();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[4]);
 #endif
@@ -3734,7 +3542,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 	// Stage 5: Remove fixed mutations and associated tasks
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3753,7 +3561,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		if (generation_ % 100 == 0)
 			population_.UniqueMutationRuns();
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[5]);
 #endif
@@ -3771,7 +3579,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 	// Stage 6: Execute late() script events for the current generation
 	//
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3789,14 +3597,14 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		{
 			if (script_block->active_)
 			{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_START_NESTED();
 #endif
 				
 				population_.ExecuteScript(script_block, generation_, chromosome_);
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END_NESTED(profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosEventLate)]);
 #endif
@@ -3812,7 +3620,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		if (x_experiments_enabled_)
 			MaintainMutationRunExperiments((clock() - x_clock0) / (double)CLOCKS_PER_SEC);
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(profile_stage_totals_[6]);
 #endif
@@ -3852,9 +3660,16 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		{
 			CheckAutoSimplification();
 			
+			// checkpointing simplifies too, but it also resets the auto-simplification schedule, so it does not confuse it
+			if (!checkpoint_path_.empty() && (generation_ % checkpoint_interval_ == 0))
+				WriteTreeSequenceCheckpoint();
+			
 			// note that this causes simplification, so it will confuse the auto-simplification code
 			if (running_treeseq_crosschecks_ && (generation_ % treeseq_crosschecks_interval_ == 0))
 				CrosscheckTreeSeqIntegrity();
+			
+			if (crosscheck_sample_size_ > 0)
+				SampledCrosscheckTreeSeqIntegrity();
 		}
 		
 		cached_value_generation_.reset();
@@ -3869,7 +3684,7 @@ bool SLiMSim::_RunOneGenerationNonWF(void)
 		gEidosCurrentScript = nullptr;
 		gEidosExecutingRuntimeScript = false;
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		if (gEidosProfilingClientCount)
 			CollectSLiMguiMemoryUsageProfileInfo();
@@ -4380,6 +4195,8 @@ void SLiMSim::TabulateMemoryUsage(SLiM_MemoryUsage *p_usage, EidosSymbolTable *p
 		
 		p_usage->mutationRefcountBuffer = SLiM_MemoryUsageForMutationRefcounts();
 		
+		p_usage->mutationHotBuffers = SLiM_MemoryUsageForMutationHotBuffers();
+		
 		p_usage->mutationUnusedPoolSpace = SLiM_MemoryUsageForMutationBlock() - p_usage->mutationObjects;
 	}
 	
@@ -4437,7 +4254,8 @@ void SLiMSim::TabulateMemoryUsage(SLiM_MemoryUsage *p_usage, EidosSymbolTable *p
 		
 		p_usage->slimsimObjects = (sizeof(SLiMSim) - sizeof(Chromosome)) * p_usage->slimsimObjects_count;	// Chromosome is handled separately above
 		
-		p_usage->slimsimTreeSeqTables = recording_tree_ ? MemoryUsageForTables(tables_) : 0;
+		// rows buffered since the last flush are counted where they are, rather than flushed just to be measured
+		p_usage->slimsimTreeSeqTables = recording_tree_ ? MemoryUsageForTables(tables_) + MemoryUsageForTreeSequenceBuffers() : 0;
 	}
 	
 	// Subpopulation
@@ -4547,6 +4365,7 @@ void SLiMSim::TabulateMemoryUsage(SLiM_MemoryUsage *p_usage, EidosSymbolTable *p
 	
 	total_usage += p_usage->mutationObjects;
 	total_usage += p_usage->mutationRefcountBuffer;
+	total_usage += p_usage->mutationHotBuffers;
 	total_usage += p_usage->mutationUnusedPoolSpace;
 	
 	total_usage += p_usage->mutationRunObjects;
@@ -4575,7 +4394,7 @@ void SLiMSim::TabulateMemoryUsage(SLiM_MemoryUsage *p_usage, EidosSymbolTable *p
 	p_usage->totalMemoryUsage = total_usage;
 }
 
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 // PROFILING
 void SLiMSim::CollectSLiMguiMemoryUsageProfileInfo(void)
 {
@@ -4612,6 +4431,7 @@ void SLiMSim::CollectSLiMguiMemoryUsageProfileInfo(void)
 	profile_total_memory_usage_.mutationObjects_count += profile_last_memory_usage_.mutationObjects_count;
 	profile_total_memory_usage_.mutationObjects += profile_last_memory_usage_.mutationObjects;
 	profile_total_memory_usage_.mutationRefcountBuffer += profile_last_memory_usage_.mutationRefcountBuffer;
+	profile_total_memory_usage_.mutationHotBuffers += profile_last_memory_usage_.mutationHotBuffers;
 	profile_total_memory_usage_.mutationUnusedPoolSpace += profile_last_memory_usage_.mutationUnusedPoolSpace;
 	
 	profile_total_memory_usage_.mutationRunObjects_count += profile_last_memory_usage_.mutationRunObjects_count;
@@ -4646,6 +4466,298 @@ void SLiMSim::CollectSLiMguiMemoryUsageProfileInfo(void)
 	
 	total_memory_tallies_++;
 }
+
+void SLiMSim::StartProfiling(void)
+{
+#if SLIM_USE_NONNEUTRAL_CACHES
+	// call this first, which has the side effect of emptying out any pending profile counts
+	CollectSLiMguiMutationProfileInfo();
+#endif
+	
+	// zero out profile counts for generation stages
+	for (int stage = 0; stage < 7; ++stage)
+		profile_stage_totals_[stage] = 0;
+	
+	// zero out profile counts for callback types (note SLiMEidosUserDefinedFunction is excluded; that is not a category we profile)
+	for (int callback_type = 0; callback_type < 11; ++callback_type)
+		profile_callback_totals_[callback_type] = 0;
+	
+	// zero out profile counts for script blocks; dynamic scripts will be zeroed on construction
+	std::vector<SLiMEidosBlock*> &script_blocks = AllScriptBlocks();
+	
+	for (SLiMEidosBlock *script_block : script_blocks)
+		if (script_block->type_ != SLiMEidosBlockType::SLiMEidosUserDefinedFunction)	// exclude user-defined functions; not user-visible as blocks
+			script_block->root_node_->ZeroProfileTotals();
+	
+	// zero out profile counts for all user-defined functions
+	for (auto functionPairIter = simulation_functions_.begin(); functionPairIter != simulation_functions_.end(); ++functionPairIter)
+	{
+		const EidosFunctionSignature *signature = functionPairIter->second.get();
+		
+		if (signature->body_script_ && signature->user_defined_)
+			signature->body_script_->AST()->ZeroProfileTotals();
+	}
+	
+#if SLIM_USE_NONNEUTRAL_CACHES
+	// zero out mutation run metrics
+	profile_mutcount_history_.clear();
+	profile_nonneutral_regime_history_.clear();
+	profile_mutation_total_usage_ = 0;
+	profile_nonneutral_mutation_total_ = 0;
+	profile_mutrun_total_usage_ = 0;
+	profile_unique_mutrun_total_ = 0;
+	profile_mutrun_nonneutral_recache_total_ = 0;
+	profile_max_mutation_index_ = 0;
+#endif
+	
+	// zero out memory usage metrics
+	EIDOS_BZERO(&profile_last_memory_usage_, sizeof(SLiM_MemoryUsage));
+	EIDOS_BZERO(&profile_total_memory_usage_, sizeof(SLiM_MemoryUsage));
+	total_memory_tallies_ = 0;
+}
+
+// Convert a memory usage record to JSON; each value is divided by p_divisor, so that averages can be reported
+static nlohmann::json SLiM_MemoryUsageToJSON(const SLiM_MemoryUsage &p_usage, int64_t p_divisor)
+{
+	nlohmann::json j;
+	
+	if (p_divisor <= 0)
+		return j;
+	
+	j["Chromosome"]["count"] = p_usage.chromosomeObjects_count / p_divisor;
+	j["Chromosome"]["objects"] = p_usage.chromosomeObjects / p_divisor;
+	j["Chromosome"]["mutation_rate_maps"] = p_usage.chromosomeMutationRateMaps / p_divisor;
+	j["Chromosome"]["recombination_rate_maps"] = p_usage.chromosomeRecombinationRateMaps / p_divisor;
+	j["Chromosome"]["ancestral_sequence"] = p_usage.chromosomeAncestralSequence / p_divisor;
+	
+	j["Genome"]["count"] = p_usage.genomeObjects_count / p_divisor;
+	j["Genome"]["objects"] = p_usage.genomeObjects / p_divisor;
+	j["Genome"]["external_buffers"] = p_usage.genomeExternalBuffers / p_divisor;
+	j["Genome"]["unused_pool_space"] = p_usage.genomeUnusedPoolSpace / p_divisor;
+	j["Genome"]["unused_pool_buffers"] = p_usage.genomeUnusedPoolBuffers / p_divisor;
+	
+	j["GenomicElement"]["count"] = p_usage.genomicElementObjects_count / p_divisor;
+	j["GenomicElement"]["objects"] = p_usage.genomicElementObjects / p_divisor;
+	
+	j["GenomicElementType"]["count"] = p_usage.genomicElementTypeObjects_count / p_divisor;
+	j["GenomicElementType"]["objects"] = p_usage.genomicElementTypeObjects / p_divisor;
+	
+	j["Individual"]["count"] = p_usage.individualObjects_count / p_divisor;
+	j["Individual"]["objects"] = p_usage.individualObjects / p_divisor;
+	j["Individual"]["unused_pool_space"] = p_usage.individualUnusedPoolSpace / p_divisor;
+	
+	j["InteractionType"]["count"] = p_usage.interactionTypeObjects_count / p_divisor;
+	j["InteractionType"]["objects"] = p_usage.interactionTypeObjects / p_divisor;
+	j["InteractionType"]["kd_trees"] = p_usage.interactionTypeKDTrees / p_divisor;
+	j["InteractionType"]["position_caches"] = p_usage.interactionTypePositionCaches / p_divisor;
+	j["InteractionType"]["sparse_arrays"] = p_usage.interactionTypeSparseArrays / p_divisor;
+	
+	j["Mutation"]["count"] = p_usage.mutationObjects_count / p_divisor;
+	j["Mutation"]["objects"] = p_usage.mutationObjects / p_divisor;
+	j["Mutation"]["refcount_buffer"] = p_usage.mutationRefcountBuffer / p_divisor;
+	j["Mutation"]["hot_buffers"] = p_usage.mutationHotBuffers / p_divisor;
+	j["Mutation"]["unused_pool_space"] = p_usage.mutationUnusedPoolSpace / p_divisor;
+	
+	j["MutationRun"]["count"] = p_usage.mutationRunObjects_count / p_divisor;
+	j["MutationRun"]["objects"] = p_usage.mutationRunObjects / p_divisor;
+	j["MutationRun"]["external_buffers"] = p_usage.mutationRunExternalBuffers / p_divisor;
+	j["MutationRun"]["nonneutral_caches"] = p_usage.mutationRunNonneutralCaches / p_divisor;
+	j["MutationRun"]["unused_pool_space"] = p_usage.mutationRunUnusedPoolSpace / p_divisor;
+	j["MutationRun"]["unused_pool_buffers"] = p_usage.mutationRunUnusedPoolBuffers / p_divisor;
+	
+	j["MutationType"]["count"] = p_usage.mutationTypeObjects_count / p_divisor;
+	j["MutationType"]["objects"] = p_usage.mutationTypeObjects / p_divisor;
+	
+	j["SLiMSim"]["count"] = p_usage.slimsimObjects_count / p_divisor;
+	j["SLiMSim"]["objects"] = p_usage.slimsimObjects / p_divisor;
+	j["SLiMSim"]["tree_seq_tables"] = p_usage.slimsimTreeSeqTables / p_divisor;
+	
+	j["Subpopulation"]["count"] = p_usage.subpopulationObjects_count / p_divisor;
+	j["Subpopulation"]["objects"] = p_usage.subpopulationObjects / p_divisor;
+	j["Subpopulation"]["fitness_caches"] = p_usage.subpopulationFitnessCaches / p_divisor;
+	j["Subpopulation"]["parent_tables"] = p_usage.subpopulationParentTables / p_divisor;
+	j["Subpopulation"]["spatial_maps"] = p_usage.subpopulationSpatialMaps / p_divisor;
+	j["Subpopulation"]["spatial_maps_display"] = p_usage.subpopulationSpatialMapsDisplay / p_divisor;
+	
+	j["Substitution"]["count"] = p_usage.substitutionObjects_count / p_divisor;
+	j["Substitution"]["objects"] = p_usage.substitutionObjects / p_divisor;
+	
+	j["Eidos"]["ast_node_pool"] = p_usage.eidosASTNodePool / p_divisor;
+	j["Eidos"]["symbol_table_pool"] = p_usage.eidosSymbolTablePool / p_divisor;
+	j["Eidos"]["value_pool"] = p_usage.eidosValuePool / p_divisor;
+	
+	j["total"] = p_usage.totalMemoryUsage / p_divisor;
+	
+	return j;
+}
+
+// Write a profile report in JSON format, covering the same information as SLiMgui's profile report.  All times are in seconds,
+// corrected for profiling overhead, and percentages are relative to p_elapsed_wall_clock, the corrected time inside SLiM.
+// Note that this converts the profile counts in script blocks to self counts, so it can only be called once per profile.
+void SLiMSim::WriteProfileReport(std::ostream &p_out, eidos_profile_t p_elapsed_wall_clock, clock_t p_elapsed_cpu_clock, slim_generation_t p_start_generation, slim_generation_t p_elapsed_generations)
+{
+	nlohmann::json j;
+	double elapsed_wall_clock_time = Eidos_ElapsedProfileTime(p_elapsed_wall_clock);
+	double percent_scale = ((elapsed_wall_clock_time > 0.0) ? (100.0 / elapsed_wall_clock_time) : 0.0);
+	bool is_WF = (ModelType() == SLiMModelType::kModelTypeWF);
+	
+	j["software"]["name"] = "SLiM";
+	j["software"]["version"] = SLIM_VERSION_STRING;
+	j["parameters"]["command"] = cli_params_;
+	j["parameters"]["model_type"] = (is_WF ? "WF" : "nonWF");
+	j["parameters"]["seed"] = original_seed_;
+	
+	j["elapsed"]["wall_clock_time"] = elapsed_wall_clock_time;
+	j["elapsed"]["cpu_time"] = p_elapsed_cpu_clock / (double)CLOCKS_PER_SEC;
+	j["elapsed"]["start_generation"] = p_start_generation;
+	j["elapsed"]["generations"] = p_elapsed_generations;
+	j["elapsed"]["includes_initialize"] = (p_start_generation == 0);
+	
+	j["profile_overhead"]["block_external_overhead"] = gEidos_ProfileOverheadSeconds;
+	j["profile_overhead"]["block_internal_lag"] = gEidos_ProfileLagSeconds;
+	
+	// Generation stage breakdown; the stage order differs between WF and nonWF models
+	{
+		static const char *WF_stage_names[7] = {"initialize() callback execution", "early() event execution", "offspring generation", "bookkeeping (fixed mutation removal, etc.)", "generation swap", "late() event execution", "fitness calculation"};
+		static const char *nonWF_stage_names[7] = {"initialize() callback execution", "offspring generation", "early() event execution", "fitness calculation", "viability/survival selection", "bookkeeping (fixed mutation removal, etc.)", "late() event execution"};
+		nlohmann::json stages = nlohmann::json::array();
+		
+		for (int stage = 0; stage < 7; ++stage)
+		{
+			double stage_time = Eidos_ElapsedProfileTime(profile_stage_totals_[stage]);
+			
+			stages.push_back({{"stage", stage}, {"name", (is_WF ? WF_stage_names[stage] : nonWF_stage_names[stage])}, {"time", stage_time}, {"percent", stage_time * percent_scale}});
+		}
+		
+		j["generation_stages"] = stages;
+	}
+	
+	// Callback type breakdown
+	{
+		nlohmann::json callback_types = nlohmann::json::array();
+		
+		for (int callback_type = 0; callback_type < 11; ++callback_type)
+		{
+			double callback_time = Eidos_ElapsedProfileTime(profile_callback_totals_[callback_type]);
+			std::ostringstream type_string;
+			
+			type_string << (SLiMEidosBlockType)callback_type;
+			callback_types.push_back({{"type", type_string.str()}, {"time", callback_time}, {"percent", callback_time * percent_scale}});
+		}
+		
+		j["callback_types"] = callback_types;
+	}
+	
+	// Script block profiles; the time for each block is the total of the self counts of its nodes
+	{
+		nlohmann::json blocks = nlohmann::json::array();
+		const std::string &script_string = script_->String();
+		
+		for (SLiMEidosBlock *script_block : AllScriptBlocks())
+		{
+			if (script_block->type_ == SLiMEidosBlockType::SLiMEidosUserDefinedFunction)
+				continue;
+			
+			const EidosASTNode *profile_root = script_block->root_node_;
+			
+			profile_root->ConvertProfileTotalsToSelfCounts();
+			
+			double block_time = Eidos_ElapsedProfileTime(profile_root->TotalOfSelfCounts());
+			std::ostringstream type_string;
+			nlohmann::json block;
+			
+			type_string << script_block->type_;
+			
+			block["id"] = script_block->block_id_;
+			block["type"] = type_string.str();
+			block["start_generation"] = script_block->start_generation_;
+			block["end_generation"] = script_block->end_generation_;
+			
+			// blocks from the input file get a line number; blocks defined programmatically have their own script
+			if (!script_block->script_)
+			{
+				int32_t token_start = profile_root->token_->token_start_;
+				
+				if ((token_start >= 0) && ((size_t)token_start <= script_string.length()))
+					block["line"] = 1 + std::count(script_string.begin(), script_string.begin() + token_start, '\n');
+			}
+			
+			block["source"] = profile_root->token_->token_string_;
+			block["time"] = block_time;
+			block["percent"] = block_time * percent_scale;
+			
+			blocks.push_back(block);
+		}
+		
+		j["script_blocks"] = blocks;
+	}
+	
+	// User-defined functions
+	{
+		nlohmann::json functions = nlohmann::json::array();
+		
+		for (auto functionPairIter = simulation_functions_.begin(); functionPairIter != simulation_functions_.end(); ++functionPairIter)
+		{
+			const EidosFunctionSignature *signature = functionPairIter->second.get();
+			
+			if (signature->body_script_ && signature->user_defined_)
+			{
+				const EidosASTNode *profile_root = signature->body_script_->AST();
+				
+				profile_root->ConvertProfileTotalsToSelfCounts();
+				
+				double function_time = Eidos_ElapsedProfileTime(profile_root->TotalOfSelfCounts());
+				
+				functions.push_back({{"signature", signature->SignatureString()}, {"time", function_time}, {"percent", function_time * percent_scale}});
+			}
+		}
+		
+		j["user_defined_functions"] = functions;
+	}
+	
+	// Memory usage, both the average across generations and the last generation
+	j["memory_usage"]["tally_count"] = total_memory_tallies_;
+	j["memory_usage"]["average"] = SLiM_MemoryUsageToJSON(profile_total_memory_usage_, total_memory_tallies_);
+	j["memory_usage"]["final"] = SLiM_MemoryUsageToJSON(profile_last_memory_usage_, 1);
+	
+#if SLIM_USE_NONNEUTRAL_CACHES
+	// MutationRun metrics
+	{
+		nlohmann::json mutrun_counts = nlohmann::json::object();
+		nlohmann::json regimes = nlohmann::json::object();
+		std::map<int32_t, int64_t> mutrun_count_tallies;
+		int64_t regime_tallies[3] = {0, 0, 0};
+		
+		for (int32_t count : profile_mutcount_history_)
+			mutrun_count_tallies[count]++;
+		
+		for (auto &tally : mutrun_count_tallies)
+			mutrun_counts[std::to_string(tally.first)] = tally.second;
+		
+		for (int32_t regime : profile_nonneutral_regime_history_)
+			if ((regime >= 1) && (regime <= 3))
+				regime_tallies[regime - 1]++;
+		
+		regimes["1"] = regime_tallies[0];		// no fitness callbacks
+		regimes["2"] = regime_tallies[1];		// constant neutral fitness callbacks only
+		regimes["3"] = regime_tallies[2];		// unpredictable fitness callbacks present
+		
+		j["mutation_runs"]["mutation_runs_per_genome"] = mutrun_counts;			// generation counts, keyed by the number of mutation runs per genome
+		j["mutation_runs"]["nonneutral_regimes"] = regimes;						// generation counts, keyed by nonneutral regime
+		j["mutation_runs"]["mutations_referenced"] = profile_mutation_total_usage_;
+		j["mutation_runs"]["mutations_nonneutral"] = profile_nonneutral_mutation_total_;
+		j["mutation_runs"]["max_simultaneous_mutations"] = profile_max_mutation_index_;
+		j["mutation_runs"]["mutation_runs_referenced"] = profile_mutrun_total_usage_;
+		j["mutation_runs"]["mutation_runs_unique"] = profile_unique_mutrun_total_;
+		j["mutation_runs"]["mutation_runs_recached"] = profile_mutrun_nonneutral_recache_total_;
+		
+		if (profile_unique_mutrun_total_ > 0)
+			j["mutation_runs"]["mutation_run_sharing"] = profile_mutrun_total_usage_ / (double)profile_unique_mutrun_total_;
+	}
+#endif
+	
+	p_out << j.dump(4) << std::endl;
+}
 #endif
 
 
@@ -4722,102 +4834,391 @@ void SLiMSim::ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vect
 	}
 }
 
-void SLiMSim::SimplifyTreeSequence(void)
+// This is used by SortTreeSequenceTables() to sort edges; it mirrors the sort order of cmp_edge() in tables.c
+typedef struct {
+	double time;
+	tsk_id_t parent;
+	tsk_id_t child;
+	double left;
+	double right;
+} slim_edge_sort_t;
+
+static inline bool SLiM_EdgeSortsBefore(const slim_edge_sort_t &p_a, const slim_edge_sort_t &p_b)
 {
-#if DEBUG
-	if (!recording_tree_)
-		EIDOS_TERMINATION << "ERROR (SLiMSim::SimplifyTreeSequence): (internal error) tree sequence recording method called with recording off." << EidosTerminate();
-#endif
+	if (p_a.time != p_b.time)
+		return (p_a.time < p_b.time);
+	if (p_a.parent != p_b.parent)
+		return (p_a.parent < p_b.parent);
+	if (p_a.child != p_b.child)
+		return (p_a.child < p_b.child);
+	return (p_a.left < p_b.left);
+}
+
+static inline slim_edge_sort_t SLiM_EdgeSortRecord(tsk_table_collection_t *p_tables, tsk_size_t p_row)
+{
+	tsk_edge_table_t &edges = p_tables->edges;
+	tsk_id_t parent = edges.parent[p_row];
 	
-	if (tables_.nodes.num_rows == 0)
-		return;
+	return slim_edge_sort_t{p_tables->nodes.time[parent], parent, edges.child[p_row], edges.left[p_row], edges.right[p_row]};
+}
+
+int SLiMSim::SortTreeSequenceTables(tsk_table_collection_t *p_tables, tsk_size_t p_sorted_edge_count)
+{
+	// This is equivalent to tsk_table_collection_sort(p_tables, NULL, 0), but it takes advantage of the fact that the
+	// first p_sorted_edge_count edges are already sorted, which is the case for the edges left by the last simplify.
+	// Only the edges recorded since then get sorted; they are then merged with the sorted prefix in place.  We can't
+	// simply sort the suffix with tskit's edge_start bookmark, because new edges can have parents younger than the
+	// parents of edges in the prefix, so they need to be interleaved.  We check that the prefix really is sorted,
+	// since that is cheap compared to sorting, and fall back to a full sort if it is not.  This returns a tskit error
+	// code rather than raising, since it is also called by the background simplification thread.
+	tsk_edge_table_t &edges = p_tables->edges;
+	tsk_size_t edge_count = edges.num_rows;
+	tsk_size_t prefix_count = std::min(p_sorted_edge_count, edge_count);
 	
-	std::vector<tsk_id_t> samples;
+	for (tsk_size_t row = 1; row < prefix_count; ++row)
+	{
+		if (SLiM_EdgeSortsBefore(SLiM_EdgeSortRecord(p_tables, row), SLiM_EdgeSortRecord(p_tables, row - 1)))
+		{
+			prefix_count = 0;
+			break;
+		}
+	}
+	
+	if (prefix_count == 0)
+		return tsk_table_collection_sort(p_tables, /* edge_start */ 0, /* flags */ 0);
 	
-	// BCH 7/27/2019: We now build a std::unordered_map containing all of the entries of remembered_genomes_,
-	// so that the find() operations in the loop below can be done in constant time instead of O(N) time.
-	// We need to be able to find out the index of an entry, in remembered_genomes_, once we have found it;
-	// that is what the mapped value provides, whereas the key value is the tsk_id_t we need to find below.
-	// We do all this inside a block so the map gets deallocated as soon as possible, to minimize footprint.
+	if (prefix_count < edge_count)
 	{
-		std::unordered_map<tsk_id_t, uint32_t> remembered_genomes_lookup;
+		// sort the new edges
+		std::vector<slim_edge_sort_t> new_edges;
 		
-		// the remembered_genomes_ come first in the list of samples
-		uint32_t index = 0;
+		new_edges.reserve(edge_count - prefix_count);
 		
-		for (tsk_id_t sid : remembered_genomes_)
-		{
-			samples.push_back(sid);
-			remembered_genomes_lookup.emplace(std::pair<tsk_id_t, uint32_t>(sid, index));
-			index++;
-		}
+		for (tsk_size_t row = prefix_count; row < edge_count; ++row)
+			new_edges.push_back(SLiM_EdgeSortRecord(p_tables, row));
 		
-		// and then come all the genomes of the extant individuals
-		tsk_id_t newValueInNodeTable = (tsk_id_t)remembered_genomes_.size();
+		std::sort(new_edges.begin(), new_edges.end(), SLiM_EdgeSortsBefore);
 		
-		for (auto it = population_.subpops_.begin(); it != population_.subpops_.end(); it++)
+		// merge them with the prefix from the back end, so that the merge can be done in place in the edge table
+		int64_t prefix_index = (int64_t)prefix_count - 1;
+		int64_t new_index = (int64_t)new_edges.size() - 1;
+		int64_t dest_index = (int64_t)edge_count - 1;
+		
+		while (new_index >= 0)
 		{
-			std::vector<Genome *> &subpopulationGenomes = it->second->parent_genomes_;
-			
-			for (Genome *genome : subpopulationGenomes)
+			if ((prefix_index >= 0) && SLiM_EdgeSortsBefore(new_edges[new_index], SLiM_EdgeSortRecord(p_tables, (tsk_size_t)prefix_index)))
 			{
-				tsk_id_t M = genome->tsk_node_id_;
-				
-				// check if this sample is already being remembered, and assign the correct tsk_node_id_
-				// if not remembered, it is currently alive, so we need to mark it as a sample so it persists through simplify()
-				auto iter = remembered_genomes_lookup.find(M);
+				edges.left[dest_index] = edges.left[prefix_index];
+				edges.right[dest_index] = edges.right[prefix_index];
+				edges.parent[dest_index] = edges.parent[prefix_index];
+				edges.child[dest_index] = edges.child[prefix_index];
+				prefix_index--;
+			}
+			else
+			{
+				slim_edge_sort_t &new_edge = new_edges[new_index];
 				
-				if (iter == remembered_genomes_lookup.end())
-				{
-					samples.push_back(M);
-					genome->tsk_node_id_ = newValueInNodeTable++;
-				}
-				else
-				{
-					genome->tsk_node_id_ = (tsk_id_t)(iter->second);
-				}
+				edges.left[dest_index] = new_edge.left;
+				edges.right[dest_index] = new_edge.right;
+				edges.parent[dest_index] = new_edge.parent;
+				edges.child[dest_index] = new_edge.child;
+				new_index--;
 			}
+			
+			dest_index--;
 		}
 	}
 	
-	// the tables need to have a population table to be able to sort it
-	WritePopulationTable(&tables_);
-	
-	// sort the table collection
-	int ret = tsk_table_collection_sort(&tables_, /* edge_start */ 0, /* flags */ 0);
-	if (ret < 0) handle_error("tsk_table_collection_sort", ret);
-	
-	// remove redundant sites we added
-	ret = tsk_table_collection_deduplicate_sites(&tables_, 0);
-	if (ret < 0) handle_error("tsk_table_collection_deduplicate_sites", ret);
-	
-	// simplify
-	ret = tsk_table_collection_simplify(&tables_, samples.data(), (tsk_size_t)samples.size(), TSK_FILTER_SITES | TSK_FILTER_INDIVIDUALS, NULL);
-	if (ret != 0) handle_error("tsk_table_collection_simplify", ret);
-	
-	// update map of remembered_genomes_, which are now the first n entries in the node table
-	for (tsk_id_t i = 0; i < (tsk_id_t)remembered_genomes_.size(); i++)
-		remembered_genomes_[i] = i;
-	
-	// reset current position, used to rewind individuals that are rejected by modifyChild()
-	RecordTablePosition();
+	// now sort the sites and mutations; passing the full edge count as the edge start tells tskit that the edges are sorted
+	tsk_bookmark_t start;
 	
-	// and reset our elapsed time since last simplification, for auto-simplification
-	simplify_elapsed_ = 0;
+	memset(&start, 0, sizeof(start));
+	start.edges = edge_count;
 	
-	// as a side effect of simplification, update a "model has coalesced" flag that the user can consult, if requested
-	if (running_coalescence_checks_)
-		CheckCoalescenceAfterSimplification();
+	return tsk_table_collection_sort(p_tables, &start, /* flags */ 0);
 }
 
-void SLiMSim::CheckCoalescenceAfterSimplification(void)
+void SLiMSim::CollectSimplificationSamples(std::vector<tsk_id_t> &p_samples)
 {
-#if DEBUG
-	if (!recording_tree_ || !running_coalescence_checks_)
-		EIDOS_TERMINATION << "ERROR (SLiMSim::CheckCoalescenceAfterSimplification): (internal error) coalescence check called with recording or checking off." << EidosTerminate();
-#endif
+	// The remembered_genomes_ come first in the list of samples, and then come all the genomes of the extant individuals
+	// that are not also remembered.  Simplification maps the samples to the first entries of the node table, in order.
+	// BCH 7/27/2019: We build a std::unordered_set containing all of the entries of remembered_genomes_, so that the
+	// find() operations in the loop below can be done in constant time instead of O(N) time.
+	std::unordered_set<tsk_id_t> remembered_genomes_lookup(remembered_genomes_.begin(), remembered_genomes_.end());
 	
-	// Copy the table collection; Jerome says this is unnecessary since tsk_table_collection_build_index()
+	p_samples.clear();
+	p_samples.insert(p_samples.end(), remembered_genomes_.begin(), remembered_genomes_.end());
+	
+	for (auto it = population_.subpops_.begin(); it != population_.subpops_.end(); it++)
+	{
+		std::vector<Genome *> &subpopulationGenomes = it->second->parent_genomes_;
+		
+		for (Genome *genome : subpopulationGenomes)
+		{
+			tsk_id_t M = genome->tsk_node_id_;
+			
+			// if not remembered, it is currently alive, so we need to mark it as a sample so it persists through simplify()
+			if (remembered_genomes_lookup.find(M) == remembered_genomes_lookup.end())
+				p_samples.push_back(M);
+		}
+	}
+}
+
+void SLiMSim::RemapNodeIDsAfterSimplification(const std::vector<tsk_id_t> &p_node_map, tsk_id_t p_appended_node_base)
+{
+	// Update the tsk_node_id_ of every extant genome to its index in the simplified node table.  Nodes that existed
+	// at the time of simplification are mapped through p_node_map, the node map produced by simplify; nodes recorded
+	// after that (only possible with background simplification) were appended after the simplified nodes, starting
+	// at p_appended_node_base.  Extant genomes are always samples, so they should never map to TSK_NULL.
+	tsk_id_t mapped_node_count = (tsk_id_t)p_node_map.size();
+	
+	for (auto it = population_.subpops_.begin(); it != population_.subpops_.end(); it++)
+	{
+		std::vector<Genome *> &subpopulationGenomes = it->second->parent_genomes_;
+		
+		for (Genome *genome : subpopulationGenomes)
+		{
+			tsk_id_t M = genome->tsk_node_id_;
+			
+			genome->tsk_node_id_ = ((M < mapped_node_count) ? p_node_map[M] : p_appended_node_base + (M - mapped_node_count));
+			
+#if DEBUG
+			if (genome->tsk_node_id_ == TSK_NULL)
+				EIDOS_TERMINATION << "ERROR (SLiMSim::RemapNodeIDsAfterSimplification): (internal error) extant genome lost in simplification." << EidosTerminate();
+#endif
+		}
+	}
+	
+	// the remembered_genomes_ are now the first n entries in the node table
+	for (tsk_id_t i = 0; i < (tsk_id_t)remembered_genomes_.size(); i++)
+		remembered_genomes_[i] = i;
+}
+
+void SLiMSim::SimplifyTreeSequence(void)
+{
+#if DEBUG
+	if (!recording_tree_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::SimplifyTreeSequence): (internal error) tree sequence recording method called with recording off." << EidosTerminate();
+#endif
+	
+	// any background simplification needs to be incorporated first; we then simplify the result again, which is cheap
+	FinishBackgroundSimplification();
+	
+	if (tables_.nodes.num_rows == 0)
+		return;
+	
+	std::vector<tsk_id_t> samples;
+	std::vector<tsk_id_t> node_map(tables_.nodes.num_rows);
+	
+	CollectSimplificationSamples(samples);
+	
+	// the tables need to have a population table to be able to sort it
+	WritePopulationTable(&tables_);
+	
+	// measure the cost of simplification, for the cost model used by optimizeSimplification=T
+	uint64_t rows_before = TableRowCount(tables_);
+	size_t bytes_before = MemoryInUseForTables(tables_);
+	double work = SimplificationWork(tables_, sorted_edge_count_);
+	
+	// sort the table collection; only the edges recorded since the last simplify need to be sorted
+	int ret = SortTreeSequenceTables(&tables_, sorted_edge_count_);
+	if (ret < 0) handle_error("tsk_table_collection_sort", ret);
+	
+	// remove redundant sites we added
+	ret = tsk_table_collection_deduplicate_sites(&tables_, 0);
+	if (ret < 0) handle_error("tsk_table_collection_deduplicate_sites", ret);
+	
+	// simplify
+	ret = tsk_table_collection_simplify(&tables_, samples.data(), (tsk_size_t)samples.size(), TSK_FILTER_SITES | TSK_FILTER_INDIVIDUALS, node_map.data());
+	if (ret != 0) handle_error("tsk_table_collection_simplify", ret);
+	
+	RecordSimplificationCost(work, simplify_elapsed_, rows_before, TableRowCount(tables_), bytes_before, MemoryInUseForTables(tables_));
+	
+	// update the node IDs kept by genomes and remembered_genomes_
+	RemapNodeIDsAfterSimplification(node_map, (tsk_id_t)tables_.nodes.num_rows);
+	crosscheck_index_valid_ = false;
+	
+	// the edge table is now sorted, so the next sort only needs to deal with edges recorded after this point
+	sorted_edge_count_ = tables_.edges.num_rows;
+	
+	// reset current position, used to rewind individuals that are rejected by modifyChild()
+	RecordTablePosition();
+	
+	// and reset our elapsed time since last simplification, for auto-simplification
+	simplify_elapsed_ = 0;
+	
+	// as a side effect of simplification, update a "model has coalesced" flag that the user can consult, if requested
+	if (running_coalescence_checks_)
+		CheckCoalescenceAfterSimplification();
+}
+
+void SLiMSim::_RunBackgroundSimplification(SLiMSim *p_sim)
+{
+	// This runs on the background simplification thread.  It touches only background_tables_ and the other background_
+	// ivars, which the main thread leaves alone until it joins this thread; errors are passed back as tskit error codes.
+	tsk_table_collection_t *tables = &p_sim->background_tables_;
+	std::vector<tsk_id_t> &samples = p_sim->background_samples_;
+	int ret;
+	
+	ret = SortTreeSequenceTables(tables, p_sim->background_sorted_edge_count_);
+	if (ret < 0) { p_sim->background_error_ = ret; p_sim->background_error_function_ = "tsk_table_collection_sort"; return; }
+	
+	ret = tsk_table_collection_deduplicate_sites(tables, 0);
+	if (ret < 0) { p_sim->background_error_ = ret; p_sim->background_error_function_ = "tsk_table_collection_deduplicate_sites"; return; }
+	
+	ret = tsk_table_collection_simplify(tables, samples.data(), (tsk_size_t)samples.size(), TSK_FILTER_SITES | TSK_FILTER_INDIVIDUALS, p_sim->background_node_map_.data());
+	if (ret != 0) { p_sim->background_error_ = ret; p_sim->background_error_function_ = "tsk_table_collection_simplify"; return; }
+}
+
+void SLiMSim::StartBackgroundSimplification(bool p_adjust_interval)
+{
+#if DEBUG
+	if (!recording_tree_ || background_simplification_running_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::StartBackgroundSimplification): (internal error) background simplification started with recording off or simplification already running." << EidosTerminate();
+#endif
+	
+	// With simplifyInBackground=T, we snapshot the tables and simplify the snapshot on a background thread while
+	// the model continues to run, appending new rows to tables_.  FinishBackgroundSimplification() later splices the
+	// rows recorded since the snapshot onto the simplified tables.  The result is identical to simplifying tables_
+	// synchronously here, provided that nothing but appending happens to tables_ in the meantime; anything else
+	// (output, remembering individuals, crosschecks, etc.) calls FinishBackgroundSimplification() first.
+	FlushTreeSequenceBuffers();
+	
+	if (tables_.nodes.num_rows == 0)
+		return;
+	
+	CollectSimplificationSamples(background_samples_);
+	WritePopulationTable(&tables_);
+	
+	int ret = tsk_table_collection_copy(&tables_, &background_tables_, 0);
+	if (ret < 0) handle_error("tsk_table_collection_copy", ret);
+	
+	tsk_table_collection_record_num_rows(&tables_, &background_position_);
+	background_table_size_ = TableRowCount(tables_);
+	background_table_bytes_ = MemoryInUseForTables(tables_);
+	background_work_ = SimplificationWork(tables_, sorted_edge_count_);
+	background_elapsed_ = simplify_elapsed_;
+	background_adjust_interval_ = p_adjust_interval;
+	background_node_map_.resize(tables_.nodes.num_rows);
+	background_sorted_edge_count_ = sorted_edge_count_;
+	background_error_ = 0;
+	background_error_function_ = nullptr;
+	
+	background_simplification_thread_ = std::thread(_RunBackgroundSimplification, this);
+	background_simplification_running_ = true;
+	
+	// the simplification is considered to have happened now, for purposes of auto-simplification
+	simplify_elapsed_ = 0;
+}
+
+void SLiMSim::FinishBackgroundSimplification(void)
+{
+	// every caller needs tables_ to be current, so buffered rows are flushed here even if no background simplification is running
+	FlushTreeSequenceBuffers();
+	
+	if (!background_simplification_running_)
+		return;
+	
+	background_simplification_thread_.join();
+	background_simplification_running_ = false;
+	
+	if (background_error_ != 0)
+	{
+		tsk_table_collection_free(&background_tables_);
+		handle_error(background_error_function_, background_error_);
+	}
+	
+	// Append everything recorded since the snapshot to the simplified tables, remapping node and site IDs.  Only nodes,
+	// edges, sites, and mutations are recorded during a generation; other tables are written only at points where we
+	// have finished any background simplification first, so the snapshot's versions of those tables are current.
+	tsk_table_collection_t &simplified = background_tables_;
+	tsk_bookmark_t &snapshot = background_position_;
+	tsk_id_t snapshot_node_count = (tsk_id_t)snapshot.nodes;
+	tsk_id_t appended_node_base = (tsk_id_t)simplified.nodes.num_rows;
+	tsk_id_t site_id_offset = (tsk_id_t)simplified.sites.num_rows - (tsk_id_t)snapshot.sites;
+	tsk_size_t simplified_edge_count = simplified.edges.num_rows;
+	uint64_t simplified_table_size = TableRowCount(simplified);
+	
+	RecordSimplificationCost(background_work_, background_elapsed_, background_table_size_, simplified_table_size, background_table_bytes_, MemoryInUseForTables(simplified));
+	
+	std::vector<tsk_id_t> &node_map = background_node_map_;
+	int ret;
+	
+#if DEBUG
+	if ((tables_.individuals.num_rows != snapshot.individuals) || (tables_.nodes.num_rows < snapshot.nodes) || (tables_.edges.num_rows < snapshot.edges) || (tables_.sites.num_rows < snapshot.sites) || (tables_.mutations.num_rows < snapshot.mutations))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::FinishBackgroundSimplification): (internal error) tables modified during background simplification." << EidosTerminate();
+#endif
+	
+	auto remap_node = [&node_map, snapshot_node_count, appended_node_base](tsk_id_t p_node) {
+		return ((p_node < snapshot_node_count) ? node_map[p_node] : appended_node_base + (p_node - snapshot_node_count));
+	};
+	
+	for (tsk_size_t row = snapshot.nodes; row < tables_.nodes.num_rows; ++row)
+	{
+		tsk_node_table_t &nodes = tables_.nodes;
+		
+		ret = tsk_node_table_add_row(&simplified.nodes, nodes.flags[row], nodes.time[row], nodes.population[row], nodes.individual[row],
+									 nodes.metadata + nodes.metadata_offset[row], nodes.metadata_offset[row + 1] - nodes.metadata_offset[row]);
+		if (ret < 0) handle_error("tsk_node_table_add_row", ret);
+	}
+	
+	for (tsk_size_t row = snapshot.edges; row < tables_.edges.num_rows; ++row)
+	{
+		tsk_edge_table_t &edges = tables_.edges;
+		
+		ret = tsk_edge_table_add_row(&simplified.edges, edges.left[row], edges.right[row], remap_node(edges.parent[row]), remap_node(edges.child[row]));
+		if (ret < 0) handle_error("tsk_edge_table_add_row", ret);
+	}
+	
+	for (tsk_size_t row = snapshot.sites; row < tables_.sites.num_rows; ++row)
+	{
+		tsk_site_table_t &sites = tables_.sites;
+		
+		ret = tsk_site_table_add_row(&simplified.sites, sites.position[row],
+									 sites.ancestral_state + sites.ancestral_state_offset[row], sites.ancestral_state_offset[row + 1] - sites.ancestral_state_offset[row],
+									 sites.metadata + sites.metadata_offset[row], sites.metadata_offset[row + 1] - sites.metadata_offset[row]);
+		if (ret < 0) handle_error("tsk_site_table_add_row", ret);
+	}
+	
+	for (tsk_size_t row = snapshot.mutations; row < tables_.mutations.num_rows; ++row)
+	{
+		// every mutation recorded by RecordNewDerivedState() gets its own new site, and has no parent
+		tsk_mutation_table_t &mutations = tables_.mutations;
+		
+		ret = tsk_mutation_table_add_row(&simplified.mutations, mutations.site[row] + site_id_offset, remap_node(mutations.node[row]), mutations.parent[row],
+										 mutations.derived_state + mutations.derived_state_offset[row], mutations.derived_state_offset[row + 1] - mutations.derived_state_offset[row],
+										 mutations.metadata + mutations.metadata_offset[row], mutations.metadata_offset[row + 1] - mutations.metadata_offset[row]);
+		if (ret < 0) handle_error("tsk_mutation_table_add_row", ret);
+	}
+	
+	// the simplified tables become our tables, and the old tables are freed
+	std::swap(tables_, background_tables_);
+	tsk_table_collection_free(&background_tables_);
+	
+	RemapNodeIDsAfterSimplification(node_map, appended_node_base);
+	crosscheck_index_valid_ = false;
+	
+	sorted_edge_count_ = simplified_edge_count;
+	RecordTablePosition();
+	
+	background_samples_.clear();
+	background_samples_.shrink_to_fit();
+	background_node_map_.clear();
+	background_node_map_.shrink_to_fit();
+	
+	// now that we know how much the simplification achieved, we can adjust the auto-simplification interval
+	if (background_adjust_interval_)
+		AdjustAutoSimplificationInterval(background_table_size_, simplified_table_size);
+}
+
+void SLiMSim::CheckCoalescenceAfterSimplification(void)
+{
+#if DEBUG
+	if (!recording_tree_ || !running_coalescence_checks_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::CheckCoalescenceAfterSimplification): (internal error) coalescence check called with recording or checking off." << EidosTerminate();
+#endif
+	
+	// Copy the table collection; Jerome says this is unnecessary since tsk_table_collection_build_index()
 	// does not modify the core information in the table collection, but just adds some separate indices.
 	// However, we also need to add a population table, so really it is best to make a copy I think.
 	tsk_table_collection_t tables_copy;
@@ -4918,8 +5319,107 @@ void SLiMSim::CheckCoalescenceAfterSimplification(void)
 
 void SLiMSim::RecordTablePosition(void)
 {
-	// keep the current table position for rewinding if a proposed child is rejected
+	// keep the current table position for rewinding if a proposed child is rejected; rows that are still buffered count
+	// as being in the tables, so that RetractNewIndividual() can rewind whether or not they have been flushed since
 	tsk_table_collection_record_num_rows(&tables_, &table_position_);
+	
+	table_position_.nodes += buffered_node_time_.size();
+	table_position_.edges += buffered_edge_left_.size();
+	table_position_.sites += buffered_site_position_.size();
+	table_position_.mutations += buffered_mutation_site_.size();
+}
+
+void SLiMSim::FlushTreeSequenceBuffers(void)
+{
+	// Append the rows buffered by RecordNewGenome() and RecordNewDerivedState() to tables_, one bulk append per table.  Before
+	// appending, we set each table's growth increment in proportion to its current size, so that its columns grow geometrically;
+	// tskit's default of a fixed 1024 rows would mean reallocating and copying the big tables very frequently as they fill up
+	// between simplifications.
+	int ret;
+	
+	size_t node_count = buffered_node_time_.size();
+	
+	if (node_count)
+	{
+		static std::vector<tsk_size_t> metadata_offsets;
+		
+		metadata_offsets.resize(node_count + 1);
+		for (size_t row = 0; row <= node_count; ++row)
+			metadata_offsets[row] = (tsk_size_t)(row * sizeof(GenomeMetadataRec));
+		
+		tsk_node_table_set_max_rows_increment(&tables_.nodes, std::max((tsk_size_t)1024, tables_.nodes.num_rows / 2));
+		tsk_node_table_set_max_metadata_length_increment(&tables_.nodes, std::max((tsk_size_t)65536, tables_.nodes.metadata_length / 2));
+		
+		ret = tsk_node_table_append_columns(&tables_.nodes, (tsk_size_t)node_count, buffered_node_flags_.data(), buffered_node_time_.data(),
+											buffered_node_population_.data(), NULL, buffered_node_metadata_.data(), metadata_offsets.data());
+		if (ret < 0) handle_error("tsk_node_table_append_columns", ret);
+	}
+	
+	size_t edge_count = buffered_edge_left_.size();
+	
+	if (edge_count)
+	{
+		tsk_edge_table_set_max_rows_increment(&tables_.edges, std::max((tsk_size_t)1024, tables_.edges.num_rows / 2));
+		
+		ret = tsk_edge_table_append_columns(&tables_.edges, (tsk_size_t)edge_count, buffered_edge_left_.data(), buffered_edge_right_.data(),
+											buffered_edge_parent_.data(), buffered_edge_child_.data());
+		if (ret < 0) handle_error("tsk_edge_table_append_columns", ret);
+	}
+	
+	size_t site_count = buffered_site_position_.size();
+	
+	if (site_count)
+	{
+		// the sites we record have no ancestral state and no metadata
+		static std::vector<tsk_size_t> empty_offsets;
+		
+		if (empty_offsets.size() < site_count + 1)
+			empty_offsets.resize(site_count + 1, 0);
+		
+		tsk_site_table_set_max_rows_increment(&tables_.sites, std::max((tsk_size_t)1024, tables_.sites.num_rows / 2));
+		
+		ret = tsk_site_table_append_columns(&tables_.sites, (tsk_size_t)site_count, buffered_site_position_.data(), "", empty_offsets.data(), NULL, NULL);
+		if (ret < 0) handle_error("tsk_site_table_append_columns", ret);
+	}
+	
+	size_t mutation_count = buffered_mutation_site_.size();
+	
+	if (mutation_count)
+	{
+		// the derived state of a mutation can be empty, so the derived state buffer can be empty too; tskit requires a non-NULL pointer
+		const char *derived_state = (buffered_mutation_derived_state_.size() ? buffered_mutation_derived_state_.data() : "");
+		const char *metadata = (buffered_mutation_metadata_.size() ? buffered_mutation_metadata_.data() : "");
+		
+		tsk_mutation_table_set_max_rows_increment(&tables_.mutations, std::max((tsk_size_t)1024, tables_.mutations.num_rows / 2));
+		tsk_mutation_table_set_max_derived_state_length_increment(&tables_.mutations, std::max((tsk_size_t)65536, tables_.mutations.derived_state_length / 2));
+		tsk_mutation_table_set_max_metadata_length_increment(&tables_.mutations, std::max((tsk_size_t)65536, tables_.mutations.metadata_length / 2));
+		
+		ret = tsk_mutation_table_append_columns(&tables_.mutations, (tsk_size_t)mutation_count, buffered_mutation_site_.data(), buffered_mutation_node_.data(), NULL,
+												derived_state, buffered_mutation_derived_state_offset_.data(), metadata, buffered_mutation_metadata_offset_.data());
+		if (ret < 0) handle_error("tsk_mutation_table_append_columns", ret);
+	}
+	
+	ClearTreeSequenceBuffers();
+}
+
+void SLiMSim::ClearTreeSequenceBuffers(void)
+{
+	// discard any buffered rows; the buffers keep their capacity, since they will be refilled to a similar size next generation
+	buffered_node_flags_.clear();
+	buffered_node_time_.clear();
+	buffered_node_population_.clear();
+	buffered_node_metadata_.clear();
+	buffered_edge_left_.clear();
+	buffered_edge_right_.clear();
+	buffered_edge_parent_.clear();
+	buffered_edge_child_.clear();
+	buffered_site_position_.clear();
+	buffered_mutation_site_.clear();
+	buffered_mutation_node_.clear();
+	buffered_mutation_derived_state_.clear();
+	buffered_mutation_derived_state_offset_.resize(1);
+	buffered_mutation_metadata_.clear();
+	buffered_mutation_metadata_offset_.resize(1);
 }
 
 void SLiMSim::AllocateTreeSequenceTables(void)
@@ -4936,7 +5436,10 @@ void SLiMSim::AllocateTreeSequenceTables(void)
 	if (ret != 0) handle_error("AllocateTreeSequenceTables()", ret);
 	
 	tables_.sequence_length = (double)chromosome_.last_position_ + 1;
+	sorted_edge_count_ = 0;
+	crosscheck_index_valid_ = false;
 	
+	ClearTreeSequenceBuffers();
 	RecordTablePosition();
 }
 
@@ -4972,7 +5475,38 @@ void SLiMSim::RetractNewIndividual()
 	// around the code since it seems to keep coming back...
 	//current_new_individual_ = nullptr;
 	
-    tsk_table_collection_truncate(&tables_, &table_position_);
+	// Usually the rows to be backed out are all still buffered, and we just shorten the buffers; if the buffers have been
+	// flushed since the table position was recorded (by a callback that wrote output, for example), we truncate the tables.
+	if ((table_position_.nodes >= tables_.nodes.num_rows) && (table_position_.edges >= tables_.edges.num_rows) &&
+		(table_position_.sites >= tables_.sites.num_rows) && (table_position_.mutations >= tables_.mutations.num_rows))
+	{
+		size_t node_count = table_position_.nodes - tables_.nodes.num_rows;
+		size_t edge_count = table_position_.edges - tables_.edges.num_rows;
+		size_t site_count = table_position_.sites - tables_.sites.num_rows;
+		size_t mutation_count = table_position_.mutations - tables_.mutations.num_rows;
+		
+		buffered_node_flags_.resize(node_count);
+		buffered_node_time_.resize(node_count);
+		buffered_node_population_.resize(node_count);
+		buffered_node_metadata_.resize(node_count * sizeof(GenomeMetadataRec));
+		buffered_edge_left_.resize(edge_count);
+		buffered_edge_right_.resize(edge_count);
+		buffered_edge_parent_.resize(edge_count);
+		buffered_edge_child_.resize(edge_count);
+		buffered_site_position_.resize(site_count);
+		buffered_mutation_site_.resize(mutation_count);
+		buffered_mutation_node_.resize(mutation_count);
+		buffered_mutation_derived_state_offset_.resize(mutation_count + 1);
+		buffered_mutation_derived_state_.resize(buffered_mutation_derived_state_offset_.back());
+		buffered_mutation_metadata_offset_.resize(mutation_count + 1);
+		buffered_mutation_metadata_.resize(buffered_mutation_metadata_offset_.back());
+	}
+	else
+	{
+		ClearTreeSequenceBuffers();
+		tsk_table_collection_truncate(&tables_, &table_position_);
+		crosscheck_index_valid_ = false;
+	}
 }
 
 void SLiMSim::RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genome *p_new_genome, 
@@ -4997,10 +5531,14 @@ void SLiMSim::RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genom
 	
 	MetadataForGenome(p_new_genome, &metadata_rec);
 	
+	// the node and its edges are buffered, to be appended to tables_ by FlushTreeSequenceBuffers(); its id is what it will have then
 	const char *metadata = (char *)&metadata_rec;
-	size_t metadata_length = sizeof(GenomeMetadataRec)/sizeof(char);
-	tsk_id_t offspringTSKID = tsk_node_table_add_row(&tables_.nodes, flags, time, (tsk_id_t)p_new_genome->subpop_->subpopulation_id_,
-                                        TSK_NULL, metadata, (tsk_size_t)metadata_length);
+	tsk_id_t offspringTSKID = (tsk_id_t)(tables_.nodes.num_rows + buffered_node_time_.size());
+	
+	buffered_node_flags_.emplace_back(flags);
+	buffered_node_time_.emplace_back(time);
+	buffered_node_population_.emplace_back((tsk_id_t)p_new_genome->subpop_->subpopulation_id_);
+	buffered_node_metadata_.insert(buffered_node_metadata_.end(), metadata, metadata + sizeof(GenomeMetadataRec));
 	
 	p_new_genome->tsk_node_id_ = offspringTSKID;
 	
@@ -5018,27 +5556,37 @@ void SLiMSim::RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genom
 	if (breakpoint_count && (p_breakpoints->back() > chromosome_.last_position_))
 		breakpoint_count--;
 	
-	// add an edge for each interval between breakpoints
+	// add an edge for each interval between breakpoints; abutting intervals inherited from the same parental genome (which happens
+	// when both parental genomes are the same genome, or with breakpoints at the same position) are squashed into a single edge
 	double left = 0.0;
 	double right;
 	bool polarity = true;
+	size_t first_edge_index = buffered_edge_left_.size();
 	
-	for (size_t i = 0; i < breakpoint_count; i++)
+	for (size_t i = 0; i <= breakpoint_count; i++)
 	{
-		right = (*p_breakpoints)[i];
-
+		right = ((i < breakpoint_count) ? (double)(*p_breakpoints)[i] : (double)chromosome_.last_position_ + 1);
+		
 		tsk_id_t parent = (tsk_id_t) (polarity ? genome1TSKID : genome2TSKID);
-		int ret = tsk_edge_table_add_row(&tables_.edges,left,right,parent,offspringTSKID);
-		if (ret < 0) handle_error("add_edge", ret);
+		
+		if (right > left)
+		{
+			if ((buffered_edge_left_.size() > first_edge_index) && (buffered_edge_parent_.back() == parent) && (buffered_edge_right_.back() == left))
+			{
+				buffered_edge_right_.back() = right;
+			}
+			else
+			{
+				buffered_edge_left_.emplace_back(left);
+				buffered_edge_right_.emplace_back(right);
+				buffered_edge_parent_.emplace_back(parent);
+				buffered_edge_child_.emplace_back(offspringTSKID);
+			}
+		}
 		
 		polarity = !polarity;
 		left = right;
 	}
-	
-	right = (double)chromosome_.last_position_+1;
-	tsk_id_t parent = (tsk_id_t) (polarity ? genome1TSKID : genome2TSKID);
-	int ret = tsk_edge_table_add_row(&tables_.edges,left,right,parent,offspringTSKID);
-	if (ret < 0) handle_error("add_edge", ret);
 }
 
 void SLiMSim::RecordNewDerivedState(const Genome *p_genome, slim_position_t p_position, const std::vector<Mutation *> &p_derived_mutations)
@@ -5074,9 +5622,11 @@ void SLiMSim::RecordNewDerivedState(const Genome *p_genome, slim_position_t p_po
 
     // Identify any previous mutations at this site in this genome, and add a new site.
 	// This site may already exist, but we add it anyway, and deal with that in deduplicate_sites().
+	// The site and mutation rows are buffered, to be appended to tables_ by FlushTreeSequenceBuffers().
     double tsk_position = (double) p_position;
-
-    tsk_id_t site_id = tsk_site_table_add_row(&tables_.sites, tsk_position, NULL, 0, NULL, 0);
+	tsk_id_t site_id = (tsk_id_t)(tables_.sites.num_rows + buffered_site_position_.size());
+	
+	buffered_site_position_.emplace_back(tsk_position);
 	
     // form derived state
 	static std::vector<slim_mutationid_t> derived_mutation_ids;
@@ -5115,11 +5665,13 @@ void SLiMSim::RecordNewDerivedState(const Genome *p_genome, slim_position_t p_po
     size_t derived_state_length = derived_mutation_ids.size() * sizeof(slim_mutationid_t);
     char *mutation_metadata_bytes = (char *)(mutation_metadata.data());
     size_t mutation_metadata_length = mutation_metadata.size() * sizeof(MutationMetadataRec);
-
-    int ret = tsk_mutation_table_add_row(&tables_.mutations, site_id, genomeTSKID, TSK_NULL, 
-                    derived_muts_bytes, (tsk_size_t)derived_state_length,
-                    mutation_metadata_bytes, (tsk_size_t)mutation_metadata_length);
-	if (ret < 0) handle_error("add_mutation", ret);
+	
+	buffered_mutation_site_.emplace_back(site_id);
+	buffered_mutation_node_.emplace_back(genomeTSKID);
+	buffered_mutation_derived_state_.insert(buffered_mutation_derived_state_.end(), derived_muts_bytes, derived_muts_bytes + derived_state_length);
+	buffered_mutation_derived_state_offset_.emplace_back((tsk_size_t)buffered_mutation_derived_state_.size());
+	buffered_mutation_metadata_.insert(buffered_mutation_metadata_.end(), mutation_metadata_bytes, mutation_metadata_bytes + mutation_metadata_length);
+	buffered_mutation_metadata_offset_.emplace_back((tsk_size_t)buffered_mutation_metadata_.size());
 }
 
 void SLiMSim::CheckAutoSimplification(void)
@@ -5134,69 +5686,224 @@ void SLiMSim::CheckAutoSimplification(void)
 	// time we simplify, we ask whether we simplified too early, too late, or just the right time by comparing
 	// the pre:post ratio of the tree recording table sizes to the desired pre:post ratio, simplification_ratio_,
 	// as set up in initializeTreeSeq().  Note that a simplification_ratio_ value of INF means "never simplify
-	// automatically"; we check for that up front.
+	// automatically"; we check for that up front.  With optimizeSimplification=T, the interval is instead chosen
+	// by a cost model; see OptimizeAutoSimplificationInterval().
 	++simplify_elapsed_;
 	
+	// If a background simplification was started in a previous generation, we incorporate its result now, before
+	// deciding whether to simplify again; this keeps the simplification schedule identical to synchronous simplification.
+	FinishBackgroundSimplification();
+	
+	bool simplify = false, adjust_interval = false;
+	
 	if (simplification_interval_ != -1)
 	{
 		// BCH 4/5/2019: Adding support for a chosen simplification interval rather than a ratio.  A value of -1
 		// means the simplification ratio is being used, as implemented below; any other value is a target interval.
-		if ((simplify_elapsed_ >= 1) && (simplify_elapsed_ >= simplification_interval_))
+		simplify = ((simplify_elapsed_ >= 1) && (simplify_elapsed_ >= simplification_interval_));
+	}
+	else if (optimize_simplification_ || !std::isinf(simplification_ratio_))
+	{
+		simplify = adjust_interval = (simplify_elapsed_ >= simplify_interval_);
+	}
+	
+	// A hard ceiling on table memory, if set with maxTableMemory, forces simplification regardless of the schedule; rows still
+	// buffered count toward it, since they are about to be appended to the tables.  The cost model also takes these forced
+	// simplifications into account, whereas the ratio-based heuristic does not
+	if (!simplify && (max_table_memory_ > 0) && (MemoryInUseForTables(tables_) + MemoryInUseForTreeSequenceBuffers() > max_table_memory_))
+		simplify = true, adjust_interval = optimize_simplification_;
+	
+	if (!simplify)
+		return;
+	
+	// with background simplification, the interval gets adjusted by FinishBackgroundSimplification() instead
+	if (simplify_in_background_)
+	{
+		StartBackgroundSimplification(adjust_interval);
+		return;
+	}
+	
+	// We could, in principle, calculate actual memory used based on number of rows * sizeof(column), etc.,
+	// but that seems like overkill; adding together the number of rows in all the tables should be a
+	// reasonable proxy, and this whole thing is just a heuristic that needs to be tailored anyway.
+	uint64_t old_table_size = TableRowCount(tables_);
+	
+	SimplifyTreeSequence();
+	
+	uint64_t new_table_size = TableRowCount(tables_);
+	
+	if (adjust_interval)
+		AdjustAutoSimplificationInterval(old_table_size, new_table_size);
+}
+
+uint64_t SLiMSim::TableRowCount(tsk_table_collection_t &p_tables)
+{
+	return (uint64_t)p_tables.nodes.num_rows + (uint64_t)p_tables.edges.num_rows + (uint64_t)p_tables.sites.num_rows + (uint64_t)p_tables.mutations.num_rows;
+}
+
+double SLiMSim::SimplificationWork(tsk_table_collection_t &p_tables, tsk_size_t p_sorted_edge_count)
+{
+	// The cost of a simplification, in arbitrary units, for RecordSimplificationCost(): every row is processed once, and the
+	// edges recorded since the last sort must also be sorted.  This is counted rather than timed, so that the simplification
+	// schedule chosen by optimizeSimplification=T is the same in every run of a model with a given seed.
+	double unsorted_edges = (double)(p_tables.edges.num_rows - std::min(p_sorted_edge_count, p_tables.edges.num_rows));
+	double work = (double)TableRowCount(p_tables);
+	
+	if (unsorted_edges > 1.0)
+		work += unsorted_edges * std::log2(unsorted_edges);
+	
+	return work;
+}
+
+void SLiMSim::RecordSimplificationCost(double p_work, int64_t p_generations, uint64_t p_rows_before, uint64_t p_rows_after, size_t p_bytes_before, size_t p_bytes_after)
+{
+	// A table memory ceiling below the size of the simplified tables forces simplification every generation; that is legal,
+	// but probably not what the user intended, so we say so once
+	if ((max_table_memory_ > 0) && (p_bytes_after >= max_table_memory_) && !warned_table_memory_ceiling_)
+	{
+		if (!gEidosSuppressWarnings)
+			SLIM_OUTSTREAM << "#WARNING (SLiMSim::RecordSimplificationCost): in generation " << generation_ << ", the simplified tree-sequence tables use " << p_bytes_after << " bytes, which is not below maxTableMemory (" << max_table_memory_ << " bytes); simplification will be forced at the end of every generation." << std::endl;
+		warned_table_memory_ceiling_ = true;
+	}
+	
+	// This keeps the statistics used by OptimizeAutoSimplificationInterval().  We model the work done by one
+	// simplification, from SimplificationWork(), as a power law, w = c * n^p, where n is the number of table rows
+	// before simplification; p is a little above 1 because of sorting.  We fit log(w) on log(n) by least squares,
+	// discounting older observations so that the fit tracks changes in the model's dynamics.  We also track the
+	// table growth per generation, in rows and in bytes.
+	if (!optimize_simplification_)
+		return;
+	
+	const double decay = 0.8;
+	
+	if ((p_work > 0.0) && (p_rows_before > 0))
+	{
+		double x = std::log((double)p_rows_before);
+		double y = std::log(p_work);
+		
+		simplify_cost_sums_[0] = simplify_cost_sums_[0] * decay + 1.0;
+		simplify_cost_sums_[1] = simplify_cost_sums_[1] * decay + x;
+		simplify_cost_sums_[2] = simplify_cost_sums_[2] * decay + y;
+		simplify_cost_sums_[3] = simplify_cost_sums_[3] * decay + x * x;
+		simplify_cost_sums_[4] = simplify_cost_sums_[4] * decay + x * y;
+		simplify_cost_observations_++;
+	}
+	
+	uint64_t new_rows = (p_rows_before > simplify_retained_rows_) ? (p_rows_before - simplify_retained_rows_) : 0;
+	size_t new_bytes = (p_bytes_before > simplify_retained_bytes_) ? (p_bytes_before - simplify_retained_bytes_) : 0;
+	
+	if ((p_generations > 0) && (new_rows > 0))
+	{
+		double growth_rows = new_rows / (double)p_generations;
+		double growth_bytes = new_bytes / (double)p_generations;
+		
+		if (simplify_growth_rows_ == 0.0)
 		{
-			SimplifyTreeSequence();
+			simplify_growth_rows_ = growth_rows;
+			simplify_growth_bytes_ = growth_bytes;
+		}
+		else
+		{
+			simplify_growth_rows_ = simplify_growth_rows_ * decay + growth_rows * (1.0 - decay);
+			simplify_growth_bytes_ = simplify_growth_bytes_ * decay + growth_bytes * (1.0 - decay);
 		}
 	}
-	else if (!std::isinf(simplification_ratio_))
+	
+	simplify_retained_rows_ = p_rows_after;
+	simplify_retained_bytes_ = p_bytes_after;
+}
+
+void SLiMSim::OptimizeAutoSimplificationInterval(void)
+{
+	// Choose the simplification interval k that minimizes the amortized cost of simplification per generation, using
+	// the model fitted by RecordSimplificationCost().  With R rows retained after simplification and g rows added per
+	// generation, simplifying every k generations costs J(k) = c * (R + k * g)^p / k per generation, which for p > 1 is
+	// minimized at k = R / ((p - 1) * g).  For p <= 1 longer intervals are always cheaper, so the interval is limited
+	// only by the maximum interval and the memory ceiling.  Until the fit is usable (which requires some spread in the
+	// table sizes observed) we probe longer intervals.  We move only part of the way towards the optimum each time,
+	// and by at most a factor of two, so that the interval settles down instead of hunting in response to noise.
+	double target_interval = simplify_interval_ * 1.5;
+	
+	if ((simplify_cost_observations_ >= 3) && (simplify_growth_rows_ > 0.0))
 	{
-		if (simplify_elapsed_ >= simplify_interval_)
+		double w = simplify_cost_sums_[0], sx = simplify_cost_sums_[1], sy = simplify_cost_sums_[2];
+		double sxx = simplify_cost_sums_[3], sxy = simplify_cost_sums_[4];
+		double spread = w * sxx - sx * sx;
+		
+		if (spread > w * w * 0.01)		// a standard deviation of at least 0.1 in log(n)
 		{
-			// We could, in principle, calculate actual memory used based on number of rows * sizeof(column), etc.,
-			// but that seems like overkill; adding together the number of rows in all the tables should be a
-			// reasonable proxy, and this whole thing is just a heuristic that needs to be tailored anyway.
-			uint64_t old_table_size = (uint64_t)tables_.nodes.num_rows;
-            old_table_size += (uint64_t)tables_.edges.num_rows;
-            old_table_size += (uint64_t)tables_.sites.num_rows;
-            old_table_size += (uint64_t)tables_.mutations.num_rows;
-			
-			SimplifyTreeSequence();
+			double p = (w * sxy - sx * sy) / spread;
 			
-			uint64_t new_table_size = (uint64_t)tables_.nodes.num_rows;
-            new_table_size += (uint64_t)tables_.edges.num_rows;
-            new_table_size += (uint64_t)tables_.sites.num_rows;
-            new_table_size += (uint64_t)tables_.mutations.num_rows;
-			double ratio = old_table_size / (double)new_table_size;
-			
-			//std::cout << "auto-simplified in generation " << generation_ << "; old size " << old_table_size << ", new size " << new_table_size;
-			//std::cout << "; ratio " << ratio << ", target " << simplification_ratio_ << std::endl;
-			//std::cout << "old interval " << simplify_interval_ << ", new interval ";
-			
-			// Adjust our automatic simplification interval based upon the observed change in storage space used.
-			// Not sure if this is exactly what we want to do; this will hunt around a lot without settling on a value,
-			// but that seems harmless.  The scaling factor of 1.2 is chosen somewhat arbitrarily; we want it to be
-			// large enough that we will arrive at the optimum interval before too terribly long, but small enough
-			// that we have some granularity, so that once we reach the optimum we don't fluctuate too much.
-			if (ratio < simplification_ratio_)
-			{
-				// We simplified too soon; wait a little longer next time
-				simplify_interval_ *= 1.2;
-				
-				// Impose a maximum interval of 1000, so we don't get caught flat-footed if model demography changes
-				if (simplify_interval_ > 1000.0)
-					simplify_interval_ = 1000.0;
-			}
-			else if (ratio > simplification_ratio_)
-			{
-				// We simplified too late; wait a little less long next time
-				simplify_interval_ /= 1.2;
-				
-				// Impose a minimum interval of 1.0, just to head off weird underflow issues
-				if (simplify_interval_ < 1.0)
-					simplify_interval_ = 1.0;
-			}
-			
-			//std::cout << simplify_interval_ << std::endl;
+			if (p > 1.0)
+				target_interval = simplify_retained_rows_ / ((p - 1.0) * simplify_growth_rows_);
+			else
+				target_interval = 1000.0;
 		}
 	}
+	
+	target_interval = std::min(std::max(target_interval, simplify_interval_ / 2.0), simplify_interval_ * 2.0);
+	simplify_interval_ = std::sqrt(simplify_interval_ * std::max(target_interval, 1.0));
+	
+	// Respect the memory ceiling, if any, by not letting the tables grow past it before the next simplification
+	if ((max_table_memory_ > 0) && (simplify_growth_bytes_ > 0.0))
+	{
+		double memory_interval = ((double)max_table_memory_ - (double)simplify_retained_bytes_) / simplify_growth_bytes_;
+		
+		// if the simplified tables are already at the ceiling (which RecordSimplificationCost() warns about), this is every generation
+		memory_interval = std::max(memory_interval, 1.0);
+		
+		if (simplify_interval_ > memory_interval)
+			simplify_interval_ = memory_interval;
+	}
+	
+	// Use the same bounds as the ratio-based heuristic below
+	if (simplify_interval_ > 1000.0)
+		simplify_interval_ = 1000.0;
+	if (simplify_interval_ < 1.0)
+		simplify_interval_ = 1.0;
+	
+	//std::cout << "optimized simplification interval in generation " << generation_ << ": " << simplify_interval_ << std::endl;
+}
+
+void SLiMSim::AdjustAutoSimplificationInterval(uint64_t p_old_table_size, uint64_t p_new_table_size)
+{
+	if (optimize_simplification_)
+	{
+		OptimizeAutoSimplificationInterval();
+		return;
+	}
+	
+	double ratio = p_old_table_size / (double)p_new_table_size;
+	
+	//std::cout << "auto-simplified in generation " << generation_ << "; old size " << p_old_table_size << ", new size " << p_new_table_size;
+	//std::cout << "; ratio " << ratio << ", target " << simplification_ratio_ << std::endl;
+	//std::cout << "old interval " << simplify_interval_ << ", new interval ";
+	
+	// Adjust our automatic simplification interval based upon the observed change in storage space used.
+	// Not sure if this is exactly what we want to do; this will hunt around a lot without settling on a value,
+	// but that seems harmless.  The scaling factor of 1.2 is chosen somewhat arbitrarily; we want it to be
+	// large enough that we will arrive at the optimum interval before too terribly long, but small enough
+	// that we have some granularity, so that once we reach the optimum we don't fluctuate too much.
+	if (ratio < simplification_ratio_)
+	{
+		// We simplified too soon; wait a little longer next time
+		simplify_interval_ *= 1.2;
+		
+		// Impose a maximum interval of 1000, so we don't get caught flat-footed if model demography changes
+		if (simplify_interval_ > 1000.0)
+			simplify_interval_ = 1000.0;
+	}
+	else if (ratio > simplification_ratio_)
+	{
+		// We simplified too late; wait a little less long next time
+		simplify_interval_ /= 1.2;
+		
+		// Impose a minimum interval of 1.0, just to head off weird underflow issues
+		if (simplify_interval_ < 1.0)
+			simplify_interval_ = 1.0;
+	}
+	
+	//std::cout << simplify_interval_ << std::endl;
 }
 
 void SLiMSim::TreeSequenceDataFromAscii(std::string NodeFileName,
@@ -5500,6 +6207,7 @@ void SLiMSim::TreeSequenceDataFromAscii(std::string NodeFileName,
 
     // not sure if we need to do this here, but it doesn't hurt
 	RecordTablePosition();
+	crosscheck_index_valid_ = false;
 	
 	// We are done with our private copy of the table collection
 	tsk_table_collection_free(&tables_copy);
@@ -5756,111 +6464,181 @@ void SLiMSim::TreeSequenceDataToAscii(tsk_table_collection_t *p_tables)
 	tsk_table_collection_free(&tables_copy);
 }
 
+// Parses one text derived state, a comma-separated list of mutation ids, between p_text and p_text_end.  The ids are
+// counted into *p_id_count and, if p_id_out is non-null, written out through it.  Returns false if the text is malformed.
+static bool ParseAsciiDerivedState(const char *p_text, const char *p_text_end, slim_mutationid_t *p_id_out, size_t *p_id_count)
+{
+	size_t id_count = 0;
+	
+	while (p_text < p_text_end)
+	{
+		bool negative = (*p_text == '-');
+		int64_t id = 0;
+		
+		if (negative)
+			p_text++;
+		
+		const char *digits_start = p_text;
+		
+		while ((p_text < p_text_end) && (*p_text >= '0') && (*p_text <= '9'))
+			id = id * 10 + (*p_text++ - '0');
+		
+		if ((p_text == digits_start) || ((p_text < p_text_end) && (*p_text != ',')) || ((p_text + 1 == p_text_end) && (*p_text == ',')))
+			return false;
+		
+		if (p_id_out)
+			*p_id_out++ = (slim_mutationid_t)(negative ? -id : id);
+		
+		id_count++;
+		
+		if (p_text < p_text_end)
+			p_text++;		// skip the comma
+	}
+	
+	*p_id_count = id_count;
+	return true;
+}
+
 void SLiMSim::DerivedStatesFromAscii(tsk_table_collection_t *p_tables)
 {
 	// This modifies p_tables in place, replacing the derived_state column of p_tables with a binary version.
-	// See TreeSequenceDataFromAscii() for comments; this is basically just a pruned version of that method.
-	tsk_mutation_table_t mutations_copy;
-	int ret = tsk_mutation_table_copy(&p_tables->mutations, &mutations_copy, 0);
-	if (ret < 0) handle_error("derived_to_ascii", ret);
+	// The text is parsed straight out of the column into a new buffer that then replaces the column's buffer,
+	// and the offsets are rewritten in place, so no copy of the mutation table and no per-row strings are made.
+	// See TreeSequenceDataFromAscii() for the text-format equivalent, which also converts metadata.
+	tsk_mutation_table_t &mutations = p_tables->mutations;
+	const char *text_derived_state = mutations.derived_state;
+	tsk_size_t *derived_state_offset = mutations.derived_state_offset;
+	tsk_size_t num_rows = mutations.num_rows;
 	
+	// The first pass validates every row and counts the ids, without writing anything; a malformed derived state
+	// therefore raises with the table still intact, rather than with its offsets partially rewritten
+	size_t id_count = 0;
+	
+	for (tsk_size_t j = 0; j < num_rows; j++)
 	{
-		const char *derived_state = p_tables->mutations.derived_state;
-		tsk_size_t *derived_state_offset = p_tables->mutations.derived_state_offset;
-		std::vector<slim_mutationid_t> binary_derived_state;
-		std::vector<tsk_size_t> binary_derived_state_offset;
-		size_t derived_state_total_part_count = 0;
+		size_t row_id_count;
 		
-		binary_derived_state_offset.push_back(0);
+		if (!ParseAsciiDerivedState(text_derived_state + derived_state_offset[j], text_derived_state + derived_state_offset[j + 1], nullptr, &row_id_count))
+			EIDOS_TERMINATION << "ERROR (SLiMSim::DerivedStatesFromAscii): the derived state of mutation " << j << " is not a comma-separated list of mutation ids." << EidosTerminate();
 		
-		for (size_t j = 0; j < p_tables->mutations.num_rows; j++)
-		{
-			std::string string_derived_state(derived_state + derived_state_offset[j], derived_state_offset[j+1] - derived_state_offset[j]);
-			
-			if (string_derived_state.size() == 0)
-			{
-				// nothing to do for an empty derived state
-			}
-			else if (string_derived_state.find(",") == std::string::npos)
-			{
-				// a single mutation can be handled more efficiently, and this is the common case so it's worth optimizing
-				binary_derived_state.emplace_back((slim_mutationid_t)std::stoll(string_derived_state));
-				derived_state_total_part_count++;
-			}
-			else
-			{
-				// stacked mutations require that the derived state be separated to parse it
-				std::vector<std::string> derived_state_parts = Eidos_string_split(string_derived_state, ",");
-				
-				for (std::string &derived_state_part : derived_state_parts)
-					binary_derived_state.emplace_back((slim_mutationid_t)std::stoll(derived_state_part));
-				
-				derived_state_total_part_count += derived_state_parts.size();
-			}
-			
-			binary_derived_state_offset.push_back((tsk_size_t)(derived_state_total_part_count * sizeof(slim_mutationid_t)));
-		}
+		id_count += row_id_count;
+	}
+	
+	slim_mutationid_t *binary_derived_state = (slim_mutationid_t *)malloc(std::max(id_count, (size_t)1) * sizeof(slim_mutationid_t));
+	
+	if (!binary_derived_state)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::DerivedStatesFromAscii): allocation failed; you may need to raise the memory limit for SLiM." << EidosTerminate(nullptr);
+	
+	// The second pass parses into the new buffer and rewrites the offsets; every row is known to be well-formed now
+	slim_mutationid_t *id_ptr = binary_derived_state;
+	tsk_size_t row_start = derived_state_offset[0];
+	
+	for (tsk_size_t j = 0; j < num_rows; j++)
+	{
+		tsk_size_t row_end = derived_state_offset[j + 1];
+		size_t row_id_count;
 		
-		if (binary_derived_state.size() == 0)
-			binary_derived_state.resize(1);
+		ParseAsciiDerivedState(text_derived_state + row_start, text_derived_state + row_end, id_ptr, &row_id_count);
+		id_ptr += row_id_count;
 		
-		ret = tsk_mutation_table_set_columns(&p_tables->mutations,
-										 mutations_copy.num_rows,
-										 mutations_copy.site,
-										 mutations_copy.node,
-										 mutations_copy.parent,
-										 (char *)binary_derived_state.data(),
-										 binary_derived_state_offset.data(),
-										 mutations_copy.metadata,
-										 mutations_copy.metadata_offset);
-		if (ret < 0) handle_error("convert_from_ascii", ret);
+		row_start = row_end;	// fetched before the offset is overwritten below
+		derived_state_offset[j + 1] = (tsk_size_t)((id_ptr - binary_derived_state) * sizeof(slim_mutationid_t));
+	}
+	
+	derived_state_offset[0] = 0;
+	
+	// Swap in the new column; tskit allocates its columns with malloc() and frees them with free(), so this is safe
+	free(mutations.derived_state);
+	mutations.derived_state = (char *)binary_derived_state;
+	mutations.derived_state_length = (tsk_size_t)(id_count * sizeof(slim_mutationid_t));
+	mutations.max_derived_state_length = (tsk_size_t)(std::max(id_count, (size_t)1) * sizeof(slim_mutationid_t));
+}
+
+static inline size_t DecimalDigitCount(uint64_t p_value)
+{
+	size_t digits = 1;
+	
+	while (p_value >= 10)
+	{
+		p_value /= 10;
+		digits++;
 	}
 	
-	tsk_mutation_table_free(&mutations_copy);
+	return digits;
 }
 
 void SLiMSim::DerivedStatesToAscii(tsk_table_collection_t *p_tables)
 {
 	// This modifies p_tables in place, replacing the derived_state column of p_tables with an ASCII version.
-	// See TreeSequenceDataToAscii() for comments; this is basically just a pruned version of that method.
-	tsk_mutation_table_t mutations_copy;
-	int ret = tsk_mutation_table_copy(&p_tables->mutations, &mutations_copy, 0);
-	if (ret < 0) handle_error("derived_to_ascii", ret);
+	// Like DerivedStatesFromAscii(), this formats the ids straight into a new buffer, sized exactly by a first
+	// pass, that replaces the column's buffer.  See TreeSequenceDataToAscii() for the text-format equivalent.
+	tsk_mutation_table_t &mutations = p_tables->mutations;
+	const slim_mutationid_t *binary_derived_state = (const slim_mutationid_t *)mutations.derived_state;
+	tsk_size_t *derived_state_offset = mutations.derived_state_offset;
+	tsk_size_t num_rows = mutations.num_rows;
 	
+	// Measure the text: the digits of every id, a sign for any negative id, and a comma between ids within a row
+	size_t text_length = 0;
+	
+	for (tsk_size_t j = 0; j < num_rows; j++)
 	{
-		const char *derived_state = p_tables->mutations.derived_state;
-		tsk_size_t *derived_state_offset = p_tables->mutations.derived_state_offset;
-		std::string text_derived_state;
-		std::vector<tsk_size_t> text_derived_state_offset;
+		size_t first_id = derived_state_offset[j] / sizeof(slim_mutationid_t);
+		size_t last_id = derived_state_offset[j + 1] / sizeof(slim_mutationid_t);
 		
-		text_derived_state_offset.push_back(0);
+		if (last_id > first_id)
+			text_length += (last_id - first_id) - 1;
 		
-		for (size_t j = 0; j < p_tables->mutations.num_rows; j++)
+		for (size_t i = first_id; i < last_id; i++)
 		{
-			slim_mutationid_t *int_derived_state = (slim_mutationid_t *)(derived_state + derived_state_offset[j]);
-			size_t cur_derived_state_length = (derived_state_offset[j+1] - derived_state_offset[j])/sizeof(slim_mutationid_t);
+			slim_mutationid_t id = binary_derived_state[i];
 			
-			for (size_t i = 0; i < cur_derived_state_length; i++)
+			text_length += (id < 0) ? 1 + DecimalDigitCount((uint64_t)0 - (uint64_t)id) : DecimalDigitCount((uint64_t)id);
+		}
+	}
+	
+	char *text_derived_state = (char *)malloc(std::max(text_length, (size_t)1));
+	
+	if (!text_derived_state)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::DerivedStatesToAscii): allocation failed; you may need to raise the memory limit for SLiM." << EidosTerminate(nullptr);
+	
+	char *text_ptr = text_derived_state;
+	size_t first_id = derived_state_offset[0] / sizeof(slim_mutationid_t);
+	
+	for (tsk_size_t j = 0; j < num_rows; j++)
+	{
+		size_t last_id = derived_state_offset[j + 1] / sizeof(slim_mutationid_t);
+		
+		for (size_t i = first_id; i < last_id; i++)
+		{
+			slim_mutationid_t id = binary_derived_state[i];
+			uint64_t magnitude = (id < 0) ? (uint64_t)0 - (uint64_t)id : (uint64_t)id;
+			size_t digits = DecimalDigitCount(magnitude);
+			
+			if (i != first_id)
+				*text_ptr++ = ',';
+			if (id < 0)
+				*text_ptr++ = '-';
+			
+			for (size_t digit_index = digits; digit_index > 0; --digit_index)
 			{
-				if (i != 0) text_derived_state.append(",");
-				text_derived_state.append(std::to_string(int_derived_state[i]));
+				text_ptr[digit_index - 1] = (char)('0' + (magnitude % 10));
+				magnitude /= 10;
 			}
-			text_derived_state_offset.push_back((tsk_size_t)text_derived_state.size());
+			
+			text_ptr += digits;
 		}
 		
-		ret = tsk_mutation_table_set_columns(&p_tables->mutations,
-										 mutations_copy.num_rows,
-										 mutations_copy.site,
-										 mutations_copy.node,
-										 mutations_copy.parent,
-										 text_derived_state.c_str(),
-										 text_derived_state_offset.data(),
-										 mutations_copy.metadata,
-										 mutations_copy.metadata_offset);
-		if (ret < 0) handle_error("derived_to_ascii", ret);
+		first_id = last_id;		// fetch before the offset is overwritten
+		derived_state_offset[j + 1] = (tsk_size_t)(text_ptr - text_derived_state);
 	}
 	
-	tsk_mutation_table_free(&mutations_copy);
+	derived_state_offset[0] = 0;
+	
+	// Swap in the new column; tskit allocates its columns with malloc() and frees them with free(), so this is safe
+	free(mutations.derived_state);
+	mutations.derived_state = text_derived_state;
+	mutations.derived_state_length = (tsk_size_t)text_length;
+	mutations.max_derived_state_length = (tsk_size_t)std::max(text_length, (size_t)1);
 }
 
 void SLiMSim::AddIndividualsToTable(Individual * const *p_individual, size_t p_num_individuals, tsk_table_collection_t *p_tables, uint32_t p_flags)
@@ -5881,6 +6659,10 @@ void SLiMSim::AddIndividualsToTable(Individual * const *p_individual, size_t p_n
 	if (p_tables == nullptr)
 		p_tables = &tables_;
 	
+	// the nodes of the individuals may still be buffered
+	if (p_tables == &tables_)
+		FlushTreeSequenceBuffers();
+	
 	// construct the map of currently remembered individuals first; these are not really just those
 	// that are "remembered", but all individuals that are currently in the tables
     std::vector<slim_pedigreeid_t> remembered_individuals;
@@ -6422,6 +7204,9 @@ void SLiMSim::WriteTreeSequence(std::string &p_recording_tree_path, bool p_binar
     // and write out to text files in that directory
 	int ret = 0;
 	
+	// incorporate any background simplification first, since we need the current state of the tables
+	FinishBackgroundSimplification();
+	
 	// Standardize the path, resolving a leading ~ and maybe other things
 	std::string path = Eidos_ResolvedPath(Eidos_StripTrailingSlash(p_recording_tree_path));
 	
@@ -6439,8 +7224,11 @@ void SLiMSim::WriteTreeSequence(std::string &p_recording_tree_path, bool p_binar
 	else
 	{
         // this is done by SimplifyTreeSequence() but we need to do in any case
-		ret = tsk_table_collection_sort(&tables_, /* edge_start */ 0, /* flags */ 0);
-        if (ret < 0) handle_error("tsk_table_collection_sort", ret);
+		ret = SortTreeSequenceTables(&tables_, sorted_edge_count_);
+		if (ret < 0) handle_error("tsk_table_collection_sort", ret);
+		
+		sorted_edge_count_ = tables_.edges.num_rows;
+		crosscheck_index_valid_ = false;
 		
         // Remove redundant sites we added
         ret = tsk_table_collection_deduplicate_sites(&tables_, 0);
@@ -6452,6 +7240,14 @@ void SLiMSim::WriteTreeSequence(std::string &p_recording_tree_path, bool p_binar
 	ret = tsk_table_collection_copy(&tables_, &output_tables, 0);
 	if (ret < 0) handle_error("tsk_table_collection_copy", ret);
 	
+	// Drop mutations of overlaid mutation types onto the copy; they exist only in the output, never in SLiM or in tables_
+	if (chromosome_.overlay_subranges_H_.size() || chromosome_.overlay_subranges_M_.size() || chromosome_.overlay_subranges_F_.size())
+		OverlayMutations(&output_tables);
+	
+	// Coalescent history is marked only so that it gets overlaid; once written out, it is like any other loaded history
+	for (tsk_size_t node_index = 0; node_index < output_tables.nodes.num_rows; ++node_index)
+		output_tables.nodes.flags[node_index] &= ~SLIM_TSK_NODE_COALESCENT;
+	
 	// Add in the mutation.parent information; valid tree sequences need parents, but we don't keep them while running
 	ret = tsk_table_collection_build_index(&output_tables, 0);
 	if (ret < 0) handle_error("tsk_table_collection_build_index", ret);
@@ -6467,133 +7263,669 @@ void SLiMSim::WriteTreeSequence(std::string &p_recording_tree_path, bool p_binar
 	// SLiM so that when we read back in it doesn't cause a reordering as a side effect
 	std::vector<int> individual_map;
 	
-	for (const std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : population_.subpops_)
+	for (const std::pair<const slim_objectid_t,Subpopulation*> &subpop_pair : population_.subpops_)
+	{
+		Subpopulation *subpop = subpop_pair.second;
+		
+		for (Individual *individual : subpop->parent_individuals_)
+		{
+			tsk_id_t node_id = individual->genome1_->tsk_node_id_;
+			tsk_id_t ind_id = output_tables.nodes.individual[node_id];
+			
+			individual_map.push_back(ind_id);
+		}
+	}
+
+	// all other individuals in the table will be retained, at the end
+	ReorderIndividualTable(&output_tables, individual_map, true);
+	
+	// Unmark "first generation" nodes as samples (but, retaining their information!)
+	UnmarkFirstGenerationSamples(&output_tables);
+	
+	// Rebase the times in the nodes to be in tskit-land; see _InstantiateSLiMObjectsFromTables() for the inverse operation
+	// BCH 4/4/2019: switched to using tree_seq_generation_ to avoid a parent/child timestamp conflict
+	// This makes sense; as far as tree-seq recording is concerned, tree_seq_generation_ is the generation counter
+	slim_generation_t time_adjustment = tree_seq_generation_;
+	
+	for (size_t node_index = 0; node_index < output_tables.nodes.num_rows; ++node_index)
+		output_tables.nodes.time[node_index] += time_adjustment;
+	
+	// Add a row to the Provenance table to record current state; text format does not allow newlines in the entry,
+	// so we don't prettyprint the JSON when going to text, as a quick fix that avoids quoting the newlines etc.
+    WriteProvenanceTable(&output_tables, /* p_use_newlines */ p_binary);
+	
+	// Write out the copied tables
+    if (p_binary)
+	{
+		// derived state data must be in ASCII (or unicode) on disk, according to tskit policy
+		DerivedStatesToAscii(&output_tables);
+		
+		ret = tsk_table_collection_dump(&output_tables, path.c_str(), 0);
+		if (ret < 0) handle_error("tsk_table_collection_dump", ret);
+		
+		// In nucleotide-based models, write out the ancestral sequence, re-opening the kastore to append
+		if (nucleotide_based_)
+		{
+			std::size_t buflen = chromosome_.AncestralSequence()->size();
+			char *buffer;	// kastore needs to provide us with a memory location to which to write the data
+			kastore_t store;
+			
+			buffer = (char *)malloc(buflen);
+			chromosome_.AncestralSequence()->WriteNucleotidesToBuffer(buffer);
+			
+			ret = kastore_open(&store, path.c_str(), "a", 0);
+			if (ret < 0) handle_error("kastore_open", ret);
+				
+			kastore_oputs_int8(&store, "reference_sequence/data", (int8_t *)buffer, buflen, 0);
+			if (ret < 0) handle_error("kastore_oputs_int8", ret);
+			
+			ret = kastore_close(&store);
+			if (ret < 0) handle_error("kastore_close", ret);
+			
+			// kastore owns buffer now, so we do not free it
+		}
+    }
+	else
+	{
+        std::string error_string;
+        bool success = Eidos_CreateDirectory(path, &error_string);
+		
+		if (success)
+		{
+            // first translate the bytes we've put into mutation derived state into printable ascii
+            TreeSequenceDataToAscii(&output_tables);
+			
+			std::string NodeFileName = path + "/NodeTable.txt";
+			std::string EdgeFileName = path + "/EdgeTable.txt";
+			std::string SiteFileName = path + "/SiteTable.txt";
+			std::string MutationFileName = path + "/MutationTable.txt";
+			std::string IndividualFileName = path + "/IndividualTable.txt";
+			std::string PopulationFileName = path + "/PopulationTable.txt";
+			std::string ProvenanceFileName = path + "/ProvenanceTable.txt";
+			
+			FILE *MspTxtNodeTable = fopen(NodeFileName.c_str(), "w");
+			FILE *MspTxtEdgeTable = fopen(EdgeFileName.c_str(), "w");
+			FILE *MspTxtSiteTable = fopen(SiteFileName.c_str(), "w");
+			FILE *MspTxtMutationTable = fopen(MutationFileName.c_str(), "w");
+			FILE *MspTxtIndividualTable = fopen(IndividualFileName.c_str(), "w");
+			FILE *MspTxtPopulationTable = fopen(PopulationFileName.c_str(), "w");
+			FILE *MspTxtProvenanceTable = fopen(ProvenanceFileName.c_str(), "w");
+			
+			tsk_node_table_dump_text(&output_tables.nodes, MspTxtNodeTable);
+			tsk_edge_table_dump_text(&output_tables.edges, MspTxtEdgeTable);
+			tsk_site_table_dump_text(&output_tables.sites, MspTxtSiteTable);
+			tsk_mutation_table_dump_text(&output_tables.mutations, MspTxtMutationTable);
+			tsk_individual_table_dump_text(&output_tables.individuals, MspTxtIndividualTable);
+			tsk_population_table_dump_text(&output_tables.populations, MspTxtPopulationTable);
+			tsk_provenance_table_dump_text(&output_tables.provenances, MspTxtProvenanceTable);
+			
+			fclose(MspTxtNodeTable);
+			fclose(MspTxtEdgeTable);
+			fclose(MspTxtSiteTable);
+			fclose(MspTxtMutationTable);
+			fclose(MspTxtIndividualTable);
+			fclose(MspTxtPopulationTable);
+			fclose(MspTxtProvenanceTable);
+			
+			// In nucleotide-based models, write out the ancestral sequence as a separate text file
+			if (nucleotide_based_)
+			{
+				std::string RefSeqFileName = path + "/ReferenceSequence.txt";
+				std::ofstream outfile;
+				
+				outfile.open(RefSeqFileName, std::ofstream::out);
+				if (!outfile.is_open())
+					EIDOS_TERMINATION << "ERROR (SLiMSim::WriteTreeSequence): treeSeqOutput() could not open "<< RefSeqFileName << "." << EidosTerminate();
+				
+				outfile << *(chromosome_.AncestralSequence());
+				outfile.close();
+			}
+		}
+		else
+		{
+			EIDOS_TERMINATION << "ERROR (SLiMSim::WriteTreeSequence): unable to create output folder for treeSeqOutput() (" << error_string << ")" << EidosTerminate();
+		}
+    }
+	
+	// Done with our tables copy
+	tsk_table_collection_free(&output_tables);
+}	
+
+
+void SLiMSim::WriteTreeSequenceCheckpoint(void)
+{
+	// A checkpoint is an ordinary simplified binary .trees file, so a long run can be restarted from it with
+	// readFromPopulationFile().  It is written to a temporary file beside the checkpoint path and then renamed
+	// over it; rename() is atomic, so a run killed partway through writing leaves the previous checkpoint intact.
+	std::string path = Eidos_ResolvedPath(checkpoint_path_);
+	std::string temp_path = path + ".tmp";
+	
+	WriteTreeSequence(temp_path, true, true);
+	
+	if (rename(temp_path.c_str(), path.c_str()) != 0)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::WriteTreeSequenceCheckpoint): unable to move the tree-sequence checkpoint into place at " << path << " (" << strerror(errno) << ")." << EidosTerminate();
+}
+
+
+void SLiMSim::ResolveOverlayMutationTypes(void)
+{
+	// Called at the end of initialization, once all mutation types are defined, to mark the mutation types that
+	// were given to initializeTreeSeq() as overlaid; genomic element types then stop drawing them, and the chromosome
+	// builds a separate rate map for them in InitializeDraws(), which our caller does next
+	if (overlay_mutation_type_ids_.size() == 0)
+		return;
+	
+	if (nucleotide_based_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ResolveOverlayMutationTypes): overlaid mutation types are not supported in nucleotide-based models." << EidosTerminate();
+	if (!recording_mutations_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ResolveOverlayMutationTypes): overlaid mutation types require recordMutations=T in initializeTreeSeq()." << EidosTerminate();
+	
+	for (slim_objectid_t mutation_type_id : overlay_mutation_type_ids_)
+	{
+		auto found_muttype_pair = mutation_types_.find(mutation_type_id);
+		
+		if (found_muttype_pair == mutation_types_.end())
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ResolveOverlayMutationTypes): overlayMutationTypes refers to mutation type m" << mutation_type_id << ", which is not defined." << EidosTerminate();
+		
+		MutationType *muttype = found_muttype_pair->second;
+		
+		if ((muttype->dfe_type_ != DFEType::kFixed) || (muttype->dfe_parameters_.size() != 1) || (muttype->dfe_parameters_[0] != 0.0))
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ResolveOverlayMutationTypes): overlaid mutation type m" << mutation_type_id << " must be neutral (a DFE of type 'f' with a selection coefficient of 0.0)." << EidosTerminate();
+		
+		muttype->overlay_ = true;
+	}
+	
+	for (auto getype_iter : genomic_element_types_)
+		getype_iter.second->InitializeDraws();
+}
+
+void SLiMSim::OverlayMutations(tsk_table_collection_t *p_tables)
+{
+	// Drop mutations of the overlaid mutation types onto the genealogy in p_tables, as if they had been simulated.  Each edge
+	// is a branch along which its child's ancestry passes through (time[child] - time[parent]) generations of inheritance
+	// over [left, right), so it receives a Poisson number of mutations with mean equal to that span times the overlay mutation
+	// rate integrated over [left, right), placed according to the overlay rate map and assigned a type according to the
+	// mutation fractions of the genomic element they fall in.  Only generations after overlay_start_generation_ are used, so
+	// a model loaded from a .trees file does not overlay mutations again onto history that was already present in the file;
+	// branches in coalescent history from addSubpopFromCoalescent() are covered completely, since no file has included them yet.
+	// Each new mutation gets its own new site, so an overlaid mutation that falls at a position that already has a site is
+	// discarded, as is the second of two overlaid mutations at the same position; at realistic mutation rates this is rare.
+	// Node times in p_tables are still SLiM's (negative) generation times at this point; see WriteTreeSequence().
+	std::vector<std::pair<const std::vector<OverlaySubrange> *, double>> overlay_maps;
+	
+	if (chromosome_.UsingSingleMutationMap())
+	{
+		overlay_maps.emplace_back(&chromosome_.overlay_subranges_H_, 1.0);
+	}
+	else
+	{
+		// with separate mutation rate maps for the sexes, each generation of inheritance goes through either sex equally often
+		overlay_maps.emplace_back(&chromosome_.overlay_subranges_M_, 0.5);
+		overlay_maps.emplace_back(&chromosome_.overlay_subranges_F_, 0.5);
+	}
+	
+	struct OverlayCandidate {
+		slim_position_t position_;
+		tsk_id_t node_;
+		MutationType *mutation_type_ptr_;
+		slim_objectid_t subpop_index_;
+		slim_generation_t origin_generation_;
+	};
+	std::vector<OverlayCandidate> candidates;
+	
+	for (auto &overlay_map : overlay_maps)
+	{
+		const std::vector<OverlaySubrange> &subranges = *overlay_map.first;
+		size_t subrange_count = subranges.size();
+		
+		if (subrange_count == 0)
+			continue;
+		
+		// the cumulative overlay rate at the start of each subrange, so that the rate over any interval is a difference of two lookups
+		std::vector<double> cumulative_rate(subrange_count + 1);
+		
+		cumulative_rate[0] = 0.0;
+		for (size_t subrange_index = 0; subrange_index < subrange_count; ++subrange_index)
+			cumulative_rate[subrange_index + 1] = cumulative_rate[subrange_index] + subranges[subrange_index].rate_ * (subranges[subrange_index].end_position_ - subranges[subrange_index].start_position_ + 1);
+		
+		auto rate_before = [&subranges, &cumulative_rate](double p_position) {
+			auto subrange_iter = std::upper_bound(subranges.begin(), subranges.end(), p_position, [](double p_pos, const OverlaySubrange &p_subrange) { return p_pos < p_subrange.start_position_; });
+			
+			if (subrange_iter == subranges.begin())
+				return 0.0;
+			
+			size_t subrange_index = (subrange_iter - subranges.begin()) - 1;
+			const OverlaySubrange &subrange = subranges[subrange_index];
+			
+			return cumulative_rate[subrange_index] + subrange.rate_ * (std::min(p_position, (double)subrange.end_position_ + 1) - subrange.start_position_);
+		};
+		
+		for (tsk_size_t edge_index = 0; edge_index < p_tables->edges.num_rows; ++edge_index)
+		{
+			tsk_id_t child = p_tables->edges.child[edge_index];
+			tsk_id_t parent = p_tables->edges.parent[edge_index];
+			double child_generation = -p_tables->nodes.time[child];
+			double parent_generation = -p_tables->nodes.time[parent];
+			double branch_start = (p_tables->nodes.flags[parent] & SLIM_TSK_NODE_COALESCENT) ? parent_generation : std::max(parent_generation, (double)overlay_start_generation_);
+			double branch_generations = child_generation - branch_start;
+			
+			if (branch_generations <= 0.0)
+				continue;
+			
+			double rate_left = rate_before(p_tables->edges.left[edge_index]);
+			double rate_right = rate_before(p_tables->edges.right[edge_index]);
+			double expected_count = (rate_right - rate_left) * branch_generations * overlay_map.second;
+			
+			if (expected_count <= 0.0)
+				continue;
+			
+			unsigned int mutation_count = gsl_ran_poisson(overlay_rng_.gsl_rng_, expected_count);
+			
+			for (unsigned int mutation_index = 0; mutation_index < mutation_count; ++mutation_index)
+			{
+				// choose a position by inverting the cumulative rate map
+				double target_rate = rate_left + Eidos_rng_uniform(overlay_rng_.gsl_rng_) * (rate_right - rate_left);
+				size_t subrange_index = (std::upper_bound(cumulative_rate.begin(), cumulative_rate.begin() + subrange_count, target_rate) - cumulative_rate.begin()) - 1;
+				const OverlaySubrange &subrange = subranges[subrange_index];
+				slim_position_t position = subrange.start_position_ + (slim_position_t)((target_rate - cumulative_rate[subrange_index]) / subrange.rate_);
+				
+				position = std::max(position, std::max(subrange.start_position_, (slim_position_t)p_tables->edges.left[edge_index]));
+				position = std::min(position, std::min(subrange.end_position_, (slim_position_t)p_tables->edges.right[edge_index] - 1));
+				
+				// choose an overlaid mutation type according to the genomic element type's mutation fractions
+				GenomicElementType &ge_type = *subrange.genomic_element_type_ptr_;
+				double fraction_total = 0.0;
+				
+				for (size_t type_index = 0; type_index < ge_type.mutation_type_ptrs_.size(); ++type_index)
+					if (ge_type.mutation_type_ptrs_[type_index]->overlay_)
+						fraction_total += ge_type.mutation_fractions_[type_index];
+				
+				double fraction_target = Eidos_rng_uniform(overlay_rng_.gsl_rng_) * fraction_total;
+				MutationType *mutation_type_ptr = nullptr;
+				
+				for (size_t type_index = 0; type_index < ge_type.mutation_type_ptrs_.size(); ++type_index)
+				{
+					if (ge_type.mutation_type_ptrs_[type_index]->overlay_)
+					{
+						mutation_type_ptr = ge_type.mutation_type_ptrs_[type_index];
+						fraction_target -= ge_type.mutation_fractions_[type_index];
+						
+						if (fraction_target < 0.0)
+							break;
+					}
+				}
+				
+				// choose the generation of origin uniformly within the part of the branch being overlaid
+				slim_generation_t first_generation = (slim_generation_t)std::floor(branch_start);
+				slim_generation_t last_generation = (slim_generation_t)std::floor(child_generation);
+				slim_generation_t origin_generation = last_generation;
+				
+				if (last_generation > first_generation)
+					origin_generation = first_generation + 1 + (slim_generation_t)Eidos_rng_uniform_int(overlay_rng_.gsl_rng_, (uint32_t)(last_generation - first_generation));
+				
+				candidates.emplace_back(OverlayCandidate{position, child, mutation_type_ptr, p_tables->nodes.population[child], origin_generation});
+			}
+		}
+	}
+	
+	if (candidates.size() == 0)
+		return;
+	
+	std::stable_sort(candidates.begin(), candidates.end(), [](const OverlayCandidate &p_a, const OverlayCandidate &p_b) { return p_a.position_ < p_b.position_; });
+	
+	// the sites table is sorted at this point, so existing sites can be found by binary search
+	const double *site_positions = p_tables->sites.position;
+	const double *site_positions_end = site_positions + p_tables->sites.num_rows;
+	slim_position_t previous_position = -1;
+	int ret;
+	
+	// Overlaid mutations exist only in this output, so they are numbered upward from gSLiM_next_mutation_id without advancing it;
+	// their ids are thus distinct from those of all simulated mutations in the output, and the model's own ids are unaffected.
+	// If the output is loaded later, the loaded mutations advance gSLiM_next_mutation_id past these ids in the usual way.
+	slim_mutationid_t overlay_mutation_id = gSLiM_next_mutation_id;
+	
+	for (OverlayCandidate &candidate : candidates)
+	{
+		if ((candidate.position_ == previous_position) || std::binary_search(site_positions, site_positions_end, (double)candidate.position_))
+			continue;
+		
+		previous_position = candidate.position_;
+		
+		MutationMetadataRec metadata_rec;
+		slim_mutationid_t mutation_id = overlay_mutation_id++;
+		
+		// overlaid mutation types are always of DFE type "f" (see ResolveOverlayMutationTypes()), so no draw is needed here
+		metadata_rec.mutation_type_id_ = candidate.mutation_type_ptr_->mutation_type_id_;
+		metadata_rec.selection_coeff_ = static_cast<slim_selcoeff_t>(candidate.mutation_type_ptr_->dfe_parameters_[0]);
+		metadata_rec.subpop_index_ = candidate.subpop_index_;
+		metadata_rec.origin_generation_ = candidate.origin_generation_;
+		metadata_rec.nucleotide_ = -1;
+		
+		tsk_id_t site_id = tsk_site_table_add_row(&p_tables->sites, (double)candidate.position_, NULL, 0, NULL, 0);
+		if (site_id < 0) handle_error("tsk_site_table_add_row", site_id);
+		
+		ret = tsk_mutation_table_add_row(&p_tables->mutations, site_id, candidate.node_, TSK_NULL, (char *)&mutation_id, (tsk_size_t)sizeof(slim_mutationid_t), (char *)&metadata_rec, (tsk_size_t)sizeof(MutationMetadataRec));
+		if (ret < 0) handle_error("tsk_mutation_table_add_row", ret);
+	}
+	
+	// the new sites were appended, so the sites and mutations need to be sorted again; the edges are already sorted
+	ret = SortTreeSequenceTables(p_tables, p_tables->edges.num_rows);
+	if (ret < 0) handle_error("SortTreeSequenceTables", ret);
+}
+
+
+void SLiMSim::AddCoalescentAncestry(Subpopulation *p_subpop, double p_effective_size)
+{
+	// Give the genomes of a newly created subpopulation an ancestry drawn from the coalescent with recombination (Hudson's
+	// algorithm), as if the subpopulation had existed at size p_effective_size forever; this replaces a long forward burn-in.
+	// Each lineage is a list of segments of the chromosome that it carries ancestral material for.  A lineage recombines at
+	// the rate given by the recombination map over the span of its segments, and each pair of lineages coalesces at rate
+	// 1/(2Ne) per generation.  Where two coalescing lineages overlap, a new ancestral node is created with edges down to the
+	// two overlapping nodes; material is dropped from the lineages once it has found its most recent common ancestor, and we
+	// finish when no material remains.  The new nodes and edges go straight into tables_, older than the genomes' own nodes,
+	// so the result is just like a recapitated tree sequence.  The new nodes are marked with SLIM_TSK_NODE_COALESCENT, so
+	// that OverlayMutations() knows to overlay mutations on this history; no other mutations are placed in it.
+	struct CoalescentSegment {
+		slim_position_t left_;
+		slim_position_t right_;
+		tsk_id_t node_;
+	};
+	
+	// the genomes' own nodes may still be buffered, and our nodes need to come after them in the node table
+	FlushTreeSequenceBuffers();
+	
+	slim_position_t sequence_length = chromosome_.last_position_ + 1;
+	std::vector<std::vector<CoalescentSegment>> lineages;
+	double sample_time = 0.0;
+	
+	for (Genome *genome : p_subpop->parent_genomes_)
+	{
+		if (genome->IsNull())
+			continue;
+		
+		lineages.emplace_back(std::vector<CoalescentSegment>{CoalescentSegment{0, sequence_length, genome->tsk_node_id_}});
+		sample_time = tables_.nodes.time[genome->tsk_node_id_];
+	}
+	
+	if (lineages.size() < 2)
+		return;
+	
+	// Build the recombination map as a cumulative rate over breakpoint positions 1..b; breakpoint b falls between bases
+	// b-1 and b, as in Chromosome::DrawBreakpoints().  With sex-specific maps ancestry passes through each sex equally often.
+	std::vector<slim_position_t> map_ends;
+	std::vector<double> map_rates;
+	
+	if (chromosome_.UsingSingleRecombinationMap())
 	{
-		Subpopulation *subpop = subpop_pair.second;
+		map_ends = chromosome_.recombination_end_positions_H_;
+		map_rates = chromosome_.recombination_rates_H_;
+	}
+	else
+	{
+		const std::vector<slim_position_t> &ends_M = chromosome_.recombination_end_positions_M_, &ends_F = chromosome_.recombination_end_positions_F_;
+		const std::vector<double> &rates_M = chromosome_.recombination_rates_M_, &rates_F = chromosome_.recombination_rates_F_;
+		size_t index_M = 0, index_F = 0;
 		
-		for (Individual *individual : subpop->parent_individuals_)
+		while ((index_M < ends_M.size()) && (index_F < ends_F.size()))
 		{
-			tsk_id_t node_id = individual->genome1_->tsk_node_id_;
-			tsk_id_t ind_id = output_tables.nodes.individual[node_id];
+			map_ends.emplace_back(std::min(ends_M[index_M], ends_F[index_F]));
+			map_rates.emplace_back((rates_M[index_M] + rates_F[index_F]) / 2.0);
 			
-			individual_map.push_back(ind_id);
+			if (ends_M[index_M] == map_ends.back()) index_M++;
+			if (ends_F[index_F] == map_ends.back()) index_F++;
 		}
 	}
-
-	// all other individuals in the table will be retained, at the end
-	ReorderIndividualTable(&output_tables, individual_map, true);
 	
-	// Unmark "first generation" nodes as samples (but, retaining their information!)
-	UnmarkFirstGenerationSamples(&output_tables);
+	std::vector<double> map_cumulative(map_ends.size());
 	
-	// Rebase the times in the nodes to be in tskit-land; see _InstantiateSLiMObjectsFromTables() for the inverse operation
-	// BCH 4/4/2019: switched to using tree_seq_generation_ to avoid a parent/child timestamp conflict
-	// This makes sense; as far as tree-seq recording is concerned, tree_seq_generation_ is the generation counter
-	slim_generation_t time_adjustment = tree_seq_generation_;
+	for (size_t map_index = 0; map_index < map_ends.size(); ++map_index)
+	{
+		slim_position_t previous_end = (map_index == 0) ? 0 : map_ends[map_index - 1];
+		
+		map_cumulative[map_index] = ((map_index == 0) ? 0.0 : map_cumulative[map_index - 1]) + map_rates[map_index] * (map_ends[map_index] - previous_end);
+	}
 	
-	for (size_t node_index = 0; node_index < output_tables.nodes.num_rows; ++node_index)
-		output_tables.nodes.time[node_index] += time_adjustment;
+	auto rate_through = [&map_ends, &map_rates, &map_cumulative](slim_position_t p_breakpoint) {
+		size_t map_index = std::lower_bound(map_ends.begin(), map_ends.end(), p_breakpoint) - map_ends.begin();
+		
+		if (map_index == map_ends.size())
+			return map_cumulative.back();
+		
+		slim_position_t previous_end = (map_index == 0) ? 0 : map_ends[map_index - 1];
+		
+		return ((map_index == 0) ? 0.0 : map_cumulative[map_index - 1]) + map_rates[map_index] * (p_breakpoint - previous_end);
+	};
 	
-	// Add a row to the Provenance table to record current state; text format does not allow newlines in the entry,
-	// so we don't prettyprint the JSON when going to text, as a quick fix that avoids quoting the newlines etc.
-    WriteProvenanceTable(&output_tables, /* p_use_newlines */ p_binary);
+	auto lineage_rate = [&rate_through](const std::vector<CoalescentSegment> &p_lineage) {
+		return rate_through(p_lineage.back().right_ - 1) - rate_through(p_lineage.front().left_);
+	};
 	
-	// Write out the copied tables
-    if (p_binary)
+	// Each lineage's recombination rate, and their total; the total is updated incrementally as lineages split and merge, in
+	// constant time per event, but is also re-summed exactly every 1024 events, and whenever the number of lineages has halved
+	// since it was last summed, so that rounding error from the incremental updates cannot build up over a long coalescent
+	std::vector<double> recombination_rates;
+	
+	for (std::vector<CoalescentSegment> &lineage : lineages)
+		recombination_rates.emplace_back(lineage_rate(lineage));
+	
+	auto sum_recombination_rates = [&recombination_rates]() {
+		double sum = 0.0;
+		
+		for (double rate : recombination_rates)
+			sum += rate;
+		
+		return sum;
+	};
+	
+	double total_recombination_rate = sum_recombination_rates();
+	size_t summed_lineage_count = lineages.size();
+	int events_since_sum = 0;
+	
+	// The number of lineages carrying ancestral material for each interval, keyed by the interval's start; the interval
+	// for a key runs to the next key.  When this count reaches 1, the interval has found its most recent common ancestor.
+	std::map<slim_position_t, size_t> ancestral_counts;
+	
+	ancestral_counts[0] = lineages.size();
+	ancestral_counts[sequence_length] = 0;
+	
+	auto split_counts_at = [&ancestral_counts](slim_position_t p_position) {
+		auto count_iter = ancestral_counts.upper_bound(p_position);
+		
+		--count_iter;
+		if (count_iter->first != p_position)
+			count_iter = ancestral_counts.emplace_hint(std::next(count_iter), p_position, count_iter->second);
+		
+		return count_iter;
+	};
+	
+	auto remove_lineage = [&lineages, &recombination_rates](size_t p_index) {
+		lineages[p_index].swap(lineages.back());
+		lineages.pop_back();
+		recombination_rates[p_index] = recombination_rates.back();
+		recombination_rates.pop_back();
+	};
+	
+	double coalescence_time = 0.0;
+	slim_objectid_t population_id = p_subpop->subpopulation_id_;
+	
+	while (lineages.size() > 1)
 	{
-		// derived state data must be in ASCII (or unicode) on disk, according to tskit policy
-		DerivedStatesToAscii(&output_tables);
+		if ((++events_since_sum >= 1024) || (lineages.size() * 2 <= summed_lineage_count))
+		{
+			total_recombination_rate = sum_recombination_rates();
+			summed_lineage_count = lineages.size();
+			events_since_sum = 0;
+		}
 		
-		tsk_table_collection_dump(&output_tables, path.c_str(), 0);
+		double lineage_count = lineages.size();
+		double coalescence_rate = lineage_count * (lineage_count - 1) / 2.0 / (2.0 * p_effective_size);
+		double total_rate = coalescence_rate + std::max(total_recombination_rate, 0.0);
 		
-		// In nucleotide-based models, write out the ancestral sequence, re-opening the kastore to append
-		if (nucleotide_based_)
+		coalescence_time += gsl_ran_exponential(EIDOS_GSL_RNG, 1.0 / total_rate);
+		
+		if (Eidos_rng_uniform(EIDOS_GSL_RNG) * total_rate >= coalescence_rate)
 		{
-			std::size_t buflen = chromosome_.AncestralSequence()->size();
-			char *buffer;	// kastore needs to provide us with a memory location to which to write the data
-			kastore_t store;
+			// Recombination: choose a lineage in proportion to its rate, and split it at a breakpoint within its span
+			double target_rate = Eidos_rng_uniform(EIDOS_GSL_RNG) * total_recombination_rate;
+			size_t lineage_index = 0;
 			
-			buffer = (char *)malloc(buflen);
-			chromosome_.AncestralSequence()->WriteNucleotidesToBuffer(buffer);
+			while ((lineage_index < lineages.size() - 1) && ((target_rate >= recombination_rates[lineage_index]) || (recombination_rates[lineage_index] == 0.0)))
+			{
+				target_rate -= recombination_rates[lineage_index];
+				lineage_index++;
+			}
 			
-			ret = kastore_open(&store, path.c_str(), "a", 0);
-			if (ret < 0) handle_error("kastore_open", ret);
-				
-			kastore_oputs_int8(&store, "reference_sequence/data", (int8_t *)buffer, buflen, 0);
-			if (ret < 0) handle_error("kastore_oputs_int8", ret);
+			std::vector<CoalescentSegment> &lineage = lineages[lineage_index];
+			slim_position_t span_start = lineage.front().left_, span_end = lineage.back().right_;
 			
-			ret = kastore_close(&store);
-			if (ret < 0) handle_error("kastore_close", ret);
+			if ((span_end - span_start < 2) || (recombination_rates[lineage_index] <= 0.0))
+				continue;
 			
-			// kastore owns buffer now, so we do not free it
+			double target_cumulative = rate_through(span_start) + Eidos_rng_uniform(EIDOS_GSL_RNG) * recombination_rates[lineage_index];
+			size_t map_index = std::min((size_t)(std::lower_bound(map_cumulative.begin(), map_cumulative.end(), target_cumulative) - map_cumulative.begin()), map_ends.size() - 1);
+			slim_position_t previous_end = (map_index == 0) ? 0 : map_ends[map_index - 1];
+			double previous_cumulative = (map_index == 0) ? 0.0 : map_cumulative[map_index - 1];
+			slim_position_t breakpoint = map_ends[map_index];
+			
+			if (map_rates[map_index] > 0.0)
+				breakpoint = previous_end + (slim_position_t)std::ceil((target_cumulative - previous_cumulative) / map_rates[map_index]);
+			
+			breakpoint = std::max(span_start + 1, std::min(span_end - 1, breakpoint));
+			
+			// the segments to the right of the breakpoint go to a new lineage; a segment spanning the breakpoint is split
+			std::vector<CoalescentSegment> right_lineage;
+			size_t segment_index = 0;
+			
+			while (lineage[segment_index].right_ <= breakpoint)
+				segment_index++;
+			
+			size_t kept_count = segment_index;
+			
+			if (lineage[segment_index].left_ < breakpoint)
+			{
+				right_lineage.emplace_back(CoalescentSegment{breakpoint, lineage[segment_index].right_, lineage[segment_index].node_});
+				lineage[segment_index].right_ = breakpoint;
+				segment_index++;
+				kept_count = segment_index;
+			}
+			
+			right_lineage.insert(right_lineage.end(), lineage.begin() + segment_index, lineage.end());
+			lineage.resize(kept_count);
+			
+			// the total rate is kept up to date incrementally, as below for coalescence, rather than summed over all lineages
+			total_recombination_rate -= recombination_rates[lineage_index];
+			recombination_rates[lineage_index] = lineage_rate(lineage);
+			recombination_rates.emplace_back(lineage_rate(right_lineage));
+			total_recombination_rate += recombination_rates[lineage_index] + recombination_rates.back();
+			lineages.emplace_back(std::move(right_lineage));
 		}
-    }
-	else
-	{
-        std::string error_string;
-        bool success = Eidos_CreateDirectory(path, &error_string);
-		
-		if (success)
+		else
 		{
-            // first translate the bytes we've put into mutation derived state into printable ascii
-            TreeSequenceDataToAscii(&output_tables);
+			// Coalescence: merge two lineages chosen uniformly, recording a new node wherever their material overlaps
+			size_t index_x = Eidos_rng_uniform_int(EIDOS_GSL_RNG, (uint32_t)lineages.size());
+			size_t index_y = Eidos_rng_uniform_int(EIDOS_GSL_RNG, (uint32_t)lineages.size() - 1);
 			
-			std::string NodeFileName = path + "/NodeTable.txt";
-			std::string EdgeFileName = path + "/EdgeTable.txt";
-			std::string SiteFileName = path + "/SiteTable.txt";
-			std::string MutationFileName = path + "/MutationTable.txt";
-			std::string IndividualFileName = path + "/IndividualTable.txt";
-			std::string PopulationFileName = path + "/PopulationTable.txt";
-			std::string ProvenanceFileName = path + "/ProvenanceTable.txt";
+			if (index_y >= index_x)
+				index_y++;
 			
-			FILE *MspTxtNodeTable = fopen(NodeFileName.c_str(), "w");
-			FILE *MspTxtEdgeTable = fopen(EdgeFileName.c_str(), "w");
-			FILE *MspTxtSiteTable = fopen(SiteFileName.c_str(), "w");
-			FILE *MspTxtMutationTable = fopen(MutationFileName.c_str(), "w");
-			FILE *MspTxtIndividualTable = fopen(IndividualFileName.c_str(), "w");
-			FILE *MspTxtPopulationTable = fopen(PopulationFileName.c_str(), "w");
-			FILE *MspTxtProvenanceTable = fopen(ProvenanceFileName.c_str(), "w");
+			const std::vector<CoalescentSegment> &lineage_x = lineages[index_x], &lineage_y = lineages[index_y];
+			std::vector<slim_position_t> boundaries;
 			
-			tsk_node_table_dump_text(&output_tables.nodes, MspTxtNodeTable);
-			tsk_edge_table_dump_text(&output_tables.edges, MspTxtEdgeTable);
-			tsk_site_table_dump_text(&output_tables.sites, MspTxtSiteTable);
-			tsk_mutation_table_dump_text(&output_tables.mutations, MspTxtMutationTable);
-			tsk_individual_table_dump_text(&output_tables.individuals, MspTxtIndividualTable);
-			tsk_population_table_dump_text(&output_tables.populations, MspTxtPopulationTable);
-			tsk_provenance_table_dump_text(&output_tables.provenances, MspTxtProvenanceTable);
+			for (const CoalescentSegment &segment : lineage_x) { boundaries.emplace_back(segment.left_); boundaries.emplace_back(segment.right_); }
+			for (const CoalescentSegment &segment : lineage_y) { boundaries.emplace_back(segment.left_); boundaries.emplace_back(segment.right_); }
 			
-			fclose(MspTxtNodeTable);
-			fclose(MspTxtEdgeTable);
-			fclose(MspTxtSiteTable);
-			fclose(MspTxtMutationTable);
-			fclose(MspTxtIndividualTable);
-			fclose(MspTxtPopulationTable);
-			fclose(MspTxtProvenanceTable);
+			std::sort(boundaries.begin(), boundaries.end());
+			boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
 			
-			// In nucleotide-based models, write out the ancestral sequence as a separate text file
-			if (nucleotide_based_)
+			std::vector<CoalescentSegment> merged;
+			std::vector<CoalescentSegment> new_edges;		// left_, right_, and the child node, all with the parent node below
+			tsk_id_t parent_node = TSK_NULL;
+			size_t segment_x = 0, segment_y = 0;
+			
+			auto add_segment = [](std::vector<CoalescentSegment> &p_segments, slim_position_t p_left, slim_position_t p_right, tsk_id_t p_node) {
+				if (p_segments.size() && (p_segments.back().right_ == p_left) && (p_segments.back().node_ == p_node))
+					p_segments.back().right_ = p_right;
+				else
+					p_segments.emplace_back(CoalescentSegment{p_left, p_right, p_node});
+			};
+			
+			for (size_t boundary_index = 0; boundary_index + 1 < boundaries.size(); ++boundary_index)
 			{
-				std::string RefSeqFileName = path + "/ReferenceSequence.txt";
-				std::ofstream outfile;
+				slim_position_t left = boundaries[boundary_index], right = boundaries[boundary_index + 1];
 				
-				outfile.open(RefSeqFileName, std::ofstream::out);
-				if (!outfile.is_open())
-					EIDOS_TERMINATION << "ERROR (SLiMSim::WriteTreeSequence): treeSeqOutput() could not open "<< RefSeqFileName << "." << EidosTerminate();
+				while ((segment_x < lineage_x.size()) && (lineage_x[segment_x].right_ <= left)) segment_x++;
+				while ((segment_y < lineage_y.size()) && (lineage_y[segment_y].right_ <= left)) segment_y++;
 				
-				outfile << *(chromosome_.AncestralSequence());
-				outfile.close();
+				bool in_x = (segment_x < lineage_x.size()) && (lineage_x[segment_x].left_ <= left);
+				bool in_y = (segment_y < lineage_y.size()) && (lineage_y[segment_y].left_ <= left);
+				
+				if (in_x && in_y)
+				{
+					if (parent_node == TSK_NULL)
+					{
+						parent_node = tsk_node_table_add_row(&tables_.nodes, SLIM_TSK_NODE_COALESCENT, sample_time + coalescence_time, population_id, TSK_NULL, NULL, 0);
+						if (parent_node < 0) handle_error("tsk_node_table_add_row", parent_node);
+					}
+					
+					// edges are merged with an abutting edge to the same child, so each child gets as few edges as possible
+					for (tsk_id_t child_node : {lineage_x[segment_x].node_, lineage_y[segment_y].node_})
+					{
+						auto edge_iter = std::find_if(new_edges.begin(), new_edges.end(), [child_node, left](const CoalescentSegment &p_edge) { return (p_edge.node_ == child_node) && (p_edge.right_ == left); });
+						
+						if (edge_iter != new_edges.end())
+							edge_iter->right_ = right;
+						else
+							new_edges.emplace_back(CoalescentSegment{left, right, child_node});
+					}
+					
+					// the parent carries the material onward, except where it is now the most recent common ancestor
+					auto count_iter = split_counts_at(left);
+					auto count_end = split_counts_at(right);
+					
+					for ( ; count_iter != count_end; ++count_iter)
+					{
+						if (--(count_iter->second) > 1)
+							add_segment(merged, count_iter->first, std::next(count_iter)->first, parent_node);
+					}
+				}
+				else if (in_x)
+				{
+					add_segment(merged, left, right, lineage_x[segment_x].node_);
+				}
+				else if (in_y)
+				{
+					add_segment(merged, left, right, lineage_y[segment_y].node_);
+				}
+			}
+			
+			for (const CoalescentSegment &edge : new_edges)
+			{
+				int ret = tsk_edge_table_add_row(&tables_.edges, edge.left_, edge.right_, parent_node, edge.node_);
+				if (ret < 0) handle_error("tsk_edge_table_add_row", ret);
+			}
+			
+			total_recombination_rate -= recombination_rates[index_x] + recombination_rates[index_y];
+			
+			// replace lineage x with the merged lineage and remove lineage y; removing y first could move x
+			lineages[index_x].swap(merged);
+			recombination_rates[index_x] = lineages[index_x].size() ? lineage_rate(lineages[index_x]) : 0.0;
+			total_recombination_rate += recombination_rates[index_x];
+			
+			if (index_x > index_y)
+			{
+				if (lineages[index_x].size() == 0)
+					remove_lineage(index_x);
+				remove_lineage(index_y);
+			}
+			else
+			{
+				remove_lineage(index_y);
+				if (lineages[index_x].size() == 0)
+					remove_lineage(index_x);
 			}
 		}
-		else
-		{
-			EIDOS_TERMINATION << "ERROR (SLiMSim::WriteTreeSequence): unable to create output folder for treeSeqOutput() (" << error_string << ")" << EidosTerminate();
-		}
-    }
-	
-	// Done with our tables copy
-	tsk_table_collection_free(&output_tables);
-}	
-
+	}
+}
 
 void SLiMSim::FreeTreeSequence(void)
 {
@@ -6603,8 +7935,17 @@ void SLiMSim::FreeTreeSequence(void)
 #endif
 	
 	// Free any tree-sequence recording stuff that has been allocated; called when SLiMSim is getting deallocated,
-	// and also when we're wiping the slate clean with something like readFromPopulationFile().
+	// and also when we're wiping the slate clean with something like readFromPopulationFile().  Any background
+	// simplification in progress is waited for and then discarded.
+	if (background_simplification_running_)
+	{
+		background_simplification_thread_.join();
+		background_simplification_running_ = false;
+		tsk_table_collection_free(&background_tables_);
+	}
+	
 	tsk_table_collection_free(&tables_);
+	ClearTreeSequenceBuffers();
 	
 	remembered_genomes_.clear();
 }
@@ -6715,6 +8056,7 @@ void SLiMSim::DumpMutationTable(void)
 #endif
 	
 	// Dump for debugging; should not be called in production code!
+	FlushTreeSequenceBuffers();
 	
 	tsk_mutation_table_t &mutations = tables_.mutations;
 	
@@ -6757,6 +8099,9 @@ void SLiMSim::CrosscheckTreeSeqIntegrity(void)
 		EIDOS_TERMINATION << "ERROR (SLiMSim::CrosscheckTreeSeqIntegrity): (internal error) tree sequence recording method called with recording off." << EidosTerminate();
 #endif
 	
+	// the crosschecks compare extant genomes against tables_, so any background simplification needs to be incorporated
+	FinishBackgroundSimplification();
+	
 	// first crosscheck the substitutions multimap against SLiM's substitutions vector
 	{
 		std::vector<Substitution *> vector_subs = population_.substitutions_;
@@ -6827,7 +8172,7 @@ void SLiMSim::CrosscheckTreeSeqIntegrity(void)
 				for (Genome *genome : iter->second->parent_genomes_)
 					samples.push_back(genome->tsk_node_id_);
 			
-			ret = tsk_table_collection_sort(tables_copy, /* edge_start */ 0, /* flags */ 0);
+			ret = SortTreeSequenceTables(tables_copy, sorted_edge_count_);
 			if (ret < 0) handle_error("tsk_table_collection_sort", ret);
 			
 			ret = tsk_table_collection_deduplicate_sites(tables_copy, 0);
@@ -7033,13 +8378,174 @@ void SLiMSim::CrosscheckTreeSeqIntegrity(void)
 		if (ret != 0) handle_error("CrosscheckTreeSeqIntegrity tsk_vargen_free()", ret);
 		free(vg);
 		
-		ret = tsk_treeseq_free(ts);
-		if (ret != 0) handle_error("CrosscheckTreeSeqIntegrity tsk_treeseq_free()", ret);
-		free(ts);
+		ret = tsk_treeseq_free(ts);
+		if (ret != 0) handle_error("CrosscheckTreeSeqIntegrity tsk_treeseq_free()", ret);
+		free(ts);
+		
+		ret = tsk_table_collection_free(tables_copy);
+		if (ret != 0) handle_error("CrosscheckTreeSeqIntegrity tsk_table_collection_free()", ret);
+		free(tables_copy);
+	}
+}
+
+void SLiMSim::SampledCrosscheckTreeSeqIntegrity(void)
+{
+#if DEBUG
+	if (!recording_tree_ || !recording_mutations_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::SampledCrosscheckTreeSeqIntegrity): (internal error) tree sequence recording method called with recording off." << EidosTerminate();
+#endif
+	
+	// This is a cheap statistical version of CrosscheckTreeSeqIntegrity(), enabled with crosscheckSampleSize, that is meant to be
+	// left on in long runs.  Each generation we check crosscheck_sample_size_ randomly chosen genome/position pairs: we find the
+	// derived state that tables_ gives the genome at the position by walking up its ancestry in the tables directly, without any
+	// copy, sort, or simplify, and compare that to the mutations SLiM has there.  Alternate checks use the position of a mutation
+	// in the genome, and the position of a recorded site, which the genome usually lacks.  Divergences are counted rather than
+	// raised, so that the divergence rate can be monitored with treeSeqCrosscheckCounts(); only the first produces a warning.
+	// The walk uses per-node linked lists of edges and mutations, which are extended as rows are appended to tables_ and
+	// rebuilt only when the tables are reordered, so each generation costs the rows appended plus the ancestries walked.
+	
+	// buffered rows need to be in tables_; a background simplification can keep running, since tables_ only grows meanwhile
+	FlushTreeSequenceBuffers();
+	
+	tsk_node_table_t &nodes = tables_.nodes;
+	tsk_edge_table_t &edges = tables_.edges;
+	tsk_site_table_t &sites = tables_.sites;
+	tsk_mutation_table_t &mutations = tables_.mutations;
+	
+	if (!crosscheck_index_valid_ || (crosscheck_edge_head_.size() > nodes.num_rows) || (crosscheck_edge_next_.size() > edges.num_rows) || (crosscheck_mutation_next_.size() > mutations.num_rows))
+	{
+		crosscheck_edge_head_.clear();
+		crosscheck_edge_next_.clear();
+		crosscheck_mutation_head_.clear();
+		crosscheck_mutation_next_.clear();
+		crosscheck_index_valid_ = true;
+	}
+	
+	crosscheck_edge_head_.resize(nodes.num_rows, TSK_NULL);
+	crosscheck_mutation_head_.resize(nodes.num_rows, TSK_NULL);
+	
+	for (tsk_size_t row = crosscheck_edge_next_.size(); row < edges.num_rows; ++row)
+	{
+		tsk_id_t child = edges.child[row];
+		
+		crosscheck_edge_next_.emplace_back(crosscheck_edge_head_[child]);
+		crosscheck_edge_head_[child] = (tsk_id_t)row;
+	}
+	
+	for (tsk_size_t row = crosscheck_mutation_next_.size(); row < mutations.num_rows; ++row)
+	{
+		tsk_id_t node = mutations.node[row];
+		
+		crosscheck_mutation_next_.emplace_back(crosscheck_mutation_head_[node]);
+		crosscheck_mutation_head_[node] = (tsk_id_t)row;
+	}
+	
+	// gather the non-null genomes, which are the ones that can carry mutations
+	static std::vector<Genome *> genomes;
+	genomes.clear();
+	
+	for (auto pop_iter : population_.subpops_)
+		for (Genome *genome : pop_iter.second->parent_genomes_)
+			if (!genome->IsNull())
+				genomes.push_back(genome);
+	
+	if (genomes.size() == 0)
+		return;
+	
+	static std::vector<slim_mutationid_t> tree_mutids;
+	static std::vector<slim_mutationid_t> slim_mutids;
+	
+	for (int64_t check_index = 0; check_index < crosscheck_sample_size_; ++check_index)
+	{
+		Genome *genome = genomes[Eidos_rng_uniform_int_MT64(crosscheck_rng_, genomes.size())];
+		int genome_mutation_count = genome->mutation_count();
+		slim_position_t position;
+		
+		if (genome_mutation_count && ((check_index % 2 == 0) || (sites.num_rows == 0)))
+		{
+			int mutation_index = (int)Eidos_rng_uniform_int_MT64(crosscheck_rng_, genome_mutation_count);
+			
+			for (int run_index = 0; ; ++run_index)
+			{
+				MutationRun *mutrun = genome->mutruns_[run_index].get();
+				
+				if (mutation_index < mutrun->size())
+				{
+					position = (gSLiM_Mutation_Block + mutrun->begin_pointer_const()[mutation_index])->position_;
+					break;
+				}
+				
+				mutation_index -= mutrun->size();
+			}
+		}
+		else if (sites.num_rows)
+			position = (slim_position_t)sites.position[Eidos_rng_uniform_int_MT64(crosscheck_rng_, sites.num_rows)];
+		else
+			continue;
+		
+		// walk up the ancestry of the genome at the position; the first mutation we find there, taking the most recently recorded
+		// mutation at each node first, gives the derived state, since each recorded derived state is the full state at the position
+		tree_mutids.clear();
+		
+		for (tsk_id_t node = genome->tsk_node_id_; node != TSK_NULL; )
+		{
+			tsk_id_t mutation = crosscheck_mutation_head_[node];
+			
+			for ( ; mutation != TSK_NULL; mutation = crosscheck_mutation_next_[mutation])
+				if (sites.position[mutations.site[mutation]] == position)
+					break;
+			
+			if (mutation != TSK_NULL)
+			{
+				const slim_mutationid_t *derived_state = (const slim_mutationid_t *)(mutations.derived_state + mutations.derived_state_offset[mutation]);
+				size_t derived_state_length = (mutations.derived_state_offset[mutation + 1] - mutations.derived_state_offset[mutation]) / sizeof(slim_mutationid_t);
+				
+				tree_mutids.insert(tree_mutids.end(), derived_state, derived_state + derived_state_length);
+				break;
+			}
+			
+			tsk_id_t edge = crosscheck_edge_head_[node];
+			
+			for ( ; edge != TSK_NULL; edge = crosscheck_edge_next_[edge])
+				if ((edges.left[edge] <= position) && (position < edges.right[edge]))
+					break;
+			
+			node = ((edge != TSK_NULL) ? edges.parent[edge] : TSK_NULL);
+		}
+		
+		// SLiM's state at the position is the segregating mutations in the genome there, plus any fixed mutations there
+		slim_mutids.clear();
+		
+		MutationRun *mutrun = genome->mutruns_[position / genome->mutrun_length_].get();
+		const MutationIndex *mutrun_iter = mutrun->begin_pointer_const();
+		const MutationIndex *mutrun_end = mutrun_iter + mutrun->size();
+		
+		for ( ; mutrun_iter != mutrun_end; ++mutrun_iter)
+		{
+			Mutation *mutation = gSLiM_Mutation_Block + *mutrun_iter;
+			
+			if (mutation->position_ == position)
+				slim_mutids.push_back(mutation->mutation_id_);
+		}
+		
+		auto substitution_range_iter = population_.treeseq_substitutions_map_.equal_range(position);
+		
+		for (auto substitution_iter = substitution_range_iter.first; substitution_iter != substitution_range_iter.second; ++substitution_iter)
+			slim_mutids.push_back(substitution_iter->second->mutation_id_);
 		
-		ret = tsk_table_collection_free(tables_copy);
-		if (ret != 0) handle_error("CrosscheckTreeSeqIntegrity tsk_table_collection_free()", ret);
-		free(tables_copy);
+		// crosscheck, sorting so there is no order-dependency
+		std::sort(tree_mutids.begin(), tree_mutids.end());
+		std::sort(slim_mutids.begin(), slim_mutids.end());
+		
+		crosscheck_check_count_++;
+		
+		if (tree_mutids != slim_mutids)
+		{
+			crosscheck_divergence_count_++;
+			
+			if ((crosscheck_divergence_count_ == 1) && !gEidosSuppressWarnings)
+				SLIM_OUTSTREAM << "#WARNING (SLiMSim::SampledCrosscheckTreeSeqIntegrity): in generation " << generation_ << ", the tree sequence has " << tree_mutids.size() << " mutation(s) at position " << position << " for a genome that SLiM has " << slim_mutids.size() << " mutation(s) for, including fixed mutations; further divergences will be counted by treeSeqCrosscheckCounts() without warning." << std::endl;
+		}
 	}
 }
 
@@ -7222,7 +8728,7 @@ void SLiMSim::__TabulateSubpopulationsFromTreeSequence(std::unordered_map<slim_o
 	}
 }
 
-void SLiMSim::__CreateSubpopulationsFromTabulation(std::unordered_map<slim_objectid_t, ts_subpop_info> &p_subpopInfoMap, EidosInterpreter *p_interpreter, std::unordered_map<tsk_id_t, Genome *> &p_nodeToGenomeMap)
+void SLiMSim::__CreateSubpopulationsFromTabulation(std::unordered_map<slim_objectid_t, ts_subpop_info> &p_subpopInfoMap, EidosInterpreter *p_interpreter, std::vector<Genome *> &p_nodeToGenomeMap)
 {
 	gSLiM_next_pedigree_id = 0;
 	
@@ -7283,8 +8789,8 @@ void SLiMSim::__CreateSubpopulationsFromTabulation(std::unordered_map<slim_objec
 				individual->genome1_->tsk_node_id_ = node_id_0;
 				individual->genome2_->tsk_node_id_ = node_id_1;
 				
-				p_nodeToGenomeMap.insert(std::pair<tsk_id_t, Genome *>(node_id_0, individual->genome1_));
-				p_nodeToGenomeMap.insert(std::pair<tsk_id_t, Genome *>(node_id_1, individual->genome2_));
+				p_nodeToGenomeMap[node_id_0] = individual->genome1_;
+				p_nodeToGenomeMap[node_id_1] = individual->genome2_;
 				
 				slim_pedigreeid_t pedigree_id = subpop_info.pedigreeID_[tabulation_index];
 				individual->SetPedigreeID(pedigree_id);
@@ -7519,90 +9025,122 @@ void SLiMSim::__TabulateMutationsFromTables(std::unordered_map<slim_mutationid_t
 	}
 }
 
-void SLiMSim::__TallyMutationReferencesWithTreeSequence(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutMap, std::unordered_map<tsk_id_t, Genome *> p_nodeToGenomeMap, tsk_treeseq_t *p_ts)
+template <typename F> void SLiMSim::__VisitExtantAllelesInTreeSequence(std::vector<Genome *> &p_nodeToGenomeMap, tsk_treeseq_t *p_ts, F p_visitor)
 {
-	// allocate and set up the vargen object we'll use to walk through variants
-	tsk_vargen_t *vg;
+	// Walk the trees from left to right, calling p_visitor(genome, mutation_id, position) once for each site at which an
+	// extant genome carries a derived state, where mutation_id is the row in the mutation table that gives that state.  The
+	// genomes that carry each mutation are found from the sample lists of the tree, which tskit updates incrementally as
+	// edges come and go, so the work done at a site is proportional to the number of samples under its mutations rather
+	// than to the total number of samples, as it is with tsk_vargen_t; this matters a great deal for large, mostly rare
+	// variants.  As in tsk_vargen_t, later mutations at a site override earlier ones for the samples below them.  Sites
+	// are visited in position order, so each genome sees its alleles in position order.
+	tsk_size_t sample_count = p_ts->num_samples;
+	std::vector<Genome *> indexToGenomeMap(sample_count);
 	
-	vg = (tsk_vargen_t *)malloc(sizeof(tsk_vargen_t));
-	int ret = tsk_vargen_init(vg, p_ts, p_ts->samples, p_ts->num_samples, TSK_16_BIT_GENOTYPES);
-	if (ret != 0) handle_error("__TallyMutationReferencesWithTreeSequence tsk_vargen_init()", ret);
+	// set up a map from sample indices in the tree's sample lists to Genome objects; the sample
+	// may contain nodes that are ancestral and need to be excluded, which map to nullptr
+	for (tsk_size_t sample_index = 0; sample_index < sample_count; ++sample_index)
+		indexToGenomeMap[sample_index] = p_nodeToGenomeMap[p_ts->samples[sample_index]];
 	
-	// set up a map from sample indices in the vargen to Genome objects; the sample
-	// may contain nodes that are ancestral and need to be excluded
-	std::vector<Genome *> indexToGenomeMap;
-	size_t sample_count = vg->num_samples;
+	std::vector<tsk_id_t> sampleToMutation(sample_count, TSK_NULL);	// the mutation seen by each sample at the current site
+	std::vector<tsk_id_t> touched_samples;								// the samples with an entry in sampleToMutation
+	tsk_tree_t tree;
 	
-	for (size_t sample_index = 0; sample_index < sample_count; ++sample_index)
-	{
-		tsk_id_t sample_node_id = vg->samples[sample_index];
-		auto sample_nodeToGenome_iter = p_nodeToGenomeMap.find(sample_node_id);
-		
-		if (sample_nodeToGenome_iter != p_nodeToGenomeMap.end())
-			indexToGenomeMap.push_back(sample_nodeToGenome_iter->second);
-		else
-			indexToGenomeMap.push_back(nullptr);	// this sample is not extant; no corresponding genome
-	}
+	int ret = tsk_tree_init(&tree, p_ts, TSK_SAMPLE_LISTS);
+	if (ret < 0) handle_error("__VisitExtantAllelesInTreeSequence tsk_tree_init()", ret);
 	
-	// add mutations to genomes by looping through variants
-	do
+	for (ret = tsk_tree_first(&tree); ret == 1; ret = tsk_tree_next(&tree))
 	{
-		tsk_variant_t *variant;
-		
-		ret = tsk_vargen_next(vg, &variant);
-		if (ret < 0) handle_error("__TallyMutationReferencesWithTreeSequence tsk_vargen_next()", ret);
+		const tsk_id_t *left_sample = tree.left_sample;
+		const tsk_id_t *right_sample = tree.right_sample;
+		const tsk_id_t *next_sample = tree.next_sample;
 		
-		if (ret == 1)
+		for (tsk_size_t site_index = 0; site_index < tree.sites_length; ++site_index)
 		{
-			// We have a new variant; set it into SLiM.  A variant represents a site at which a tracked mutation exists.
-			// The tsk_variant_t will tell us all the allelic states involved at that site, what the alleles are, and which genomes
-			// in the sample are using them.  We want to find any mutations that are shared across all non-null genomes.
-			for (tsk_size_t allele_index = 0; allele_index < variant->num_alleles; ++allele_index)
+			tsk_site_t &site = tree.sites[site_index];
+			slim_position_t position = (slim_position_t)site.position;
+			
+			for (tsk_size_t mutation_index = 0; mutation_index < site.mutations_length; ++mutation_index)
 			{
-				tsk_size_t allele_length = variant->allele_lengths[allele_index];
+				tsk_mutation_t &mutation = site.mutations[mutation_index];
+				tsk_id_t sample_index = left_sample[mutation.node];
+				
+				if (sample_index == TSK_NULL)
+					continue;
+				
+				tsk_id_t stop_index = right_sample[mutation.node];
 				
-				if (allele_length > 0)
+				while (true)
 				{
-					// Calculate the number of extant genomes that reference this allele
-					int32_t allele_refs = 0;
-					
-					for (size_t sample_index = 0; sample_index < sample_count; sample_index++)
-						if ((variant->genotypes.u16[sample_index] == allele_index) && (indexToGenomeMap[sample_index] != nullptr))
-							allele_refs++;
-					
-					// If that count is greater than zero (might be zero if only non-extant nodes reference the allele), tally it
-					if (allele_refs)
+					if (indexToGenomeMap[sample_index])
 					{
-						if (allele_length % sizeof(slim_mutationid_t) != 0)
-							EIDOS_TERMINATION << "ERROR (SLiMSim::__TallyMutationReferencesWithTreeSequence): (internal error) variant allele had length that was not a multiple of sizeof(slim_mutationid_t)." << EidosTerminate();
-						allele_length /= sizeof(slim_mutationid_t);
-						
-						slim_mutationid_t *allele = (slim_mutationid_t *)variant->alleles[allele_index];
-						
-						for (tsk_size_t mutid_index = 0; mutid_index < allele_length; ++mutid_index)
-						{
-							slim_mutationid_t mut_id = allele[mutid_index];
-							auto mut_info_iter = p_mutMap.find(mut_id);
-							
-							if (mut_info_iter == p_mutMap.end())
-								EIDOS_TERMINATION << "ERROR (SLiMSim::__TallyMutationReferencesWithTreeSequence): mutation id " << mut_id << " was referenced but does not exist." << EidosTerminate();
-							
-							// Add allele_refs to the refcount for this mutation
-							ts_mut_info &mut_info = mut_info_iter->second;
-							
-							mut_info.ref_count += allele_refs;
-						}
+						if (sampleToMutation[sample_index] == TSK_NULL)
+							touched_samples.push_back(sample_index);
+						sampleToMutation[sample_index] = mutation.id;
 					}
+					
+					if (sample_index == stop_index)
+						break;
+					sample_index = next_sample[sample_index];
 				}
 			}
+			
+			for (tsk_id_t sample_index : touched_samples)
+			{
+				p_visitor(indexToGenomeMap[sample_index], sampleToMutation[sample_index], position);
+				sampleToMutation[sample_index] = TSK_NULL;
+			}
+			
+			touched_samples.clear();
 		}
 	}
-	while (ret != 0);
+	if (ret < 0) handle_error("__VisitExtantAllelesInTreeSequence tsk_tree_next()", ret);
+	
+	ret = tsk_tree_free(&tree);
+	if (ret < 0) handle_error("__VisitExtantAllelesInTreeSequence tsk_tree_free()", ret);
+}
+
+void SLiMSim::__TallyMutationReferencesWithTreeSequence(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutMap, std::vector<Genome *> &p_nodeToGenomeMap, tsk_treeseq_t *p_ts)
+{
+	// Count the extant genomes that carry each row of the mutation table; a mutation might be referenced only by
+	// non-extant nodes, in which case its refcount stays zero and it will not be instantiated
+	tsk_mutation_table_t &mut_table = tables_.mutations;
+	std::vector<int32_t> mutation_refs(mut_table.num_rows, 0);
 	
-	// free
-	ret = tsk_vargen_free(vg);
-	if (ret != 0) handle_error("__TallyMutationReferencesWithTreeSequence tsk_vargen_free()", ret);
-	free(vg);
+	__VisitExtantAllelesInTreeSequence(p_nodeToGenomeMap, p_ts, [&mutation_refs](Genome *, tsk_id_t p_mutation_id, slim_position_t) {
+		mutation_refs[p_mutation_id]++;
+	});
+	
+	// Then add each row's count to the refcounts of the mutations in its derived state
+	for (tsk_size_t mut_row = 0; mut_row < mut_table.num_rows; ++mut_row)
+	{
+		int32_t allele_refs = mutation_refs[mut_row];
+		
+		if (allele_refs)
+		{
+			tsk_size_t allele_length = mut_table.derived_state_offset[mut_row + 1] - mut_table.derived_state_offset[mut_row];
+			
+			if (allele_length % sizeof(slim_mutationid_t) != 0)
+				EIDOS_TERMINATION << "ERROR (SLiMSim::__TallyMutationReferencesWithTreeSequence): (internal error) variant allele had length that was not a multiple of sizeof(slim_mutationid_t)." << EidosTerminate();
+			allele_length /= sizeof(slim_mutationid_t);
+			
+			slim_mutationid_t *allele = (slim_mutationid_t *)(mut_table.derived_state + mut_table.derived_state_offset[mut_row]);
+			
+			for (tsk_size_t mutid_index = 0; mutid_index < allele_length; ++mutid_index)
+			{
+				slim_mutationid_t mut_id = allele[mutid_index];
+				auto mut_info_iter = p_mutMap.find(mut_id);
+				
+				if (mut_info_iter == p_mutMap.end())
+					EIDOS_TERMINATION << "ERROR (SLiMSim::__TallyMutationReferencesWithTreeSequence): mutation id " << mut_id << " was referenced but does not exist." << EidosTerminate();
+				
+				// Add allele_refs to the refcount for this mutation
+				ts_mut_info &mut_info = mut_info_iter->second;
+				
+				mut_info.ref_count += allele_refs;
+			}
+		}
+	}
 }
 
 void SLiMSim::__CreateMutationsFromTabulation(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutInfoMap, std::unordered_map<slim_mutationid_t, MutationIndex> &p_mutIndexMap)
@@ -7680,109 +9218,77 @@ void SLiMSim::__CreateMutationsFromTabulation(std::unordered_map<slim_mutationid
 	}
 }
 
-void SLiMSim::__AddMutationsFromTreeSequenceToGenomes(std::unordered_map<slim_mutationid_t, MutationIndex> &p_mutIndexMap, std::unordered_map<tsk_id_t, Genome *> p_nodeToGenomeMap, tsk_treeseq_t *p_ts)
+void SLiMSim::__AddMutationsFromTreeSequenceToGenomes(std::unordered_map<slim_mutationid_t, MutationIndex> &p_mutIndexMap, std::vector<Genome *> &p_nodeToGenomeMap, tsk_treeseq_t *p_ts)
 {
 	// This code is based on SLiMSim::CrosscheckTreeSeqIntegrity(), but it can be much simpler.
 	// We also don't need to sort/deduplicate/simplify; the tables read in should be simplified already.
 	if (!recording_mutations_)
 		return;
 	
-	// allocate and set up the vargen object we'll use to walk through variants
-	tsk_vargen_t *vg;
-	
-	vg = (tsk_vargen_t *)malloc(sizeof(tsk_vargen_t));
-	int ret = tsk_vargen_init(vg, p_ts, p_ts->samples, p_ts->num_samples, TSK_16_BIT_GENOTYPES);
-	if (ret != 0) handle_error("__AddMutationsFromTreeSequenceToGenomes tsk_vargen_init()", ret);
+	// Resolve the derived state of each row of the mutation table to MutationIndex values once, up front, so that
+	// adding alleles to genomes below needs no hash lookups; -1 marks a fixed mutation, -2 one never instantiated
+	tsk_mutation_table_t &mut_table = tables_.mutations;
+	std::vector<MutationIndex> allele_mutations;
+	std::vector<size_t> allele_offsets;
 	
-	// set up a map from sample indices in the vargen to Genome objects; the sample
-	// may contain nodes that are ancestral and need to be excluded
-	std::vector<Genome *> indexToGenomeMap;
-	size_t sample_count = vg->num_samples;
+	allele_offsets.reserve(mut_table.num_rows + 1);
+	allele_offsets.push_back(0);
 	
-	for (size_t sample_index = 0; sample_index < sample_count; ++sample_index)
+	for (tsk_size_t mut_row = 0; mut_row < mut_table.num_rows; ++mut_row)
 	{
-		tsk_id_t sample_node_id = vg->samples[sample_index];
-		auto sample_nodeToGenome_iter = p_nodeToGenomeMap.find(sample_node_id);
+		tsk_size_t allele_length = mut_table.derived_state_offset[mut_row + 1] - mut_table.derived_state_offset[mut_row];
 		
-		if (sample_nodeToGenome_iter != p_nodeToGenomeMap.end())
-		{
-			// we found a genome for this sample, so record it
-			indexToGenomeMap.push_back(sample_nodeToGenome_iter->second);
-		}
-		else
+		if (allele_length % sizeof(slim_mutationid_t) != 0)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): (internal error) variant allele had length that was not a multiple of sizeof(slim_mutationid_t)." << EidosTerminate();
+		allele_length /= sizeof(slim_mutationid_t);
+		
+		slim_mutationid_t *allele = (slim_mutationid_t *)(mut_table.derived_state + mut_table.derived_state_offset[mut_row]);
+		
+		for (tsk_size_t mutid_index = 0; mutid_index < allele_length; ++mutid_index)
 		{
-			// this sample is not extant; no corresponding genome, so record nullptr
-			indexToGenomeMap.push_back(nullptr);
+			slim_mutationid_t mut_id = allele[mutid_index];
+			auto mut_index_iter = p_mutIndexMap.find(mut_id);
+			
+			// a mutation carried only by non-extant nodes was never instantiated; that is an error only if an extant genome carries it
+			allele_mutations.push_back((mut_index_iter == p_mutIndexMap.end()) ? -2 : mut_index_iter->second);
 		}
+		
+		allele_offsets.push_back(allele_mutations.size());
 	}
 	
-	// add mutations to genomes by looping through variants
-	do
-	{
-		tsk_variant_t *variant;
+	// Then add the alleles to the genomes; sites are visited in position order, so we can always add to the ends of the mutation runs
+	__VisitExtantAllelesInTreeSequence(p_nodeToGenomeMap, p_ts, [&allele_mutations, &allele_offsets, &mut_table](Genome *p_genome, tsk_id_t p_mutation_id, slim_position_t p_position) {
+		size_t allele_start = allele_offsets[p_mutation_id];
+		size_t allele_end = allele_offsets[p_mutation_id + 1];
+		
+		if (allele_start == allele_end)
+			return;
+		
+		if (p_genome->IsNull())
+			EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): (internal error) null genome has non-zero treeseq allele length " << (allele_end - allele_start) << "." << EidosTerminate();
 		
-		ret = tsk_vargen_next(vg, &variant);
-		if (ret < 0) handle_error("__AddMutationsFromTreeSequenceToGenomes tsk_vargen_next()", ret);
+		slim_mutrun_index_t run_index = (slim_mutrun_index_t)(p_position / p_genome->mutrun_length_);
 		
-		if (ret == 1)
+		p_genome->WillModifyRun(run_index);
+		
+		MutationRun *mutrun = p_genome->mutruns_[run_index].get();
+		
+		for (size_t allele_index = allele_start; allele_index < allele_end; ++allele_index)
 		{
-			// We have a new variant; set it into SLiM.  A variant represents a site at which a tracked mutation exists.
-			// The tsk_variant_t will tell us all the allelic states involved at that site, what the alleles are, and which genomes
-			// in the sample are using them.  We will then set all the genomes that the variant claims to involve to have
-			// the allele the variant attributes to them.  The variants are returned in sorted order by position, so we can
-			// always add new mutations to the ends of genomes.
-			slim_position_t variant_pos_int = (slim_position_t)variant->site->position;
+			MutationIndex mut_index = allele_mutations[allele_index];
 			
-			for (size_t sample_index = 0; sample_index < sample_count; sample_index++)
+			if (mut_index == -2)
 			{
-				Genome *genome = indexToGenomeMap[sample_index];
+				slim_mutationid_t mut_id = ((slim_mutationid_t *)(mut_table.derived_state + mut_table.derived_state_offset[p_mutation_id]))[allele_index - allele_start];
 				
-				if (genome)
-				{
-					uint16_t genome_variant = variant->genotypes.u16[sample_index];
-					tsk_size_t genome_allele_length = variant->allele_lengths[genome_variant];
-					
-					if (genome_allele_length % sizeof(slim_mutationid_t) != 0)
-						EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): (internal error) variant allele had length that was not a multiple of sizeof(slim_mutationid_t)." << EidosTerminate();
-					genome_allele_length /= sizeof(slim_mutationid_t);
-					
-					if (genome_allele_length > 0)
-					{
-						if (genome->IsNull())
-							EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): (internal error) null genome has non-zero treeseq allele length " << genome_allele_length << "." << EidosTerminate();
-						
-						slim_mutationid_t *genome_allele = (slim_mutationid_t *)variant->alleles[genome_variant];
-						slim_mutrun_index_t run_index = (slim_mutrun_index_t)(variant_pos_int / genome->mutrun_length_);
-						
-						genome->WillModifyRun(run_index);
-						
-						MutationRun *mutrun = genome->mutruns_[run_index].get();
-						
-						for (tsk_size_t mutid_index = 0; mutid_index < genome_allele_length; ++mutid_index)
-						{
-							slim_mutationid_t mut_id = genome_allele[mutid_index];
-							auto mut_index_iter = p_mutIndexMap.find(mut_id);
-							
-							if (mut_index_iter == p_mutIndexMap.end())
-								EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): mutation id " << mut_id << " was referenced but does not exist." << EidosTerminate();
-							
-							// Add the mutation to the genome unless it is fixed (mut_index == -1)
-							MutationIndex mut_index = mut_index_iter->second;
-							
-							if (mut_index != -1)
-								mutrun->emplace_back(mut_index);
-						}
-					}
-				}
+				EIDOS_TERMINATION << "ERROR (SLiMSim::__AddMutationsFromTreeSequenceToGenomes): mutation id " << mut_id << " was referenced but does not exist." << EidosTerminate();
 			}
+			
+			// Add the mutation to the genome unless it is fixed (mut_index == -1)
+			if (mut_index != -1)
+				mutrun->emplace_back(mut_index);
 		}
-	}
-	while (ret != 0);
-	
-	// free
-	ret = tsk_vargen_free(vg);
-	if (ret != 0) handle_error("__AddMutationsFromTreeSequenceToGenomes tsk_vargen_free()", ret);
-	free(vg);
+	});
 }
 
 slim_generation_t SLiMSim::_InstantiateSLiMObjectsFromTables(EidosInterpreter *p_interpreter)
@@ -7809,6 +9315,9 @@ slim_generation_t SLiMSim::_InstantiateSLiMObjectsFromTables(EidosInterpreter *p
 	for (size_t node_index = 0; node_index < tables_.nodes.num_rows; ++node_index)
 		tables_.nodes.time[node_index] -= time_adjustment;
 	
+	// any mutations in the loaded history, including overlaid ones, are loaded as real mutations, so overlaying starts now
+	overlay_start_generation_ = tree_seq_generation_;
+	
 	// allocate and set up the tree_sequence object that contains all the tree sequences
 	// note that this tree sequence is based upon whatever sample the file was saved with, and may contain in-sample individuals
 	// that are not presently alive, so we have to tread carefully; the individual table is the list of who is actually alive
@@ -7819,7 +9328,7 @@ slim_generation_t SLiMSim::_InstantiateSLiMObjectsFromTables(EidosInterpreter *p
 	ret = tsk_treeseq_init(ts, &tables_, TSK_BUILD_INDEXES);
 	if (ret != 0) handle_error("_InstantiateSLiMObjectsFromTables tsk_treeseq_init()", ret);
 	
-	std::unordered_map<tsk_id_t, Genome *> nodeToGenomeMap;
+	std::vector<Genome *> nodeToGenomeMap(tables_.nodes.num_rows, nullptr);	// a flat map from node ids to extant genomes
 	
 	{
 		std::unordered_map<slim_objectid_t, ts_subpop_info> subpopInfoMap;
@@ -8006,6 +9515,9 @@ slim_generation_t SLiMSim::_InitializePopulationFromTskitBinaryFile(const char *
 	// copy the immutable table collection to make a mutable collection
 	ret = tsk_table_collection_copy(&immutable_tables, &tables_, 0);
 	if (ret < 0) handle_error("tsk_table_collection_copy", ret);
+	
+	sorted_edge_count_ = 0;
+	crosscheck_index_valid_ = false;
 
 	RecordTablePosition();
 	
@@ -8040,6 +9552,31 @@ slim_generation_t SLiMSim::_InitializePopulationFromTskitBinaryFile(const char *
 	return _InstantiateSLiMObjectsFromTables(p_interpreter);
 }
 
+size_t SLiMSim::MemoryInUseForTables(tsk_table_collection_t &p_tables)
+{
+	// This is like MemoryUsageForTables(), but counts the rows in use rather than the allocated capacity, since tskit
+	// does not release capacity when tables shrink; this is what maxTableMemory in initializeTreeSeq() limits.  Only
+	// the tables that grow during a run are counted.
+	tsk_table_collection_t &t = p_tables;
+	size_t usage = 0;
+	
+	usage += t.individuals.num_rows * (sizeof(uint32_t) + 2 * sizeof(tsk_size_t));
+	usage += t.individuals.location_length * sizeof(double) + t.individuals.metadata_length;
+	
+	usage += t.nodes.num_rows * (sizeof(uint32_t) + sizeof(double) + 2 * sizeof(tsk_id_t) + sizeof(tsk_size_t));
+	usage += t.nodes.metadata_length;
+	
+	usage += t.edges.num_rows * (2 * sizeof(double) + 2 * sizeof(tsk_id_t));
+	
+	usage += t.sites.num_rows * (sizeof(double) + 2 * sizeof(tsk_size_t));
+	usage += t.sites.ancestral_state_length + t.sites.metadata_length;
+	
+	usage += t.mutations.num_rows * (3 * sizeof(tsk_id_t) + 2 * sizeof(tsk_size_t));
+	usage += t.mutations.derived_state_length + t.mutations.metadata_length;
+	
+	return usage;
+}
+
 size_t SLiMSim::MemoryUsageForTables(tsk_table_collection_t &p_tables)
 {
 	tsk_table_collection_t &t = p_tables;
@@ -8158,6 +9695,53 @@ size_t SLiMSim::MemoryUsageForTables(tsk_table_collection_t &p_tables)
 	return usage;
 }
 
+size_t SLiMSim::MemoryUsageForTreeSequenceBuffers(void)
+{
+	// The allocated capacity of the buffered rows not yet appended to tables_; see FlushTreeSequenceBuffers().  This lets
+	// TabulateMemoryUsage() report them without flushing, which would make reporting memory usage change the tables.
+	size_t usage = 0;
+	
+	usage += buffered_node_flags_.capacity() * sizeof(tsk_flags_t);
+	usage += buffered_node_time_.capacity() * sizeof(double);
+	usage += buffered_node_population_.capacity() * sizeof(tsk_id_t);
+	usage += buffered_node_metadata_.capacity() * sizeof(char);
+	
+	usage += buffered_edge_left_.capacity() * sizeof(double);
+	usage += buffered_edge_right_.capacity() * sizeof(double);
+	usage += buffered_edge_parent_.capacity() * sizeof(tsk_id_t);
+	usage += buffered_edge_child_.capacity() * sizeof(tsk_id_t);
+	
+	usage += buffered_site_position_.capacity() * sizeof(double);
+	
+	usage += buffered_mutation_site_.capacity() * sizeof(tsk_id_t);
+	usage += buffered_mutation_node_.capacity() * sizeof(tsk_id_t);
+	usage += buffered_mutation_derived_state_.capacity() * sizeof(char);
+	usage += buffered_mutation_derived_state_offset_.capacity() * sizeof(tsk_size_t);
+	usage += buffered_mutation_metadata_.capacity() * sizeof(char);
+	usage += buffered_mutation_metadata_offset_.capacity() * sizeof(tsk_size_t);
+	
+	return usage;
+}
+
+size_t SLiMSim::MemoryInUseForTreeSequenceBuffers(void)
+{
+	// This is like MemoryUsageForTreeSequenceBuffers(), but counts the buffered rows rather than the allocated capacity, which
+	// the buffers keep after each flush; it is the buffered counterpart of MemoryInUseForTables(), for maxTableMemory
+	size_t usage = 0;
+	
+	usage += buffered_node_flags_.size() * (sizeof(tsk_flags_t) + sizeof(double) + sizeof(tsk_id_t) + sizeof(tsk_size_t));
+	usage += buffered_node_metadata_.size();
+	
+	usage += buffered_edge_left_.size() * (2 * sizeof(double) + 2 * sizeof(tsk_id_t));
+	
+	usage += buffered_site_position_.size() * (sizeof(double) + 2 * sizeof(tsk_size_t));
+	
+	usage += buffered_mutation_site_.size() * (3 * sizeof(tsk_id_t) + 2 * sizeof(tsk_size_t));
+	usage += buffered_mutation_derived_state_.size() + buffered_mutation_metadata_.size();
+	
+	return usage;
+}
+
 
 //
 //	Eidos support
@@ -8510,7 +10094,7 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeGenomicElementType(const
 	return symbol_entry.second;
 }
 
-//	*********************	(object<InteractionType>$)initializeInteractionType(is$ id, string$ spatiality, [logical$ reciprocal = F], [numeric$ maxDistance = INF], [string$ sexSegregation = "**"])
+//	*********************	(object<InteractionType>$)initializeInteractionType(is$ id, string$ spatiality, [logical$ reciprocal = F], [numeric$ maxDistance = INF], [string$ sexSegregation = "**"], [string$ spatialIndex = "kdtree"])
 //
 EidosValue_SP SLiMSim::ExecuteContextFunction_initializeInteractionType(const std::string &p_function_name, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
 {
@@ -8520,6 +10104,7 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeInteractionType(const st
 	EidosValue *reciprocal_value = p_arguments[2].get();
 	EidosValue *maxDistance_value = p_arguments[3].get();
 	EidosValue *sexSegregation_value = p_arguments[4].get();
+	EidosValue *spatialIndex_value = p_arguments[5].get();
 	std::ostream &output_stream = p_interpreter.ExecutionOutputStream();
 	
 	slim_objectid_t map_identifier = SLiM_ExtractObjectIDFromEidosValue_is(id_value, 0, 'i');
@@ -8527,8 +10112,10 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeInteractionType(const st
 	bool reciprocal = reciprocal_value->LogicalAtIndex(0, nullptr);
 	double max_distance = maxDistance_value->FloatAtIndex(0, nullptr);
 	std::string sex_string = sexSegregation_value->StringAtIndex(0, nullptr);
+	std::string index_string = spatialIndex_value->StringAtIndex(0, nullptr);
 	int required_dimensionality;
 	IndividualSex receiver_sex = IndividualSex::kUnspecified, exerter_sex = IndividualSex::kUnspecified;
+	SpatialIndexType spatial_index_type;
 	
 	if (interaction_types_.count(map_identifier) > 0) 
 		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeInteractionType): initializeInteractionType() interaction type m" << map_identifier << " already defined." << EidosTerminate();
@@ -8567,6 +10154,15 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeInteractionType(const st
 	if (((receiver_sex != IndividualSex::kUnspecified) || (exerter_sex != IndividualSex::kUnspecified)) && !sex_enabled_)
 		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeInteractionType): initializeInteractionType() sexSegregation value other than '**' unsupported in non-sexual simulation." << EidosTerminate();
 	
+	if (index_string == "kdtree")		spatial_index_type = SpatialIndexType::kKDTree;
+	else if (index_string == "grid")	spatial_index_type = SpatialIndexType::kGrid;
+	else if (index_string == "auto")	spatial_index_type = SpatialIndexType::kAuto;
+	else
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeInteractionType): initializeInteractionType() unsupported spatialIndex value (must be 'kdtree', 'grid', or 'auto')." << EidosTerminate();
+	
+	if ((required_dimensionality == 0) && (spatial_index_type != SpatialIndexType::kKDTree))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeInteractionType): initializeInteractionType() spatialIndex must be 'kdtree' for non-spatial interactions." << EidosTerminate();
+	
 	if ((required_dimensionality > 0) && std::isinf(max_distance))
 	{
 		if (!gEidosSuppressWarnings)
@@ -8579,7 +10175,7 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeInteractionType(const st
 		}
 	}
 	
-	InteractionType *new_interaction_type = new InteractionType(*this, map_identifier, spatiality_string, reciprocal, max_distance, receiver_sex, exerter_sex);
+	InteractionType *new_interaction_type = new InteractionType(*this, map_identifier, spatiality_string, reciprocal, max_distance, receiver_sex, exerter_sex, spatial_index_type);
 	
 	interaction_types_.insert(std::pair<const slim_objectid_t,InteractionType*>(map_identifier, new_interaction_type));
 	interaction_types_changed_ = true;
@@ -8605,6 +10201,9 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeInteractionType(const st
 		if (sex_string != "**")
 			output_stream << ", sexSegregation=\"" << sex_string << "\"";
 		
+		if (spatial_index_type != SpatialIndexType::kKDTree)
+			output_stream << ", spatialIndex=\"" << spatial_index_type << "\"";
+		
 		output_stream << ");" << std::endl;
 	}
 	
@@ -9421,7 +11020,7 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeSLiMOptions(const std::s
 }
 
 // TREE SEQUENCE RECORDING
-//	*********************	(void)initializeTreeSeq([logical$ recordMutations = T], [Nif$ simplificationRatio = NULL], [Ni$ simplificationInterval = NULL], [logical$ checkCoalescence = F], [logical$ runCrosschecks = F])
+//	*********************	(void)initializeTreeSeq([logical$ recordMutations = T], [Nif$ simplificationRatio = NULL], [Ni$ simplificationInterval = NULL], [logical$ checkCoalescence = F], [logical$ runCrosschecks = F], [logical$ simplifyInBackground = F], [logical$ optimizeSimplification = F], [Nif$ maxTableMemory = NULL], [Ns$ checkpointPath = NULL], [Ni$ checkpointInterval = NULL], [Nio<MutationType> overlayMutationTypes = NULL], [integer$ crosscheckSampleSize = 0])
 //
 EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::string &p_function_name, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
 {
@@ -9431,6 +11030,13 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::strin
 	EidosValue *arg_simplificationInterval_value = p_arguments[2].get();
 	EidosValue *arg_checkCoalescence_value = p_arguments[3].get();
 	EidosValue *arg_runCrosschecks_value = p_arguments[4].get();
+	EidosValue *arg_simplifyInBackground_value = p_arguments[5].get();
+	EidosValue *arg_optimizeSimplification_value = p_arguments[6].get();
+	EidosValue *arg_maxTableMemory_value = p_arguments[7].get();
+	EidosValue *arg_checkpointPath_value = p_arguments[8].get();
+	EidosValue *arg_checkpointInterval_value = p_arguments[9].get();
+	EidosValue *arg_overlayMutationTypes_value = p_arguments[10].get();
+	EidosValue *arg_crosscheckSampleSize_value = p_arguments[11].get();
 	std::ostream &output_stream = p_interpreter.ExecutionOutputStream();
 	
 	if (num_treeseq_declarations_ > 0)
@@ -9444,8 +11050,102 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::strin
 	running_coalescence_checks_ = arg_checkCoalescence_value->LogicalAtIndex(0, nullptr);
 	running_treeseq_crosschecks_ = arg_runCrosschecks_value->LogicalAtIndex(0, nullptr);
 	treeseq_crosschecks_interval_ = 1;		// this interval is presently not exposed in the Eidos API
+	simplify_in_background_ = arg_simplifyInBackground_value->LogicalAtIndex(0, nullptr);
+	
+	// coalescence checks are done on the tables right after simplification, whereas background simplification
+	// incorporates its result only in a later generation, so the two can't be used together
+	if (simplify_in_background_ && running_coalescence_checks_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() does not allow simplifyInBackground to be T when checkCoalescence is T." << EidosTerminate();
+	
+	optimize_simplification_ = arg_optimizeSimplification_value->LogicalAtIndex(0, nullptr);
+	
+	if (optimize_simplification_ && (arg_simplificationRatio_value->Type() != EidosValueType::kValueNULL))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires simplificationRatio to be NULL when optimizeSimplification is T." << EidosTerminate();
+	
+	if (arg_maxTableMemory_value->Type() != EidosValueType::kValueNULL)
+	{
+		double max_table_memory = arg_maxTableMemory_value->FloatAtIndex(0, nullptr);
+		
+		if (std::isnan(max_table_memory) || (max_table_memory <= 0))
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires maxTableMemory to be > 0." << EidosTerminate();
+		
+		max_table_memory_ = std::isinf(max_table_memory) ? 0 : (size_t)max_table_memory;
+	}
+	
+	if (arg_checkpointPath_value->Type() != EidosValueType::kValueNULL)
+	{
+		checkpoint_path_ = arg_checkpointPath_value->StringAtIndex(0, nullptr);
+		
+		if (checkpoint_path_.empty())
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires checkpointPath to be a non-empty path." << EidosTerminate();
+		if (arg_checkpointInterval_value->Type() == EidosValueType::kValueNULL)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires checkpointInterval when checkpointPath is supplied." << EidosTerminate();
+		
+		int64_t checkpoint_interval = arg_checkpointInterval_value->IntAtIndex(0, nullptr);
+		
+		if (checkpoint_interval <= 0)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires checkpointInterval to be > 0." << EidosTerminate();
+		
+		checkpoint_interval_ = SLiMCastToGenerationTypeOrRaise(checkpoint_interval);
+	}
+	else if (arg_checkpointInterval_value->Type() != EidosValueType::kValueNULL)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires checkpointPath when checkpointInterval is supplied." << EidosTerminate();
+	
+	// Overlaid mutation types are resolved in ResolveOverlayMutationTypes() once initialization is complete, since they may not exist yet
+	overlay_mutation_type_ids_.clear();
+	
+	if (arg_overlayMutationTypes_value->Type() != EidosValueType::kValueNULL)
+	{
+		if (!recording_mutations_)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires recordMutations=T when overlayMutationTypes is supplied." << EidosTerminate();
+		
+		int overlay_count = arg_overlayMutationTypes_value->Count();
+		
+		for (int overlay_index = 0; overlay_index < overlay_count; ++overlay_index)
+		{
+			slim_objectid_t mutation_type_id = (arg_overlayMutationTypes_value->Type() == EidosValueType::kValueInt) ? SLiMCastToObjectidTypeOrRaise(arg_overlayMutationTypes_value->IntAtIndex(overlay_index, nullptr)) : ((MutationType *)arg_overlayMutationTypes_value->ObjectElementAtIndex(overlay_index, nullptr))->mutation_type_id_;
+			
+			overlay_mutation_type_ids_.emplace_back(mutation_type_id);
+		}
+		
+		// overlaid mutations are drawn from their own RNG, seeded from the model's seed like the sampled crosscheck RNG below, so that
+		// writing a tree sequence does not change the model's subsequent behavior
+		Eidos_InitializeRNG(overlay_rng_);
+		Eidos_SetRNGSeed(overlay_rng_, Eidos_RNGStreamSeed(gEidos_RNG.rng_last_seed_, -2));
+	}
+	
+	crosscheck_sample_size_ = arg_crosscheckSampleSize_value->IntAtIndex(0, nullptr);
+	
+	if (crosscheck_sample_size_ < 0)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires crosscheckSampleSize to be >= 0." << EidosTerminate();
+	
+	if (crosscheck_sample_size_ > 0)
+	{
+		if (!recording_mutations_)
+			EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires recordMutations=T when crosscheckSampleSize is greater than 0." << EidosTerminate();
+		
+		// the sampled crosschecks use their own RNG, seeded from the model's seed, so that turning them on does not change the model's
+		// behavior; the seed is derived as for an RNG stream, but with an index that no thread stream uses
+		Eidos_InitializeRNG(crosscheck_rng_);
+		Eidos_SetRNGSeed(crosscheck_rng_, Eidos_RNGStreamSeed(gEidos_RNG.rng_last_seed_, -1));
+	}
 	
-	if ((arg_simplificationRatio_value->Type() == EidosValueType::kValueNULL) && (arg_simplificationInterval_value->Type() == EidosValueType::kValueNULL))
+	if (optimize_simplification_)
+	{
+		// The interval is chosen by the cost model; simplificationInterval, if given, is the initial interval
+		simplification_ratio_ = 0.0;
+		simplification_interval_ = -1;
+		simplify_interval_ = 20;
+		
+		if (arg_simplificationInterval_value->Type() != EidosValueType::kValueNULL)
+		{
+			simplify_interval_ = arg_simplificationInterval_value->IntAtIndex(0, nullptr);
+			
+			if (simplify_interval_ <= 0)
+				EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteContextFunction_initializeTreeSeq): initializeTreeSeq() requires simplificationInterval to be > 0." << EidosTerminate();
+		}
+	}
+	else if ((arg_simplificationRatio_value->Type() == EidosValueType::kValueNULL) && (arg_simplificationInterval_value->Type() == EidosValueType::kValueNULL))
 	{
 		// Both ratio and interval are NULL; use the default behavior of a ratio of 10
 		simplification_ratio_ = 10.0;
@@ -9533,6 +11233,51 @@ EidosValue_SP SLiMSim::ExecuteContextFunction_initializeTreeSeq(const std::strin
 			if (previous_params) output_stream << ", ";
 			output_stream << "runCrosschecks = " << (running_treeseq_crosschecks_ ? "T" : "F");
 			previous_params = true;
+		}
+		
+		if (simplify_in_background_)
+		{
+			if (previous_params) output_stream << ", ";
+			output_stream << "simplifyInBackground = " << (simplify_in_background_ ? "T" : "F");
+			previous_params = true;
+		}
+		
+		if (optimize_simplification_)
+		{
+			if (previous_params) output_stream << ", ";
+			output_stream << "optimizeSimplification = " << (optimize_simplification_ ? "T" : "F");
+			previous_params = true;
+		}
+		
+		if (arg_maxTableMemory_value->Type() != EidosValueType::kValueNULL)
+		{
+			if (previous_params) output_stream << ", ";
+			output_stream << "maxTableMemory = " << arg_maxTableMemory_value->FloatAtIndex(0, nullptr);
+			previous_params = true;
+		}
+		
+		if (!checkpoint_path_.empty())
+		{
+			if (previous_params) output_stream << ", ";
+			output_stream << "checkpointPath = '" << checkpoint_path_ << "', checkpointInterval = " << checkpoint_interval_;
+			previous_params = true;
+		}
+		
+		if (overlay_mutation_type_ids_.size())
+		{
+			if (previous_params) output_stream << ", ";
+			output_stream << "overlayMutationTypes = c(";
+			for (size_t overlay_index = 0; overlay_index < overlay_mutation_type_ids_.size(); ++overlay_index)
+				output_stream << (overlay_index ? ", " : "") << overlay_mutation_type_ids_[overlay_index];
+			output_stream << ")";
+			previous_params = true;
+		}
+		
+		if (crosscheck_sample_size_ > 0)
+		{
+			if (previous_params) output_stream << ", ";
+			output_stream << "crosscheckSampleSize = " << crosscheck_sample_size_;
+			previous_params = true;
 			(void)previous_params;	// dead store above is deliberate
 		}
 		
@@ -9603,7 +11348,7 @@ const std::vector<EidosFunctionSignature_SP> *SLiMSim::ZeroGenerationFunctionSig
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeGenomicElementType, nullptr, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_GenomicElementType_Class, "SLiM"))
 										->AddIntString_S("id")->AddIntObject("mutationTypes", gSLiM_MutationType_Class)->AddNumeric("proportions")->AddFloat_ON("mutationMatrix", gStaticEidosValueNULL));
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeInteractionType, nullptr, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_InteractionType_Class, "SLiM"))
-										->AddIntString_S("id")->AddString_S(gStr_spatiality)->AddLogical_OS(gStr_reciprocal, gStaticEidosValue_LogicalF)->AddNumeric_OS(gStr_maxDistance, gStaticEidosValue_FloatINF)->AddString_OS(gStr_sexSegregation, gStaticEidosValue_StringDoubleAsterisk));
+										->AddIntString_S("id")->AddString_S(gStr_spatiality)->AddLogical_OS(gStr_reciprocal, gStaticEidosValue_LogicalF)->AddNumeric_OS(gStr_maxDistance, gStaticEidosValue_FloatINF)->AddString_OS(gStr_sexSegregation, gStaticEidosValue_StringDoubleAsterisk)->AddString_OS(gStr_spatialIndex, gStaticEidosValue_StringKDTree));
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeMutationType, nullptr, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_MutationType_Class, "SLiM"))
 									   ->AddIntString_S("id")->AddNumeric_S("dominanceCoeff")->AddString_S("distributionType")->AddEllipsis());
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeMutationTypeNuc, nullptr, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_MutationType_Class, "SLiM"))
@@ -9621,7 +11366,7 @@ const std::vector<EidosFunctionSignature_SP> *SLiMSim::ZeroGenerationFunctionSig
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeSLiMOptions, nullptr, kEidosValueMaskVOID, "SLiM"))
 									   ->AddLogical_OS("keepPedigrees", gStaticEidosValue_LogicalF)->AddString_OS("dimensionality", gStaticEidosValue_StringEmpty)->AddString_OS("periodicity", gStaticEidosValue_StringEmpty)->AddInt_OS("mutationRuns", gStaticEidosValue_Integer0)->AddLogical_OS("preventIncidentalSelfing", gStaticEidosValue_LogicalF)->AddLogical_OS("nucleotideBased", gStaticEidosValue_LogicalF));
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeTreeSeq, nullptr, kEidosValueMaskVOID, "SLiM"))
-									   ->AddLogical_OS("recordMutations", gStaticEidosValue_LogicalT)->AddNumeric_OSN("simplificationRatio", gStaticEidosValueNULL)->AddInt_OSN("simplificationInterval", gStaticEidosValueNULL)->AddLogical_OS("checkCoalescence", gStaticEidosValue_LogicalF)->AddLogical_OS("runCrosschecks", gStaticEidosValue_LogicalF));
+									   ->AddLogical_OS("recordMutations", gStaticEidosValue_LogicalT)->AddNumeric_OSN("simplificationRatio", gStaticEidosValueNULL)->AddInt_OSN("simplificationInterval", gStaticEidosValueNULL)->AddLogical_OS("checkCoalescence", gStaticEidosValue_LogicalF)->AddLogical_OS("runCrosschecks", gStaticEidosValue_LogicalF)->AddLogical_OS("simplifyInBackground", gStaticEidosValue_LogicalF)->AddLogical_OS("optimizeSimplification", gStaticEidosValue_LogicalF)->AddNumeric_OSN("maxTableMemory", gStaticEidosValueNULL)->AddString_OSN("checkpointPath", gStaticEidosValueNULL)->AddInt_OSN("checkpointInterval", gStaticEidosValueNULL)->AddIntObject_ON("overlayMutationTypes", gSLiM_MutationType_Class, gStaticEidosValueNULL)->AddInt_OS("crosscheckSampleSize", gStaticEidosValue_Integer0));
 		sim_0_signatures_.emplace_back((EidosFunctionSignature *)(new EidosFunctionSignature(gStr_initializeSLiMModelType, nullptr, kEidosValueMaskVOID, "SLiM"))
 									   ->AddString_S("modelType"));
 	}
@@ -10113,6 +11858,7 @@ EidosValue_SP SLiMSim::ExecuteInstanceMethod(EidosGlobalStringID p_method_id, co
 #endif	// SLIM_WF_ONLY
 			
 		case gID_addSubpop:						return ExecuteMethod_addSubpop(p_method_id, p_arguments, p_argument_count, p_interpreter);
+		case gID_addSubpopFromCoalescent:		return ExecuteMethod_addSubpopFromCoalescent(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_deregisterScriptBlock:			return ExecuteMethod_deregisterScriptBlock(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_mutationFrequencies:
 		case gID_mutationCounts:				return ExecuteMethod_mutationFreqsCounts(p_method_id, p_arguments, p_argument_count, p_interpreter);
@@ -10136,6 +11882,7 @@ EidosValue_SP SLiMSim::ExecuteInstanceMethod(EidosGlobalStringID p_method_id, co
 		case gID_rescheduleScriptBlock:			return ExecuteMethod_rescheduleScriptBlock(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_simulationFinished:			return ExecuteMethod_simulationFinished(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_treeSeqCoalesced:				return ExecuteMethod_treeSeqCoalesced(p_method_id, p_arguments, p_argument_count, p_interpreter);
+		case gID_treeSeqCrosscheckCounts:		return ExecuteMethod_treeSeqCrosscheckCounts(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_treeSeqSimplify:				return ExecuteMethod_treeSeqSimplify(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_treeSeqRememberIndividuals:	return ExecuteMethod_treeSeqRememberIndividuals(p_method_id, p_arguments, p_argument_count, p_interpreter);
 		case gID_treeSeqOutput:					return ExecuteMethod_treeSeqOutput(p_method_id, p_arguments, p_argument_count, p_interpreter);
@@ -10182,6 +11929,56 @@ EidosValue_SP SLiMSim::ExecuteMethod_addSubpop(EidosGlobalStringID p_method_id,
 	return symbol_entry.second;
 }
 
+//	*********************	– (object<Subpopulation>$)addSubpopFromCoalescent(is$ subpopID, integer$ size, [Nif$ Ne = NULL], [float$ sexRatio = 0.5])
+//
+EidosValue_SP SLiMSim::ExecuteMethod_addSubpopFromCoalescent(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
+{
+#pragma unused (p_method_id, p_arguments, p_argument_count, p_interpreter)
+	SLiMGenerationStage gen_stage = GenerationStage();
+	
+	if ((gen_stage != SLiMGenerationStage::kWFStage1ExecuteEarlyScripts) && (gen_stage != SLiMGenerationStage::kWFStage5ExecuteLateScripts) &&
+		(gen_stage != SLiMGenerationStage::kNonWFStage2ExecuteEarlyScripts) && (gen_stage != SLiMGenerationStage::kNonWFStage6ExecuteLateScripts))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_addSubpopFromCoalescent): addSubpopFromCoalescent() may only be called from an early() or late() event." << EidosTerminate();
+	if ((executing_block_type_ != SLiMEidosBlockType::SLiMEidosEventEarly) && (executing_block_type_ != SLiMEidosBlockType::SLiMEidosEventLate))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_addSubpopFromCoalescent): addSubpopFromCoalescent() may not be called from inside a callback." << EidosTerminate();
+	if (!recording_tree_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_addSubpopFromCoalescent): addSubpopFromCoalescent() requires tree-sequence recording to be enabled with initializeTreeSeq()." << EidosTerminate();
+	if (sex_enabled_ && (modeled_chromosome_type_ != GenomeType::kAutosome))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_addSubpopFromCoalescent): addSubpopFromCoalescent() is only supported when modeling autosomes." << EidosTerminate();
+	
+	EidosValue *subpopID_value = p_arguments[0].get();
+	EidosValue *size_value = p_arguments[1].get();
+	EidosValue *Ne_value = p_arguments[2].get();
+	EidosValue *sexRatio_value = p_arguments[3].get();
+	
+	slim_objectid_t subpop_id = SLiM_ExtractObjectIDFromEidosValue_is(subpopID_value, 0, 'p');
+	slim_popsize_t subpop_size = SLiMCastToPopsizeTypeOrRaise(size_value->IntAtIndex(0, nullptr));
+	double effective_size = (Ne_value->Type() == EidosValueType::kValueNULL) ? subpop_size : Ne_value->FloatAtIndex(0, nullptr);
+	
+	if (!std::isfinite(effective_size) || (effective_size <= 0.0))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_addSubpopFromCoalescent): addSubpopFromCoalescent() requires Ne to be greater than 0 and finite." << EidosTerminate();
+	
+	double sex_ratio = sexRatio_value->FloatAtIndex(0, nullptr);
+	
+	if ((sex_ratio != 0.5) && !sex_enabled_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_addSubpopFromCoalescent): addSubpopFromCoalescent() sex ratio supplied in non-sexual simulation." << EidosTerminate();
+	
+	// construct the subpop just as addSubpop() does, and then give its genomes a coalescent history in the tree sequence
+	Subpopulation *new_subpop = population_.AddSubpopulation(subpop_id, subpop_size, sex_ratio);
+	
+	AddCoalescentAncestry(new_subpop, effective_size);
+	
+	// define a new Eidos variable to refer to the new subpopulation
+	EidosSymbolTableEntry &symbol_entry = new_subpop->SymbolTableEntry();
+	
+	if (p_interpreter.SymbolTable().ContainsSymbol(symbol_entry.first))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_addSubpopFromCoalescent): addSubpopFromCoalescent() symbol " << Eidos_StringForGlobalStringID(symbol_entry.first) << " was already defined prior to its definition here." << EidosTerminate();
+	
+	simulation_constants_->InitializeConstantSymbolEntry(symbol_entry);
+	
+	return symbol_entry.second;
+}
+
 #ifdef SLIM_WF_ONLY
 //	*********************	– (object<Subpopulation>$)addSubpopSplit(is$ subpopID, integer$ size, io<Subpopulation>$ sourceSubpop, [float$ sexRatio = 0.5])
 //
@@ -10925,6 +12722,9 @@ EidosValue_SP SLiMSim::ExecuteMethod_outputUsage(EidosGlobalStringID p_method_id
 		out << "      Refcount buffer: ";
 		PrintBytes(out, usage.mutationRefcountBuffer);
 		
+		out << "      Hot side buffers: ";
+		PrintBytes(out, usage.mutationHotBuffers);
+		
 		out << "      Unused pool space: ";
 		PrintBytes(out, usage.mutationUnusedPoolSpace);
 	}
@@ -11126,7 +12926,7 @@ EidosValue_SP SLiMSim::ExecuteMethod_registerEarlyLateEvent(EidosGlobalStringID
 	return new_script_block->SelfSymbolTableEntry().second;
 }
 
-//	*********************	– (object<SLiMEidosBlock>$)registerFitnessCallback(Nis$ id, string$ source, Nio<MutationType>$ mutType, [Nio<Subpopulation>$ subpop = NULL], [Ni$ start = NULL], [Ni$ end = NULL])
+//	*********************	– (object<SLiMEidosBlock>$)registerFitnessCallback(Nis$ id, string$ source, Nio<MutationType>$ mutType, [Nio<Subpopulation>$ subpop = NULL], [Ni$ start = NULL], [Ni$ end = NULL], [logical$ vectorized = F])
 //
 EidosValue_SP SLiMSim::ExecuteMethod_registerFitnessCallback(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
 {
@@ -11137,6 +12937,7 @@ EidosValue_SP SLiMSim::ExecuteMethod_registerFitnessCallback(EidosGlobalStringID
 	EidosValue *subpop_value = p_arguments[3].get();
 	EidosValue *start_value = p_arguments[4].get();
 	EidosValue *end_value = p_arguments[5].get();
+	EidosValue *vectorized_value = p_arguments[6].get();
 	
 	slim_objectid_t script_id = -1;		// used if id_value is NULL, to indicate an anonymous block
 	std::string script_string = source_value->StringAtIndex(0, nullptr);
@@ -11154,8 +12955,12 @@ EidosValue_SP SLiMSim::ExecuteMethod_registerFitnessCallback(EidosGlobalStringID
 	if (subpop_value->Type() != EidosValueType::kValueNULL)
 		subpop_id = (subpop_value->Type() == EidosValueType::kValueInt) ? SLiMCastToObjectidTypeOrRaise(subpop_value->IntAtIndex(0, nullptr)) : ((Subpopulation *)subpop_value->ObjectElementAtIndex(0, nullptr))->subpopulation_id_;
 	
+	bool vectorized = vectorized_value->LogicalAtIndex(0, nullptr);
+	
 	if (start_generation > end_generation)
 		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_registerFitnessCallback): registerFitnessCallback() requires start <= end." << EidosTerminate();
+	if (vectorized && (mut_type_id != -2))
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_registerFitnessCallback): registerFitnessCallback() supports vectorized=T only for global fitness callbacks (mutType=NULL)." << EidosTerminate();
 	
 	CheckScheduling(start_generation, (model_type_ == SLiMModelType::kModelTypeWF) ? SLiMGenerationStage::kWFStage6CalculateFitness : SLiMGenerationStage::kNonWFStage3CalculateFitness);
 	
@@ -11165,6 +12970,7 @@ EidosValue_SP SLiMSim::ExecuteMethod_registerFitnessCallback(EidosGlobalStringID
 	
 	new_script_block->mutation_type_id_ = mut_type_id;
 	new_script_block->subpopulation_id_ = subpop_id;
+	new_script_block->vectorized_ = vectorized;
 	
 	AddScriptBlock(new_script_block, &p_interpreter, nullptr);		// takes ownership from us
 	
@@ -11562,6 +13368,25 @@ EidosValue_SP SLiMSim::ExecuteMethod_treeSeqCoalesced(EidosGlobalStringID p_meth
 	return (last_coalescence_state_ ? gStaticEidosValue_LogicalT : gStaticEidosValue_LogicalF);
 }
 
+// TREE SEQUENCE RECORDING
+//	*********************	- (integer)treeSeqCrosscheckCounts(void)
+//
+EidosValue_SP SLiMSim::ExecuteMethod_treeSeqCrosscheckCounts(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter)
+{
+#pragma unused (p_method_id, p_arguments, p_argument_count, p_interpreter)
+	if (!recording_tree_)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqCrosscheckCounts): treeSeqCrosscheckCounts() may only be called when tree recording is enabled." << EidosTerminate();
+	if (crosscheck_sample_size_ == 0)
+		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqCrosscheckCounts): treeSeqCrosscheckCounts() may only be called when sampled crosschecks are enabled; pass crosscheckSampleSize to initializeTreeSeq() to enable this feature." << EidosTerminate();
+	
+	EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(2);
+	
+	int_result->set_int_no_check(crosscheck_check_count_, 0);
+	int_result->set_int_no_check(crosscheck_divergence_count_, 1);
+	
+	return EidosValue_SP(int_result);
+}
+
 // TREE SEQUENCE RECORDING
 //	*********************	- (void)treeSeqSimplify(void)
 //
@@ -11602,6 +13427,9 @@ EidosValue_SP SLiMSim::ExecuteMethod_treeSeqRememberIndividuals(EidosGlobalStrin
 	if ((executing_block_type_ == SLiMEidosBlockType::SLiMEidosMateChoiceCallback) || (executing_block_type_ == SLiMEidosBlockType::SLiMEidosModifyChildCallback) || (executing_block_type_ == SLiMEidosBlockType::SLiMEidosRecombinationCallback))
 		EIDOS_TERMINATION << "ERROR (SLiMSim::ExecuteMethod_treeSeqRememberIndividuals): treeSeqRememberIndividuals() may not be called from inside a mateChoice(), modifyChild(), or recombination() callback." << EidosTerminate();
 	
+	// remembered genomes are kept as node IDs in tables_, so any background simplification needs to be incorporated first
+	FinishBackgroundSimplification();
+	
 	if (individuals_value->Count() == 1)
 	{
 		Individual *ind = (Individual *)individuals_value->ObjectElementAtIndex(0, nullptr);
@@ -11719,6 +13547,7 @@ const std::vector<const EidosMethodSignature *> *SLiMSim_Class::Methods(void) co
 		methods = new std::vector<const EidosMethodSignature *>(*SLiMEidosDictionary_Class::Methods());
 		
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_addSubpop, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Subpopulation_Class))->AddIntString_S("subpopID")->AddInt_S("size")->AddFloat_OS("sexRatio", gStaticEidosValue_Float0Point5));
+		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_addSubpopFromCoalescent, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Subpopulation_Class))->AddIntString_S("subpopID")->AddInt_S("size")->AddNumeric_OSN("Ne", gStaticEidosValueNULL)->AddFloat_OS("sexRatio", gStaticEidosValue_Float0Point5));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_addSubpopSplit, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_Subpopulation_Class))->AddIntString_S("subpopID")->AddInt_S("size")->AddIntObject_S("sourceSubpop", gSLiM_Subpopulation_Class)->AddFloat_OS("sexRatio", gStaticEidosValue_Float0Point5));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_countOfMutationsOfType, kEidosValueMaskInt | kEidosValueMaskSingleton))->AddIntObject_S("mutType", gSLiM_MutationType_Class));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_deregisterScriptBlock, kEidosValueMaskVOID))->AddIntObject("scriptBlocks", gSLiM_SLiMEidosBlock_Class));
@@ -11733,7 +13562,7 @@ const std::vector<const EidosMethodSignature *> *SLiMSim_Class::Methods(void) co
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_recalculateFitness, kEidosValueMaskVOID))->AddInt_OSN("generation", gStaticEidosValueNULL));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_registerEarlyEvent, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_SLiMEidosBlock_Class))->AddIntString_SN("id")->AddString_S("source")->AddInt_OSN("start", gStaticEidosValueNULL)->AddInt_OSN("end", gStaticEidosValueNULL));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_registerLateEvent, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_SLiMEidosBlock_Class))->AddIntString_SN("id")->AddString_S("source")->AddInt_OSN("start", gStaticEidosValueNULL)->AddInt_OSN("end", gStaticEidosValueNULL));
-		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_registerFitnessCallback, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_SLiMEidosBlock_Class))->AddIntString_SN("id")->AddString_S("source")->AddIntObject_SN("mutType", gSLiM_MutationType_Class)->AddIntObject_OSN("subpop", gSLiM_Subpopulation_Class, gStaticEidosValueNULL)->AddInt_OSN("start", gStaticEidosValueNULL)->AddInt_OSN("end", gStaticEidosValueNULL));
+		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_registerFitnessCallback, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_SLiMEidosBlock_Class))->AddIntString_SN("id")->AddString_S("source")->AddIntObject_SN("mutType", gSLiM_MutationType_Class)->AddIntObject_OSN("subpop", gSLiM_Subpopulation_Class, gStaticEidosValueNULL)->AddInt_OSN("start", gStaticEidosValueNULL)->AddInt_OSN("end", gStaticEidosValueNULL)->AddLogical_OS("vectorized", gStaticEidosValue_LogicalF));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_registerInteractionCallback, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_SLiMEidosBlock_Class))->AddIntString_SN("id")->AddString_S("source")->AddIntObject_S("intType", gSLiM_InteractionType_Class)->AddIntObject_OSN("subpop", gSLiM_Subpopulation_Class, gStaticEidosValueNULL)->AddInt_OSN("start", gStaticEidosValueNULL)->AddInt_OSN("end", gStaticEidosValueNULL));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_registerMateChoiceCallback, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_SLiMEidosBlock_Class))->AddIntString_SN("id")->AddString_S("source")->AddIntObject_OSN("subpop", gSLiM_Subpopulation_Class, gStaticEidosValueNULL)->AddInt_OSN("start", gStaticEidosValueNULL)->AddInt_OSN("end", gStaticEidosValueNULL));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_registerModifyChildCallback, kEidosValueMaskObject | kEidosValueMaskSingleton, gSLiM_SLiMEidosBlock_Class))->AddIntString_SN("id")->AddString_S("source")->AddIntObject_OSN("subpop", gSLiM_Subpopulation_Class, gStaticEidosValueNULL)->AddInt_OSN("start", gStaticEidosValueNULL)->AddInt_OSN("end", gStaticEidosValueNULL));
@@ -11743,6 +13572,7 @@ const std::vector<const EidosMethodSignature *> *SLiMSim_Class::Methods(void) co
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_rescheduleScriptBlock, kEidosValueMaskObject, gSLiM_SLiMEidosBlock_Class))->AddObject_S("block", gSLiM_SLiMEidosBlock_Class)->AddInt_OSN("start", gStaticEidosValueNULL)->AddInt_OSN("end", gStaticEidosValueNULL)->AddInt_ON("generations", gStaticEidosValueNULL));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_simulationFinished, kEidosValueMaskVOID)));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqCoalesced, kEidosValueMaskLogical | kEidosValueMaskSingleton)));
+		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqCrosscheckCounts, kEidosValueMaskInt)));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqSimplify, kEidosValueMaskVOID)));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqRememberIndividuals, kEidosValueMaskVOID))->AddObject("individuals", gSLiM_Individual_Class));
 		methods->emplace_back((EidosInstanceMethodSignature *)(new EidosInstanceMethodSignature(gStr_treeSeqOutput, kEidosValueMaskVOID))->AddString_S("path")->AddLogical_OS("simplify", gStaticEidosValue_LogicalT)->AddLogical_OS("_binary", gStaticEidosValue_LogicalT));
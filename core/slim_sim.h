@@ -31,6 +31,7 @@
 #include <map>
 #include <vector>
 #include <iostream>
+#include <thread>
 
 #include "slim_globals.h"
 #include "mutation.h"
@@ -216,6 +217,7 @@ typedef struct
 	int64_t mutationObjects_count;
 	size_t mutationObjects;
 	size_t mutationRefcountBuffer;
+	size_t mutationHotBuffers;
 	size_t mutationUnusedPoolSpace;
 	
 	int64_t mutationRunObjects_count;
@@ -286,12 +288,15 @@ private:
 	std::vector<SLiMEidosBlock*> cached_reproduction_callbacks_;
 	std::vector<SLiMEidosBlock*> cached_userdef_functions_;
 	
-#ifdef SLIMGUI
+#if defined(SLIMGUI) || (SLIMPROFILING == 1)
 public:
 	
+#endif
+#ifdef SLIMGUI
 	bool simulation_valid_ = true;													// set to false if a terminating condition is encountered while running in SLiMgui
-
-#if (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#endif
+	
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	eidos_profile_t profile_stage_totals_[7];										// profiling clocks; index 0 is initialize(), the rest follow SLiMGenerationStage
 	eidos_profile_t profile_callback_totals_[11];									// profiling clocks; these follow SLiMEidosBlockType, except no SLiMEidosUserDefinedFunction
@@ -310,9 +315,9 @@ public:
 	int64_t profile_mutrun_nonneutral_recache_total_;								// of profile_unique_mutrun_total_, how many mutruns regenerated their nonneutral cache
 	int64_t profile_max_mutation_index_;											// the largest mutation index seen over the course of the profile
 #endif	// SLIM_USE_NONNEUTRAL_CACHES
-#endif	// (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#endif	// (SLIMPROFILING == 1)
 	
-#else
+#ifndef SLIMGUI
 private:
 #endif
 	
@@ -426,8 +431,27 @@ private:
 	bool recording_tree_ = false;				// true if we are doing tree sequence recording
 	bool recording_mutations_ = false;			// true if we are recording mutations in our tree sequence tables
 	
-	tsk_table_collection_t tables_;
+	tsk_table_collection_t tables_{};
 	tsk_bookmark_t table_position_;
+	tsk_size_t sorted_edge_count_ = 0;			// the number of edges at the start of the edge table known to be sorted, as of the last sort/simplify
+	
+	// rows recorded by RecordNewGenome() and RecordNewDerivedState() are buffered here, column by column, and bulk-appended to
+	// tables_ by FlushTreeSequenceBuffers(); anything that reads or modifies tables_ other than by appending flushes first
+	std::vector<tsk_flags_t> buffered_node_flags_;
+	std::vector<double> buffered_node_time_;
+	std::vector<tsk_id_t> buffered_node_population_;
+	std::vector<char> buffered_node_metadata_;				// GenomeMetadataRec records, one per node
+	std::vector<double> buffered_edge_left_;
+	std::vector<double> buffered_edge_right_;
+	std::vector<tsk_id_t> buffered_edge_parent_;
+	std::vector<tsk_id_t> buffered_edge_child_;
+	std::vector<double> buffered_site_position_;
+	std::vector<tsk_id_t> buffered_mutation_site_;
+	std::vector<tsk_id_t> buffered_mutation_node_;
+	std::vector<char> buffered_mutation_derived_state_;
+	std::vector<tsk_size_t> buffered_mutation_derived_state_offset_{0};	// always one longer than buffered_mutation_site_
+	std::vector<char> buffered_mutation_metadata_;
+	std::vector<tsk_size_t> buffered_mutation_metadata_offset_{0};		// always one longer than buffered_mutation_site_
 	
     std::vector<tsk_id_t> remembered_genomes_;
 	//Individual *current_new_individual_;
@@ -438,11 +462,58 @@ private:
 	bool running_treeseq_crosschecks_ = false;	// true if crosschecks between our tree sequence tables and SLiM's data are enabled
 	int treeseq_crosschecks_interval_ = 1;		// crosschecks, if enabled, will be done every treeseq_crosschecks_interval_ generations
 	
+	// sampled crosschecks, enabled with crosscheckSampleSize; see SampledCrosscheckTreeSeqIntegrity()
+	int64_t crosscheck_sample_size_ = 0;				// the number of genome/position pairs checked each generation; 0 if not used
+	Eidos_RNG_State crosscheck_rng_{};					// a private RNG, so that sampled crosschecks do not perturb the model's own draws
+	int64_t crosscheck_check_count_ = 0;				// the total number of genome/position pairs checked
+	int64_t crosscheck_divergence_count_ = 0;			// the number of those for which SLiM and the tables disagreed
+	bool crosscheck_index_valid_ = false;				// false if the tables have been reordered or replaced since the indices were extended
+	std::vector<tsk_id_t> crosscheck_edge_head_;		// for each node, the last edge row with that node as child, or TSK_NULL
+	std::vector<tsk_id_t> crosscheck_edge_next_;		// for each edge row, the previous edge row with the same child, or TSK_NULL
+	std::vector<tsk_id_t> crosscheck_mutation_head_;	// for each node, the last mutation row on that node, or TSK_NULL
+	std::vector<tsk_id_t> crosscheck_mutation_next_;	// for each mutation row, the previous mutation row on the same node, or TSK_NULL
+	
 	double simplification_ratio_;				// the pre:post table size ratio we target with our automatic simplification heuristic
 	int64_t simplification_interval_;			// the generation interval between simplifications; -1 if not used (in which case the ratio is used)
 	int64_t simplify_elapsed_ = 0;				// the number of generations elapsed since a simplification was done (automatic or otherwise)
 	double simplify_interval_;					// the current number of generations between automatic simplifications when using simplification_ratio_
 	
+	// background simplification, enabled with simplifyInBackground=T; see StartBackgroundSimplification()
+	bool simplify_in_background_ = false;				// true if auto-simplification should be done on a background thread
+	bool background_simplification_running_ = false;	// true if background_simplification_thread_ has been started and not yet joined
+	std::thread background_simplification_thread_;
+	tsk_table_collection_t background_tables_;			// a snapshot of tables_, simplified by the background thread
+	tsk_bookmark_t background_position_;				// the table sizes at the time of the snapshot
+	uint64_t background_table_size_ = 0;				// the total number of rows in the snapshot, for AdjustAutoSimplificationInterval()
+	size_t background_table_bytes_ = 0;					// the memory in use by the snapshot, for RecordSimplificationCost()
+	int64_t background_elapsed_ = 0;					// simplify_elapsed_ at the time of the snapshot
+	bool background_adjust_interval_ = false;			// true if the auto-simplification interval should be adjusted when finished
+	double background_work_ = 0.0;						// the work done by the background thread, from SimplificationWork()
+	tsk_size_t background_sorted_edge_count_ = 0;		// sorted_edge_count_ at the time of the snapshot
+	std::vector<tsk_id_t> background_samples_;			// the samples for the background simplification
+	std::vector<tsk_id_t> background_node_map_;			// the node map produced by the background simplification
+	int background_error_ = 0;							// a tskit error code from the background thread, or 0
+	const char *background_error_function_ = nullptr;	// the tskit function that produced background_error_
+	
+	// cost-model scheduling of auto-simplification, enabled with optimizeSimplification=T; see OptimizeAutoSimplificationInterval()
+	bool optimize_simplification_ = false;				// true if simplify_interval_ is chosen by the cost model rather than simplification_ratio_
+	size_t max_table_memory_ = 0;						// a ceiling on MemoryInUseForTables() that forces simplification; 0 if not used
+	double simplify_cost_sums_[5] = {0, 0, 0, 0, 0};	// discounted least-squares sums for the simplification cost model
+	int simplify_cost_observations_ = 0;				// the number of simplifications observed by the cost model
+	double simplify_growth_rows_ = 0.0;					// the smoothed number of table rows added per generation
+	double simplify_growth_bytes_ = 0.0;				// the smoothed number of table bytes added per generation
+	uint64_t simplify_retained_rows_ = 0;				// the number of table rows after the last simplification
+	size_t simplify_retained_bytes_ = 0;				// the table bytes in use after the last simplification
+	
+	// periodic checkpointing of the tree sequence, enabled with checkpointPath; see WriteTreeSequenceCheckpoint()
+	std::string checkpoint_path_;						// the .trees path a checkpoint is written to; empty if not checkpointing
+	slim_generation_t checkpoint_interval_ = 0;			// the number of generations between checkpoints
+	
+	// mutation types overlaid on the tree sequence at output rather than simulated, enabled with overlayMutationTypes; see OverlayMutations()
+	std::vector<slim_objectid_t> overlay_mutation_type_ids_;	// the ids given to initializeTreeSeq(), resolved by ResolveOverlayMutationTypes()
+	slim_generation_t overlay_start_generation_ = 0;	// overlaid mutations arise only after this generation (or in coalescent history); set when a .trees file is loaded
+	Eidos_RNG_State overlay_rng_{};						// a private RNG, so that overlaying mutations at output does not perturb the model's own draws
+	
 	slim_generation_t tree_seq_generation_ = 0;	// the generation for the tree sequence code, incremented after offspring generation
 												// this is needed since addSubpop() in an early() event makes one gen, and then the offspring
 												// arrive in the same generation according to SLiM, which confuses the tree-seq code
@@ -475,6 +546,7 @@ public:
 	bool warned_no_max_distance_ = false;
 	bool warned_inSLiMgui_deprecated_ = false;
 	bool warned_readFromVCF_mutIDs_unused_ = false;
+	bool warned_table_memory_ceiling_ = false;
 	
 	// these ivars are set around callbacks so we know what type of callback we're in, to prevent illegal operations during callbacks
 	SLiMEidosBlockType executing_block_type_ = SLiMEidosBlockType::SLiMEidosNoBlockType;	// the innermost callback type we're executing now
@@ -532,12 +604,14 @@ public:
 	void EnterStasisForMutationRunExperiments(void);
 	void MaintainMutationRunExperiments(double p_last_gen_runtime);
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	void CollectSLiMguiMemoryUsageProfileInfo(void);
 #if SLIM_USE_NONNEUTRAL_CACHES
 	void CollectSLiMguiMutationProfileInfo(void);
 #endif
+	void StartProfiling(void);														// zero all profile counts; Eidos_PrepareForProfiling() should be called first
+	void WriteProfileReport(std::ostream &p_out, eidos_profile_t p_elapsed_wall_clock, clock_t p_elapsed_cpu_clock, slim_generation_t p_start_generation, slim_generation_t p_elapsed_generations);	// a JSON report, for -profile
 #endif
 	
 	// Mutation stack policy checking
@@ -586,6 +660,8 @@ public:
 #pragma mark -
 	inline __attribute__((always_inline)) bool RecordingTreeSequence(void) const											{ return recording_tree_; }
 	inline __attribute__((always_inline)) bool RecordingTreeSequenceMutations(void) const									{ return recording_mutations_; }
+	inline __attribute__((always_inline)) bool OverlayingMutationTypes(void) const										{ return (overlay_mutation_type_ids_.size() > 0); }
+	inline __attribute__((always_inline)) int64_t CrosscheckDivergenceCount(void) const									{ return crosscheck_divergence_count_; }
 	inline __attribute__((always_inline)) void AboutToSplitSubpop(void)														{ tree_seq_generation_offset_ += 0.00001; }	// see Population::AddSubpopulationSplit()
 	
 	static void handle_error(std::string msg, int error);
@@ -598,6 +674,8 @@ public:
 	static void DerivedStatesToAscii(tsk_table_collection_t *p_tables);
 	
 	void RecordTablePosition(void);
+	void FlushTreeSequenceBuffers(void);
+	void ClearTreeSequenceBuffers(void);
 	void AllocateTreeSequenceTables(void);
 	void SetCurrentNewIndividual(Individual *p_individual);
 	void RecordNewGenome(std::vector<slim_position_t> *p_breakpoints, Genome *p_new_genome, const Genome *p_initial_parental_genome, const Genome *p_second_parental_genome);
@@ -612,10 +690,25 @@ public:
 	void WriteProvenanceTable(tsk_table_collection_t *p_tables, bool p_use_newlines);
 	void ReadProvenanceTable(tsk_table_collection_t *p_tables, slim_generation_t *p_generation, SLiMModelType *p_model_type, int *p_file_version);
 	void WriteTreeSequence(std::string &p_recording_tree_path, bool p_binary, bool p_simplify);
+	void WriteTreeSequenceCheckpoint(void);
+	void ResolveOverlayMutationTypes(void);
+	void OverlayMutations(tsk_table_collection_t *p_tables);
+	void AddCoalescentAncestry(Subpopulation *p_subpop, double p_effective_size);
     void ReorderIndividualTable(tsk_table_collection_t *p_tables, std::vector<int> p_individual_map, bool p_keep_unmapped);
+	static int SortTreeSequenceTables(tsk_table_collection_t *p_tables, tsk_size_t p_sorted_edge_count);
+	void CollectSimplificationSamples(std::vector<tsk_id_t> &p_samples);
+	void RemapNodeIDsAfterSimplification(const std::vector<tsk_id_t> &p_node_map, tsk_id_t p_appended_node_base);
 	void SimplifyTreeSequence(void);
+	static void _RunBackgroundSimplification(SLiMSim *p_sim);
+	void StartBackgroundSimplification(bool p_adjust_interval);
+	void FinishBackgroundSimplification(void);
 	void CheckCoalescenceAfterSimplification(void);
 	void CheckAutoSimplification(void);
+	static uint64_t TableRowCount(tsk_table_collection_t &p_tables);
+	static double SimplificationWork(tsk_table_collection_t &p_tables, tsk_size_t p_sorted_edge_count);
+	void RecordSimplificationCost(double p_work, int64_t p_generations, uint64_t p_rows_before, uint64_t p_rows_after, size_t p_bytes_before, size_t p_bytes_after);
+	void OptimizeAutoSimplificationInterval(void);
+	void AdjustAutoSimplificationInterval(uint64_t p_old_table_size, uint64_t p_new_table_size);
     void TreeSequenceDataFromAscii(std::string NodeFileName, 
             std::string EdgeFileName, std::string SiteFileName, std::string MutationFileName, 
             std::string IndividualsFileName, std::string PopulationFileName, std::string ProvenanceFileName);
@@ -623,19 +716,24 @@ public:
 	void RecordAllDerivedStatesFromSLiM(void);
 	void DumpMutationTable(void);
 	void CrosscheckTreeSeqIntegrity(void);
+	void SampledCrosscheckTreeSeqIntegrity(void);
 	void TSXC_Enable(void);
 	
 	void __TabulateSubpopulationsFromTreeSequence(std::unordered_map<slim_objectid_t, ts_subpop_info> &p_subpopInfoMap, tsk_treeseq_t *p_ts, SLiMModelType p_file_model_type);
-	void __CreateSubpopulationsFromTabulation(std::unordered_map<slim_objectid_t, ts_subpop_info> &p_subpopInfoMap, EidosInterpreter *p_interpreter, std::unordered_map<tsk_id_t, Genome *> &p_nodeToGenomeMap);
+	void __CreateSubpopulationsFromTabulation(std::unordered_map<slim_objectid_t, ts_subpop_info> &p_subpopInfoMap, EidosInterpreter *p_interpreter, std::vector<Genome *> &p_nodeToGenomeMap);
 	void __ConfigureSubpopulationsFromTables(EidosInterpreter *p_interpreter);
 	void __TabulateMutationsFromTables(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutMap, int p_file_version);
-	void __TallyMutationReferencesWithTreeSequence(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutMap, std::unordered_map<tsk_id_t, Genome *> p_nodeToGenomeMap, tsk_treeseq_t *p_ts);
+	template <typename F> static void __VisitExtantAllelesInTreeSequence(std::vector<Genome *> &p_nodeToGenomeMap, tsk_treeseq_t *p_ts, F p_visitor);
+	void __TallyMutationReferencesWithTreeSequence(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutMap, std::vector<Genome *> &p_nodeToGenomeMap, tsk_treeseq_t *p_ts);
 	void __CreateMutationsFromTabulation(std::unordered_map<slim_mutationid_t, ts_mut_info> &p_mutInfoMap, std::unordered_map<slim_mutationid_t, MutationIndex> &p_mutIndexMap);
-	void __AddMutationsFromTreeSequenceToGenomes(std::unordered_map<slim_mutationid_t, MutationIndex> &p_mutIndexMap, std::unordered_map<tsk_id_t, Genome *> p_nodeToGenomeMap, tsk_treeseq_t *p_ts);
+	void __AddMutationsFromTreeSequenceToGenomes(std::unordered_map<slim_mutationid_t, MutationIndex> &p_mutIndexMap, std::vector<Genome *> &p_nodeToGenomeMap, tsk_treeseq_t *p_ts);
 	slim_generation_t _InstantiateSLiMObjectsFromTables(EidosInterpreter *p_interpreter);								// given tree-seq tables, makes individuals, genomes, and mutations
 	slim_generation_t _InitializePopulationFromTskitTextFile(const char *p_file, EidosInterpreter *p_interpreter);	// initialize the population from an tskit text file
 	slim_generation_t _InitializePopulationFromTskitBinaryFile(const char *p_file, EidosInterpreter *p_interpreter);	// initialize the population from an tskit binary file
 	size_t MemoryUsageForTables(tsk_table_collection_t &p_tables);
+	size_t MemoryInUseForTables(tsk_table_collection_t &p_tables);
+	size_t MemoryUsageForTreeSequenceBuffers(void);
+	size_t MemoryInUseForTreeSequenceBuffers(void);
 	
 	//
 	// Eidos support
@@ -684,6 +782,7 @@ public:
 #endif	// SLIM_WF_ONLY
 	
 	EidosValue_SP ExecuteMethod_addSubpop(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
+	EidosValue_SP ExecuteMethod_addSubpopFromCoalescent(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_deregisterScriptBlock(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_mutationFreqsCounts(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_mutationsOfType(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
@@ -703,6 +802,7 @@ public:
 	EidosValue_SP ExecuteMethod_rescheduleScriptBlock(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_simulationFinished(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_treeSeqCoalesced(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
+	EidosValue_SP ExecuteMethod_treeSeqCrosscheckCounts(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_treeSeqSimplify(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_treeSeqRememberIndividuals(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
 	EidosValue_SP ExecuteMethod_treeSeqOutput(EidosGlobalStringID p_method_id, const EidosValue_SP *const p_arguments, int p_argument_count, EidosInterpreter &p_interpreter);
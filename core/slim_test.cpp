@@ -9,6 +9,8 @@
 
 #include "slim_test.h"
 #include "slim_sim.h"
+#include "subpopulation.h"
+#include "genome.h"
 #include "eidos_test.h"
 
 #include <iostream>
@@ -390,6 +392,102 @@ void _RunBasicTests(void)
 	
 	SLiMAssertScriptSuccess(basic_script);
 	
+	// Test that multithreaded code paths (offspring generation, fitness evaluation) produce exactly the same result as single-threaded code
+	std::string threads_script(R"V0G0N(
+							   
+							   initialize() {
+								   setSeed(17);
+								   initializeTreeSeq();
+								   initializeMutationRate(1e-5);
+								   initializeMutationType('m1', 0.5, 'f', 0.0);
+								   initializeMutationType('m2', 0.5, 'n', 0.0, 0.05);
+								   m2.mutationStackPolicy = 'l';
+								   initializeGenomicElementType('g1', c(m1,m2), c(1.0, 0.5));
+								   initializeGenomicElement(g1, 0, 99999);
+								   initializeRecombinationRate(c(1e-6, 0.5, 1e-6), c(49999, 50000, 99999));
+								   initializeSex('A');
+							   }
+							   1 { sim.addSubpop('p1', 200); sim.addSubpop('p2', 100); p2.setMigrationRates(p1, 0.1); }
+							   10 early() { print(sum(sim.mutationCounts(p1))); print(sum(sim.mutationCounts(NULL))); }
+							   20 late() { sim.treeSeqSimplify(); g = sim.subpopulations.genomes; print(size(g.mutations)); print(sum(g.mutations.position * seqAlong(g.mutations))); print(sum(sim.mutations.selectionCoeff * sim.mutationFrequencies(NULL))); }
+							   
+							   )V0G0N");
+	
+	// spatial interactions large enough to use the multithreaded k-d tree build and sparse array fill
+	std::string interaction_threads_script(R"V0G0N(
+										   
+										   initialize() {
+											   setSeed(17);
+											   initializeSLiMOptions(dimensionality='xyz');
+											   initializeSex('A');
+											   initializeMutationRate(0);
+											   initializeMutationType('m1', 0.5, 'f', 0.0);
+											   initializeGenomicElementType('g1', m1, 1.0);
+											   initializeGenomicElement(g1, 0, 99);
+											   initializeRecombinationRate(0);
+											   initializeInteractionType(1, 'x', maxDistance=0.0005);
+											   initializeInteractionType(2, 'xy', maxDistance=0.03, sexSegregation='FM');
+											   initializeInteractionType(3, 'xyz', maxDistance=0.06, sexSegregation='*M');
+											   initializeInteractionType(4, 'xy', maxDistance=0.03, spatialIndex='grid');
+											   i1.setInteractionFunction('n', 1.0, 0.0002);
+											   i2.setInteractionFunction('e', 2.0, 3.0);
+											   i3.setInteractionFunction('l', 1.0);
+											   i4.setInteractionFunction('c', 1.0, 0.01);
+										   }
+										   1 { sim.addSubpop('p1', 12000); }
+										   1:2 late() {
+											   inds = p1.individuals;
+											   inds.x = runif(12000); inds.y = runif(12000); inds.z = runif(12000);
+											   for (it in c(i1, i2, i3, i4)) {
+												   it.evaluate();
+												   t = it.totalOfNeighborStrengths(inds);
+												   print(format('%.17g', sum(t * seqAlong(t))));
+												   print(format('%.17g', sum(it.strength(inds[5]))));
+												   print(sum(it.nearestNeighbors(inds[0], 5).index));
+												   print(sum(it.drawByStrength(inds[11], 20).index));
+											   }
+										   }
+										   
+										   )V0G0N");
+	
+#ifdef _OPENMP
+	// these comparisons are meaningful only in builds that support multithreading
+	int saved_max_threads = gEidosMaxThreads;
+	
+	for (const std::string &script : {threads_script, interaction_threads_script})
+	{
+		std::string single_threaded_output, multithreaded_output;
+		
+		gSLiMOut.clear();
+		gSLiMOut.str("");
+		gEidosMaxThreads = 1;
+		SLiMAssertScriptSuccess(script);
+		single_threaded_output = gSLiMOut.str();
+		
+		gSLiMOut.clear();
+		gSLiMOut.str("");
+		gEidosMaxThreads = 4;
+		SLiMAssertScriptSuccess(script);
+		multithreaded_output = gSLiMOut.str();
+		
+		// skip the initial random seed, which differs between runs since the script sets its own seed afterwards
+		single_threaded_output.erase(0, single_threaded_output.find("\n\n"));
+		multithreaded_output.erase(0, multithreaded_output.find("\n\n"));
+		
+		if (single_threaded_output == multithreaded_output)
+		{
+			gSLiMTestSuccessCount++;
+		}
+		else
+		{
+			gSLiMTestFailureCount++;
+			std::cerr << "multithreaded execution : " << EIDOS_OUTPUT_FAILURE_TAG << " : output does not match single-threaded output" << std::endl;
+		}
+	}
+	
+	gEidosMaxThreads = saved_max_threads;
+#endif
+	
 	
 	// Test that stop() raises as it is supposed to
 	std::string stop_test(R"V0G0N(
@@ -646,7 +744,7 @@ void _RunInitTests(void)
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(); initializeSLiMOptions(); stop(); }", 1, 40, "may be called only once", __LINE__);
 	SLiMAssertScriptRaise("initialize() { initializeMutationRate(0.0); initializeSLiMOptions(); stop(); }", 1, 44, "must be called before", __LINE__);
 	
-	// Test (object<InteractionType>$)initializeInteractionType(is$ id, string$ spatiality, [logical$ reciprocal = F], [numeric$ maxDistance = INF], [string$ sexSegregation = "**"])
+	// Test (object<InteractionType>$)initializeInteractionType(is$ id, string$ spatiality, [logical$ reciprocal = F], [numeric$ maxDistance = INF], [string$ sexSegregation = "**"], [string$ spatialIndex = "kdtree"])
 	SLiMAssertScriptRaise("initialize() { initializeInteractionType(-1, ''); stop(); }", 1, 15, "identifier value is out of range", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeInteractionType(0, ''); stop(); }", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeInteractionType('i0', ''); stop(); }", __LINE__);
@@ -689,6 +787,11 @@ void _RunInitTests(void)
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(dimensionality='x'); initializeInteractionType(0, 'x', T, -0.1); stop(); }", 1, 58, "maxDistance must be >= 0.0", __LINE__);
 	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(dimensionality='x'); initializeInteractionType(0, 'x', T, 0.1, '*M'); stop(); }", 1, 58, "unsupported in non-sexual simulation", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='x'); initializeSex('A'); initializeInteractionType(0, 'x', T, 0.1, '*M'); stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='x'); initializeInteractionType(0, 'x', T, 0.1, spatialIndex='kdtree'); stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='x'); initializeInteractionType(0, 'x', T, 0.1, spatialIndex='grid'); stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='x'); initializeInteractionType(0, 'x', T, 0.1, spatialIndex='auto'); stop(); }", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(dimensionality='x'); initializeInteractionType(0, 'x', T, 0.1, spatialIndex='octree'); stop(); }", 1, 58, "unsupported spatialIndex value", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeSLiMOptions(dimensionality='x'); initializeInteractionType(0, '', T, spatialIndex='grid'); stop(); }", 1, 58, "must be 'kdtree' for non-spatial", __LINE__);
 	
 	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xyz'); initializeInteractionType(0, 'x'); stop(); }", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='xyz'); initializeInteractionType(0, 'y'); stop(); }", __LINE__);
@@ -782,6 +885,15 @@ void _RunSLiMSimTests(std::string temp_path)
 	SLiMAssertScriptRaise(gen1_setup + "1 { p7 = 17; sim.addSubpop('p7', 10); stop(); }", 1, 229, "already defined", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup + "1 { sim.addSubpop('p7', 10); sim.addSubpop(7, 10); stop(); }", 1, 245, "already exists", __LINE__);
 	
+	// Test sim - (object<Subpopulation>)addSubpopFromCoalescent(is$ subpopID, integer$ size, [Nif$ Ne], [float$ sexRatio])
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup + "1 { sim.addSubpopFromCoalescent('p1', 10); } " + gen2_stop, __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(runCrosschecks=T); } " + gen1_setup + "1 { x = sim.addSubpopFromCoalescent(1, 10, Ne=1000); if (x == p1) sim.addSubpopFromCoalescent(2, 20); } 10 { sim.treeSeqSimplify(); stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(); initializeSex('A'); } " + gen1_setup + "1 { sim.addSubpopFromCoalescent('p1', 10, sexRatio=0.4); } " + gen2_stop, __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_sex + "1 { sim.addSubpopFromCoalescent('p1', 10); } " + gen2_stop, 1, 278, "only supported when modeling autosomes", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup + "1 { sim.addSubpopFromCoalescent('p1', 10); } " + gen2_stop, 1, 220, "requires tree-sequence recording", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup + "1 { sim.addSubpopFromCoalescent('p1', 10, Ne=0); } " + gen2_stop, 1, 258, "requires Ne to be greater than 0", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup + "1 { sim.addSubpopFromCoalescent('p1', 10, sexRatio=0.4); } " + gen2_stop, 1, 258, "non-sexual simulation", __LINE__);
+	
 	// Test sim - (object<Subpopulation>)addSubpopSplit(is$ subpopID, integer$ size, io<Subpopulation>$ sourceSubpop, [float$ sexRatio])
 	SLiMAssertScriptStop(gen1_setup_p1 + "1 { sim.addSubpopSplit('p2', 10, p1); } " + gen2_stop, __LINE__);
 	SLiMAssertScriptStop(gen1_setup_p1 + "1 { sim.addSubpopSplit('p2', 10, 1); } " + gen2_stop, __LINE__);
@@ -906,7 +1018,7 @@ void _RunSLiMSimTests(std::string temp_path)
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { sim.registerLateEvent(1, '{ stop(); }', 0, 0); }", 1, 251, "out of range", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_p1 + "1 { sim.registerLateEvent(1, '{ $; }', 2, 2); }", 1, 2, "unexpected token '$'", __LINE__);
 	
-	// Test sim - (object<SLiMEidosBlock>)registerFitnessCallback(Nis$ id, string$ source, Nio<MutationType>$ mutType, [Nio<Subpopulation>$ subpop], [integer$ start], [integer$ end])
+	// Test sim - (object<SLiMEidosBlock>)registerFitnessCallback(Nis$ id, string$ source, Nio<MutationType>$ mutType, [Nio<Subpopulation>$ subpop], [integer$ start], [integer$ end], [logical$ vectorized = F])
 	SLiMAssertScriptStop(gen1_setup_highmut_p1 + "1 { sim.registerFitnessCallback(NULL, '{ stop(); }', 1, NULL, 5, 10); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_highmut_p1 + "1 { sim.registerFitnessCallback(NULL, '{ stop(); }', m1, NULL, 5, 10); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_highmut_p1 + "1 { sim.registerFitnessCallback(NULL, '{ stop(); }', NULL, NULL, 5, 10); }", __LINE__);
@@ -925,6 +1037,8 @@ void _RunSLiMSimTests(std::string temp_path)
 	SLiMAssertScriptRaise(gen1_setup_highmut_p1 + "1 { sim.registerFitnessCallback(1, '{ stop(); }', m1, NULL, -1, -1); }", 1, 251, "out of range", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_highmut_p1 + "1 { sim.registerFitnessCallback(1, '{ stop(); }', m1, NULL, 0, 0); }", 1, 251, "out of range", __LINE__);
 	SLiMAssertScriptRaise(gen1_setup_highmut_p1 + "1 { sim.registerFitnessCallback(1, '{ $; }', m1, NULL, 2, 2); }", 1, 2, "unexpected token '$'", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_highmut_p1 + "1 { sim.registerFitnessCallback(NULL, '{ if (size(individual) == 10) stop(); return rep(1.0, 10); }', NULL, p1, 1, 1, vectorized=T); } 10 { ; }", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_highmut_p1 + "1 { sim.registerFitnessCallback(1, '{ return 1.0; }', m1, NULL, 2, 2, vectorized=T); }", 1, 251, "only for global", __LINE__);
 	
 	// Test sim - (object<SLiMEidosBlock>)registerInteractionCallback(Nis$ id, string$ source, io<InteractionType>$ intType, [Nio<Subpopulation>$ subpop], [integer$ start], [integer$ end])
 	SLiMAssertScriptStop(gen1_setup_i1 + "1 { sim.registerInteractionCallback(NULL, '{ stop(); }', 1, NULL, 5, 10); }", __LINE__);
@@ -2932,6 +3046,30 @@ void _RunInteractionTypeTests(void)
 	SLiMAssertScriptRaise(gen1_setup_i1x + "1 { c(i1,i1).tag; }", 1, 430, "before being set", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_i1x + "1 { i1.tag = 17; } 2 { if (i1.tag == 17) stop(); }", __LINE__);
 	
+	// Test that the uniform grid spatial index finds the same interactions as the k-d tree; the order of neighbors differs
+	for (int i = 0; i < 6; ++i)
+	{
+		std::string dimensionality, periodicity;
+		
+		switch (i)
+		{
+			case 0: dimensionality = "x";	periodicity = "";		break;
+			case 1: dimensionality = "x";	periodicity = "x";		break;
+			case 2: dimensionality = "xy";	periodicity = "";		break;
+			case 3: dimensionality = "xy";	periodicity = "y";		break;
+			case 4: dimensionality = "xyz";	periodicity = "";		break;
+			case 5: dimensionality = "xyz";	periodicity = "xyz";	break;
+		}
+		
+		std::string gen1_setup_grid("initialize() { initializeSLiMOptions(dimensionality='" + dimensionality + "', periodicity='" + periodicity + "'); initializeSex('A'); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); initializeInteractionType(1, '" + dimensionality + "', maxDistance=0.2, sexSegregation='FM'); initializeInteractionType(2, '" + dimensionality + "', maxDistance=0.2, sexSegregation='FM', spatialIndex='grid'); i1.setInteractionFunction('n', 1.0, 0.1); i2.setInteractionFunction('n', 1.0, 0.1); } 1 { sim.addSubpop('p1', 200); ind = p1.individuals; ind.setSpatialPosition(p1.pointUniform(200)); i1.evaluate(); i2.evaluate(); ");
+		
+		SLiMAssertScriptStop(gen1_setup_grid + "ok = T; for (i in ind) ok = ok & identical(sort(i1.nearestNeighbors(i, 200).index), sort(i2.nearestNeighbors(i, 200).index)) & (size(i1.nearestNeighbors(i, 5)) == size(i2.nearestNeighbors(i, 5))); if (ok) stop(); }", __LINE__);
+		SLiMAssertScriptStop(gen1_setup_grid + "ok = T; for (i in ind) ok = ok & identical(sort(i1.nearestInteractingNeighbors(i, 200).index), sort(i2.nearestInteractingNeighbors(i, 200).index)); if (ok) stop(); }", __LINE__);
+		SLiMAssertScriptStop(gen1_setup_grid + "ok = T; for (i in 1:20) { pt = p1.pointUniform(); ok = ok & identical(sort(i1.nearestNeighborsOfPoint(p1, pt, 200).index), sort(i2.nearestNeighborsOfPoint(p1, pt, 200).index)); } if (ok) stop(); }", __LINE__);
+		SLiMAssertScriptStop(gen1_setup_grid + "if (identical(i1.interactingNeighborCount(ind), i2.interactingNeighborCount(ind)) & all(abs(i1.totalOfNeighborStrengths(ind) - i2.totalOfNeighborStrengths(ind)) < 1e-6)) stop(); }", __LINE__);
+		SLiMAssertScriptStop(gen1_setup_grid + "ok = T; for (i in ind) { d = i2.drawByStrength(i, 5); ok = ok & all(i2.strength(i, d) > 0.0); } if (ok) stop(); }", __LINE__);
+	}
+	
 	// Run tests in a variety of combinations
 	_RunInteractionTypeTests_Nonspatial(false, false, false, "**");
 	_RunInteractionTypeTests_Nonspatial(true, false, false, "**");
@@ -3677,6 +3815,30 @@ void _RunSLiMEidosBlockTests(void)
 	
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "fitness(m1) { mut; homozygous; individual; genome1; genome2; subpop; return relFitness; } 100 { stop(); }", __LINE__);
 	
+	// fitness() callbacks of the form { return <expr>; } are compiled by SLiMFitnessExpression; check their results against Eidos, and check that cases
+	// the compiled code declines (unset tags, NULL homozygous, and so forth) fall back to the interpreter and produce the same results or errors
+	std::string gen1_setup_nomut_p1("initialize() { initializeMutationRate(0); initializeMutationType('m1', 0.5, 'f', 0.0); initializeMutationType('m2', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); } 1 { sim.addSubpop('p1', 10); } ");
+	
+	SLiMAssertScriptStop(gen1_setup_nomut_p1 + "1 late() { p1.individuals.tagF = runif(10); } fitness(NULL) { return 1.0 + dnorm(individual.tagF - 0.5, 0.0, 0.2) / 5.0; } 2 { ind = p1.individuals; if (all(abs(p1.cachedFitness(NULL) - (1.0 + dnorm(ind.tagF - 0.5, 0.0, 0.2) / 5.0)) < 1e-15)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_nomut_p1 + "1 late() { p1.individuals.tagF = runif(10); } fitness(NULL) { return dnorm(individual.tagF, mean=0.4, sd=0.3); } 2 { ind = p1.individuals; if (all(abs(p1.cachedFitness(NULL) - dnorm(ind.tagF, 0.4, 0.3)) < 1e-15)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_nomut_p1 + "1 late() { p1.individuals.tag = 0:9; } fitness(NULL) { return ifelse(individual.tag > 5, exp(-0.1 * individual.tag), log(individual.tag + 2.0)); } 2 { t = p1.individuals.tag; if (all(abs(p1.cachedFitness(NULL) - ifelse(t > 5, exp(-0.1 * t), log(t + 2.0))) < 1e-15)) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_nomut_p1 + "1 late() { p1.individuals.tag = 0:9; } fitness(NULL) { return ((individual.tag % 2 == 0) & !(individual.tag == 4)) | (individual.tag >= 9) ? 1.5 else 2.0^-1; } 2 { t = p1.individuals.tag; if (identical(p1.cachedFitness(NULL), ifelse(((t % 2 == 0) & !(t == 4)) | (t >= 9), 1.5, 0.5))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_nomut_p1 + "1 late() { p1.genomes[0:4].addNewMutation(m2, 0.25, 500); p1.genomes[3].addNewMutation(m2, 0.5, 600); } fitness(m2) { return 1.0; } fitness(NULL) { return 1.0 + individual.sumOfMutationsOfType(m2); } 2 { if (identical(p1.cachedFitness(NULL), c(1.5, 2.0, 1.25, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_nomut_p1 + "1 late() { p1.genomes[0:4].addNewMutation(m2, 0.25, 500); } fitness(m2) { return ifelse(homozygous, 4.0, 2.0) * relFitness / relFitness; } 2 { if (identical(p1.cachedFitness(NULL), c(4.0, 4.0, 2.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0))) stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMOptions(dimensionality='x'); initializeMutationRate(0); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); } 1 { sim.addSubpop('p1', 10); } 1 late() { p1.individuals.x = runif(10); } fitness(NULL) { return 1.0 + individual.spatialPosition + individual.x * individual.spatialPosition[0]; } 2 { x = p1.individuals.x; if (all(abs(p1.cachedFitness(NULL) - (1.0 + x + x * x)) < 1e-15)) stop(); }", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_nomut_p1 + "fitness(NULL) { return 1.0 + individual.tagF; } 2 { stop(); }", 1, 325, "before being set", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_nomut_p1 + "1 late() { p1.individuals.tagF = runif(10); } fitness(NULL) { return dnorm(individual.tagF, 0.0, -1.0); } 2 { stop(); }", 1, 354, "requires sd > 0.0", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_nomut_p1 + "1 late() { p1.individuals.tag = 0:9; } fitness(NULL) { return individual.tag * 9223372036854775807 + 1.0; } 2 { stop(); }", 1, 362, "multiplication overflow", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_nomut_p1 + "fitness(NULL) { return 1.0 + individual.spatialPosition; } 2 { stop(); }", 1, 325, "non-spatial simulations", __LINE__);
+	
+	// vectorized=T global fitness() callbacks, which are called once for all of the individuals in a subpopulation
+	SLiMAssertScriptStop(gen1_setup_nomut_p1 + "1 late() { p1.individuals.tagF = runif(10); } fitness(NULL, p1, vectorized=T) { return 1.0 + individual.tagF; } fitness(NULL) { return 2.0; } 2 { if (identical(p1.cachedFitness(NULL), 2.0 * (1.0 + p1.individuals.tagF))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_nomut_p1 + "1 late() { p1.individuals.tag = 0:9; } fitness(NULL, vectorized=T) { if (size(genome1) != 10 | !identical(subpop, p1) | relFitness != 1.0 | !isNULL(homozygous)) stop('bad parameters'); return ifelse(individual.tag < 5, 0.0, 0.5); } 2 { if (identical(p1.cachedFitness(NULL), repEach(c(0.0, 0.5), 5))) stop(); }", __LINE__);
+	SLiMAssertScriptStop(gen1_setup_nomut_p1 + "1 late() { p1.individuals.tag = 0:9; } fitness(NULL, vectorized=T) { return ifelse(individual.tag < 5, -1.0, 0.5); } fitness(NULL, vectorized=T) { return ifelse(individual.tag < 5, -2.0, 0.5); } 2 { if (identical(p1.cachedFitness(NULL), repEach(c(0.0, 0.25), 5))) stop(); }", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_nomut_p1 + "fitness(NULL, vectorized=T) { return 1.0; } 2 { stop(); }", 1, 285, "one value per individual", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_nomut_p1 + "fitness(NULL, vectorized=X) { return 1.0; } 2 { stop(); }", 1, 310, "of T or F", __LINE__);
+	SLiMAssertScriptRaise(gen1_setup_nomut_p1 + "fitness(m1, vectorized=T) { return 1.0; } 2 { stop(); }", 1, 308, "only for global", __LINE__);
+	
 	// mateChoice() callbacks
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "mateChoice() { return weights; } 10 { stop(); }", __LINE__);
 	SLiMAssertScriptStop(gen1_setup_p1p2p3 + "mateChoice() { stop(); } 10 { ; }", __LINE__);
@@ -3980,6 +4142,140 @@ void _RunTreeSeqTests(std::string temp_path)
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(recordMutations=F, simplificationRatio=0.0, checkCoalescence=T, runCrosschecks=T); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(recordMutations=T, simplificationRatio=0.0, checkCoalescence=T, runCrosschecks=T); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
 	
+	// frequent simplification with overlapping generations, which interleaves newly recorded edges with the sorted edges left by the last simplify
+	SLiMAssertScriptStop("initialize() { initializeSLiMModelType('nonWF'); initializeTreeSeq(simplificationInterval=3, runCrosschecks=T); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeMutationRate(1e-6); initializeRecombinationRate(1e-7); } "
+						 "reproduction() { subpop.addCrossed(individual, subpop.sampleIndividuals(1)); } 1 { sim.addSubpop('p1', 20); } early() { p1.fitnessScaling = 50 / p1.individualCount; } 20 { sim.treeSeqRememberIndividuals(p1.sampleIndividuals(3)); } 100 { sim.treeSeqSimplify(); stop(); }", __LINE__);
+	
+	// buffered recording of nodes, edges, and mutations, with children rejected by modifyChild() (some while outputUsage() is measuring the buffered rows), and recombinants of a genome with itself
+	SLiMAssertScriptStop("initialize() { initializeSLiMModelType('nonWF'); initializeTreeSeq(simplificationInterval=3, runCrosschecks=T); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeMutationRate(1e-5); initializeRecombinationRate(1e-5); } "
+						 "reproduction() { g = individual.genome1; subpop.addRecombinant(g, g, c(100, 5000), NULL, NULL, NULL); subpop.addCrossed(individual, subpop.sampleIndividuals(1)); } 1 { sim.addSubpop('p1', 20); } early() { p1.fitnessScaling = 50 / p1.individualCount; } "
+						 "modifyChild() { if (runif(1) < 0.05) sim.outputUsage(); return runif(1) < 0.8; } 30 { sim.treeSeqSimplify(); stop(); }", __LINE__);
+	
+	// a rejected child whose rows have already been flushed from the buffers is retracted by truncating the tables; no script can flush
+	// from inside modifyChild(), so the recording, flush, and retraction are done directly here, checking the node id a retried child gets
+	{
+		SLiMSim *sim = nullptr;
+		
+		try {
+			std::istringstream infile("initialize() { initializeTreeSeq(runCrosschecks=T); } " + gen1_setup_highmut_p1 + "100 { stop(); }");
+			
+			sim = new SLiMSim(infile);
+			sim->InitializeRNGFromSeed(nullptr);
+			
+			for (int generation = 0; generation < 10; ++generation)
+				sim->_RunOneGeneration();
+			
+			// the child genomes are left over from the last generation, and will be overwritten (and re-recorded) in the next one
+			Subpopulation *subpop = sim->ThePopulation().subpops_.begin()->second;
+			Genome *child_genome = subpop->child_genomes_[0], *parent_genome = subpop->parent_genomes_[0];
+			
+			sim->SetCurrentNewIndividual(nullptr);
+			sim->RecordNewGenome(nullptr, child_genome, parent_genome, nullptr);
+			tsk_id_t first_node_id = child_genome->TskNodeID();
+			sim->FlushTreeSequenceBuffers();
+			sim->RetractNewIndividual();
+			
+			sim->SetCurrentNewIndividual(nullptr);
+			sim->RecordNewGenome(nullptr, child_genome, parent_genome, nullptr);
+			tsk_id_t second_node_id = child_genome->TskNodeID();
+			sim->RetractNewIndividual();
+			
+			sim->CrosscheckTreeSeqIntegrity();
+			
+			for (int generation = 0; generation < 10; ++generation)
+				sim->_RunOneGeneration();
+			
+			if (first_node_id == second_node_id)
+			{
+				gSLiMTestSuccessCount++;
+			}
+			else
+			{
+				gSLiMTestFailureCount++;
+				std::cerr << "[" << __LINE__ << "] retraction after flush : " << EIDOS_OUTPUT_FAILURE_TAG << " : node ids " << first_node_id << " and " << second_node_id << " for the retracted and retried child." << std::endl;
+			}
+		}
+		catch (...)
+		{
+			gSLiMTestFailureCount++;
+			std::cerr << "[" << __LINE__ << "] retraction after flush : " << EIDOS_OUTPUT_FAILURE_TAG << " : unexpected raise: " << Eidos_GetTrimmedRaiseMessage() << std::endl;
+		}
+		
+		delete sim;
+		MutationRun::DeleteMutationRunFreeList();
+		
+		gEidosCurrentScript = nullptr;
+		gEidosExecutingRuntimeScript = false;
+	}
+	
+	// background simplification, with interval-based and ratio-based scheduling, remembered individuals, explicit simplification, and crosschecks
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(simplificationInterval=3, simplifyInBackground=T); } " + gen1_setup_p1 + "20 { sim.treeSeqRememberIndividuals(p1.individuals[0:2]); } 50 { sim.treeSeqSimplify(); } 100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(simplificationRatio=2.0, runCrosschecks=T, simplifyInBackground=T); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMModelType('nonWF'); initializeTreeSeq(simplificationInterval=2, simplifyInBackground=T); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeMutationRate(1e-6); initializeRecombinationRate(1e-7); } "
+						 "reproduction() { subpop.addCrossed(individual, subpop.sampleIndividuals(1)); } 1 { sim.addSubpop('p1', 20); } early() { p1.fitnessScaling = 50 / p1.individualCount; } 21 { sim.treeSeqRememberIndividuals(p1.sampleIndividuals(3)); } 100 { sim.treeSeqSimplify(); stop(); }", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(checkCoalescence=T, simplifyInBackground=T); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "does not allow simplifyInBackground", __LINE__);
+	
+	// cost-model simplification scheduling, and the table memory ceiling
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(optimizeSimplification=T); } " + gen1_setup_p1 + "200 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(simplificationInterval=5, runCrosschecks=T, simplifyInBackground=T, optimizeSimplification=T, maxTableMemory=1e5); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(simplificationRatio=INF, runCrosschecks=T, maxTableMemory=2e4); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(optimizeSimplification=T, maxTableMemory=100); } " + gen1_setup_p1 + "100 { stop(); }", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(simplificationRatio=10, optimizeSimplification=T); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "requires simplificationRatio to be NULL", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(maxTableMemory=0); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "requires maxTableMemory to be > 0", __LINE__);
+	
+	// sampled crosschecks, and treeSeqCrosscheckCounts()
+	SLiMAssertScriptStop("initialize() { initializeTreeSeq(simplificationInterval=10, crosscheckSampleSize=50); } " + gen1_setup_p1 + "50 late() { p1.genomes[0:3].removeMutations(); } 100 { c = sim.treeSeqCrosscheckCounts(); if ((c[0] > 0) & (c[1] == 0)) stop(); }", __LINE__);
+	SLiMAssertScriptStop("initialize() { initializeSLiMModelType('nonWF'); initializeTreeSeq(simplificationInterval=3, simplifyInBackground=T, crosscheckSampleSize=50); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeMutationRate(1e-5); initializeRecombinationRate(1e-7); } "
+						 "reproduction() { subpop.addCrossed(individual, subpop.sampleIndividuals(1)); } 1 { sim.addSubpop('p1', 20); } early() { p1.fitnessScaling = 50 / p1.individualCount; } 100 { c = sim.treeSeqCrosscheckCounts(); if ((c[0] > 0) & (c[1] == 0)) stop(); }", __LINE__);
+	
+	// sampled crosschecks count divergences when genomes change without being recorded; no script can do that, so the genomes are emptied directly here
+	{
+		SLiMSim *sim = nullptr;
+		
+		try {
+			std::istringstream infile("initialize() { initializeTreeSeq(crosscheckSampleSize=500); } " + gen1_setup_highmut_p1 + "100 { stop(); }");
+			
+			sim = new SLiMSim(infile);
+			sim->InitializeRNGFromSeed(nullptr);
+			
+			for (int generation = 0; generation < 20; ++generation)
+				sim->_RunOneGeneration();
+			
+			int64_t divergences_before = sim->CrosscheckDivergenceCount();
+			
+			for (auto subpop_pair : sim->ThePopulation().subpops_)
+				for (Genome *genome : subpop_pair.second->parent_genomes_)
+					genome->clear_to_empty();
+			
+			sim->SampledCrosscheckTreeSeqIntegrity();
+			
+			if ((divergences_before == 0) && (sim->CrosscheckDivergenceCount() > 0))
+			{
+				gSLiMTestSuccessCount++;
+			}
+			else
+			{
+				gSLiMTestFailureCount++;
+				std::cerr << "[" << __LINE__ << "] sampled crosscheck : " << EIDOS_OUTPUT_FAILURE_TAG << " : divergence counts " << divergences_before << " before and " << sim->CrosscheckDivergenceCount() << " after emptying genomes without recording." << std::endl;
+			}
+		}
+		catch (...)
+		{
+			gSLiMTestFailureCount++;
+			std::cerr << "[" << __LINE__ << "] sampled crosscheck : " << EIDOS_OUTPUT_FAILURE_TAG << " : unexpected raise: " << Eidos_GetTrimmedRaiseMessage() << std::endl;
+		}
+		
+		delete sim;
+		MutationRun::DeleteMutationRunFreeList();
+		
+		gEidosCurrentScript = nullptr;
+		gEidosExecutingRuntimeScript = false;
+	}
+	
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(crosscheckSampleSize=-1); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "requires crosscheckSampleSize to be >= 0", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(recordMutations=F, crosscheckSampleSize=10); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "requires recordMutations=T when crosscheckSampleSize", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "1: { sim.treeSeqCrosscheckCounts(); } 100 { stop(); }", 1, 290, "sampled crosschecks are enabled", __LINE__);
+	
 	// treeSeqCoalesced()
 	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "1: { sim.treeSeqCoalesced(); } 100 { stop(); }", 1, 290, "coalescence checking is enabled", __LINE__);
 	SLiMAssertScriptStop("initialize() { initializeTreeSeq(checkCoalescence=T); } " + gen1_setup_p1 + "1: { sim.treeSeqCoalesced(); } 100 { stop(); }", __LINE__);
@@ -3999,7 +4295,64 @@ void _RunTreeSeqTests(std::string temp_path)
 		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_2.trees', simplify=T, _binary=F); stop(); }", __LINE__);
 		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_3.trees', simplify=F, _binary=T); stop(); }", __LINE__);
 		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "100 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_4.trees', simplify=T, _binary=T); stop(); }", __LINE__);
+		
+		// background simplification gives the same tables as foreground simplification of the same seeded model; genome and mutation ids
+		// continue from one test model to the next, so the columns derived from them (metadata, derived states) are not compared
+		for (std::string background : {"F", "T"})
+			SLiMAssertScriptStop("initialize() { setSeed(17); initializeSLiMModelType('nonWF'); initializeTreeSeq(simplificationInterval=3, simplifyInBackground=" + background + "); initializeMutationType('m1', 0.5, 'f', 0.0); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeMutationRate(1e-6); initializeRecombinationRate(1e-7); } "
+								 "reproduction() { subpop.addCrossed(individual, subpop.sampleIndividuals(1)); } 1 { sim.addSubpop('p1', 20); } early() { p1.fitnessScaling = 50 / p1.individualCount; } 21 { sim.treeSeqRememberIndividuals(p1.sampleIndividuals(3)); } "
+								 "50 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_background_" + background + ".trees', simplify=F, _binary=F); stop(); }", __LINE__);
+		SLiMAssertScriptStop("initialize() { tables = c('Node', 'Edge', 'Site', 'Mutation', 'Individual'); columns = c(5, 5, 4, 4, 3); for (i in 0:4) { n = columns[i]; "
+							 "f = sapply(readFile('" + temp_path + "/SLiM_treeSeq_background_F.trees/' + tables[i] + 'Table.txt'), 'paste(strsplit(applyValue, \"\\t\")[0:(n-1)]);'); "
+							 "t = sapply(readFile('" + temp_path + "/SLiM_treeSeq_background_T.trees/' + tables[i] + 'Table.txt'), 'paste(strsplit(applyValue, \"\\t\")[0:(n-1)]);'); "
+							 "if ((size(f) < 2) | !identical(f, t)) stop('mismatch in ' + tables[i]); } stop(); }", __LINE__);
+		
+		// the cost model counts the work done by simplification rather than timing it, so its simplification schedule is reproducible
+		for (std::string run : {"1", "2"})
+			SLiMAssertScriptStop("initialize() { setSeed(17); initializeTreeSeq(optimizeSimplification=T, maxTableMemory=2e5); } " + gen1_setup_p1 + "150 { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_optimized_" + run + ".trees', simplify=F, _binary=F); stop(); }", __LINE__);
+		SLiMAssertScriptStop("initialize() { f = readFile('" + temp_path + "/SLiM_treeSeq_optimized_1.trees/EdgeTable.txt'); t = readFile('" + temp_path + "/SLiM_treeSeq_optimized_2.trees/EdgeTable.txt'); if ((size(f) > 1) & identical(f, t)) stop(); }", __LINE__);
+		
+		// periodic checkpoints, and resuming from the last one written
+		SLiMAssertScriptStop("initialize() { initializeTreeSeq(checkpointPath='" + temp_path + "/SLiM_treeSeq_checkpoint.trees', checkpointInterval=10); } " + gen1_setup_p1 + "25 { stop(); }", __LINE__);
+		SLiMAssertScriptStop("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "1 late() { sim.readFromPopulationFile('" + temp_path + "/SLiM_treeSeq_checkpoint.trees'); if ((sim.generation == 20) & (p1.individualCount == 10)) stop(); }", __LINE__);
+		SLiMAssertScriptStop("initialize() { initializeTreeSeq(simplifyInBackground=T, checkpointPath='" + temp_path + "/SLiM_treeSeq_checkpoint.trees', checkpointInterval=3); } " + gen1_setup_p1 + "50 { stop(); }", __LINE__);
+		
+		// overlaid mutation types, which are not simulated but appear in the output, and are loaded as ordinary mutations
+		SLiMAssertScriptStop("initialize() { initializeTreeSeq(overlayMutationTypes=1); } " + gen1_setup_highmut_p1 + "50 { if (size(sim.mutations) + size(sim.substitutions) == 0) { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_overlay_1.trees'); sim.readFromPopulationFile('" + temp_path + "/SLiM_treeSeq_overlay_1.trees'); if ((sim.generation == 50) & all(sim.mutations.mutationType == m1) & (size(sim.mutations) > 0)) stop(); } }", __LINE__);
+		SLiMAssertScriptStop("initialize() { initializeTreeSeq(overlayMutationTypes=1); } " + gen1_setup + "1 { sim.addSubpopFromCoalescent('p1', 10, Ne=10000); } 2 late() { sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_overlay_2.trees'); sim.readFromPopulationFile('" + temp_path + "/SLiM_treeSeq_overlay_2.trees'); if ((sim.generation == 2) & any(sim.mutations.originGeneration < 0)) stop(); }", __LINE__);
+		
+		// overlaid mutations neither perturb the model's RNG nor use up mutation ids, and their rate map and mutation fractions are fixed
+		std::string overlay_setup("initialize() { initializeTreeSeq(overlayMutationTypes=1); initializeMutationRate(1e-5); initializeMutationType('m1', 0.5, 'f', 0.0); initializeMutationType('m2', 0.5, 'f', -0.01); initializeGenomicElementType('g1', c(m1, m2), c(3, 1)); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); initializeSex('A'); } 1 { sim.addSubpop('p1', 10); } ");
+		
+		SLiMAssertScriptStop(overlay_setup + "50 { g = p1.genomes[0]; a = g.addNewMutation(m2, 0.0, 5).id; sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_overlay_3.trees'); b = g.addNewMutation(m2, 0.0, 6).id; if (b == a + 1) stop(); }", __LINE__);
+		SLiMAssertScriptStop(overlay_setup + "50 { setSeed(7); sim.treeSeqOutput('" + temp_path + "/SLiM_treeSeq_overlay_4.trees'); x = runif(1); setSeed(7); y = runif(1); if (x == y) stop(); }", __LINE__);
+		SLiMAssertScriptStop(overlay_setup + "20 { g1.setMutationFractions(c(m1, m2), c(3, 1)); sim.chromosome.setMutationRate(1e-5); } 21 { stop(); }", __LINE__);
+		SLiMAssertScriptRaise(overlay_setup + "20 { g1.setMutationFractions(m2, 1.0); }", 1, 372, "cannot change the mutation fractions", __LINE__);
+		SLiMAssertScriptRaise(overlay_setup + "20 { sim.chromosome.setMutationRate(1e-6); }", 1, 384, "cannot change the mutation rate map", __LINE__);
+		SLiMAssertScriptRaise(overlay_setup + "20 { sim.chromosome.setMutationRate(c(1e-5, 1e-6), c(50000, 99999)); }", 1, 384, "cannot change the mutation rate map", __LINE__);
+		
+		// a derived state that is not a comma-separated list of mutation ids is an error on load; the file is written directly with tskit
+		{
+			std::string malformed_path = temp_path + "/SLiM_treeSeq_malformed.trees";
+			tsk_table_collection_t malformed_tables;
+			
+			tsk_table_collection_init(&malformed_tables, 0);
+			malformed_tables.sequence_length = 100000;
+			tsk_node_table_add_row(&malformed_tables.nodes, TSK_NODE_IS_SAMPLE, 0.0, TSK_NULL, TSK_NULL, NULL, 0);
+			tsk_site_table_add_row(&malformed_tables.sites, 10.0, "", 0, NULL, 0);
+			tsk_mutation_table_add_row(&malformed_tables.mutations, 0, 0, TSK_NULL, "1,x", 3, NULL, 0);
+			tsk_table_collection_dump(&malformed_tables, malformed_path.c_str(), 0);
+			tsk_table_collection_free(&malformed_tables);
+			
+			SLiMAssertScriptRaise("initialize() { initializeTreeSeq(); } " + gen1_setup_p1 + "1 late() { sim.readFromPopulationFile('" + malformed_path + "'); stop(); }", 1, 296, "is not a comma-separated list of mutation ids", __LINE__);
+		}
 	}
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(recordMutations=F, overlayMutationTypes=1); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "requires recordMutations=T", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(overlayMutationTypes=2); } " + gen1_setup_p1 + "100 { stop(); }", -1, -1, "is not defined", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(overlayMutationTypes=1); initializeMutationRate(1e-7); initializeMutationType('m1', 0.5, 'f', 0.1); initializeGenomicElementType('g1', m1, 1.0); initializeGenomicElement(g1, 0, 99999); initializeRecombinationRate(1e-8); } 1 { sim.addSubpop('p1', 10); } 100 { stop(); }", -1, -1, "must be neutral", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(checkpointPath='checkpoint.trees'); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "requires checkpointInterval", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(checkpointInterval=10); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "requires checkpointPath", __LINE__);
+	SLiMAssertScriptRaise("initialize() { initializeTreeSeq(checkpointPath='checkpoint.trees', checkpointInterval=0); } " + gen1_setup_p1 + "100 { stop(); }", 1, 15, "requires checkpointInterval to be > 0", __LINE__);
 }
 
 #pragma mark Nucleotide API tests
@@ -23,6 +23,7 @@
 #include <ostream>
 #include <cmath>
 #include <string.h>
+#include <algorithm>
 
 #pragma mark -
 #pragma mark SparseArray
@@ -196,6 +197,47 @@ void SparseArray::AddEntryInteraction(uint32_t p_row, uint32_t p_column, sa_dist
 	strengths_[offset] = p_strength;
 }
 
+void SparseArray::AddRowsFromFragment(const SparseArray &p_fragment, uint32_t p_start_row, uint32_t p_after_end_row)
+{
+	if (finished_)
+		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowsFromFragment): adding rows to sparse array that is finished." << EidosTerminate(nullptr);
+	if ((p_fragment.nrows_ != nrows_) || (p_fragment.ncols_ != ncols_))
+		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowsFromFragment): fragment dimensions do not match." << EidosTerminate(nullptr);
+	if ((p_start_row > p_after_end_row) || (p_after_end_row > nrows_))
+		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowsFromFragment): row range out of range." << EidosTerminate(nullptr);
+	if (p_start_row < nrows_set_)
+		EIDOS_TERMINATION << "ERROR (SparseArray::AddRowsFromFragment): adding rows out of order." << EidosTerminate(nullptr);
+	
+	// the fragment may not have configured all of its rows, since trailing empty rows are added only by Finished()
+	uint32_t fragment_after_end_row = std::min(p_fragment.nrows_set_, p_after_end_row);
+	
+	if (fragment_after_end_row <= p_start_row)
+		return;
+	
+	// add intervening empty rows
+	uint32_t offset = row_offsets_[nrows_set_];
+	
+	while (p_start_row > nrows_set_)
+		row_offsets_[++nrows_set_] = offset;
+	
+	// make room for the new entries and copy them over
+	uint32_t fragment_offset = p_fragment.row_offsets_[p_start_row];
+	uint32_t fragment_nnz = p_fragment.row_offsets_[fragment_after_end_row] - fragment_offset;
+	
+	nnz_ += fragment_nnz;
+	ResizeToFitNNZ();
+	
+	memcpy(columns_ + offset, p_fragment.columns_ + fragment_offset, fragment_nnz * sizeof(uint32_t));
+	memcpy(distances_ + offset, p_fragment.distances_ + fragment_offset, fragment_nnz * sizeof(sa_distance_t));
+	memcpy(strengths_ + offset, p_fragment.strengths_ + fragment_offset, fragment_nnz * sizeof(sa_strength_t));
+	
+	// rebase the fragment's row offsets onto ours
+	for (uint32_t row = p_start_row; row < fragment_after_end_row; ++row)
+		row_offsets_[row + 1] = p_fragment.row_offsets_[row + 1] - fragment_offset + offset;
+	
+	nrows_set_ = fragment_after_end_row;
+}
+
 void SparseArray::Finished(void)
 {
 	if (finished_)
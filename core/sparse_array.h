@@ -125,6 +125,11 @@ public:
 	}
 	void AddEntryInteraction(uint32_t p_row, const uint32_t p_column, sa_distance_t p_distance, sa_strength_t p_strength);
 	
+	// Building from fragments; a fragment is an unfinished sparse array with the same dimensions, into which rows
+	// [p_start_row, p_after_end_row) have been added by another thread.  Those rows are appended to this sparse array,
+	// which must not yet contain any row at or beyond p_start_row.  Fragments must be appended in row order.
+	void AddRowsFromFragment(const SparseArray &p_fragment, uint32_t p_start_row, uint32_t p_after_end_row);
+	
 	void Finished(void);
 	inline __attribute__((always_inline)) bool IsFinished() const { return finished_; };
 	
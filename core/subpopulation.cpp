@@ -1396,11 +1396,19 @@ void Subpopulation::UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callba
 	int global_fitness_callback_count = (int)p_global_fitness_callbacks.size();
 	bool global_fitness_callbacks_exist = (global_fitness_callback_count > 0);
 	
+	// Vectorized global callbacks, declared with vectorized=T, are called once here for all of the individuals in the subpopulation; their
+	// results are then multiplied in by ApplyGlobalFitnessCallbacks() together with the results of any per-individual global callbacks
+	ApplyVectorizedGlobalFitnessCallbacks(p_global_fitness_callbacks);
+	
 	// We optimize the pure neutral case, as long as no fitness callbacks are defined; fitness values are then simply 1.0, for everybody.
 	// BCH 12 Jan 2018: now fitness_scaling_ modifies even pure_neutral_ models, but the framework here remains valid
 	bool pure_neutral = (!fitness_callbacks_exist && !global_fitness_callbacks_exist && population_.sim_.pure_neutral_);
 	double subpop_fitness_scaling = fitness_scaling_;
 	
+	// Without callbacks of any kind, the fitness of each individual depends only upon its own genomes, so the general case below can
+	// be computed by multiple threads; see CacheFitnessOfParentsInRange_NoCallbacks_Parallel()
+	bool parallel_fitness = ((gEidosMaxThreads > 1) && !fitness_callbacks_exist && !global_fitness_callbacks_exist);
+	
 #if (!defined(SLIMGUI) && defined(SLIM_WF_ONLY))
 	// Reset our override of individual cached fitness values; we make this decision afresh with each UpdateFitness() call.  See
 	// the header for further comments on this mechanism.
@@ -1461,6 +1469,11 @@ void Subpopulation::UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callba
 				totalFemaleFitness += fitness;
 			}
 		}
+		else if (parallel_fitness)
+		{
+			// general case for females, without callbacks, multithreaded
+			totalFemaleFitness = CacheFitnessOfParentsInRange_NoCallbacks_Parallel(0, parent_first_male_index_, subpop_fitness_scaling);
+		}
 		else
 		{
 			// general case for females
@@ -1540,6 +1553,11 @@ void Subpopulation::UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callba
 				totalMaleFitness += fitness;
 			}
 		}
+		else if (parallel_fitness)
+		{
+			// general case for males, without callbacks, multithreaded
+			totalMaleFitness = CacheFitnessOfParentsInRange_NoCallbacks_Parallel(parent_first_male_index_, parent_subpop_size_, subpop_fitness_scaling);
+		}
 		else
 		{
 			// general case for males
@@ -1626,6 +1644,11 @@ void Subpopulation::UpdateFitness(std::vector<SLiMEidosBlock*> &p_fitness_callba
 				totalFitness += fitness;
 			}
 		}
+		else if (parallel_fitness)
+		{
+			// general case for hermaphrodites, without callbacks, multithreaded
+			totalFitness = CacheFitnessOfParentsInRange_NoCallbacks_Parallel(0, parent_subpop_size_, subpop_fitness_scaling);
+		}
 		else
 		{
 			// general case for hermaphrodites
@@ -1783,13 +1806,14 @@ void Subpopulation::UpdateWFFitnessBuffers(bool p_pure_neutral)
 
 double Subpopulation::ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homozygous, double p_computed_fitness, std::vector<SLiMEidosBlock*> &p_fitness_callbacks, Individual *p_individual, Genome *p_genome1, Genome *p_genome2)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
 	
 	slim_objectid_t mutation_type_id = (gSLiM_Mutation_Block + p_mutation)->mutation_type_ptr_->mutation_type_id_;
 	SLiMSim &sim = population_.sim_;
+	double compiled_fitness;
 	
 	for (SLiMEidosBlock *fitness_callback : p_fitness_callbacks)
 	{
@@ -1817,23 +1841,12 @@ double Subpopulation::ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homo
 					// the cached value is owned by the tree, so we do not dispose of it
 					// there is also no script output to handle
 				}
-				else if (fitness_callback->has_cached_optimization_)
+				else if (fitness_callback->has_cached_optimization_ && fitness_callback->cached_fitness_expr_->Evaluate(p_individual, p_computed_fitness, p_homozygous, &compiled_fitness))
 				{
-					// We can special-case particular simple callbacks for speed.  This is similar to the cached_return_value_
-					// mechanism above, but it is done in SLiM, not in Eidos, and is specific to callbacks, not general.
-					// The has_cached_optimization_ flag is the umbrella flag for all such optimizations; we then figure
-					// out below which cached optimization is in effect for this callback.  See SLiMSim::OptimizeScriptBlock()
-					// for comments on the specific cases optimized here.
-					if (fitness_callback->has_cached_opt_reciprocal)
-					{
-						double A = fitness_callback->cached_opt_A_;
-						
-						p_computed_fitness = (A / p_computed_fitness);	// p_computed_fitness is relFitness
-					}
-					else
-					{
-						EIDOS_TERMINATION << "ERROR (Subpopulation::ApplyFitnessCallbacks): (internal error) cached optimization flag mismatch" << EidosTerminate(fitness_callback->identifier_token_);
-					}
+					// The callback was compiled by SLiMSim::OptimizeScriptBlock(), so we evaluated it in C++ above, with
+					// p_computed_fitness as relFitness.  If evaluation declined, because the interpreter would raise or
+					// produce a non-float value for this individual, we fall through and interpret the callback instead.
+					p_computed_fitness = compiled_fitness;
 				}
 				else
 				{
@@ -1912,7 +1925,7 @@ double Subpopulation::ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homo
 		}
 	}
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(population_.sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosFitnessCallback)]);
 #endif
@@ -1923,20 +1936,26 @@ double Subpopulation::ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homo
 // This calculates the effects of global fitness callbacks, i.e. those with muttype==NULL and which therefore do not reference any mutation
 double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &p_fitness_callbacks, slim_popsize_t p_individual_index)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+	// Start from the effect of any vectorized callbacks, computed by ApplyVectorizedGlobalFitnessCallbacks(); if that is already zero, we're done
+	double computed_fitness = (vectorized_global_fitness_.size() ? vectorized_global_fitness_[p_individual_index] : 1.0);
+	
+	if (computed_fitness <= 0.0)
+		return 0.0;
+	
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
 	
-	double computed_fitness = 1.0;
 	Individual *individual = parent_individuals_[p_individual_index];
 	Genome *genome1 = parent_genomes_[p_individual_index * 2];
 	Genome *genome2 = parent_genomes_[p_individual_index * 2 + 1];
 	SLiMSim &sim = population_.sim_;
+	double compiled_fitness;
 	
 	for (SLiMEidosBlock *fitness_callback : p_fitness_callbacks)
 	{
-		if (fitness_callback->active_)
+		if (fitness_callback->active_ && !fitness_callback->vectorized_)		// vectorized callbacks were already applied above
 		{
 			// The callback is active, so we need to execute it
 			// This code is similar to Population::ExecuteScript, but we set up an additional symbol table, and we use the return value
@@ -1956,26 +1975,12 @@ double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &
 				// the cached value is owned by the tree, so we do not dispose of it
 				// there is also no script output to handle
 			}
-			else if (fitness_callback->has_cached_optimization_)
+			else if (fitness_callback->has_cached_optimization_ && fitness_callback->cached_fitness_expr_->Evaluate(individual, 1.0, -1, &compiled_fitness))
 			{
-				// We can special-case particular simple callbacks for speed.  This is similar to the cached_return_value_
-				// mechanism above, but it is done in SLiM, not in Eidos, and is specific to callbacks, not general.
-				// The has_cached_optimization_ flag is the umbrella flag for all such optimizations; we then figure
-				// out below which cached optimization is in effect for this callback.  See SLiMSim::OptimizeScriptBlock()
-				// for comments on the specific cases optimized here.
-				if (fitness_callback->has_cached_opt_dnorm1_)
-				{
-					double A = fitness_callback->cached_opt_A_;
-					double B = fitness_callback->cached_opt_B_;
-					double C = fitness_callback->cached_opt_C_;
-					double D = fitness_callback->cached_opt_D_;
-					
-					computed_fitness *= (D + (gsl_ran_gaussian_pdf(individual->TagFloat() - A, B) / C));
-				}
-				else
-				{
-					EIDOS_TERMINATION << "ERROR (Subpopulation::ApplyGlobalFitnessCallbacks): (internal error) cached optimization flag mismatch" << EidosTerminate(fitness_callback->identifier_token_);
-				}
+				// The callback was compiled by SLiMSim::OptimizeScriptBlock(), so we evaluated it in C++ above, with
+				// relFitness 1.0 and homozygous NULL as for global callbacks.  If evaluation declined, we fall through
+				// and interpret the callback, which produces the true result or error for this individual.
+				computed_fitness *= compiled_fitness;
 			}
 			else
 			{
@@ -2042,7 +2047,7 @@ double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &
 		}
 	}
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(population_.sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback)]);
 #endif
@@ -2050,6 +2055,169 @@ double Subpopulation::ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &
 	return computed_fitness;
 }
 
+// This calls global fitness callbacks declared with vectorized=T, once each for the whole subpopulation, with individual, genome1, and genome2
+// defined as vectors over all parental individuals in index order.  Each callback returns a float vector with one fitness effect per individual,
+// and the product of those effects is left in vectorized_global_fitness_ for ApplyGlobalFitnessCallbacks() to use; if no vectorized callback is
+// active, vectorized_global_fitness_ is left empty.  Unlike per-individual callbacks, vectorized callbacks see individuals whose fitness is zero.
+void Subpopulation::ApplyVectorizedGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &p_fitness_callbacks)
+{
+	vectorized_global_fitness_.clear();
+	
+	bool any_vectorized = false;
+	
+	for (SLiMEidosBlock *fitness_callback : p_fitness_callbacks)
+		if (fitness_callback->active_ && fitness_callback->vectorized_)
+			any_vectorized = true;
+	
+	if (!any_vectorized)
+		return;
+	
+#if (SLIMPROFILING == 1)
+	// PROFILING
+	SLIM_PROFILE_BLOCK_START();
+#endif
+	
+	SLiMSim &sim = population_.sim_;
+	slim_popsize_t subpop_size = parent_subpop_size_;
+	
+	// Make the parameter vectors once; the callbacks cannot change the set of individuals or genomes while they run
+	EidosValue_Object_vector *individuals_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Individual_Class))->resize_no_initialize(subpop_size);
+	EidosValue_Object_vector *genome1_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Genome_Class))->resize_no_initialize(subpop_size);
+	EidosValue_Object_vector *genome2_vec = (new (gEidosValuePool->AllocateChunk()) EidosValue_Object_vector(gSLiM_Genome_Class))->resize_no_initialize(subpop_size);
+	EidosValue_SP individuals_value(individuals_vec), genome1_value(genome1_vec), genome2_value(genome2_vec);
+	
+	for (slim_popsize_t individual_index = 0; individual_index < subpop_size; individual_index++)
+	{
+		individuals_vec->set_object_element_no_check(parent_individuals_[individual_index], individual_index);
+		genome1_vec->set_object_element_no_check(parent_genomes_[individual_index * 2], individual_index);
+		genome2_vec->set_object_element_no_check(parent_genomes_[individual_index * 2 + 1], individual_index);
+	}
+	
+	vectorized_global_fitness_.resize(subpop_size, 1.0);
+	
+	for (SLiMEidosBlock *fitness_callback : p_fitness_callbacks)
+	{
+		if (fitness_callback->active_ && fitness_callback->vectorized_)
+		{
+			// We need to actually execute the script; we start a block here to manage the lifetime of the symbol table
+			{
+				EidosSymbolTable callback_symbols(EidosSymbolTableType::kContextConstantsTable, &sim.SymbolTable());
+				EidosSymbolTable client_symbols(EidosSymbolTableType::kVariablesTable, &callback_symbols);
+				EidosFunctionMap &function_map = sim.FunctionMap();
+				EidosInterpreter interpreter(fitness_callback->compound_statement_node_, client_symbols, function_map, &sim);
+				
+				if (fitness_callback->contains_self_)
+					callback_symbols.InitializeConstantSymbolEntry(fitness_callback->SelfSymbolTableEntry());		// define "self"
+				
+				// Set all of the callback's parameters; as in ApplyGlobalFitnessCallbacks(), mut and homozygous are NULL and relFitness is 1.0
+				if (fitness_callback->contains_mut_)
+					callback_symbols.InitializeConstantSymbolEntry(gID_mut, gStaticEidosValueNULL);
+				if (fitness_callback->contains_relFitness_)
+					callback_symbols.InitializeConstantSymbolEntry(gID_relFitness, gStaticEidosValue_Float1);
+				if (fitness_callback->contains_individual_)
+					callback_symbols.InitializeConstantSymbolEntry(gID_individual, individuals_value);
+				if (fitness_callback->contains_genome1_)
+					callback_symbols.InitializeConstantSymbolEntry(gID_genome1, genome1_value);
+				if (fitness_callback->contains_genome2_)
+					callback_symbols.InitializeConstantSymbolEntry(gID_genome2, genome2_value);
+				if (fitness_callback->contains_subpop_)
+					callback_symbols.InitializeConstantSymbolEntry(gID_subpop, SymbolTableEntry().second);
+				if (fitness_callback->contains_homozygous_)
+					callback_symbols.InitializeConstantSymbolEntry(gID_homozygous, gStaticEidosValueNULL);
+				
+				try
+				{
+					// Interpret the script; the result from the interpretation must be a float vector with one value per individual
+					EidosValue_SP result_SP = interpreter.EvaluateInternalBlock(fitness_callback->script_);
+					EidosValue *result = result_SP.get();
+					
+					if ((result->Type() != EidosValueType::kValueFloat) || (result->Count() != subpop_size))
+						EIDOS_TERMINATION << "ERROR (Subpopulation::ApplyVectorizedGlobalFitnessCallbacks): vectorized fitness() callbacks must provide a float vector return value with one value per individual." << EidosTerminate(fitness_callback->identifier_token_);
+					
+					// effects below zero are clamped to zero, as ApplyGlobalFitnessCallbacks() does, so two negative effects cannot cancel
+					if (subpop_size == 1)
+						vectorized_global_fitness_[0] *= std::max(result->FloatAtIndex(0, nullptr), 0.0);
+					else
+					{
+						const double *result_data = result->FloatVector()->data();
+						double *fitness_data = vectorized_global_fitness_.data();
+						
+						for (slim_popsize_t individual_index = 0; individual_index < subpop_size; individual_index++)
+							fitness_data[individual_index] *= std::max(result_data[individual_index], 0.0);
+					}
+					
+					// Output generated by the interpreter goes to our output stream
+					interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+				}
+				catch (...)
+				{
+					// Emit final output even on a throw, so that stop() messages and such get printed
+					interpreter.FlushExecutionOutputToStream(SLIM_OUTSTREAM);
+					
+					throw;
+				}
+				
+			}
+		}
+	}
+	
+#if (SLIMPROFILING == 1)
+	// PROFILING
+	SLIM_PROFILE_BLOCK_END(population_.sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosFitnessGlobalCallback)]);
+#endif
+}
+
+// This calculates the fitness of each individual in [p_first_index, p_last_index) with FitnessOfParentWithGenomeIndices_NoCallbacks(), like the
+// general case in UpdateFitness() does when no callbacks exist, but using multiple threads.  The only shared state that calculation modifies is
+// the nonneutral mutation cache of each MutationRun, which is filled lazily; since mutation runs are shared among genomes, we validate those caches
+// serially first.  The total fitness is then summed serially, in order, so that the result is identical to the single-threaded calculation.
+double Subpopulation::CacheFitnessOfParentsInRange_NoCallbacks_Parallel(slim_popsize_t p_first_index, slim_popsize_t p_last_index, double p_subpop_fitness_scaling)
+{
+#if SLIM_USE_NONNEUTRAL_CACHES
+	SLiMSim &sim = population_.sim_;
+	int32_t nonneutral_change_counter = sim.nonneutral_change_counter_;
+	int32_t nonneutral_regime = sim.last_nonneutral_regime_;
+	
+	for (slim_popsize_t genome_index = p_first_index * 2; genome_index < p_last_index * 2; genome_index++)
+	{
+		Genome *genome = parent_genomes_[genome_index];
+		
+		if (!genome->IsNull())
+		{
+			const int32_t mutrun_count = genome->mutrun_count_;
+			
+			for (int run_index = 0; run_index < mutrun_count; ++run_index)
+			{
+				const MutationIndex *genome_iter, *genome_max;
+				
+				genome->mutruns_[run_index]->beginend_nonneutral_pointers(&genome_iter, &genome_max, nonneutral_change_counter, nonneutral_regime);
+			}
+		}
+	}
+#endif
+	
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64) num_threads(gEidosMaxThreads)
+#endif
+	for (slim_popsize_t individual_index = p_first_index; individual_index < p_last_index; individual_index++)
+	{
+		Individual *individual = parent_individuals_[individual_index];
+		double fitness = p_subpop_fitness_scaling * individual->fitness_scaling_;
+		
+		if (fitness > 0.0)
+			fitness *= FitnessOfParentWithGenomeIndices_NoCallbacks(individual_index);
+		
+		individual->cached_fitness_UNSAFE_ = fitness;
+	}
+	
+	double total_fitness = 0.0;
+	
+	for (slim_popsize_t individual_index = p_first_index; individual_index < p_last_index; individual_index++)
+		total_fitness += parent_individuals_[individual_index]->cached_fitness_UNSAFE_;
+	
+	return total_fitness;
+}
+
 // FitnessOfParentWithGenomeIndices has three versions, for no callbacks, a single callback, and multiple callbacks.  This is for two reasons.  First,
 // it allows the case without fitness() callbacks to run at full speed.  Second, the non-callback case short-circuits when the selection coefficient
 // is exactly 0.0f, as an optimization; but that optimization would be invalid in the callback case, since callbacks can change the relative fitness
@@ -2076,6 +2244,11 @@ double Subpopulation::FitnessOfParentWithGenomeIndices_NoCallbacks(slim_popsize_
 #endif
 	
 	Mutation *mut_block_ptr = gSLiM_Mutation_Block;
+	
+	// the fitness effects and positions are read from the hot side buffers, rather than from the Mutation objects; see mutation.h
+	const slim_position_t *position_block_ptr = gSLiM_Mutation_Positions;
+	const slim_selcoeff_t *one_plus_sel_block_ptr = gSLiM_Mutation_OnePlusSel;
+	const slim_selcoeff_t *one_plus_dom_sel_block_ptr = gSLiM_Mutation_OnePlusDomSel;
 	Genome *genome1 = parent_genomes_[p_individual_index * 2];
 	Genome *genome2 = parent_genomes_[p_individual_index * 2 + 1];
 	bool genome1_null = genome1->IsNull();
@@ -2130,7 +2303,7 @@ double Subpopulation::FitnessOfParentWithGenomeIndices_NoCallbacks(slim_popsize_
 			{
 				// with other types of unpaired chromosomes (like the Y chromosome of a male when we are modeling the Y) there is no dominance coefficient
 				while (genome_iter != genome_max)
-					w *= (mut_block_ptr + *genome_iter++)->cached_one_plus_sel_;
+					w *= one_plus_sel_block_ptr[*genome_iter++];
 			}
 		}
 		
@@ -2165,32 +2338,32 @@ double Subpopulation::FitnessOfParentWithGenomeIndices_NoCallbacks(slim_popsize_
 			if (genome1_iter != genome1_max && genome2_iter != genome2_max)
 			{
 				MutationIndex genome1_mutation = *genome1_iter, genome2_mutation = *genome2_iter;
-				slim_position_t genome1_iter_position = (mut_block_ptr + genome1_mutation)->position_, genome2_iter_position = (mut_block_ptr + genome2_mutation)->position_;
+				slim_position_t genome1_iter_position = position_block_ptr[genome1_mutation], genome2_iter_position = position_block_ptr[genome2_mutation];
 				
 				do
 				{
 					if (genome1_iter_position < genome2_iter_position)
 					{
 						// Process a mutation in genome1 since it is leading
-						w *= (mut_block_ptr + genome1_mutation)->cached_one_plus_dom_sel_;
+						w *= one_plus_dom_sel_block_ptr[genome1_mutation];
 						
 						if (++genome1_iter == genome1_max)
 							break;
 						else {
 							genome1_mutation = *genome1_iter;
-							genome1_iter_position = (mut_block_ptr + genome1_mutation)->position_;
+							genome1_iter_position = position_block_ptr[genome1_mutation];
 						}
 					}
 					else if (genome1_iter_position > genome2_iter_position)
 					{
 						// Process a mutation in genome2 since it is leading
-						w *= (mut_block_ptr + genome2_mutation)->cached_one_plus_dom_sel_;
+						w *= one_plus_dom_sel_block_ptr[genome2_mutation];
 						
 						if (++genome2_iter == genome2_max)
 							break;
 						else {
 							genome2_mutation = *genome2_iter;
-							genome2_iter_position = (mut_block_ptr + genome2_mutation)->position_;
+							genome2_iter_position = position_block_ptr[genome2_mutation];
 						}
 					}
 					else
@@ -2205,12 +2378,12 @@ double Subpopulation::FitnessOfParentWithGenomeIndices_NoCallbacks(slim_popsize_
 							const MutationIndex *genome2_matchscan = genome2_iter; 
 							
 							// advance through genome2 with genome2_matchscan, looking for a match for the current mutation in genome1, to determine whether we are homozygous or not
-							while (genome2_matchscan != genome2_max && (mut_block_ptr + *genome2_matchscan)->position_ == position)
+							while (genome2_matchscan != genome2_max && position_block_ptr[*genome2_matchscan] == position)
 							{
 								if (genome1_mutation == *genome2_matchscan) 		// note pointer equality test
 								{
 									// a match was found, so we multiply our fitness by the full selection coefficient
-									w *= (mut_block_ptr + genome1_mutation)->cached_one_plus_sel_;
+									w *= one_plus_sel_block_ptr[genome1_mutation];
 									goto homozygousExit1;
 								}
 								
@@ -2218,7 +2391,7 @@ double Subpopulation::FitnessOfParentWithGenomeIndices_NoCallbacks(slim_popsize_
 							}
 							
 							// no match was found, so we are heterozygous; we multiply our fitness by the selection coefficient and the dominance coefficient
-							w *= (mut_block_ptr + genome1_mutation)->cached_one_plus_dom_sel_;
+							w *= one_plus_dom_sel_block_ptr[genome1_mutation];
 							
 						homozygousExit1:
 							
@@ -2226,7 +2399,7 @@ double Subpopulation::FitnessOfParentWithGenomeIndices_NoCallbacks(slim_popsize_
 								break;
 							else {
 								genome1_mutation = *genome1_iter;
-								genome1_iter_position = (mut_block_ptr + genome1_mutation)->position_;
+								genome1_iter_position = position_block_ptr[genome1_mutation];
 							}
 						} while (genome1_iter_position == position);
 						
@@ -2236,7 +2409,7 @@ double Subpopulation::FitnessOfParentWithGenomeIndices_NoCallbacks(slim_popsize_
 							const MutationIndex *genome1_matchscan = genome1_start; 
 							
 							// advance through genome1 with genome1_matchscan, looking for a match for the current mutation in genome2, to determine whether we are homozygous or not
-							while (genome1_matchscan != genome1_max && (mut_block_ptr + *genome1_matchscan)->position_ == position)
+							while (genome1_matchscan != genome1_max && position_block_ptr[*genome1_matchscan] == position)
 							{
 								if (genome2_mutation == *genome1_matchscan)		// note pointer equality test
 								{
@@ -2248,7 +2421,7 @@ double Subpopulation::FitnessOfParentWithGenomeIndices_NoCallbacks(slim_popsize_
 							}
 							
 							// no match was found, so we are heterozygous; we multiply our fitness by the selection coefficient and the dominance coefficient
-							w *= (mut_block_ptr + genome2_mutation)->cached_one_plus_dom_sel_;
+							w *= one_plus_dom_sel_block_ptr[genome2_mutation];
 							
 						homozygousExit2:
 							
@@ -2256,7 +2429,7 @@ double Subpopulation::FitnessOfParentWithGenomeIndices_NoCallbacks(slim_popsize_
 								break;
 							else {
 								genome2_mutation = *genome2_iter;
-								genome2_iter_position = (mut_block_ptr + genome2_mutation)->position_;
+								genome2_iter_position = position_block_ptr[genome2_mutation];
 							}
 						} while (genome2_iter_position == position);
 						
@@ -2274,11 +2447,11 @@ double Subpopulation::FitnessOfParentWithGenomeIndices_NoCallbacks(slim_popsize_
 			
 			// if genome1 is unfinished, finish it
 			while (genome1_iter != genome1_max)
-				w *= (mut_block_ptr + *genome1_iter++)->cached_one_plus_dom_sel_;
+				w *= one_plus_dom_sel_block_ptr[*genome1_iter++];
 			
 			// if genome2 is unfinished, finish it
 			while (genome2_iter != genome2_max)
-				w *= (mut_block_ptr + *genome2_iter++)->cached_one_plus_dom_sel_;
+				w *= one_plus_dom_sel_block_ptr[*genome2_iter++];
 		}
 		
 		return w;
@@ -2976,7 +3149,7 @@ void Subpopulation::SwapChildAndParentGenomes(void)
 #ifdef SLIM_NONWF_ONLY
 void Subpopulation::ApplyReproductionCallbacks(std::vector<SLiMEidosBlock*> &p_reproduction_callbacks, slim_popsize_t p_individual_index)
 {
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_START();
 #endif
@@ -3049,7 +3222,7 @@ void Subpopulation::ApplyReproductionCallbacks(std::vector<SLiMEidosBlock*> &p_r
 		}
 	}
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	SLIM_PROFILE_BLOCK_END(population_.sim_.profile_callback_totals_[(int)(SLiMEidosBlockType::SLiMEidosReproductionCallback)]);
 #endif
@@ -154,6 +154,7 @@ public:
 	slim_popsize_t parent_first_male_index_ = INT_MAX;	// the index of the first male in the parental Genome vector (NOT premultiplied by 2!); equal to the number of females
 	std::vector<Individual *> parent_individuals_;	// OWNED: objects representing simulated individuals, each of which has two genomes
 	EidosValue_SP cached_parent_individuals_value_;	// cached for the individuals property; self-maintains
+	std::vector<double> vectorized_global_fitness_;	// per-parent results of vectorized fitness(NULL) callbacks during UpdateFitness(); empty if none
 #ifdef SLIM_WF_ONLY
 	double parent_sex_ratio_ = 0.0;					// what sex ratio the parental genomes approximate (M:M+F)
 #endif	// SLIM_WF_ONLY
@@ -361,8 +362,12 @@ public:
 	double FitnessOfParentWithGenomeIndices_Callbacks(slim_popsize_t p_individual_index, std::vector<SLiMEidosBlock*> &p_fitness_callbacks);
 	double FitnessOfParentWithGenomeIndices_SingleCallback(slim_popsize_t p_individual_index, std::vector<SLiMEidosBlock*> &p_fitness_callbacks, MutationType *p_single_callback_mut_type);
 	
+	// calculate and cache the fitness of the individuals in [p_first_index, p_last_index) using multiple threads, with no callbacks; returns the total fitness
+	double CacheFitnessOfParentsInRange_NoCallbacks_Parallel(slim_popsize_t p_first_index, slim_popsize_t p_last_index, double p_subpop_fitness_scaling);
+	
 	double ApplyFitnessCallbacks(MutationIndex p_mutation, int p_homozygous, double p_computed_fitness, std::vector<SLiMEidosBlock*> &p_fitness_callbacks, Individual *p_individual, Genome *p_genome1, Genome *p_genome2);
 	double ApplyGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &p_fitness_callbacks, slim_popsize_t p_individual_index);
+	void ApplyVectorizedGlobalFitnessCallbacks(std::vector<SLiMEidosBlock*> &p_fitness_callbacks);
 	
 #ifdef SLIM_WF_ONLY
 	void SwapChildAndParentGenomes(void);															// switch to the next generation by swapping; the children become the parents
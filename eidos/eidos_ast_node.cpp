@@ -39,6 +39,12 @@ EidosASTNode::~EidosASTNode(void)
 		gEidosASTNodePool->DisposeChunk(const_cast<EidosASTNode*>(child));
 	}
 	
+	if (cached_bytecode_)
+	{
+		delete cached_bytecode_;
+		cached_bytecode_ = nullptr;
+	}
+	
 	if (token_is_owned_)
 	{
 		delete token_;
@@ -73,6 +79,7 @@ void EidosASTNode::OptimizeTree(void) const
 	_OptimizeEvaluators();		// cache evaluator functions in cached_evaluator_ for fast node evaluation
 	_OptimizeFor();				// cache information about for loops that allows them to be accelerated at runtime
 	_OptimizeAssignments();		// cache information about assignments that allows simple increment/decrement assignments to be accelerated
+	_OptimizeBytecode();		// compile scalar expression subtrees to bytecode; must follow _OptimizeEvaluators(), which provides the fallback evaluators
 }
 
 void EidosASTNode::_OptimizeConstants(void) const
@@ -362,8 +369,213 @@ void EidosASTNode::_OptimizeAssignments(void) const
 					}
 				}
 			}
+			else if ((child1_token_type == EidosTokenType::kTokenLParen) && (child1->children_.size() >= 3))
+			{
+				// ... or the rvalue is a call with at least two arguments...
+				EidosASTNode *call_name_node = child1->children_[0];
+				EidosASTNode *first_argument = child1->children_[1];
+				
+				if ((call_name_node->token_->token_type_ == EidosTokenType::kTokenIdentifier) && call_name_node->cached_signature_ && (call_name_node->token_->token_string_.compare("c") == 0) &&
+					(first_argument->token_->token_type_ == EidosTokenType::kTokenIdentifier) && (first_argument->token_->token_string_.compare(child0->token_->token_string_) == 0))
+				{
+					// ... to the built-in function c(), with the lvalue as its first argument...
+					bool named_arguments = false;
+					
+					for (size_t child_index = 1; child_index < child1->children_.size(); ++child_index)
+						if (child1->children_[child_index]->token_->token_type_ == EidosTokenType::kTokenAssign)
+							named_arguments = true;
+					
+					// ... and no named arguments, so we have an append like x = c(x, y), which Evaluate_Assign() can do in place
+					if (!named_arguments)
+						cached_append_assignment_ = true;
+				}
+			}
+		}
+	}
+}
+
+void EidosASTNode::_OptimizeBytecode(void) const
+{
+	// unlike the other passes, this one works top-down, since we want to compile maximal subtrees; the nodes inside a compiled
+	// subtree keep their own evaluators, which are used by the root's fallback evaluator if the bytecode bails out at runtime
+	if (cached_bytecode_)
+	{
+		// OptimizeTree() has been called before; _OptimizeEvaluators() has already reset our evaluator, so just recompile
+		delete cached_bytecode_;
+		cached_bytecode_ = nullptr;
+	}
+	
+	switch (token_->token_type_)
+	{
+		case EidosTokenType::kTokenPlus:
+		case EidosTokenType::kTokenMinus:
+		case EidosTokenType::kTokenMod:
+		case EidosTokenType::kTokenMult:
+		case EidosTokenType::kTokenExp:
+		case EidosTokenType::kTokenDiv:
+		case EidosTokenType::kTokenAnd:
+		case EidosTokenType::kTokenOr:
+		case EidosTokenType::kTokenEq:
+		case EidosTokenType::kTokenNotEq:
+		case EidosTokenType::kTokenLt:
+		case EidosTokenType::kTokenLtEq:
+		case EidosTokenType::kTokenGt:
+		case EidosTokenType::kTokenGtEq:
+		case EidosTokenType::kTokenNot:
+		{
+			if (cached_evaluator_)
+			{
+				EidosBytecode *bytecode = new EidosBytecode();
+				
+				if (_CompileBytecode(bytecode, 0))
+				{
+					bytecode->fallback_evaluator_ = cached_evaluator_;
+					cached_bytecode_ = bytecode;
+					cached_evaluator_ = &EidosInterpreter::Evaluate_Bytecode;
+					return;
+				}
+				
+				delete bytecode;
+			}
+			break;
+		}
+		default:
+			break;
+	}
+	
+	for (auto child : children_)
+		child->_OptimizeBytecode();
+}
+
+bool EidosASTNode::_CompileBytecode(EidosBytecode *p_bytecode, int p_dest_register) const
+{
+	// Emit instructions that leave the value of this subtree in p_dest_register, using the registers above it as temporaries.
+	// Returns false if the subtree contains anything the VM can't handle; the caller then discards the partial bytecode.
+	if (p_dest_register + 1 >= EIDOS_BYTECODE_MAX_REGISTERS)
+		return false;
+	
+	EidosTokenType token_type = token_->token_type_;
+	size_t children_count = children_.size();
+	EidosBytecodeInstruction instruction;
+	
+	instruction.dest_ = (uint8_t)p_dest_register;
+	instruction.src1_ = (uint8_t)p_dest_register;
+	instruction.src2_ = (uint8_t)(p_dest_register + 1);
+	instruction.symbol_ = gEidosID_none;
+	instruction.constant_.type_ = EidosValueType::kValueInt;
+	instruction.constant_.int_ = 0;
+	
+	switch (token_type)
+	{
+		case EidosTokenType::kTokenNumber:
+		case EidosTokenType::kTokenIdentifier:
+		{
+			if (children_count != 0)
+				return false;
+			
+			if (cached_literal_value_)
+			{
+				// numbers, and built-in constants like T and PI, are loaded as constants; NULL, for example, is not compilable
+				EidosValue *literal = cached_literal_value_.get();
+				
+				if ((literal->Count() != 1) || (literal->DimensionCount() != 1))
+					return false;
+				
+				switch (literal->Type())
+				{
+					case EidosValueType::kValueLogical:	instruction.constant_.logical_ = literal->LogicalAtIndex(0, nullptr);	break;
+					case EidosValueType::kValueInt:		instruction.constant_.int_ = literal->IntAtIndex(0, nullptr);			break;
+					case EidosValueType::kValueFloat:	instruction.constant_.float_ = literal->FloatAtIndex(0, nullptr);		break;
+					default:							return false;
+				}
+				
+				instruction.opcode_ = EidosBytecodeOp::kLoadConstant;
+				instruction.constant_.type_ = literal->Type();
+			}
+			else if (token_type == EidosTokenType::kTokenIdentifier)
+			{
+				instruction.opcode_ = EidosBytecodeOp::kLoadSymbol;
+				instruction.symbol_ = cached_stringID_;
+			}
+			else
+			{
+				return false;
+			}
+			
+			p_bytecode->instructions_.emplace_back(instruction);
+			return true;
+		}
+		case EidosTokenType::kTokenPlus:
+		case EidosTokenType::kTokenMinus:
+		{
+			if (children_count == 1)
+			{
+				if (!children_[0]->_CompileBytecode(p_bytecode, p_dest_register))
+					return false;
+				
+				instruction.opcode_ = ((token_type == EidosTokenType::kTokenPlus) ? EidosBytecodeOp::kUnaryPlus : EidosBytecodeOp::kUnaryMinus);
+				p_bytecode->instructions_.emplace_back(instruction);
+				return true;
+			}
+			
+			instruction.opcode_ = ((token_type == EidosTokenType::kTokenPlus) ? EidosBytecodeOp::kPlus : EidosBytecodeOp::kMinus);
+			break;
+		}
+		case EidosTokenType::kTokenNot:
+		{
+			if (children_count != 1)
+				return false;
+			if (!children_[0]->_CompileBytecode(p_bytecode, p_dest_register))
+				return false;
+			
+			instruction.opcode_ = EidosBytecodeOp::kNot;
+			p_bytecode->instructions_.emplace_back(instruction);
+			return true;
+		}
+		case EidosTokenType::kTokenAnd:
+		case EidosTokenType::kTokenOr:
+		{
+			// & and | can have any number of children, all of which are evaluated; we fold them left to right
+			if (children_count < 2)
+				return false;
+			if (!children_[0]->_CompileBytecode(p_bytecode, p_dest_register))
+				return false;
+			
+			instruction.opcode_ = ((token_type == EidosTokenType::kTokenAnd) ? EidosBytecodeOp::kAnd : EidosBytecodeOp::kOr);
+			
+			for (size_t child_index = 1; child_index < children_count; ++child_index)
+			{
+				if (!children_[child_index]->_CompileBytecode(p_bytecode, p_dest_register + 1))
+					return false;
+				
+				p_bytecode->instructions_.emplace_back(instruction);
+			}
+			return true;
 		}
+		case EidosTokenType::kTokenMult:	instruction.opcode_ = EidosBytecodeOp::kMult;		break;
+		case EidosTokenType::kTokenDiv:		instruction.opcode_ = EidosBytecodeOp::kDiv;		break;
+		case EidosTokenType::kTokenMod:		instruction.opcode_ = EidosBytecodeOp::kMod;		break;
+		case EidosTokenType::kTokenExp:		instruction.opcode_ = EidosBytecodeOp::kExp;		break;
+		case EidosTokenType::kTokenEq:		instruction.opcode_ = EidosBytecodeOp::kEq;			break;
+		case EidosTokenType::kTokenNotEq:	instruction.opcode_ = EidosBytecodeOp::kNotEq;		break;
+		case EidosTokenType::kTokenLt:		instruction.opcode_ = EidosBytecodeOp::kLt;			break;
+		case EidosTokenType::kTokenLtEq:	instruction.opcode_ = EidosBytecodeOp::kLtEq;		break;
+		case EidosTokenType::kTokenGt:		instruction.opcode_ = EidosBytecodeOp::kGt;			break;
+		case EidosTokenType::kTokenGtEq:	instruction.opcode_ = EidosBytecodeOp::kGtEq;		break;
+		default:
+			return false;
 	}
+	
+	// the remaining cases are all binary operators
+	if (children_count != 2)
+		return false;
+	if (!children_[0]->_CompileBytecode(p_bytecode, p_dest_register))
+		return false;
+	if (!children_[1]->_CompileBytecode(p_bytecode, p_dest_register + 1))
+		return false;
+	
+	p_bytecode->instructions_.emplace_back(instruction);
+	return true;
 }
 
 bool EidosASTNode::HasCachedNumericValue(void) const
@@ -481,7 +693,7 @@ void EidosASTNode::PrintTreeWithIndent(std::ostream &p_outstream, int p_indent)
 	}
 }
 
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 // PROFILING
 
 void EidosASTNode::ZeroProfileTotals(void) const
@@ -566,7 +778,7 @@ void EidosASTNode::FullUTF16Range(int32_t *p_start, int32_t *p_end) const
 	*p_end = end;
 }
 
-#endif	// defined(SLIMGUI) && (SLIMPROFILING == 1)
+#endif	// (SLIMPROFILING == 1)
 
 
 
@@ -42,6 +42,67 @@ extern EidosObjectPool *gEidosASTNodePool;
 typedef EidosValue_SP (EidosInterpreter::*EidosEvaluationMethod)(const EidosASTNode *p_node);
 
 
+// Bytecode for scalar expressions.  EidosASTNode::_OptimizeBytecode() lowers maximal subtrees of arithmetic, comparison,
+// and logical operators whose leaves are numeric/logical constants and identifiers into a flat sequence of instructions
+// operating on virtual registers, which EidosInterpreter::Evaluate_Bytecode() executes without allocating an EidosValue
+// for every intermediate result or dispatching through cached_evaluator_ for every node.  Registers hold a typed scalar
+// (logical, integer, or float); the type is established at runtime, since identifiers are untyped until they are fetched.
+// Anything the VM does not handle – a non-singleton or matrix operand, another value type, an undefined identifier, an
+// integer overflow, a NAN used as a logical – makes it bail out to the node's original tree-walking evaluator, which then
+// handles the general case or raises exactly as it always has.  Compiled expressions have no side effects, so evaluating
+// them again after a bailout is always safe.
+#define EIDOS_BYTECODE_MAX_REGISTERS	32
+
+enum class EidosBytecodeOp : uint8_t {
+	kLoadConstant = 0,		// dest = constant_
+	kLoadSymbol,			// dest = the value of symbol_, which must be a singleton logical, integer, or float
+	kPlus,					// dest = src1 + src2
+	kMinus,					// dest = src1 - src2
+	kMult,					// dest = src1 * src2
+	kDiv,					// dest = src1 / src2, always float
+	kMod,					// dest = src1 % src2, always float
+	kExp,					// dest = src1 ^ src2, always float
+	kUnaryPlus,				// dest = +src1
+	kUnaryMinus,			// dest = -src1
+	kNot,					// dest = !src1
+	kAnd,					// dest = src1 & src2
+	kOr,					// dest = src1 | src2
+	kEq,					// dest = src1 == src2
+	kNotEq,					// dest = src1 != src2
+	kLt,					// dest = src1 < src2
+	kLtEq,					// dest = src1 <= src2
+	kGt,					// dest = src1 > src2
+	kGtEq					// dest = src1 >= src2
+};
+
+typedef struct {
+	EidosValueType type_;	// kValueLogical, kValueInt, or kValueFloat
+	union {
+		eidos_logical_t logical_;
+		int64_t int_;
+		double float_;
+	};
+} EidosBytecodeRegister;
+
+typedef struct {
+	EidosBytecodeOp opcode_;
+	uint8_t dest_;
+	uint8_t src1_;
+	uint8_t src2_;
+	EidosGlobalStringID symbol_;		// for kLoadSymbol
+	EidosBytecodeRegister constant_;	// for kLoadConstant
+} EidosBytecodeInstruction;
+
+class EidosBytecode
+{
+public:
+	std::vector<EidosBytecodeInstruction> instructions_;		// the result is always left in register 0
+	EidosEvaluationMethod fallback_evaluator_ = nullptr;		// the tree-walking evaluator for the root node, used on bailout
+	int64_t success_count_ = 0;									// used to give up on nodes that bail out more often than not
+	int64_t bailout_count_ = 0;
+};
+
+
 // A class representing a node in a parse tree for a script
 class EidosASTNode
 {
@@ -58,16 +119,18 @@ public:
 	mutable EidosFunctionSignature_SP cached_signature_ = nullptr;		// a cached pointer to the function signature corresponding to the token
 	mutable EidosEvaluationMethod cached_evaluator_ = nullptr;			// a pre-cached pointer to method to evaluate this node; shorthand for EvaluateNode()
 	mutable EidosGlobalStringID cached_stringID_ = gEidosID_none;		// a pre-cached identifier for the token string, for fast property/method lookup
+	mutable EidosBytecode *cached_bytecode_ = nullptr;					// OWNED; compiled bytecode for scalar expression subtrees, run by Evaluate_Bytecode()
 	
 	uint8_t token_is_owned_ = false;									// if T, we own token_ because it is a virtual token that replaced a real token
 	mutable uint8_t cached_for_references_index_ = true;				// pre-cached as true if the index variable is referenced at all in the loop
 	mutable uint8_t cached_for_assigns_index_ = true;					// pre-cached as true if the index variable is assigned to in the loop
 	mutable uint8_t cached_compound_assignment_ = false;				// pre-cached on assignment nodes if they are of the form "x=x+1" or "x=x-1" only
+	mutable uint8_t cached_append_assignment_ = false;					// pre-cached on assignment nodes if they are of the form "x=c(x, ...)"
 	
 	mutable EidosTypeSpecifier typespec_;								// only valid for type-specifier nodes inside function declarations
 	mutable bool hit_eof_in_tolerant_parse_ = false;					// only valid for compound statement nodes; used by the type-interpreter to handle scoping
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	mutable eidos_profile_t profile_total_ = 0;							// profiling clock for this node and its children; only set for some nodes
 	EidosToken *full_range_end_token_ = nullptr;						// the ")" or "]" that ends the full range of tokens like "(", "[", for, if, and while
@@ -96,6 +159,8 @@ public:
 	void _OptimizeFor(void) const;										// determine whether/how for-loop index variables need to be set up
 	void _OptimizeForScan(const std::string &p_for_index_identifier, uint8_t *p_references, uint8_t *p_assigns) const;	// internal method
 	void _OptimizeAssignments(void) const;								// detect and mark simple increment/decrement assignments on a variable
+	void _OptimizeBytecode(void) const;									// compile scalar expression subtrees to bytecode; see EidosBytecode
+	bool _CompileBytecode(EidosBytecode *p_bytecode, int p_dest_register) const;	// internal method
 	
 	bool HasCachedNumericValue(void) const;
 	double CachedNumericValue(void) const;
@@ -103,7 +168,7 @@ public:
 	void PrintToken(std::ostream &p_outstream) const;
 	void PrintTreeWithIndent(std::ostream &p_outstream, int p_indent) const;
 	
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 	// PROFILING
 	void ZeroProfileTotals(void) const;
 	eidos_profile_t ConvertProfileTotalsToSelfCounts(void) const;
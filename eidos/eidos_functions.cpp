@@ -644,6 +644,106 @@ EidosValue_SP ConcatenateEidosValues(const EidosValue_SP *const p_arguments, int
 	return EidosValue_SP(nullptr);
 }
 
+bool AppendEidosValuesInPlace(EidosValue *p_target, const EidosValue_SP *const p_arguments, int p_argument_count)
+{
+	// This appends the arguments to p_target in place, producing the same values as ConcatenateEidosValues() would for p_target followed by
+	// the arguments, provided that the concatenation would not promote p_target to a different type or class; if it would, p_target is left
+	// unmodified and false is returned.  The caller is responsible for ensuring that p_target is a non-singleton vector without dimensions
+	// that nothing else references.  The push methods grow the buffer geometrically, so a series of appends takes amortized linear time.
+	EidosValueType target_type = p_target->Type();
+	const EidosObjectClass *target_class = nullptr;
+	
+	if (target_type == EidosValueType::kValueObject)
+	{
+		target_class = static_cast<EidosValue_Object *>(p_target)->Class();
+		
+		if (target_class == gEidos_UndefinedClassObject)
+			return false;
+	}
+	else if ((target_type != EidosValueType::kValueLogical) && (target_type != EidosValueType::kValueInt) && (target_type != EidosValueType::kValueFloat) && (target_type != EidosValueType::kValueString))
+		return false;
+	
+	// Check that every argument can be appended without changing the result type; NULL appends nothing, and lower types promote as in c()
+	for (int arg_index = 0; arg_index < p_argument_count; ++arg_index)
+	{
+		EidosValue *arg_value = p_arguments[arg_index].get();
+		EidosValueType arg_type = arg_value->Type();
+		
+		if (arg_type == EidosValueType::kValueNULL)
+			continue;
+		
+		if (target_type == EidosValueType::kValueObject)
+		{
+			if ((arg_type != EidosValueType::kValueObject) || (static_cast<EidosValue_Object *>(arg_value)->Class() != target_class))
+				return false;
+		}
+		else if ((arg_type < EidosValueType::kValueLogical) || (arg_type > target_type))
+			return false;
+	}
+	
+	for (int arg_index = 0; arg_index < p_argument_count; ++arg_index)
+	{
+		EidosValue *arg_value = p_arguments[arg_index].get();
+		int arg_value_count = arg_value->Count();
+		
+		switch (target_type)
+		{
+			case EidosValueType::kValueLogical:
+			{
+				EidosValue_Logical *logical_target = static_cast<EidosValue_Logical *>(p_target);
+				
+				for (int value_index = 0; value_index < arg_value_count; ++value_index)
+					logical_target->push_logical(arg_value->LogicalAtIndex(value_index, nullptr));
+				break;
+			}
+			case EidosValueType::kValueInt:
+			{
+				EidosValue_Int_vector *int_target = static_cast<EidosValue_Int_vector *>(p_target);
+				
+				for (int value_index = 0; value_index < arg_value_count; ++value_index)
+					int_target->push_int(arg_value->IntAtIndex(value_index, nullptr));
+				break;
+			}
+			case EidosValueType::kValueFloat:
+			{
+				EidosValue_Float_vector *float_target = static_cast<EidosValue_Float_vector *>(p_target);
+				
+				if ((arg_value->Type() == EidosValueType::kValueFloat) && (arg_value_count > 1))
+				{
+					const double *arg_data = arg_value->FloatVector()->data();
+					
+					for (int value_index = 0; value_index < arg_value_count; ++value_index)
+						float_target->push_float(arg_data[value_index]);
+				}
+				else
+				{
+					for (int value_index = 0; value_index < arg_value_count; ++value_index)
+						float_target->push_float(arg_value->FloatAtIndex(value_index, nullptr));
+				}
+				break;
+			}
+			case EidosValueType::kValueString:
+			{
+				EidosValue_String_vector *string_target = static_cast<EidosValue_String_vector *>(p_target);
+				
+				for (int value_index = 0; value_index < arg_value_count; ++value_index)
+					string_target->PushString(arg_value->StringAtIndex(value_index, nullptr));
+				break;
+			}
+			default:	// EidosValueType::kValueObject
+			{
+				EidosValue_Object_vector *object_target = static_cast<EidosValue_Object_vector *>(p_target);
+				
+				for (int value_index = 0; value_index < arg_value_count; ++value_index)
+					object_target->push_object_element(arg_value->ObjectElementAtIndex(value_index, nullptr));
+				break;
+			}
+		}
+	}
+	
+	return true;
+}
+
 EidosValue_SP UniqueEidosValue(const EidosValue *p_x_value, bool p_force_new_vector, bool p_preserve_order)
 {
 	EidosValue_SP result_SP(nullptr);
@@ -1268,8 +1368,11 @@ EidosValue_SP Eidos_ExecuteFunction_exp(const EidosValue_SP *const p_arguments,
 		EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 		result_SP = EidosValue_SP(float_result);
 		
-		for (int value_index = 0; value_index < x_count; ++value_index)
-			float_result->set_float_no_check(exp(x_value->FloatAtIndex(value_index, nullptr)), value_index);
+		if (x_value->Type() == EidosValueType::kValueFloat)
+			Eidos_Kernel_Exp(x_value->FloatVector()->data(), float_result->data(), x_count);
+		else
+			for (int value_index = 0; value_index < x_count; ++value_index)
+				float_result->set_float_no_check(exp(x_value->FloatAtIndex(value_index, nullptr)), value_index);
 	}
 	
 	result_SP->CopyDimensionsFromValue(x_value);
@@ -1620,8 +1723,11 @@ EidosValue_SP Eidos_ExecuteFunction_log(const EidosValue_SP *const p_arguments,
 		EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 		result_SP = EidosValue_SP(float_result);
 		
-		for (int value_index = 0; value_index < x_count; ++value_index)
-			float_result->set_float_no_check(log(x_value->FloatAtIndex(value_index, nullptr)), value_index);
+		if (x_value->Type() == EidosValueType::kValueFloat)
+			Eidos_Kernel_Log(x_value->FloatVector()->data(), float_result->data(), x_count);
+		else
+			for (int value_index = 0; value_index < x_count; ++value_index)
+				float_result->set_float_no_check(log(x_value->FloatAtIndex(value_index, nullptr)), value_index);
 	}
 	
 	result_SP->CopyDimensionsFromValue(x_value);
@@ -3259,8 +3365,11 @@ EidosValue_SP Eidos_ExecuteFunction_sqrt(const EidosValue_SP *const p_arguments,
 		EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 		result_SP = EidosValue_SP(float_result);
 		
-		for (int value_index = 0; value_index < x_count; ++value_index)
-			float_result->set_float_no_check(sqrt(x_value->FloatAtIndex(value_index, nullptr)), value_index);
+		if (x_value->Type() == EidosValueType::kValueFloat)
+			Eidos_Kernel_Sqrt(x_value->FloatVector()->data(), float_result->data(), x_count);
+		else
+			for (int value_index = 0; value_index < x_count; ++value_index)
+				float_result->set_float_no_check(sqrt(x_value->FloatAtIndex(value_index, nullptr)), value_index);
 	}
 	
 	result_SP->CopyDimensionsFromValue(x_value);
@@ -3291,6 +3400,10 @@ EidosValue_SP Eidos_ExecuteFunction_sum(const EidosValue_SP *const p_arguments,
 			double sum_d = 0;
 			bool fits_in_integer = true;
 			
+			// First try the vectorized kernel, which succeeds whenever the values are small enough that the sum cannot overflow
+			if (Eidos_Kernel_IntSum(int_data, x_count, &sum))
+				return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(sum));
+			
 			// We do a tricky thing here.  We want to try to compute in integer, but switch to float if we overflow.
 			// If we do overflow, we want to minimize numerical error by accumulating in integer for as long as we
 			// can, and then throwing the integer accumulator over into the float accumulator only when it is about
@@ -4020,8 +4133,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmax(const EidosValue_SP *const p_arguments,
 			EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(int_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				int_result->set_int_no_check(std::max(int0_data[value_index], y_singleton_value), value_index);
+			Eidos_Kernel_IntMax_VS(int0_data, y_singleton_value, int_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueFloat)
 		{
@@ -4030,8 +4142,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmax(const EidosValue_SP *const p_arguments,
 			EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(float_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				float_result->set_float_no_check(std::max(float0_data[value_index], y_singleton_value), value_index);
+			Eidos_Kernel_FloatMax_VS(float0_data, y_singleton_value, float_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueString)
 		{
@@ -4064,8 +4175,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmax(const EidosValue_SP *const p_arguments,
 			EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(int_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				int_result->set_int_no_check(std::max(int0_data[value_index], int1_data[value_index]), value_index);
+			Eidos_Kernel_IntMax_VV(int0_data, int1_data, int_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueFloat)
 		{
@@ -4074,8 +4184,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmax(const EidosValue_SP *const p_arguments,
 			EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(float_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				float_result->set_float_no_check(std::max(float0_data[value_index], float1_data[value_index]), value_index);
+			Eidos_Kernel_FloatMax_VV(float0_data, float1_data, float_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueString)
 		{
@@ -4168,8 +4277,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmin(const EidosValue_SP *const p_arguments,
 			EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(int_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				int_result->set_int_no_check(std::min(int0_data[value_index], y_singleton_value), value_index);
+			Eidos_Kernel_IntMin_VS(int0_data, y_singleton_value, int_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueFloat)
 		{
@@ -4178,8 +4286,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmin(const EidosValue_SP *const p_arguments,
 			EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(float_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				float_result->set_float_no_check(std::min(float0_data[value_index], y_singleton_value), value_index);
+			Eidos_Kernel_FloatMin_VS(float0_data, y_singleton_value, float_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueString)
 		{
@@ -4212,8 +4319,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmin(const EidosValue_SP *const p_arguments,
 			EidosValue_Int_vector *int_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(int_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				int_result->set_int_no_check(std::min(int0_data[value_index], int1_data[value_index]), value_index);
+			Eidos_Kernel_IntMin_VV(int0_data, int1_data, int_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueFloat)
 		{
@@ -4222,8 +4328,7 @@ EidosValue_SP Eidos_ExecuteFunction_pmin(const EidosValue_SP *const p_arguments,
 			EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(x_count);
 			result_SP = EidosValue_SP(float_result);
 			
-			for (int value_index = 0; value_index < x_count; ++value_index)
-				float_result->set_float_no_check(std::min(float0_data[value_index], float1_data[value_index]), value_index);
+			Eidos_Kernel_FloatMin_VV(float0_data, float1_data, float_result->data(), x_count);
 		}
 		else if (x_type == EidosValueType::kValueString)
 		{
@@ -4666,20 +4771,21 @@ EidosValue_SP Eidos_ExecuteFunction_dnorm(const EidosValue_SP *const p_arguments
 			EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize(num_quantiles);
 			result_SP = EidosValue_SP(float_result);
 			
-			for (int64_t value_index = 0; value_index < num_quantiles; ++value_index)
-				float_result->set_float_no_check(gsl_ran_gaussian_pdf(float_data[value_index] - mu0, sigma0), value_index);
+			Eidos_Kernel_DNorm(float_data, mu0, sigma0, float_result->data(), num_quantiles);
 		}
 	}
 	else
 	{
 		const double *float_data = arg_quantile->FloatVector()->data();
+		const double *mu_data = ((!mu_singleton && (arg_mu->Type() == EidosValueType::kValueFloat)) ? arg_mu->FloatVector()->data() : nullptr);
+		const double *sigma_data = ((!sigma_singleton && (arg_sigma->Type() == EidosValueType::kValueFloat)) ? arg_sigma->FloatVector()->data() : nullptr);
 		EidosValue_Float_vector *float_result = (new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector())->resize_no_initialize((int)num_quantiles);
 		result_SP = EidosValue_SP(float_result);
 		
 		for (int value_index = 0; value_index < num_quantiles; ++value_index)
 		{
-			double mu = (mu_singleton ? mu0 : arg_mu->FloatAtIndex(value_index, nullptr));
-			double sigma = (sigma_singleton ? sigma0 : arg_sigma->FloatAtIndex(value_index, nullptr));
+			double mu = (mu_singleton ? mu0 : (mu_data ? mu_data[value_index] : arg_mu->FloatAtIndex(value_index, nullptr)));
+			double sigma = (sigma_singleton ? sigma0 : (sigma_data ? sigma_data[value_index] : arg_sigma->FloatAtIndex(value_index, nullptr)));
 			
 			if (sigma <= 0.0)
 				EIDOS_TERMINATION << "ERROR (Eidos_ExecuteFunction_dnorm): function dnorm() requires sd > 0.0 (" << EidosStringForFloat(sigma) << " supplied)." << EidosTerminate(nullptr);
@@ -5694,9 +5800,20 @@ EidosValue_SP Eidos_ExecuteFunction_c(const EidosValue_SP *const p_arguments, __
 	EidosValue_SP result_SP(nullptr);
 	
 	if (p_argument_count == 0)
+	{
 		result_SP = gStaticEidosValueNULL;	// c() returns NULL, by definition
+	}
 	else
-		result_SP = ConcatenateEidosValues(p_arguments, p_argument_count, true, false);	// allow NULL but not VOID
+	{
+		// If the first argument is a vector that only our argument list references – a temporary such as the result of c() itself,
+		// as in c(c(x, y), z) – we can append the remaining arguments to it in place rather than copying everything into a new vector
+		EidosValue *first_value = p_arguments[0].get();
+		
+		if ((p_argument_count > 1) && (first_value->UseCount() == 1) && !first_value->IsSingleton() && (first_value->DimensionCount() == 1) && !first_value->Invisible() && AppendEidosValuesInPlace(first_value, p_arguments + 1, p_argument_count - 1))
+			result_SP = p_arguments[0];
+		else
+			result_SP = ConcatenateEidosValues(p_arguments, p_argument_count, true, false);	// allow NULL but not VOID
+	}
 	
 	return result_SP;
 }
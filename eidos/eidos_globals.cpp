@@ -46,6 +46,10 @@
 #include <utility>
 #include <sys/param.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 // added for Eidos_mkstemps() and Eidos_SlashTmpExists()
 #include <sys/stat.h>
 #include <fstream>
@@ -58,6 +62,7 @@
 
 
 bool eidos_do_memory_checks = true;
+int gEidosMaxThreads = 1;
 
 EidosSymbolTable *gEidosConstantsSymbolTable = nullptr;
 
@@ -66,7 +71,7 @@ EidosSymbolTable *gEidosConstantsSymbolTable = nullptr;
 #pragma mark Profiling support
 #pragma mark -
 
-#if (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#if (SLIMPROFILING == 1)
 // PROFILING
 
 int gEidosProfilingClientCount = 0;
@@ -77,6 +82,7 @@ double gEidos_ProfileOverheadSeconds;
 double gEidos_ProfileLagTicks;
 double gEidos_ProfileLagSeconds;
 
+#ifdef __APPLE__
 #include <mach/mach.h>
 #include <mach/mach_time.h>
 
@@ -103,6 +109,13 @@ double Eidos_ElapsedProfileTime(uint64_t p_elapsed_profile_time)
 	
 	return p_elapsed_profile_time * timebaseRatio;
 }
+#else
+double Eidos_ElapsedProfileTime(uint64_t p_elapsed_profile_time)
+{
+	// Eidos_ProfileTime() calls out to clock_gettime() on this platform, and returns nanoseconds
+	return p_elapsed_profile_time / 1000000000.0;
+}
+#endif
 
 static eidos_profile_t gEidos_ProfilePrep_Ticks;
 
@@ -148,7 +161,7 @@ void Eidos_PrepareForProfiling(void)
 	//std::cout << "Profile lag internal to block: " << gEidos_ProfileLag_double << " ticks, " << gEidos_ProfileLagSeconds << " seconds" << std::endl;
 }
 
-#endif	// (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#endif	// (SLIMPROFILING == 1)
 
 
 #pragma mark -
@@ -1864,6 +1877,242 @@ std::string EidosStringForFloat(double p_value)
 }
 
 
+#pragma mark -
+#pragma mark Vector kernels
+#pragma mark -
+
+// Note that the result pointers here are deliberately not declared __restrict, since they may equal an operand pointer;
+// the compiler emits a runtime overlap check and uses the vectorized loop for both the disjoint and the identical case.
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_Float_VV(EidosKernelOp p_op, const double *p_x, const double *p_y, double *p_result, int64_t p_count)
+{
+	switch (p_op)
+	{
+		case EidosKernelOp::kAdd:		for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x[index] + p_y[index]; break;
+		case EidosKernelOp::kSubtract:	for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x[index] - p_y[index]; break;
+		case EidosKernelOp::kMultiply:	for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x[index] * p_y[index]; break;
+		case EidosKernelOp::kDivide:	for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x[index] / p_y[index]; break;
+	}
+}
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_Float_VS(EidosKernelOp p_op, const double *p_x, double p_y, double *p_result, int64_t p_count)
+{
+	switch (p_op)
+	{
+		case EidosKernelOp::kAdd:		for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x[index] + p_y; break;
+		case EidosKernelOp::kSubtract:	for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x[index] - p_y; break;
+		case EidosKernelOp::kMultiply:	for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x[index] * p_y; break;
+		case EidosKernelOp::kDivide:	for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x[index] / p_y; break;
+	}
+}
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_Float_SV(EidosKernelOp p_op, double p_x, const double *p_y, double *p_result, int64_t p_count)
+{
+	switch (p_op)
+	{
+		case EidosKernelOp::kAdd:		for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x + p_y[index]; break;
+		case EidosKernelOp::kSubtract:	for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x - p_y[index]; break;
+		case EidosKernelOp::kMultiply:	for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x * p_y[index]; break;
+		case EidosKernelOp::kDivide:	for (int64_t index = 0; index < p_count; ++index) p_result[index] = p_x / p_y[index]; break;
+	}
+}
+
+// The integer kernels compute with unsigned wraparound, and detect signed overflow from the sign bits of the operands and
+// result, accumulating an overflow flag across the whole loop; this keeps the loop branch-free so that it vectorizes.
+// The caller raises an error if overflow occurred, so the wrapped values are never seen.
+
+EIDOS_KERNEL_DISPATCH bool Eidos_Kernel_IntAdd_VV(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count)
+{
+	uint64_t overflow = 0;
+	
+	for (int64_t index = 0; index < p_count; ++index)
+	{
+		uint64_t x = (uint64_t)p_x[index], y = (uint64_t)p_y[index], r = x + y;
+		
+		overflow |= (x ^ r) & (y ^ r);
+		p_result[index] = (int64_t)r;
+	}
+	
+	return (overflow >> 63);
+}
+
+EIDOS_KERNEL_DISPATCH bool Eidos_Kernel_IntAdd_VS(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count)
+{
+	uint64_t overflow = 0, y = (uint64_t)p_y;
+	
+	for (int64_t index = 0; index < p_count; ++index)
+	{
+		uint64_t x = (uint64_t)p_x[index], r = x + y;
+		
+		overflow |= (x ^ r) & (y ^ r);
+		p_result[index] = (int64_t)r;
+	}
+	
+	return (overflow >> 63);
+}
+
+EIDOS_KERNEL_DISPATCH bool Eidos_Kernel_IntSubtract_VV(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count)
+{
+	uint64_t overflow = 0;
+	
+	for (int64_t index = 0; index < p_count; ++index)
+	{
+		uint64_t x = (uint64_t)p_x[index], y = (uint64_t)p_y[index], r = x - y;
+		
+		overflow |= (x ^ y) & (x ^ r);
+		p_result[index] = (int64_t)r;
+	}
+	
+	return (overflow >> 63);
+}
+
+EIDOS_KERNEL_DISPATCH bool Eidos_Kernel_IntSubtract_VS(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count)
+{
+	uint64_t overflow = 0, y = (uint64_t)p_y;
+	
+	for (int64_t index = 0; index < p_count; ++index)
+	{
+		uint64_t x = (uint64_t)p_x[index], r = x - y;
+		
+		overflow |= (x ^ y) & (x ^ r);
+		p_result[index] = (int64_t)r;
+	}
+	
+	return (overflow >> 63);
+}
+
+EIDOS_KERNEL_DISPATCH bool Eidos_Kernel_IntSubtract_SV(int64_t p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count)
+{
+	uint64_t overflow = 0, x = (uint64_t)p_x;
+	
+	for (int64_t index = 0; index < p_count; ++index)
+	{
+		uint64_t y = (uint64_t)p_y[index], r = x - y;
+		
+		overflow |= (x ^ y) & (x ^ r);
+		p_result[index] = (int64_t)r;
+	}
+	
+	return (overflow >> 63);
+}
+
+EIDOS_KERNEL_DISPATCH bool Eidos_Kernel_IntSum(const int64_t *p_x, int64_t p_count, int64_t *p_sum)
+{
+	// First we bound the magnitude of the values; OR-ing their magnitudes gives a bound that is at most twice the largest
+	// magnitude, which is good enough and vectorizes trivially.  If count * bound fits in int64_t, no partial sum can
+	// overflow, and we can sum without overflow checks; otherwise the caller falls back to its overflow-checking loop.
+	uint64_t magnitude_bound = 0;
+	
+	for (int64_t index = 0; index < p_count; ++index)
+	{
+		uint64_t value = (uint64_t)p_x[index];
+		
+		magnitude_bound |= ((p_x[index] < 0) ? (0 - value) : value);
+	}
+	
+	if ((p_count <= 0) || (magnitude_bound > (uint64_t)INT64_MAX / (uint64_t)p_count))
+		return false;
+	
+	int64_t sum = 0;
+	
+	for (int64_t index = 0; index < p_count; ++index)
+		sum += p_x[index];
+	
+	*p_sum = sum;
+	return true;
+}
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_FloatMax_VV(const double *p_x, const double *p_y, double *p_result, int64_t p_count)
+{
+	for (int64_t index = 0; index < p_count; ++index)
+		p_result[index] = std::max(p_x[index], p_y[index]);
+}
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_FloatMax_VS(const double *p_x, double p_y, double *p_result, int64_t p_count)
+{
+	for (int64_t index = 0; index < p_count; ++index)
+		p_result[index] = std::max(p_x[index], p_y);
+}
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_FloatMin_VV(const double *p_x, const double *p_y, double *p_result, int64_t p_count)
+{
+	for (int64_t index = 0; index < p_count; ++index)
+		p_result[index] = std::min(p_x[index], p_y[index]);
+}
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_FloatMin_VS(const double *p_x, double p_y, double *p_result, int64_t p_count)
+{
+	for (int64_t index = 0; index < p_count; ++index)
+		p_result[index] = std::min(p_x[index], p_y);
+}
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_IntMax_VV(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count)
+{
+	for (int64_t index = 0; index < p_count; ++index)
+		p_result[index] = std::max(p_x[index], p_y[index]);
+}
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_IntMax_VS(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count)
+{
+	for (int64_t index = 0; index < p_count; ++index)
+		p_result[index] = std::max(p_x[index], p_y);
+}
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_IntMin_VV(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count)
+{
+	for (int64_t index = 0; index < p_count; ++index)
+		p_result[index] = std::min(p_x[index], p_y[index]);
+}
+
+EIDOS_KERNEL_DISPATCH void Eidos_Kernel_IntMin_VS(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count)
+{
+	for (int64_t index = 0; index < p_count; ++index)
+		p_result[index] = std::min(p_x[index], p_y);
+}
+
+void Eidos_Kernel_Sqrt(const double *p_x, double *p_result, int64_t p_count)
+{
+	int64_t index = 0;
+	
+#ifdef __SSE2__
+	// The compiler will not vectorize sqrt() itself, since it must preserve errno for negative arguments (which we don't
+	// use), so we use the SSE2 square root directly; it is correctly rounded, and so identical to sqrt(), as IEEE requires
+	for (; index + 2 <= p_count; index += 2)
+		_mm_storeu_pd(p_result + index, _mm_sqrt_pd(_mm_loadu_pd(p_x + index)));
+#endif
+	
+	for (; index < p_count; ++index)
+		p_result[index] = sqrt(p_x[index]);
+}
+
+void Eidos_Kernel_Exp(const double *p_x, double *p_result, int64_t p_count)
+{
+	for (int64_t index = 0; index < p_count; ++index)
+		p_result[index] = exp(p_x[index]);
+}
+
+void Eidos_Kernel_Log(const double *p_x, double *p_result, int64_t p_count)
+{
+	for (int64_t index = 0; index < p_count; ++index)
+		p_result[index] = log(p_x[index]);
+}
+
+void Eidos_Kernel_DNorm(const double *p_x, double p_mu, double p_sigma, double *p_result, int64_t p_count)
+{
+	// This is gsl_ran_gaussian_pdf(x - mu, sigma), with the terms that depend only upon sigma hoisted out of the loop;
+	// the arithmetic is otherwise the same as GSL's, operation for operation, so the results are identical
+	double abs_sigma = fabs(p_sigma);
+	double scale = 1 / (sqrt(2 * M_PI) * abs_sigma);
+	
+	for (int64_t index = 0; index < p_count; ++index)
+	{
+		double u = (p_x[index] - p_mu) / abs_sigma;
+		
+		p_result[index] = scale * exp(-u * u / 2);
+	}
+}
+
+
 #pragma mark -
 #pragma mark Global strings & IDs
 #pragma mark -
@@ -31,8 +31,12 @@
 #include <numeric>
 #include <algorithm>
 
-#if (defined(SLIMGUI) && (SLIMPROFILING == 1))
-#include <mach/mach_time.h>		// for mach_absolute_time(), for profiling; needed only in SLiMgui when profiling is enabled
+#if (SLIMPROFILING == 1)
+#ifdef __APPLE__
+#include <mach/mach_time.h>		// for mach_absolute_time(), for profiling; needed only when profiling is enabled
+#else
+#include <time.h>				// for clock_gettime(), for profiling; needed only when profiling is enabled
+#endif
 #endif
 
 class EidosScript;
@@ -118,6 +122,20 @@ extern bool gEidosSuppressWarnings;
 extern bool eidos_do_memory_checks;
 
 
+// *******************************************************************************************************************
+//
+//	Multithreading
+//
+#pragma mark -
+#pragma mark Multithreading
+#pragma mark -
+
+// Eidos and SLiM are not thread-safe in general, but a few hot loops in SLiM can run in parallel when it is built with
+// OpenMP (see CMakeLists.txt).  This is the maximum number of threads those loops may use.  It is 1 by default, in which
+// case all work is done on the main thread; in SLiM it is set with the -threads command-line option.
+extern int gEidosMaxThreads;
+
+
 // *******************************************************************************************************************
 //
 //	Memory usage monitoring
@@ -147,16 +165,17 @@ void Eidos_CheckRSSAgainstMax(std::string p_message1, std::string p_message2);
 #pragma mark Profiling support
 #pragma mark -
 
-#if (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#if (SLIMPROFILING == 1)
 // PROFILING
 
 extern int gEidosProfilingClientCount;	// if non-zero, profiling is happening in some context
 
 // Profiling clocks; note that these can overflow, we don't care, only (t2-t1) ever matters and that is overflow-robust
 
-// This is the fastest clock, is available across OS X versions, and gives us nanoseconds.  The only disadvantage to
-// it is that it is platform-specific, so we can only use this clock in SLiMgui and Eidos_GUI.  That is OK.  This
-// returns uint64_t in CPU-specific time units; see https://developer.apple.com/library/content/qa/qa1398/_index.html
+// On OS X we use mach_absolute_time(), which is the fastest clock, is available across OS X versions, and gives us
+// nanoseconds.  It returns uint64_t in CPU-specific time units; see https://developer.apple.com/library/content/qa/qa1398/_index.html
+// Elsewhere (profiling in the command-line build, with cmake -D PROFILE=ON) we use clock_gettime(CLOCK_MONOTONIC),
+// converted to uint64_t nanoseconds; it is somewhat slower, but the profile block overhead is measured and corrected.
 typedef uint64_t eidos_profile_t;
 
 extern uint64_t gEidos_ProfileCounter;			// incremented by Eidos_ProfileTime() every time it is called
@@ -166,7 +185,18 @@ extern double gEidos_ProfileLagTicks;			// the clocked length of an empty profil
 extern double gEidos_ProfileLagSeconds;			// the clocked length of an empty profile block, in seconds
 
 // Get a profile clock measurement, to be used as a start or end time
+#ifdef __APPLE__
 inline __attribute__((always_inline)) eidos_profile_t Eidos_ProfileTime(void) { gEidos_ProfileCounter++; return mach_absolute_time(); }
+#else
+inline __attribute__((always_inline)) eidos_profile_t Eidos_ProfileTime(void)
+{
+	struct timespec ts;
+	
+	gEidos_ProfileCounter++;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (eidos_profile_t)ts.tv_sec * 1000000000 + (eidos_profile_t)ts.tv_nsec;
+}
+#endif
 
 // Convert an elapsed profiling time (the difference between two Eidos_ProfileTime() results) to seconds
 double Eidos_ElapsedProfileTime(uint64_t p_elapsed_profile_time);
@@ -231,7 +261,7 @@ void Eidos_PrepareForProfiling(void);
 		(slim__accumulator) += slim__corrected_ticks;																														\
 	}
 
-#endif	// (defined(SLIMGUI) && (SLIMPROFILING == 1))
+#endif	// (SLIMPROFILING == 1)
 
 
 // *******************************************************************************************************************
@@ -478,6 +508,73 @@ public:
 #endif
 
 
+// *******************************************************************************************************************
+//
+//	Vector kernels
+//
+#pragma mark -
+#pragma mark Vector kernels
+#pragma mark -
+
+// These kernels implement the inner loops of Eidos vector arithmetic, integer sums, min/max, and elementwise math
+// functions over raw int64_t / double buffers, so that the compiler can vectorize them.  On x86_64 Linux with GCC they
+// are compiled in several versions (AVX-512F, AVX2, and the baseline SSE2) and the best version for the running CPU is
+// chosen when the executable is loaded, using GCC's target_clones; elsewhere the baseline version is used.  Define
+// EIDOS_NO_KERNEL_DISPATCH to build only the baseline version.  Each kernel performs exactly the same floating-point
+// operations as the scalar loop it replaces, so results do not depend upon the CPU, or upon whether a kernel is used.
+// The result buffer may be identical to an operand buffer (for in-place reuse of operands), but must not otherwise
+// overlap it.
+
+#if defined(__x86_64__) && defined(__linux__) && defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 6) && !defined(EIDOS_NO_KERNEL_DISPATCH)
+#define EIDOS_KERNEL_DISPATCH	__attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define EIDOS_KERNEL_DISPATCH
+#endif
+
+enum class EidosKernelOp : uint8_t {
+	kAdd = 0,
+	kSubtract,
+	kMultiply,
+	kDivide
+};
+
+// float result = x op y, elementwise; VV is vector-vector, VS vector-singleton, SV singleton-vector
+void Eidos_Kernel_Float_VV(EidosKernelOp p_op, const double *p_x, const double *p_y, double *p_result, int64_t p_count);
+void Eidos_Kernel_Float_VS(EidosKernelOp p_op, const double *p_x, double p_y, double *p_result, int64_t p_count);
+void Eidos_Kernel_Float_SV(EidosKernelOp p_op, double p_x, const double *p_y, double *p_result, int64_t p_count);
+
+// integer result = x + y or x - y, elementwise, with wraparound; returns true if any element overflowed
+bool Eidos_Kernel_IntAdd_VV(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count);
+bool Eidos_Kernel_IntAdd_VS(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count);
+bool Eidos_Kernel_IntSubtract_VV(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count);
+bool Eidos_Kernel_IntSubtract_VS(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count);
+bool Eidos_Kernel_IntSubtract_SV(int64_t p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count);
+
+// integer sum; returns false, without a sum, if the sum might overflow.  There are deliberately no float reductions here;
+// sum(), mean(), cumSum() etc. accumulate floats strictly from first to last, so that their results are consistent with
+// each other, and reassociating the sum into vector lanes would change the result in the last bits.
+bool Eidos_Kernel_IntSum(const int64_t *p_x, int64_t p_count, int64_t *p_sum);
+
+// elementwise min/max, with the semantics of std::min() / std::max()
+void Eidos_Kernel_FloatMax_VV(const double *p_x, const double *p_y, double *p_result, int64_t p_count);
+void Eidos_Kernel_FloatMax_VS(const double *p_x, double p_y, double *p_result, int64_t p_count);
+void Eidos_Kernel_FloatMin_VV(const double *p_x, const double *p_y, double *p_result, int64_t p_count);
+void Eidos_Kernel_FloatMin_VS(const double *p_x, double p_y, double *p_result, int64_t p_count);
+void Eidos_Kernel_IntMax_VV(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count);
+void Eidos_Kernel_IntMax_VS(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count);
+void Eidos_Kernel_IntMin_VV(const int64_t *p_x, const int64_t *p_y, int64_t *p_result, int64_t p_count);
+void Eidos_Kernel_IntMin_VS(const int64_t *p_x, int64_t p_y, int64_t *p_result, int64_t p_count);
+
+// elementwise math functions; exp() and log() call the math library for each element, since vectorized versions
+// would not give results identical to the scalar functions, but the loops avoid all per-element dispatch overhead
+void Eidos_Kernel_Sqrt(const double *p_x, double *p_result, int64_t p_count);
+void Eidos_Kernel_Exp(const double *p_x, double *p_result, int64_t p_count);
+void Eidos_Kernel_Log(const double *p_x, double *p_result, int64_t p_count);
+
+// the normal density, with results identical to gsl_ran_gaussian_pdf(x - mu, sigma); sigma must be > 0
+void Eidos_Kernel_DNorm(const double *p_x, double p_mu, double p_sigma, double *p_result, int64_t p_count);
+
+
 // *******************************************************************************************************************
 //
 //	Floating point representation in text
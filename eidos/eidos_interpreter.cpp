@@ -61,6 +61,49 @@
 #endif
 
 
+// Conversions between EidosBytecodeRegister and the scalar types and EidosValues that the tree-walking evaluators use; these
+// must follow FloatAtIndex(), IntAtIndex(), and LogicalAtIndex() exactly, so that the VM produces identical results
+static inline __attribute__((always_inline)) double Eidos_BytecodeRegisterFloat(const EidosBytecodeRegister &p_register)
+{
+	if (p_register.type_ == EidosValueType::kValueFloat)
+		return p_register.float_;
+	if (p_register.type_ == EidosValueType::kValueInt)
+		return (double)p_register.int_;
+	return (p_register.logical_ ? 1.0 : 0.0);
+}
+
+static inline __attribute__((always_inline)) int64_t Eidos_BytecodeRegisterInt(const EidosBytecodeRegister &p_register)
+{
+	// never called for float registers; comparisons involving float are done as float
+	if (p_register.type_ == EidosValueType::kValueInt)
+		return p_register.int_;
+	return (p_register.logical_ ? 1 : 0);
+}
+
+static inline __attribute__((always_inline)) bool Eidos_BytecodeRegisterLogical(const EidosBytecodeRegister &p_register, eidos_logical_t *p_logical)
+{
+	// returns false for NAN, which LogicalAtIndex() raises on; the VM bails out and lets the evaluator raise
+	if (p_register.type_ == EidosValueType::kValueLogical)
+		*p_logical = p_register.logical_;
+	else if (p_register.type_ == EidosValueType::kValueInt)
+		*p_logical = (p_register.int_ != 0);
+	else if (std::isnan(p_register.float_))
+		return false;
+	else
+		*p_logical = (p_register.float_ != 0);
+	return true;
+}
+
+static inline __attribute__((always_inline)) EidosValue_SP Eidos_ValueForBytecodeRegister(const EidosBytecodeRegister &p_register)
+{
+	if (p_register.type_ == EidosValueType::kValueFloat)
+		return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(p_register.float_));
+	if (p_register.type_ == EidosValueType::kValueInt)
+		return EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(p_register.int_));
+	return (p_register.logical_ ? gStaticEidosValue_LogicalT : gStaticEidosValue_LogicalF);
+}
+
+
 bool TypeCheckAssignmentOfEidosValueIntoEidosValue(const EidosValue &p_base_value, const EidosValue &p_dest_value)
 {
 	EidosValueType base_type = p_base_value.Type();
@@ -265,14 +308,14 @@ EidosValue_SP EidosInterpreter::EvaluateInterpreterBlock(bool p_print_output, bo
 	
 	for (EidosASTNode *child_node : root_node_->children_)
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
 		
 		EidosValue_SP statement_result_SP = FastEvaluateNode(child_node);
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(child_node->profile_total_);
 #endif
@@ -348,11 +391,15 @@ void EidosInterpreter::_ProcessSubsetAssignment(EidosValue_SP *p_base_value_ptr,
 			
 			std::vector<int> base_indices;
 			
-			// Recurse to find the symbol host and property name that we are ultimately subscripting off of
-			_ProcessSubsetAssignment(p_base_value_ptr, p_property_string_id_ptr, &base_indices, left_operand);
+			// Recurse to find the symbol host and property name that we are ultimately subscripting off of.  If we are subscripting
+			// a variable directly, as in x[i] = v, its indices are just 0:(n-1), so we don't build base_indices at all; that keeps a
+			// loop assigning into successive elements of a vector from being quadratic in the vector's length
+			bool base_indices_identity = (left_operand->token_->token_type_ == EidosTokenType::kTokenIdentifier);
+			
+			_ProcessSubsetAssignment(p_base_value_ptr, p_property_string_id_ptr, base_indices_identity ? nullptr : &base_indices, left_operand);
 			
-			int base_indices_count = (int)base_indices.size();
 			EidosValue_SP first_child_value = *p_base_value_ptr;
+			int base_indices_count = base_indices_identity ? first_child_value->Count() : (int)base_indices.size();
 			int first_child_dim_count = first_child_value->DimensionCount();
 			
 			// organize our subset arguments
@@ -399,7 +446,7 @@ void EidosInterpreter::_ProcessSubsetAssignment(EidosValue_SP *p_base_value_ptr,
 			{
 				// We have a single subset argument of NULL, so we have x[] or x[NULL]; just return all legal indices
 				for (int value_idx = 0; value_idx < base_indices_count; value_idx++)
-					p_indices_ptr->emplace_back(base_indices[value_idx]);
+					p_indices_ptr->emplace_back(base_indices_identity ? value_idx : base_indices[value_idx]);
 			}
 			else if (subset_index_count == 1)
 			{
@@ -425,7 +472,7 @@ void EidosInterpreter::_ProcessSubsetAssignment(EidosValue_SP *p_base_value_ptr,
 						eidos_logical_t logical_value = second_child_value->LogicalAtIndex(value_idx, parent_token);
 						
 						if (logical_value)
-							p_indices_ptr->emplace_back(base_indices[value_idx]);
+							p_indices_ptr->emplace_back(base_indices_identity ? value_idx : base_indices[value_idx]);
 					}
 				}
 				else
@@ -440,7 +487,7 @@ void EidosInterpreter::_ProcessSubsetAssignment(EidosValue_SP *p_base_value_ptr,
 							if ((index_value < 0) || (index_value >= base_indices_count))
 								EIDOS_TERMINATION << "ERROR (EidosInterpreter::_ProcessSubsetAssignment): out-of-range index " << index_value << " used with the '[]' operator." << EidosTerminate(parent_token);
 							else
-								p_indices_ptr->emplace_back(base_indices[index_value]);
+								p_indices_ptr->emplace_back(base_indices_identity ? index_value : base_indices[index_value]);
 						}
 						else if (second_child_count)
 						{
@@ -454,7 +501,7 @@ void EidosInterpreter::_ProcessSubsetAssignment(EidosValue_SP *p_base_value_ptr,
 								if ((index_value < 0) || (index_value >= base_indices_count))
 									EIDOS_TERMINATION << "ERROR (EidosInterpreter::_ProcessSubsetAssignment): out-of-range index " << index_value << " used with the '[]' operator." << EidosTerminate(parent_token);
 								else
-									p_indices_ptr->emplace_back(base_indices[index_value]);
+									p_indices_ptr->emplace_back(base_indices_identity ? index_value : base_indices[index_value]);
 							}
 						}
 					}
@@ -469,7 +516,7 @@ void EidosInterpreter::_ProcessSubsetAssignment(EidosValue_SP *p_base_value_ptr,
 							if ((index_value < 0) || (index_value >= base_indices_count))
 								EIDOS_TERMINATION << "ERROR (EidosInterpreter::_ProcessSubsetAssignment): out-of-range index " << index_value << " used with the '[]' operator." << EidosTerminate(parent_token);
 							else
-								p_indices_ptr->emplace_back(base_indices[index_value]);
+								p_indices_ptr->emplace_back(base_indices_identity ? index_value : base_indices[index_value]);
 						}
 					}
 				}
@@ -665,10 +712,14 @@ void EidosInterpreter::_ProcessSubsetAssignment(EidosValue_SP *p_base_value_ptr,
 			
 			*p_base_value_ptr = std::move(identifier_value_SP);
 			
-			int number_of_elements = identifier_value->Count();	// this value is already defined, so this is fast
-			
-			for (int element_idx = 0; element_idx < number_of_elements; element_idx++)
-				p_indices_ptr->emplace_back(element_idx);
+			// our caller may pass nullptr for p_indices_ptr to indicate that it knows the indices are 0:(n-1) and does not need them
+			if (p_indices_ptr)
+			{
+				int number_of_elements = identifier_value->Count();	// this value is already defined, so this is fast
+				
+				for (int element_idx = 0; element_idx < number_of_elements; element_idx++)
+					p_indices_ptr->emplace_back(element_idx);
+			}
 			
 			break;
 		}
@@ -894,14 +945,14 @@ EidosValue_SP EidosInterpreter::Evaluate_CompoundStatement(const EidosASTNode *p
 	
 	for (EidosASTNode *child_node : p_node->children_)
 	{
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_START();
 #endif
 		
 		EidosValue_SP statement_result_SP = FastEvaluateNode(child_node);
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END(child_node->profile_total_);
 #endif
@@ -2160,6 +2211,36 @@ EidosValue_SP EidosInterpreter::Evaluate_MemberRef(const EidosASTNode *p_node)
 	return result_SP;
 }
 
+// These return a vector to hold the p_count-element result of an arithmetic operator.  If an operand is already a vector of the right
+// type and size that nothing else references – the result of a subexpression, typically – its buffer is reused for the result, so that
+// an expression like a * b + c makes one result vector rather than two; p_operand2 may be nullptr.  Values held by a symbol table,
+// cached in the AST, or retained by result_dim_source have a use count greater than one and are never reused, and neither are values
+// with dimensions, since the caller sets the result's dimensions afterwards.  Operators read element i before writing element i.
+static inline __attribute__((always_inline)) bool Eidos_OperandIsReusableVector(EidosValue *p_operand, EidosValueType p_type, int p_count)
+{
+	return (p_operand && (p_operand->UseCount() == 1) && (p_operand->Type() == p_type) && !p_operand->IsSingleton() && (p_operand->Count() == p_count) && (p_operand->DimensionCount() == 1) && !p_operand->Invisible());
+}
+
+static inline EidosValue_Float_vector_SP Eidos_FloatVectorForOperatorResult(EidosValue *p_operand1, EidosValue *p_operand2, int p_count)
+{
+	if (Eidos_OperandIsReusableVector(p_operand1, EidosValueType::kValueFloat, p_count))
+		return EidosValue_Float_vector_SP(static_cast<EidosValue_Float_vector *>(p_operand1));
+	if (Eidos_OperandIsReusableVector(p_operand2, EidosValueType::kValueFloat, p_count))
+		return EidosValue_Float_vector_SP(static_cast<EidosValue_Float_vector *>(p_operand2));
+	
+	return EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+}
+
+static inline EidosValue_Int_vector_SP Eidos_IntVectorForOperatorResult(EidosValue *p_operand1, EidosValue *p_operand2, int p_count)
+{
+	if (Eidos_OperandIsReusableVector(p_operand1, EidosValueType::kValueInt, p_count))
+		return EidosValue_Int_vector_SP(static_cast<EidosValue_Int_vector *>(p_operand1));
+	if (Eidos_OperandIsReusableVector(p_operand2, EidosValueType::kValueInt, p_count))
+		return EidosValue_Int_vector_SP(static_cast<EidosValue_Int_vector *>(p_operand2));
+	
+	return EidosValue_Int_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector());
+}
+
 EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 {
 	EIDOS_ENTRY_EXECUTION_LOG("Evaluate_Plus()");
@@ -2289,24 +2370,11 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 				{
 					const int64_t *first_child_data = first_child_value->IntVector()->data();
 					const int64_t *second_child_data = second_child_value->IntVector()->data();
-					EidosValue_Int_vector_SP int_result_SP = EidosValue_Int_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector());
+					EidosValue_Int_vector_SP int_result_SP = Eidos_IntVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 					EidosValue_Int_vector *int_result = int_result_SP->resize_no_initialize(first_child_count);
 					
-					for (int value_index = 0; value_index < first_child_count; ++value_index)
-					{
-						// This is an overflow-safe version of:
-						//int_result->set_int_no_check(first_child_value->IntAtIndex(value_index, operator_token) + second_child_value->IntAtIndex(value_index, operator_token));
-						
-						int64_t first_operand = first_child_data[value_index];
-						int64_t second_operand = second_child_data[value_index];
-						int64_t add_result;
-						bool overflow = Eidos_add_overflow(first_operand, second_operand, &add_result);
-						
-						if (overflow)
-							EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Plus): integer addition overflow with the binary '+' operator." << EidosTerminate(operator_token);
-						
-						int_result->set_int_no_check(add_result, value_index);
-					}
+					if (Eidos_Kernel_IntAdd_VV(first_child_data, second_child_data, int_result->data(), first_child_count))
+						EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Plus): integer addition overflow with the binary '+' operator." << EidosTerminate(operator_token);
 					
 					result_SP = std::move(int_result_SP);
 				}
@@ -2315,23 +2383,11 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 			{
 				int64_t singleton_int = first_child_value->IntAtIndex(0, operator_token);
 				const int64_t *second_child_data = second_child_value->IntVector()->data();
-				EidosValue_Int_vector_SP int_result_SP = EidosValue_Int_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector());
+				EidosValue_Int_vector_SP int_result_SP = Eidos_IntVectorForOperatorResult(first_child_value.get(), second_child_value.get(), second_child_count);
 				EidosValue_Int_vector *int_result = int_result_SP->resize_no_initialize(second_child_count);
 				
-				for (int value_index = 0; value_index < second_child_count; ++value_index)
-				{
-					// This is an overflow-safe version of:
-					//int_result->PushInt(singleton_int + second_child_value->IntAtIndex(value_index, operator_token));
-					
-					int64_t second_operand = second_child_data[value_index];
-					int64_t add_result;
-					bool overflow = Eidos_add_overflow(singleton_int, second_operand, &add_result);
-					
-					if (overflow)
-						EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Plus): integer addition overflow with the binary '+' operator." << EidosTerminate(operator_token);
-					
-					int_result->set_int_no_check(add_result, value_index);
-				}
+				if (Eidos_Kernel_IntAdd_VS(second_child_data, singleton_int, int_result->data(), second_child_count))
+					EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Plus): integer addition overflow with the binary '+' operator." << EidosTerminate(operator_token);
 				
 				result_SP = std::move(int_result_SP);
 			}
@@ -2339,23 +2395,11 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 			{
 				const int64_t *first_child_data = first_child_value->IntVector()->data();
 				int64_t singleton_int = second_child_value->IntAtIndex(0, operator_token);
-				EidosValue_Int_vector_SP int_result_SP = EidosValue_Int_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector());
+				EidosValue_Int_vector_SP int_result_SP = Eidos_IntVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 				EidosValue_Int_vector *int_result = int_result_SP->resize_no_initialize(first_child_count);
 				
-				for (int value_index = 0; value_index < first_child_count; ++value_index)
-				{
-					// This is an overflow-safe version of:
-					//int_result->PushInt(first_child_value->IntAtIndex(value_index, operator_token) + singleton_int);
-					
-					int64_t first_operand = first_child_data[value_index];
-					int64_t add_result;
-					bool overflow = Eidos_add_overflow(first_operand, singleton_int, &add_result);
-					
-					if (overflow)
-						EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Plus): integer addition overflow with the binary '+' operator." << EidosTerminate(operator_token);
-					
-					int_result->set_int_no_check(add_result, value_index);
-				}
+				if (Eidos_Kernel_IntAdd_VS(first_child_data, singleton_int, int_result->data(), first_child_count))
+					EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Plus): integer addition overflow with the binary '+' operator." << EidosTerminate(operator_token);
 				
 				result_SP = std::move(int_result_SP);
 			}
@@ -2378,7 +2422,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 				}
 				else
 				{
-					EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+					EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 					EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 					
 					if ((first_child_type == EidosValueType::kValueFloat) && (second_child_type == EidosValueType::kValueFloat))
@@ -2386,8 +2430,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 						const double *first_child_data = first_child_value->FloatVector()->data();
 						const double *second_child_data = second_child_value->FloatVector()->data();
 						
-						for (int value_index = 0; value_index < first_child_count; ++value_index)
-							float_result->set_float_no_check(first_child_data[value_index] + second_child_data[value_index], value_index);
+						Eidos_Kernel_Float_VV(EidosKernelOp::kAdd, first_child_data, second_child_data, float_result->data(), first_child_count);
 					}
 					else if ((first_child_type == EidosValueType::kValueFloat) && (second_child_type == EidosValueType::kValueInt))
 					{
@@ -2412,7 +2455,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 			else if (first_child_count == 1)
 			{
 				double singleton_float = first_child_value->FloatAtIndex(0, operator_token);
-				EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+				EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), second_child_count);
 				EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(second_child_count);
 				
 				if (second_child_type == EidosValueType::kValueInt)
@@ -2426,8 +2469,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 				{
 					const double *second_child_data = second_child_value->FloatVector()->data();
 					
-					for (int value_index = 0; value_index < second_child_count; ++value_index)
-						float_result->set_float_no_check(singleton_float + second_child_data[value_index], value_index);
+					Eidos_Kernel_Float_SV(EidosKernelOp::kAdd, singleton_float, second_child_data, float_result->data(), second_child_count);
 				}
 				
 				result_SP = std::move(float_result_SP);
@@ -2435,7 +2477,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 			else if (second_child_count == 1)
 			{
 				double singleton_float = second_child_value->FloatAtIndex(0, operator_token);
-				EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+				EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 				EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 				
 				if (first_child_type == EidosValueType::kValueInt)
@@ -2449,8 +2491,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Plus(const EidosASTNode *p_node)
 				{
 					const double *first_child_data = first_child_value->FloatVector()->data();
 					
-					for (int value_index = 0; value_index < first_child_count; ++value_index)
-						float_result->set_float_no_check(first_child_data[value_index] + singleton_float, value_index);
+					Eidos_Kernel_Float_VS(EidosKernelOp::kAdd, first_child_data, singleton_float, float_result->data(), first_child_count);
 				}
 				
 				result_SP = std::move(float_result_SP);
@@ -2507,23 +2548,11 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 			else
 			{
 				const int64_t *first_child_data = first_child_value->IntVector()->data();
-				EidosValue_Int_vector_SP int_result_SP = EidosValue_Int_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector());
+				EidosValue_Int_vector_SP int_result_SP = Eidos_IntVectorForOperatorResult(first_child_value.get(), nullptr, first_child_count);
 				EidosValue_Int_vector *int_result = int_result_SP->resize_no_initialize(first_child_count);
 				
-				for (int value_index = 0; value_index < first_child_count; ++value_index)
-				{
-					// This is an overflow-safe version of:
-					//int_result->set_int_no_check(-first_child_value->IntAtIndex(value_index, operator_token), value_index);
-					
-					int64_t operand = first_child_data[value_index];
-					int64_t subtract_result;
-					bool overflow = Eidos_sub_overflow((int64_t)0, operand, &subtract_result);
-					
-					if (overflow)
-						EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Minus): integer negation overflow with the unary '-' operator." << EidosTerminate(operator_token);
-					
-					int_result->set_int_no_check(subtract_result, value_index);
-				}
+				if (Eidos_Kernel_IntSubtract_SV(0, first_child_data, int_result->data(), first_child_count))
+					EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Minus): integer negation overflow with the unary '-' operator." << EidosTerminate(operator_token);
 				
 				result_SP = std::move(int_result_SP);
 			}
@@ -2537,7 +2566,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 			else
 			{
 				const double *first_child_data = first_child_value->FloatVector()->data();
-				EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+				EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), nullptr, first_child_count);
 				EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 				
 				for (int value_index = 0; value_index < first_child_count; ++value_index)
@@ -2592,24 +2621,11 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 				{
 					const int64_t *first_child_data = first_child_value->IntVector()->data();
 					const int64_t *second_child_data = second_child_value->IntVector()->data();
-					EidosValue_Int_vector_SP int_result_SP = EidosValue_Int_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector());
+					EidosValue_Int_vector_SP int_result_SP = Eidos_IntVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 					EidosValue_Int_vector *int_result = int_result_SP->resize_no_initialize(first_child_count);
 					
-					for (int value_index = 0; value_index < first_child_count; ++value_index)
-					{
-						// This is an overflow-safe version of:
-						//int_result->set_int_no_check(first_child_value->IntAtIndex(value_index, operator_token) - second_child_value->IntAtIndex(value_index, operator_token));
-						
-						int64_t first_operand = first_child_data[value_index];
-						int64_t second_operand = second_child_data[value_index];
-						int64_t subtract_result;
-						bool overflow = Eidos_sub_overflow(first_operand, second_operand, &subtract_result);
-						
-						if (overflow)
-							EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Minus): integer subtraction overflow with the binary '-' operator." << EidosTerminate(operator_token);
-						
-						int_result->set_int_no_check(subtract_result, value_index);
-					}
+					if (Eidos_Kernel_IntSubtract_VV(first_child_data, second_child_data, int_result->data(), first_child_count))
+						EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Minus): integer subtraction overflow with the binary '-' operator." << EidosTerminate(operator_token);
 					
 					result_SP = std::move(int_result_SP);
 				}
@@ -2618,23 +2634,11 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 			{
 				int64_t singleton_int = first_child_value->IntAtIndex(0, operator_token);
 				const int64_t *second_child_data = second_child_value->IntVector()->data();
-				EidosValue_Int_vector_SP int_result_SP = EidosValue_Int_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector());
+				EidosValue_Int_vector_SP int_result_SP = Eidos_IntVectorForOperatorResult(first_child_value.get(), second_child_value.get(), second_child_count);
 				EidosValue_Int_vector *int_result = int_result_SP->resize_no_initialize(second_child_count);
 				
-				for (int value_index = 0; value_index < second_child_count; ++value_index)
-				{
-					// This is an overflow-safe version of:
-					//int_result->set_int_no_check(singleton_int - second_child_value->IntAtIndex(value_index, operator_token));
-					
-					int64_t second_operand = second_child_data[value_index];
-					int64_t subtract_result;
-					bool overflow = Eidos_sub_overflow(singleton_int, second_operand, &subtract_result);
-					
-					if (overflow)
-						EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Minus): integer subtraction overflow with the binary '-' operator." << EidosTerminate(operator_token);
-					
-					int_result->set_int_no_check(subtract_result, value_index);
-				}
+				if (Eidos_Kernel_IntSubtract_SV(singleton_int, second_child_data, int_result->data(), second_child_count))
+					EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Minus): integer subtraction overflow with the binary '-' operator." << EidosTerminate(operator_token);
 				
 				result_SP = std::move(int_result_SP);
 			}
@@ -2642,23 +2646,11 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 			{
 				const int64_t *first_child_data = first_child_value->IntVector()->data();
 				int64_t singleton_int = second_child_value->IntAtIndex(0, operator_token);
-				EidosValue_Int_vector_SP int_result_SP = EidosValue_Int_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector());
+				EidosValue_Int_vector_SP int_result_SP = Eidos_IntVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 				EidosValue_Int_vector *int_result = int_result_SP->resize_no_initialize(first_child_count);
 				
-				for (int value_index = 0; value_index < first_child_count; ++value_index)
-				{
-					// This is an overflow-safe version of:
-					//int_result->set_int_no_check(first_child_value->IntAtIndex(value_index, operator_token) - singleton_int);
-					
-					int64_t first_operand = first_child_data[value_index];
-					int64_t subtract_result;
-					bool overflow = Eidos_sub_overflow(first_operand, singleton_int, &subtract_result);
-					
-					if (overflow)
-						EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Minus): integer subtraction overflow with the binary '-' operator." << EidosTerminate(operator_token);
-					
-					int_result->set_int_no_check(subtract_result, value_index);
-				}
+				if (Eidos_Kernel_IntSubtract_VS(first_child_data, singleton_int, int_result->data(), first_child_count))
+					EIDOS_TERMINATION << "ERROR (EidosInterpreter::Evaluate_Minus): integer subtraction overflow with the binary '-' operator." << EidosTerminate(operator_token);
 				
 				result_SP = std::move(int_result_SP);
 			}
@@ -2678,7 +2670,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 				}
 				else
 				{
-					EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+					EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 					EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 					
 					if ((first_child_type == EidosValueType::kValueFloat) && (second_child_type == EidosValueType::kValueFloat))
@@ -2686,8 +2678,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 						const double *first_child_data = first_child_value->FloatVector()->data();
 						const double *second_child_data = second_child_value->FloatVector()->data();
 						
-						for (int value_index = 0; value_index < first_child_count; ++value_index)
-							float_result->set_float_no_check(first_child_data[value_index] - second_child_data[value_index], value_index);
+						Eidos_Kernel_Float_VV(EidosKernelOp::kSubtract, first_child_data, second_child_data, float_result->data(), first_child_count);
 					}
 					else if ((first_child_type == EidosValueType::kValueFloat) && (second_child_type == EidosValueType::kValueInt))
 					{
@@ -2712,7 +2703,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 			else if (first_child_count == 1)
 			{
 				double singleton_float = first_child_value->FloatAtIndex(0, operator_token);
-				EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+				EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), second_child_count);
 				EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(second_child_count);
 				
 				if (second_child_type == EidosValueType::kValueInt)
@@ -2726,8 +2717,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 				{
 					const double *second_child_data = second_child_value->FloatVector()->data();
 					
-					for (int value_index = 0; value_index < second_child_count; ++value_index)
-						float_result->set_float_no_check(singleton_float - second_child_data[value_index], value_index);
+					Eidos_Kernel_Float_SV(EidosKernelOp::kSubtract, singleton_float, second_child_data, float_result->data(), second_child_count);
 				}
 				
 				result_SP = std::move(float_result_SP);
@@ -2735,7 +2725,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 			else if (second_child_count == 1)
 			{
 				double singleton_float = second_child_value->FloatAtIndex(0, operator_token);
-				EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+				EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 				EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 				
 				if (first_child_type == EidosValueType::kValueInt)
@@ -2749,8 +2739,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Minus(const EidosASTNode *p_node)
 				{
 					const double *first_child_data = first_child_value->FloatVector()->data();
 					
-					for (int value_index = 0; value_index < first_child_count; ++value_index)
-						float_result->set_float_no_check(first_child_data[value_index] - singleton_float, value_index);
+					Eidos_Kernel_Float_VS(EidosKernelOp::kSubtract, first_child_data, singleton_float, float_result->data(), first_child_count);
 				}
 				
 				result_SP = std::move(float_result_SP);
@@ -2812,7 +2801,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mod(const EidosASTNode *p_node)
 		}
 		else
 		{
-			EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+			EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 			EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 			
 			if ((first_child_type == EidosValueType::kValueFloat) && (second_child_type == EidosValueType::kValueFloat))
@@ -2854,7 +2843,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mod(const EidosASTNode *p_node)
 	else if (first_child_count == 1)
 	{
 		double singleton_float = first_child_value->FloatAtIndex(0, operator_token);
-		EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+		EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), second_child_count);
 		EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(second_child_count);
 		
 		if (second_child_type == EidosValueType::kValueInt)
@@ -2877,7 +2866,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mod(const EidosASTNode *p_node)
 	else if (second_child_count == 1)
 	{
 		double singleton_float = second_child_value->FloatAtIndex(0, operator_token);
-		EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+		EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 		EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 		
 		if (first_child_type == EidosValueType::kValueInt)
@@ -2964,7 +2953,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mult(const EidosASTNode *p_node)
 			{
 				const int64_t *first_child_data = first_child_value->IntVector()->data();
 				const int64_t *second_child_data = second_child_value->IntVector()->data();
-				EidosValue_Int_vector_SP int_result_SP = EidosValue_Int_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector());
+				EidosValue_Int_vector_SP int_result_SP = Eidos_IntVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 				EidosValue_Int_vector *int_result = int_result_SP->resize_no_initialize(first_child_count);
 				
 				for (int value_index = 0; value_index < first_child_count; ++value_index)
@@ -2994,7 +2983,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mult(const EidosASTNode *p_node)
 			}
 			else
 			{
-				EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+				EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 				EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 				
 				if ((first_child_type == EidosValueType::kValueFloat) && (second_child_type == EidosValueType::kValueFloat))
@@ -3002,8 +2991,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mult(const EidosASTNode *p_node)
 					const double *first_child_data = first_child_value->FloatVector()->data();
 					const double *second_child_data = second_child_value->FloatVector()->data();
 					
-					for (int value_index = 0; value_index < first_child_count; ++value_index)
-						float_result->set_float_no_check(first_child_data[value_index] * second_child_data[value_index], value_index);
+					Eidos_Kernel_Float_VV(EidosKernelOp::kMultiply, first_child_data, second_child_data, float_result->data(), first_child_count);
 				}
 				else if ((first_child_type == EidosValueType::kValueFloat) && (second_child_type == EidosValueType::kValueInt))
 				{
@@ -3053,7 +3041,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mult(const EidosASTNode *p_node)
 		{
 			const int64_t *any_count_data = any_count_child->IntVector()->data();
 			int64_t singleton_int = one_count_child->IntAtIndex(0, operator_token);
-			EidosValue_Int_vector_SP int_result_SP = EidosValue_Int_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector());
+			EidosValue_Int_vector_SP int_result_SP = Eidos_IntVectorForOperatorResult(any_count_child.get(), one_count_child.get(), any_count);
 			EidosValue_Int_vector *int_result = int_result_SP->resize_no_initialize(any_count);
 			
 			for (int value_index = 0; value_index < any_count; ++value_index)
@@ -3077,7 +3065,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Mult(const EidosASTNode *p_node)
 		{
 			const int64_t *any_count_data = any_count_child->IntVector()->data();
 			double singleton_float = one_count_child->FloatAtIndex(0, operator_token);
-			EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+			EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(any_count_child.get(), one_count_child.get(), any_count);
 			EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(any_count);
 			
 			for (int value_index = 0; value_index < any_count; ++value_index)
@@ -3089,11 +3077,10 @@ EidosValue_SP EidosInterpreter::Evaluate_Mult(const EidosASTNode *p_node)
 		{
 			const double *any_count_data = any_count_child->FloatVector()->data();
 			double singleton_float = one_count_child->FloatAtIndex(0, operator_token);
-			EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+			EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(any_count_child.get(), one_count_child.get(), any_count);
 			EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(any_count);
 			
-			for (int value_index = 0; value_index < any_count; ++value_index)
-				float_result->set_float_no_check(any_count_data[value_index] * singleton_float, value_index);
+			Eidos_Kernel_Float_VS(EidosKernelOp::kMultiply, any_count_data, singleton_float, float_result->data(), any_count);
 			
 			result_SP = std::move(float_result_SP);
 		}
@@ -3153,7 +3140,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Div(const EidosASTNode *p_node)
 		}
 		else
 		{
-			EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+			EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 			EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 			
 			if ((first_child_type == EidosValueType::kValueFloat) && (second_child_type == EidosValueType::kValueFloat))
@@ -3161,8 +3148,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Div(const EidosASTNode *p_node)
 				const double *first_child_data = first_child_value->FloatVector()->data();
 				const double *second_child_data = second_child_value->FloatVector()->data();
 				
-				for (int value_index = 0; value_index < first_child_count; ++value_index)
-					float_result->set_float_no_check(first_child_data[value_index] / second_child_data[value_index], value_index);
+				Eidos_Kernel_Float_VV(EidosKernelOp::kDivide, first_child_data, second_child_data, float_result->data(), first_child_count);
 			}
 			else if ((first_child_type == EidosValueType::kValueFloat) && (second_child_type == EidosValueType::kValueInt))
 			{
@@ -3195,7 +3181,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Div(const EidosASTNode *p_node)
 	else if (first_child_count == 1)
 	{
 		double singleton_float = first_child_value->FloatAtIndex(0, operator_token);
-		EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+		EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), second_child_count);
 		EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(second_child_count);
 		
 		if (second_child_type == EidosValueType::kValueInt)
@@ -3209,8 +3195,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Div(const EidosASTNode *p_node)
 		{
 			const double *second_child_data = second_child_value->FloatVector()->data();
 			
-			for (int value_index = 0; value_index < second_child_count; ++value_index)
-				float_result->set_float_no_check(singleton_float / second_child_data[value_index], value_index);
+			Eidos_Kernel_Float_SV(EidosKernelOp::kDivide, singleton_float, second_child_data, float_result->data(), second_child_count);
 		}
 		
 		result_SP = std::move(float_result_SP);
@@ -3218,7 +3203,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Div(const EidosASTNode *p_node)
 	else if (second_child_count == 1)
 	{
 		double singleton_float = second_child_value->FloatAtIndex(0, operator_token);
-		EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+		EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 		EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 		
 		if (first_child_type == EidosValueType::kValueInt)
@@ -3232,8 +3217,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Div(const EidosASTNode *p_node)
 		{
 			const double *first_child_data = first_child_value->FloatVector()->data();
 			
-			for (int value_index = 0; value_index < first_child_count; ++value_index)
-				float_result->set_float_no_check(first_child_data[value_index] / singleton_float, value_index);
+			Eidos_Kernel_Float_VS(EidosKernelOp::kDivide, first_child_data, singleton_float, float_result->data(), first_child_count);
 		}
 		
 		result_SP = std::move(float_result_SP);
@@ -3330,7 +3314,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Exp(const EidosASTNode *p_node)
 		}
 		else
 		{
-			EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+			EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 			EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 			
 			if ((first_child_type == EidosValueType::kValueFloat) && (second_child_type == EidosValueType::kValueFloat))
@@ -3372,7 +3356,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Exp(const EidosASTNode *p_node)
 	else if (first_child_count == 1)
 	{
 		double singleton_float = first_child_value->FloatAtIndex(0, operator_token);
-		EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+		EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), second_child_count);
 		EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(second_child_count);
 		
 		if (second_child_type == EidosValueType::kValueInt)
@@ -3395,7 +3379,7 @@ EidosValue_SP EidosInterpreter::Evaluate_Exp(const EidosASTNode *p_node)
 	else if (second_child_count == 1)
 	{
 		double singleton_float = second_child_value->FloatAtIndex(0, operator_token);
-		EidosValue_Float_vector_SP float_result_SP = EidosValue_Float_vector_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector());
+		EidosValue_Float_vector_SP float_result_SP = Eidos_FloatVectorForOperatorResult(first_child_value.get(), second_child_value.get(), first_child_count);
 		EidosValue_Float_vector *float_result = float_result_SP->resize_no_initialize(first_child_count);
 		
 		if (first_child_type == EidosValueType::kValueInt)
@@ -4181,11 +4165,112 @@ EidosValue_SP EidosInterpreter::Evaluate_Assign(const EidosASTNode *p_node)
 		// and then we drop through to be handled normally by the standard assign operator code
 	}
 	
+	if (p_node->cached_append_assignment_)
+	{
+		// if _OptimizeAssignments() set this flag, this assignment is of the form "x = c(x, ...)"; we evaluate the arguments to c() in order,
+		// as Evaluate_Call() would, and if x is then a vector that nothing but the symbol table references, we append the other arguments
+		// to it in place, which makes accumulating values in a loop linear rather than quadratic; otherwise, we call c() with the arguments
+		// we have already evaluated, since they might have side effects, and assign its result normally
+		EidosASTNode *lvalue_node = p_node->children_[0];
+		EidosASTNode *call_node = p_node->children_[1];
+		EidosASTNode *call_name_node = call_node->children_[0];
+		const EidosFunctionSignature *function_signature = call_name_node->cached_signature_.get();
+		int argument_count = (int)call_node->children_.size() - 1;
+		std::vector<EidosValue_SP> arguments;
+		
+		EidosErrorPosition error_pos_save = EidosScript::PushErrorPositionFromToken(call_name_node->token_);
+		
+		arguments.reserve(argument_count);
+		
+		for (int arg_index = 1; arg_index <= argument_count; ++arg_index)
+			arguments.emplace_back(FastEvaluateNode(call_node->children_[arg_index]));
+		
+		EidosValue *lvalue = global_symbols_->GetVariableRawOrNullForSymbol(lvalue_node->cached_stringID_);
+		
+		// the use count of 2 is the symbol table's reference plus ours in arguments[0]
+		if (lvalue && (lvalue == arguments[0].get()) && (lvalue->UseCount() == 2) && !lvalue->IsSingleton() && (lvalue->DimensionCount() == 1) && AppendEidosValuesInPlace(lvalue, arguments.data() + 1, argument_count - 1))
+		{
+			EidosScript::RestoreErrorPosition(error_pos_save);
+			goto compoundAssignmentSuccess;
+		}
+		
+		function_signature->CheckArguments(arguments.data(), argument_count);
+		
+		EidosValue_SP rvalue = function_signature->internal_function_(arguments.data(), argument_count, *this);
+		
+		function_signature->CheckReturn(*rvalue);
+		EidosScript::RestoreErrorPosition(error_pos_save);
+		
+		// release our references to the arguments, so that SetValueForSymbol() need not copy the result if c() returned one of them
+		arguments.clear();
+		
+		error_pos_save = EidosScript::PushErrorPositionFromToken(p_node->token_);
+		
+		_AssignRValueToLValue(std::move(rvalue), lvalue_node);
+		
+		EidosScript::RestoreErrorPosition(error_pos_save);
+		goto compoundAssignmentSuccess;
+	}
+	
 	// we can drop through to here even if cached_compound_assignment_ is set, if the code above bailed for some reason
 	{
 		EidosToken *operator_token = p_node->token_;
 		EidosASTNode *lvalue_node = p_node->children_[0];
-		EidosValue_SP rvalue = FastEvaluateNode(p_node->children_[1]);
+		EidosASTNode *rvalue_node = p_node->children_[1];
+		EidosValue_SP rvalue;
+		
+		if ((rvalue_node->cached_evaluator_ == &EidosInterpreter::Evaluate_Bytecode) && (lvalue_node->token_->token_type_ == EidosTokenType::kTokenIdentifier))
+		{
+			// the rvalue is a scalar expression compiled by _OptimizeBytecode(), assigned to a simple identifier; if the VM
+			// succeeds and the variable already holds a singleton of the same type that nothing else references, we modify
+			// it in place as the compound assignment code above does, avoiding any allocation; see EidosBytecode
+			EidosBytecode *bytecode = rvalue_node->cached_bytecode_;
+			EidosBytecodeRegister result;
+			
+			if (_ExecuteBytecode(*bytecode, &result))
+			{
+				bytecode->success_count_++;
+				
+				EidosValue *lvalue = global_symbols_->GetVariableRawOrNullForSymbol(lvalue_node->cached_stringID_);
+				
+				if (lvalue && (lvalue->UseCount() == 1) && (lvalue->Type() == result.type_) && (lvalue->DimensionCount() == 1))
+				{
+					if (lvalue->IsSingleton())
+					{
+						if (result.type_ == EidosValueType::kValueFloat)
+						{
+							static_cast<EidosValue_Float_singleton *>(lvalue)->FloatValue_Mutable() = result.float_;
+							goto compoundAssignmentSuccess;
+						}
+						else if (result.type_ == EidosValueType::kValueInt)
+						{
+							static_cast<EidosValue_Int_singleton *>(lvalue)->IntValue_Mutable() = result.int_;
+							goto compoundAssignmentSuccess;
+						}
+					}
+					else if ((result.type_ == EidosValueType::kValueLogical) && (lvalue->Count() == 1))
+					{
+						// EidosValue_Logical_const claims to be a singleton, so we never get here for the static T and F values
+						static_cast<EidosValue_Logical *>(lvalue)->set_logical_no_check(result.logical_, 0);
+						goto compoundAssignmentSuccess;
+					}
+				}
+				
+				EidosErrorPosition error_pos_save = EidosScript::PushErrorPositionFromToken(operator_token);
+				
+				_AssignRValueToLValue(Eidos_ValueForBytecodeRegister(result), lvalue_node);
+				
+				EidosScript::RestoreErrorPosition(error_pos_save);
+				goto compoundAssignmentSuccess;
+			}
+			
+			// the VM bailed out, so evaluate the tree normally; going through FastEvaluateNode() would run the VM again
+			rvalue = _EvaluateBytecodeBailout(rvalue_node);
+		}
+		else
+		{
+			rvalue = FastEvaluateNode(rvalue_node);
+		}
 		
 		EidosErrorPosition error_pos_save = EidosScript::PushErrorPositionFromToken(operator_token);
 		
@@ -5178,14 +5263,14 @@ EidosValue_SP EidosInterpreter::Evaluate_If(const EidosASTNode *p_node)
 		// Handle a static singleton logical true super fast; no need for type check, count, etc
 		EidosASTNode *true_node = p_node->children_[1];
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 		SLIM_PROFILE_BLOCK_START_CONDITION(true_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 		
 		result_SP = FastEvaluateNode(true_node);
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END_CONDITION(true_node->profile_total_);
 #endif
@@ -5197,14 +5282,14 @@ EidosValue_SP EidosInterpreter::Evaluate_If(const EidosASTNode *p_node)
 		{
 			EidosASTNode *false_node = p_node->children_[2];
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 			SLIM_PROFILE_BLOCK_START_CONDITION(false_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 			
 			result_SP = FastEvaluateNode(false_node);
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_END_CONDITION(false_node->profile_total_);
 #endif
@@ -5222,14 +5307,14 @@ EidosValue_SP EidosInterpreter::Evaluate_If(const EidosASTNode *p_node)
 		{
 			EidosASTNode *true_node = p_node->children_[1];
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 			SLIM_PROFILE_BLOCK_START_CONDITION(true_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 			
 			result_SP = FastEvaluateNode(true_node);
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_END_CONDITION(true_node->profile_total_);
 #endif
@@ -5238,14 +5323,14 @@ EidosValue_SP EidosInterpreter::Evaluate_If(const EidosASTNode *p_node)
 		{
 			EidosASTNode *false_node = p_node->children_[2];
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 			SLIM_PROFILE_BLOCK_START_CONDITION(false_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 			
 			result_SP = FastEvaluateNode(false_node);
 			
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 			// PROFILING
 			SLIM_PROFILE_BLOCK_END_CONDITION(false_node->profile_total_);
 #endif
@@ -5277,14 +5362,14 @@ EidosValue_SP EidosInterpreter::Evaluate_Do(const EidosASTNode *p_node)
 		// execute the do...while loop's statement by evaluating its node; evaluation values get thrown away
 		EidosASTNode *statement_node = p_node->children_[0];
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 		SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 		
 		EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -5378,14 +5463,14 @@ EidosValue_SP EidosInterpreter::Evaluate_While(const EidosASTNode *p_node)
 		// execute the while loop's statement by evaluating its node; evaluation values get thrown away
 		EidosASTNode *statement_node = p_node->children_[1];
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 		SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 		
 		EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 		
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 		// PROFILING
 		SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -5571,14 +5656,14 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 			{
 				EidosASTNode *statement_node = p_node->children_[2];
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 				SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 				
 				EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -5609,14 +5694,14 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 				
 				EidosASTNode *statement_node = p_node->children_[2];
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 				SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 				
 				EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 				
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 				// PROFILING
 				SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -5653,14 +5738,14 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 				{
 					EidosASTNode *statement_node = p_node->children_[2];
 					
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 					// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 					SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 					
 					EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 					
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 					// PROFILING
 					SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -5696,14 +5781,14 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 						
 						EidosASTNode *statement_node = p_node->children_[2];
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 						// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 						SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 						
 						EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 						// PROFILING
 						SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -5729,14 +5814,14 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 						
 						EidosASTNode *statement_node = p_node->children_[2];
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 						// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 						SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 						
 						EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 						// PROFILING
 						SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -5762,14 +5847,14 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 						
 						EidosASTNode *statement_node = p_node->children_[2];
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 						// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 						SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 						
 						EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 						// PROFILING
 						SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -5795,14 +5880,14 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 						
 						EidosASTNode *statement_node = p_node->children_[2];
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 						// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 						SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 						
 						EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 						// PROFILING
 						SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -5830,14 +5915,14 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 						
 						EidosASTNode *statement_node = p_node->children_[2];
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 						// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 						SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 						
 						EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 						
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 						// PROFILING
 						SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -5862,14 +5947,14 @@ EidosValue_SP EidosInterpreter::Evaluate_For(const EidosASTNode *p_node)
 					// execute the for loop's statement by evaluating its node; evaluation values get thrown away
 					EidosASTNode *statement_node = p_node->children_[2];
 					
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 					// PROFILING: profile child statement unless it is a compound statement (which does its own profiling)
 					SLIM_PROFILE_BLOCK_START_CONDITION(statement_node->token_->token_type_ != EidosTokenType::kTokenLBrace);
 #endif
 					
 					EidosValue_SP statement_value = FastEvaluateNode(statement_node);
 					
-#if defined(SLIMGUI) && (SLIMPROFILING == 1)
+#if (SLIMPROFILING == 1)
 					// PROFILING
 					SLIM_PROFILE_BLOCK_END_CONDITION(statement_node->profile_total_);
 #endif
@@ -6161,3 +6246,227 @@ EidosValue_SP EidosInterpreter::Evaluate_FunctionDecl(const EidosASTNode *p_node
 
 
 
+
+bool EidosInterpreter::_ExecuteBytecode(const EidosBytecode &p_bytecode, EidosBytecodeRegister *p_result)
+{
+	// Run the VM; returns false to bail out, in which case nothing has been changed and the caller should evaluate the
+	// tree normally.  Each case computes into result before writing it back, since dest_ is usually the same as src1_.
+	EidosBytecodeRegister registers[EIDOS_BYTECODE_MAX_REGISTERS];
+	
+	for (const EidosBytecodeInstruction &instruction : p_bytecode.instructions_)
+	{
+		const EidosBytecodeRegister &src1 = registers[instruction.src1_];
+		const EidosBytecodeRegister &src2 = registers[instruction.src2_];
+		EidosBytecodeRegister result;
+		
+		switch (instruction.opcode_)
+		{
+			case EidosBytecodeOp::kLoadConstant:
+			{
+				result = instruction.constant_;
+				break;
+			}
+			case EidosBytecodeOp::kLoadSymbol:
+			{
+				EidosValue *value = global_symbols_->GetValueRawOrNullForSymbol(instruction.symbol_);
+				
+				if (!value || (value->Count() != 1) || (value->DimensionCount() != 1))
+					return false;
+				
+				result.type_ = value->Type();
+				
+				if (result.type_ == EidosValueType::kValueFloat)
+					result.float_ = (value->IsSingleton() ? static_cast<EidosValue_Float_singleton *>(value)->FloatValue() : value->FloatAtIndex(0, nullptr));
+				else if (result.type_ == EidosValueType::kValueInt)
+					result.int_ = (value->IsSingleton() ? static_cast<EidosValue_Int_singleton *>(value)->IntValue() : value->IntAtIndex(0, nullptr));
+				else if (result.type_ == EidosValueType::kValueLogical)
+					result.logical_ = value->LogicalAtIndex(0, nullptr);
+				else
+					return false;
+				break;
+			}
+			case EidosBytecodeOp::kPlus:
+			case EidosBytecodeOp::kMinus:
+			case EidosBytecodeOp::kMult:
+			{
+				if ((src1.type_ == EidosValueType::kValueLogical) || (src2.type_ == EidosValueType::kValueLogical))
+					return false;
+				
+				if ((src1.type_ == EidosValueType::kValueInt) && (src2.type_ == EidosValueType::kValueInt))
+				{
+					bool overflow;
+					
+					if (instruction.opcode_ == EidosBytecodeOp::kPlus)
+						overflow = Eidos_add_overflow(src1.int_, src2.int_, &result.int_);
+					else if (instruction.opcode_ == EidosBytecodeOp::kMinus)
+						overflow = Eidos_sub_overflow(src1.int_, src2.int_, &result.int_);
+					else
+						overflow = Eidos_mul_overflow(src1.int_, src2.int_, &result.int_);
+					
+					if (overflow)
+						return false;
+					
+					result.type_ = EidosValueType::kValueInt;
+				}
+				else
+				{
+					double operand1 = Eidos_BytecodeRegisterFloat(src1);
+					double operand2 = Eidos_BytecodeRegisterFloat(src2);
+					
+					if (instruction.opcode_ == EidosBytecodeOp::kPlus)
+						result.float_ = operand1 + operand2;
+					else if (instruction.opcode_ == EidosBytecodeOp::kMinus)
+						result.float_ = operand1 - operand2;
+					else
+						result.float_ = operand1 * operand2;
+					
+					result.type_ = EidosValueType::kValueFloat;
+				}
+				break;
+			}
+			case EidosBytecodeOp::kDiv:
+			case EidosBytecodeOp::kMod:
+			case EidosBytecodeOp::kExp:
+			{
+				// these operators always produce float, even for integer operands
+				if ((src1.type_ == EidosValueType::kValueLogical) || (src2.type_ == EidosValueType::kValueLogical))
+					return false;
+				
+				double operand1 = Eidos_BytecodeRegisterFloat(src1);
+				double operand2 = Eidos_BytecodeRegisterFloat(src2);
+				
+				if (instruction.opcode_ == EidosBytecodeOp::kDiv)
+					result.float_ = operand1 / operand2;
+				else if (instruction.opcode_ == EidosBytecodeOp::kMod)
+					result.float_ = fmod(operand1, operand2);
+				else
+					result.float_ = pow(operand1, operand2);
+				
+				result.type_ = EidosValueType::kValueFloat;
+				break;
+			}
+			case EidosBytecodeOp::kUnaryPlus:
+			{
+				if (src1.type_ == EidosValueType::kValueLogical)
+					return false;
+				
+				result = src1;
+				break;
+			}
+			case EidosBytecodeOp::kUnaryMinus:
+			{
+				if (src1.type_ == EidosValueType::kValueInt)
+				{
+					if (Eidos_sub_overflow((int64_t)0, src1.int_, &result.int_))
+						return false;
+				}
+				else if (src1.type_ == EidosValueType::kValueFloat)
+					result.float_ = -src1.float_;
+				else
+					return false;
+				
+				result.type_ = src1.type_;
+				break;
+			}
+			case EidosBytecodeOp::kNot:
+			{
+				eidos_logical_t operand;
+				
+				if (!Eidos_BytecodeRegisterLogical(src1, &operand))
+					return false;
+				
+				result.logical_ = !operand;
+				result.type_ = EidosValueType::kValueLogical;
+				break;
+			}
+			case EidosBytecodeOp::kAnd:
+			case EidosBytecodeOp::kOr:
+			{
+				eidos_logical_t operand1, operand2;
+				
+				if (!Eidos_BytecodeRegisterLogical(src1, &operand1) || !Eidos_BytecodeRegisterLogical(src2, &operand2))
+					return false;
+				
+				result.logical_ = ((instruction.opcode_ == EidosBytecodeOp::kAnd) ? (operand1 && operand2) : (operand1 || operand2));
+				result.type_ = EidosValueType::kValueLogical;
+				break;
+			}
+			default:
+			{
+				// comparisons promote to the highest operand type, following Eidos_GetCompareFunctionForTypes()
+				int compare_result;
+				
+				if ((src1.type_ == EidosValueType::kValueFloat) || (src2.type_ == EidosValueType::kValueFloat))
+				{
+					double operand1 = Eidos_BytecodeRegisterFloat(src1);
+					double operand2 = Eidos_BytecodeRegisterFloat(src2);
+					
+					compare_result = (operand1 < operand2) ? -1 : ((operand1 > operand2) ? 1 : 0);
+				}
+				else
+				{
+					int64_t operand1 = Eidos_BytecodeRegisterInt(src1);
+					int64_t operand2 = Eidos_BytecodeRegisterInt(src2);
+					
+					compare_result = (operand1 < operand2) ? -1 : ((operand1 > operand2) ? 1 : 0);
+				}
+				
+				switch (instruction.opcode_)
+				{
+					case EidosBytecodeOp::kEq:		result.logical_ = (compare_result == 0);	break;
+					case EidosBytecodeOp::kNotEq:	result.logical_ = (compare_result != 0);	break;
+					case EidosBytecodeOp::kLt:		result.logical_ = (compare_result == -1);	break;
+					case EidosBytecodeOp::kLtEq:	result.logical_ = (compare_result != 1);	break;
+					case EidosBytecodeOp::kGt:		result.logical_ = (compare_result == 1);	break;
+					case EidosBytecodeOp::kGtEq:	result.logical_ = (compare_result != -1);	break;
+					default:
+						EIDOS_TERMINATION << "ERROR (EidosInterpreter::_ExecuteBytecode): (internal error) unrecognized opcode." << EidosTerminate(nullptr);
+				}
+				
+				result.type_ = EidosValueType::kValueLogical;
+				break;
+			}
+		}
+		
+		registers[instruction.dest_] = result;
+	}
+	
+	*p_result = registers[0];
+	return true;
+}
+
+EidosValue_SP EidosInterpreter::Evaluate_Bytecode(const EidosASTNode *p_node)
+{
+	EIDOS_ENTRY_EXECUTION_LOG("Evaluate_Bytecode()");
+	
+	EidosBytecode *bytecode = p_node->cached_bytecode_;
+	EidosBytecodeRegister result;
+	EidosValue_SP result_SP;
+	
+	if (_ExecuteBytecode(*bytecode, &result))
+	{
+		bytecode->success_count_++;
+		result_SP = Eidos_ValueForBytecodeRegister(result);
+	}
+	else
+	{
+		result_SP = _EvaluateBytecodeBailout(p_node);
+	}
+	
+	EIDOS_EXIT_EXECUTION_LOG("Evaluate_Bytecode()");
+	return result_SP;
+}
+
+EidosValue_SP EidosInterpreter::_EvaluateBytecodeBailout(const EidosASTNode *p_node)
+{
+	// The VM bailed out on p_node's bytecode, so evaluate the tree normally; if that keeps happening for this node (because
+	// a variable is usually a vector, for example), stop trying the bytecode and just use the tree-walking evaluator from now on
+	EidosBytecode *bytecode = p_node->cached_bytecode_;
+	
+	bytecode->bailout_count_++;
+	
+	if ((bytecode->bailout_count_ >= 16) && (bytecode->bailout_count_ > bytecode->success_count_))
+		p_node->cached_evaluator_ = bytecode->fallback_evaluator_;
+	
+	return (this->*(bytecode->fallback_evaluator_))(p_node);
+}
@@ -175,6 +175,11 @@ public:
 	EidosValue_SP Evaluate_Return(const EidosASTNode *p_node);
 	EidosValue_SP Evaluate_FunctionDecl(const EidosASTNode *p_node);
 	
+	// The bytecode VM for scalar expression subtrees compiled by EidosASTNode::_OptimizeBytecode(); see EidosBytecode
+	EidosValue_SP Evaluate_Bytecode(const EidosASTNode *p_node);
+	bool _ExecuteBytecode(const EidosBytecode &p_bytecode, EidosBytecodeRegister *p_result);
+	EidosValue_SP _EvaluateBytecodeBailout(const EidosASTNode *p_node);
+	
 	// Function dispatch/execution; these are implemented in eidos_functions.cpp
 	static std::vector<EidosFunctionSignature_SP> &BuiltInFunctions(void);
 	static inline __attribute__((always_inline)) const EidosFunctionMap *BuiltInFunctionMap(void) { return s_built_in_function_map_; }
@@ -44,18 +44,73 @@ unsigned long int Eidos_GenerateSeedFromPIDAndTime(void)
 }
 
 void Eidos_InitializeRNG(void)
+{
+	Eidos_InitializeRNG(gEidos_RNG);
+	
+	// Set up one stream per thread that we might use, if that has not already been done
+	if (gEidosMaxThreads > 1)
+		Eidos_InitializeRNGStreams(gEidos_RNG, gEidosMaxThreads);
+}
+
+void Eidos_InitializeRNG(Eidos_RNG_State &p_rng)
 {
 	// Allocate the RNG if needed
-	if (!gEidos_RNG.gsl_rng_)
-		gEidos_RNG.gsl_rng_ = gsl_rng_alloc(gsl_rng_taus2);	// the assumption of taus2 is hard-coded in eidos_rng.h
+	if (!p_rng.gsl_rng_)
+		p_rng.gsl_rng_ = gsl_rng_alloc(gsl_rng_taus2);	// the assumption of taus2 is hard-coded in eidos_rng.h
+	
+	if (!p_rng.mt_)
+	{
+		p_rng.mt_ = (uint64_t *)malloc(Eidos_MT64_NN * sizeof(uint64_t));
+		p_rng.mti_ = Eidos_MT64_NN + 1;				// mti==NN+1 means mt[NN] is not initialized
+	}
+}
+
+void Eidos_InitializeRNGStreams(Eidos_RNG_State &p_rng, int p_stream_count)
+{
+	if (p_stream_count == p_rng.stream_count_)
+		return;
+	
+	if (p_stream_count < 1)
+		EIDOS_TERMINATION << "ERROR (Eidos_InitializeRNGStreams): (internal error) an RNG must have at least one stream." << EidosTerminate(nullptr);
 	
-	if (!gEidos_RNG.mt_)
+	// Free any existing streams and allocate new ones; each is a full RNG state of its own, without streams of its own
+	for (int stream_index = 1; stream_index < p_rng.stream_count_; ++stream_index)
+		Eidos_FreeRNG(p_rng.streams_[stream_index - 1]);
+	
+	free(p_rng.streams_);
+	p_rng.streams_ = nullptr;
+	p_rng.stream_count_ = p_stream_count;
+	
+	if (p_stream_count > 1)
 	{
-		gEidos_RNG.mt_ = (uint64_t *)malloc(Eidos_MT64_NN * sizeof(uint64_t));
-		gEidos_RNG.mti_ = Eidos_MT64_NN + 1;				// mti==NN+1 means mt[NN] is not initialized
+		p_rng.streams_ = (Eidos_RNG_State *)calloc(p_stream_count - 1, sizeof(Eidos_RNG_State));
+		
+		for (int stream_index = 1; stream_index < p_stream_count; ++stream_index)
+		{
+			Eidos_RNG_State &stream = p_rng.streams_[stream_index - 1];
+			
+			Eidos_InitializeRNG(stream);
+			
+			// If the owning state has already been seeded, seed the new streams to match
+			if (p_rng.mti_ <= Eidos_MT64_NN)
+				Eidos_SetRNGSeed(stream, Eidos_RNGStreamSeed(p_rng.rng_last_seed_, stream_index));
+		}
 	}
 }
 
+unsigned long int Eidos_RNGStreamSeed(unsigned long int p_seed, int p_stream_index)
+{
+	// This is the splitmix64 generator's output function, applied to the p_stream_index-th element of the sequence that
+	// starts at p_seed; see Steele, Lea, and Flood (2014), "Fast splittable pseudorandom number generators", OOPSLA '14.
+	uint64_t z = (uint64_t)p_seed + (uint64_t)p_stream_index * 0x9E3779B97F4A7C15ULL;
+	
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	z = z ^ (z >> 31);
+	
+	return (unsigned long int)z;
+}
+
 void Eidos_FreeRNG(Eidos_RNG_State &p_rng)
 {
 	if (p_rng.gsl_rng_)
@@ -73,31 +128,47 @@ void Eidos_FreeRNG(Eidos_RNG_State &p_rng)
 	
 	p_rng.random_bool_bit_buffer_ = 0;
 	p_rng.random_bool_bit_counter_ = 0;
+	
+	for (int stream_index = 1; stream_index < p_rng.stream_count_; ++stream_index)
+		Eidos_FreeRNG(p_rng.streams_[stream_index - 1]);
+	
+	free(p_rng.streams_);
+	p_rng.streams_ = NULL;
+	p_rng.stream_count_ = 0;
 }
 
 void Eidos_SetRNGSeed(unsigned long int p_seed)
+{
+	Eidos_SetRNGSeed(gEidos_RNG, p_seed);
+}
+
+void Eidos_SetRNGSeed(Eidos_RNG_State &p_rng, unsigned long int p_seed)
 {
 	// BCH 12 Sept. 2016: it turns out that gsl_rng_taus2 produces exactly the same sequence for seeds 0 and 1.  This is obviously
 	// undesirable; people will often do a set of runs with sequential seeds starting at 0 and counting up, and they will get
 	// identical runs for 0 and 1.  There is no way to re-map the seed space to get rid of the problem altogether; all we can do
 	// is shift it to a place where it is unlikely to cause a problem.  So that's what we do.
 	if ((p_seed > 0) && (p_seed < 10000000000000000000UL))
-		gsl_rng_set(gEidos_RNG.gsl_rng_, p_seed + 1);	// map 1 -> 2, 2-> 3, 3-> 4, etc.
+		gsl_rng_set(p_rng.gsl_rng_, p_seed + 1);	// map 1 -> 2, 2-> 3, 3-> 4, etc.
 	else
-		gsl_rng_set(gEidos_RNG.gsl_rng_, p_seed);		// 0 stays 0
+		gsl_rng_set(p_rng.gsl_rng_, p_seed);		// 0 stays 0
 	
 	// BCH 13 May 2018: set the seed on the MT64 generator as well; we keep them synchronized in their seeding
-	Eidos_MT64_init_genrand64(p_seed);
+	Eidos_MT64_init_genrand64(p_rng, p_seed);
 	
 	// remember the seed as part of the RNG state
 	
 	// BCH 12 Sept. 2016: we want to return the user the same seed they requested, if they call getSeed(), so we save the requested
 	// seed, not the seed shifted by one that is actually passed to the GSL above.
-	gEidos_RNG.rng_last_seed_ = p_seed;
+	p_rng.rng_last_seed_ = p_seed;
 	
 	// These need to be zeroed out, too; they are part of our RNG state
-	gEidos_RNG.random_bool_bit_counter_ = 0;
-	gEidos_RNG.random_bool_bit_buffer_ = 0;
+	p_rng.random_bool_bit_counter_ = 0;
+	p_rng.random_bool_bit_buffer_ = 0;
+	
+	// Reseed our additional streams, if any, with seeds derived from the new seed
+	for (int stream_index = 1; stream_index < p_rng.stream_count_; ++stream_index)
+		Eidos_SetRNGSeed(p_rng.streams_[stream_index - 1], Eidos_RNGStreamSeed(p_seed, stream_index));
 }
 
 #ifndef USE_GSL_POISSON
@@ -129,42 +200,42 @@ double Eidos_FastRandomPoisson_PRECALCULATE(double p_mu)
 // reproduced in eidos_rng.h.  See eidos_rng.h for further comments on this code; most of the code is there.
 
 /* initializes mt[NN] with a seed */
-void Eidos_MT64_init_genrand64(uint64_t seed)
+void Eidos_MT64_init_genrand64(Eidos_RNG_State &p_rng, uint64_t seed)
 {
-	gEidos_RNG.mt_[0] = seed;
-	for (gEidos_RNG.mti_ = 1; gEidos_RNG.mti_ < Eidos_MT64_NN; gEidos_RNG.mti_++) 
-		gEidos_RNG.mt_[gEidos_RNG.mti_] =  (6364136223846793005ULL * (gEidos_RNG.mt_[gEidos_RNG.mti_ - 1] ^ (gEidos_RNG.mt_[gEidos_RNG.mti_ - 1] >> 62)) + gEidos_RNG.mti_);
+	p_rng.mt_[0] = seed;
+	for (p_rng.mti_ = 1; p_rng.mti_ < Eidos_MT64_NN; p_rng.mti_++) 
+		p_rng.mt_[p_rng.mti_] =  (6364136223846793005ULL * (p_rng.mt_[p_rng.mti_ - 1] ^ (p_rng.mt_[p_rng.mti_ - 1] >> 62)) + p_rng.mti_);
 }
 
 /* initialize by an array with array-length */
 /* init_key is the array for initializing keys */
 /* key_length is its length */
-void Eidos_MT64_init_by_array64(uint64_t init_key[],
+void Eidos_MT64_init_by_array64(Eidos_RNG_State &p_rng, uint64_t init_key[],
 					 uint64_t key_length)
 {
 	uint64_t i, j, k;
-	Eidos_MT64_init_genrand64(19650218ULL);
+	Eidos_MT64_init_genrand64(p_rng, 19650218ULL);
 	i=1; j=0;
 	k = (Eidos_MT64_NN>key_length ? Eidos_MT64_NN : key_length);
 	for (; k; k--) {
-		gEidos_RNG.mt_[i] = (gEidos_RNG.mt_[i] ^ ((gEidos_RNG.mt_[i-1] ^ (gEidos_RNG.mt_[i-1] >> 62)) * 3935559000370003845ULL))
+		p_rng.mt_[i] = (p_rng.mt_[i] ^ ((p_rng.mt_[i-1] ^ (p_rng.mt_[i-1] >> 62)) * 3935559000370003845ULL))
 		+ init_key[j] + j; /* non linear */
 		i++; j++;
-		if (i>=Eidos_MT64_NN) { gEidos_RNG.mt_[0] = gEidos_RNG.mt_[Eidos_MT64_NN-1]; i=1; }
+		if (i>=Eidos_MT64_NN) { p_rng.mt_[0] = p_rng.mt_[Eidos_MT64_NN-1]; i=1; }
 		if (j>=key_length) j=0;
 	}
 	for (k=Eidos_MT64_NN-1; k; k--) {
-		gEidos_RNG.mt_[i] = (gEidos_RNG.mt_[i] ^ ((gEidos_RNG.mt_[i-1] ^ (gEidos_RNG.mt_[i-1] >> 62)) * 2862933555777941757ULL))
+		p_rng.mt_[i] = (p_rng.mt_[i] ^ ((p_rng.mt_[i-1] ^ (p_rng.mt_[i-1] >> 62)) * 2862933555777941757ULL))
 		- i; /* non linear */
 		i++;
-		if (i>=Eidos_MT64_NN) { gEidos_RNG.mt_[0] = gEidos_RNG.mt_[Eidos_MT64_NN-1]; i=1; }
+		if (i>=Eidos_MT64_NN) { p_rng.mt_[0] = p_rng.mt_[Eidos_MT64_NN-1]; i=1; }
 	}
 	
-	gEidos_RNG.mt_[0] = 1ULL << 63; /* MSB is 1; assuring non-zero initial array */ 
+	p_rng.mt_[0] = 1ULL << 63; /* MSB is 1; assuring non-zero initial array */ 
 }
 
 /* BCH: fill the next Eidos_MT64_NN words; used internally by genrand64_int64() */
-void _Eidos_MT64_fill()
+void _Eidos_MT64_fill(Eidos_RNG_State &p_rng)
 {
 	/* generate NN words at one time */
 	/* if init_genrand64() has not been called, */
@@ -175,21 +246,21 @@ void _Eidos_MT64_fill()
 	
 	// In the original code, this would fall back to some default seed value, but we
 	// don't want to allow the RNG to be used without being seeded first.  BCH 5/13/2018
-	if (gEidos_RNG.mti_ == Eidos_MT64_NN+1) 
+	if (p_rng.mti_ == Eidos_MT64_NN+1) 
 		abort(); 
 	
 	for (i=0;i<Eidos_MT64_NN-Eidos_MT64_MM;i++) {
-		x = (gEidos_RNG.mt_[i]&Eidos_MT64_UM)|(gEidos_RNG.mt_[i+1]&Eidos_MT64_LM);
-		gEidos_RNG.mt_[i] = gEidos_RNG.mt_[i+Eidos_MT64_MM] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
+		x = (p_rng.mt_[i]&Eidos_MT64_UM)|(p_rng.mt_[i+1]&Eidos_MT64_LM);
+		p_rng.mt_[i] = p_rng.mt_[i+Eidos_MT64_MM] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
 	}
 	for (;i<Eidos_MT64_NN-1;i++) {
-		x = (gEidos_RNG.mt_[i]&Eidos_MT64_UM)|(gEidos_RNG.mt_[i+1]&Eidos_MT64_LM);
-		gEidos_RNG.mt_[i] = gEidos_RNG.mt_[i+(Eidos_MT64_MM-Eidos_MT64_NN)] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
+		x = (p_rng.mt_[i]&Eidos_MT64_UM)|(p_rng.mt_[i+1]&Eidos_MT64_LM);
+		p_rng.mt_[i] = p_rng.mt_[i+(Eidos_MT64_MM-Eidos_MT64_NN)] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
 	}
-	x = (gEidos_RNG.mt_[Eidos_MT64_NN-1]&Eidos_MT64_UM)|(gEidos_RNG.mt_[0]&Eidos_MT64_LM);
-	gEidos_RNG.mt_[Eidos_MT64_NN-1] = gEidos_RNG.mt_[Eidos_MT64_MM-1] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
+	x = (p_rng.mt_[Eidos_MT64_NN-1]&Eidos_MT64_UM)|(p_rng.mt_[0]&Eidos_MT64_LM);
+	p_rng.mt_[Eidos_MT64_NN-1] = p_rng.mt_[Eidos_MT64_MM-1] ^ (x>>1) ^ mag01[(int)(x&1ULL)];
 	
-	gEidos_RNG.mti_ = 0;
+	p_rng.mti_ = 0;
 }
 
 
@@ -37,9 +37,6 @@
 #include "eidos_globals.h"
 
 
-// This cruft belongs to the 64-bit Mersenne Twister code below; it is up here because we need it to define the global RNG
-// struct and state below.  See below for all the rest of the 64-bit MT code, including copyrights and credits and license.
-uint64_t Eidos_MT64_genrand64_int64(void);
 
 // OK, so.  This header defines the Eidos random number generator, which is now a bit of a weird hybrid.  We need to use
 // the GSL's RNG for most purposes, because we want to use its random distributions and so forth.  However, the taus2
@@ -48,7 +45,12 @@ uint64_t Eidos_MT64_genrand64_int64(void);
 // generators synchronized, in the sense that we always seed them simultaneously with the same seed value.  As long as
 // the user makes the same draws with the same calls, the fact that there are two generators under the hood shouldn't
 // matter.  This struct defines all of the variables associated with both RNGs; this is the complete Eidos RNG state.
-typedef struct
+//
+// An RNG state can also own a set of additional streams, each of which is itself a complete Eidos_RNG_State, for use by
+// worker threads that need to make random draws concurrently.  Stream 0 is always the owning state itself, so code that
+// uses only stream 0 gets exactly the same draws as code that uses the owning state directly.  The other streams are
+// seeded from the owning state's seed whenever it is seeded (see Eidos_RNGStreamSeed()), so they are reproducible too.
+typedef struct Eidos_RNG_State
 {
 	unsigned long int rng_last_seed_;		// unsigned long int is the type used for seeds in the GSL
 	
@@ -62,6 +64,10 @@ typedef struct
 	// random coin-flip generator; based on the MT64 generator now
 	int random_bool_bit_counter_;
 	uint64_t random_bool_bit_buffer_;
+	
+	// additional streams for worker threads; stream_count_ includes stream 0, which is this state, and is 0 if no streams are set up
+	int stream_count_;
+	struct Eidos_RNG_State *streams_;		// buffer of stream_count_ - 1 states, for streams 1 to stream_count_ - 1
 } Eidos_RNG_State;
 
 
@@ -78,10 +84,31 @@ extern Eidos_RNG_State gEidos_RNG;
 // generate a new random number seed from the PID and clock time
 unsigned long int Eidos_GenerateSeedFromPIDAndTime(void);
 
-// set up the random number generator with a given seed
+// set up the random number generator with a given seed; the versions without an Eidos_RNG_State parameter work on gEidos_RNG,
+// and Eidos_InitializeRNG() also sets up gEidosMaxThreads streams for it (see Eidos_InitializeRNGStreams())
 void Eidos_InitializeRNG(void);
+void Eidos_InitializeRNG(Eidos_RNG_State &p_rng);
 void Eidos_FreeRNG(Eidos_RNG_State &p_rng);
 void Eidos_SetRNGSeed(unsigned long int p_seed);
+void Eidos_SetRNGSeed(Eidos_RNG_State &p_rng, unsigned long int p_seed);
+
+// set up p_stream_count independent streams, including stream 0, for p_rng; they are seeded by Eidos_SetRNGSeed(p_rng, ...)
+void Eidos_InitializeRNGStreams(Eidos_RNG_State &p_rng, int p_stream_count);
+
+// derive the seed for stream p_stream_index (> 0) from the seed of its owning state, with the splitmix64 mixing function;
+// consecutive stream indices (and consecutive seeds) thus yield well-separated seeds for the underlying generators
+unsigned long int Eidos_RNGStreamSeed(unsigned long int p_seed, int p_stream_index);
+
+// get a stream of gEidos_RNG by index; this would typically be called with omp_get_thread_num() by a worker thread
+inline __attribute__((always_inline)) Eidos_RNG_State &Eidos_RNGStream(int p_stream_index)
+{
+#if DEBUG
+	if ((p_stream_index < 0) || ((p_stream_index > 0) && (p_stream_index >= gEidos_RNG.stream_count_)))
+		EIDOS_TERMINATION << "ERROR (Eidos_RNGStream): (internal error) RNG stream index out of range." << EidosTerminate(nullptr);
+#endif
+	
+	return (p_stream_index == 0) ? gEidos_RNG : gEidos_RNG.streams_[p_stream_index - 1];
+}
 
 
 // This code is copied and modified from taus.c in the GSL library because we want to be able to inline taus_get().
@@ -179,16 +206,16 @@ inline __attribute__((always_inline)) uint32_t Eidos_rng_uniform_int(gsl_rng *p_
 
 #ifndef USE_GSL_POISSON
 
-static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(double p_mu)
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(gsl_rng *p_r, double p_mu)
 {
 	// Defer to the GSL for large values of mu; see comments above.
 	if (p_mu > 250)
-		return gsl_ran_poisson(EIDOS_GSL_RNG, p_mu);
+		return gsl_ran_poisson(p_r, p_mu);
 	
 	unsigned int x = 0;
 	double p = exp(-p_mu);
 	double s = p;
-	double u = Eidos_rng_uniform(EIDOS_GSL_RNG);
+	double u = Eidos_rng_uniform(p_r);
 	
 	while (u > s)
 	{
@@ -203,11 +230,11 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 }
 
 // This version allows the caller to supply a precalculated exp(-mu) value
-static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(double p_mu, double p_exp_neg_mu)
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(gsl_rng *p_r, double p_mu, double p_exp_neg_mu)
 {
 	// Defer to the GSL for large values of mu; see comments above.
 	if (p_mu > 250)
-		return gsl_ran_poisson(EIDOS_GSL_RNG, p_mu);
+		return gsl_ran_poisson(p_r, p_mu);
 	
 	// Test consistency; normally this is commented out
 	//if (p_exp_neg_mu != exp(-p_mu))
@@ -216,7 +243,7 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 	unsigned int x = 0;
 	double p = p_exp_neg_mu;
 	double s = p;
-	double u = Eidos_rng_uniform(EIDOS_GSL_RNG);
+	double u = Eidos_rng_uniform(p_r);
 	
 	while (u > s)
 	{
@@ -231,7 +258,7 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 }
 
 // This version specifies that the count is guaranteed not to be zero; zero has been ruled out by a previous test
-static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson_NONZERO(double p_mu, double p_exp_neg_mu)
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson_NONZERO(gsl_rng *p_r, double p_mu, double p_exp_neg_mu)
 {
 	// Defer to the GSL for large values of mu; see comments above.
 	if (p_mu > 250)
@@ -240,7 +267,7 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 		
 		do
 		{
-			result = gsl_ran_poisson(EIDOS_GSL_RNG, p_mu);
+			result = gsl_ran_poisson(p_r, p_mu);
 		}
 		while (result == 0);
 		
@@ -254,7 +281,7 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 	unsigned int x = 0;
 	double p = p_exp_neg_mu;
 	double s = p;
-	double u = Eidos_rng_uniform_pos(EIDOS_GSL_RNG);	// exclude 0.0 so u != s after rescaling
+	double u = Eidos_rng_uniform_pos(p_r);	// exclude 0.0 so u != s after rescaling
 	
 	// rescale u so that (u > s) is true in the first round
 	u = u * (1.0 - s) + s;
@@ -276,6 +303,22 @@ static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisso
 	return x;
 }
 
+// These versions draw from the main stream, gEidos_RNG; most callers use these
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(double p_mu)
+{
+	return Eidos_FastRandomPoisson(EIDOS_GSL_RNG, p_mu);
+}
+
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson(double p_mu, double p_exp_neg_mu)
+{
+	return Eidos_FastRandomPoisson(EIDOS_GSL_RNG, p_mu, p_exp_neg_mu);
+}
+
+static inline __attribute__((always_inline)) unsigned int Eidos_FastRandomPoisson_NONZERO(double p_mu, double p_exp_neg_mu)
+{
+	return Eidos_FastRandomPoisson_NONZERO(EIDOS_GSL_RNG, p_mu, p_exp_neg_mu);
+}
+
 double Eidos_FastRandomPoisson_PRECALCULATE(double p_mu);	// exp(-mu); can underflow to zero, in which case the GSL will be used
 
 
@@ -354,22 +397,22 @@ double Eidos_FastRandomPoisson_PRECALCULATE(double p_mu);	// exp(-mu); can under
 #define Eidos_MT64_LM 0x7FFFFFFFULL /* Least significant 31 bits */
 
 /* initializes mt[NN] with a seed */
-void Eidos_MT64_init_genrand64(uint64_t seed);
+void Eidos_MT64_init_genrand64(Eidos_RNG_State &p_rng, uint64_t seed);
 
 /* initialize by an array with array-length */
-void Eidos_MT64_init_by_array64(uint64_t init_key[], uint64_t key_length);
+void Eidos_MT64_init_by_array64(Eidos_RNG_State &p_rng, uint64_t init_key[], uint64_t key_length);
 
 /* BCH: fill the next Eidos_MT64_NN words; used internally by genrand64_int64() */
-void _Eidos_MT64_fill();
+void _Eidos_MT64_fill(Eidos_RNG_State &p_rng);
 
 /* generates a random number on [0, 2^64-1]-interval */
-inline __attribute__((always_inline)) uint64_t Eidos_MT64_genrand64_int64(void)
+inline __attribute__((always_inline)) uint64_t Eidos_MT64_genrand64_int64(Eidos_RNG_State &p_rng)
 {
 	/* generate NN words at one time */
-	if (gEidos_RNG.mti_ >= Eidos_MT64_NN)
-		_Eidos_MT64_fill();
+	if (p_rng.mti_ >= Eidos_MT64_NN)
+		_Eidos_MT64_fill(p_rng);
 	
-	uint64_t x = gEidos_RNG.mt_[gEidos_RNG.mti_++];
+	uint64_t x = p_rng.mt_[p_rng.mti_++];
 	
 	x ^= (x >> 29) & 0x5555555555555555ULL;
 	x ^= (x << 17) & 0x71D67FFFEDA60000ULL;
@@ -380,31 +423,31 @@ inline __attribute__((always_inline)) uint64_t Eidos_MT64_genrand64_int64(void)
 }
 
 /* generates a random number on [0, 2^63-1]-interval */
-inline __attribute__((always_inline)) int64_t Eidos_MT64_genrand64_int63(void)
+inline __attribute__((always_inline)) int64_t Eidos_MT64_genrand64_int63(Eidos_RNG_State &p_rng)
 {
-	return (int64_t)(Eidos_MT64_genrand64_int64() >> 1);
+	return (int64_t)(Eidos_MT64_genrand64_int64(p_rng) >> 1);
 }
 
 /* generates a random number on [0,1]-real-interval */
-inline __attribute__((always_inline)) double Eidos_MT64_genrand64_real1(void)
+inline __attribute__((always_inline)) double Eidos_MT64_genrand64_real1(Eidos_RNG_State &p_rng)
 {
-	return (Eidos_MT64_genrand64_int64() >> 11) * (1.0/9007199254740991.0);
+	return (Eidos_MT64_genrand64_int64(p_rng) >> 11) * (1.0/9007199254740991.0);
 }
 
 /* generates a random number on [0,1)-real-interval */
-inline __attribute__((always_inline)) double Eidos_MT64_genrand64_real2(void)
+inline __attribute__((always_inline)) double Eidos_MT64_genrand64_real2(Eidos_RNG_State &p_rng)
 {
-	return (Eidos_MT64_genrand64_int64() >> 11) * (1.0/9007199254740992.0);
+	return (Eidos_MT64_genrand64_int64(p_rng) >> 11) * (1.0/9007199254740992.0);
 }
 
 /* generates a random number on (0,1)-real-interval */
-inline __attribute__((always_inline)) double Eidos_MT64_genrand64_real3(void)
+inline __attribute__((always_inline)) double Eidos_MT64_genrand64_real3(Eidos_RNG_State &p_rng)
 {
-	return ((Eidos_MT64_genrand64_int64() >> 12) + 0.5) * (1.0/4503599627370496.0);
+	return ((Eidos_MT64_genrand64_int64(p_rng) >> 12) + 0.5) * (1.0/4503599627370496.0);
 }
 
 /* BCH: generates a random integer in [0, p_n - 1]; parallel to Eidos_rng_uniform_int() above */
-inline __attribute__((always_inline)) uint64_t Eidos_rng_uniform_int_MT64(uint64_t p_n)
+inline __attribute__((always_inline)) uint64_t Eidos_rng_uniform_int_MT64(Eidos_RNG_State &p_rng, uint64_t p_n)
 {
 	// OK, so.  The GSL's uniform int method, whose logic we replicate in Eidos_rng_uniform_int(), makes sure
 	// that the probability of each integer is exactly equal by figuring out a scaling, and then looping on
@@ -415,9 +458,17 @@ inline __attribute__((always_inline)) uint64_t Eidos_rng_uniform_int_MT64(uint64
 	// in anywhere near the full range of the generator; we just need a couple of orders of magnitude more
 	// headroom than UINT32_MAX provides.  If we start to use this for a wider range of p_n (such as making it
 	// available in the Eidos APIs), this decision would need to be revisited.  BCH 12 May 2018
-	return Eidos_MT64_genrand64_int64() % p_n;
+	return Eidos_MT64_genrand64_int64(p_rng) % p_n;
 }
 
+/* BCH: versions of the above that use the main stream, gEidos_RNG */
+inline __attribute__((always_inline)) uint64_t Eidos_MT64_genrand64_int64(void) { return Eidos_MT64_genrand64_int64(gEidos_RNG); }
+inline __attribute__((always_inline)) int64_t Eidos_MT64_genrand64_int63(void) { return Eidos_MT64_genrand64_int63(gEidos_RNG); }
+inline __attribute__((always_inline)) double Eidos_MT64_genrand64_real1(void) { return Eidos_MT64_genrand64_real1(gEidos_RNG); }
+inline __attribute__((always_inline)) double Eidos_MT64_genrand64_real2(void) { return Eidos_MT64_genrand64_real2(gEidos_RNG); }
+inline __attribute__((always_inline)) double Eidos_MT64_genrand64_real3(void) { return Eidos_MT64_genrand64_real3(gEidos_RNG); }
+inline __attribute__((always_inline)) uint64_t Eidos_rng_uniform_int_MT64(uint64_t p_n) { return Eidos_rng_uniform_int_MT64(gEidos_RNG, p_n); }
+
 
 #pragma mark -
 #pragma mark Random coin-flips
@@ -428,27 +479,32 @@ inline __attribute__((always_inline)) uint64_t Eidos_rng_uniform_int_MT64(uint64
 
 // optimization of this is possible assuming each bit returned by the RNG is independent and usable as a random boolean.
 // the independence of all 64 bits seems to be a solid assumption for the MT64 generator, as far as I can tell.
-static inline __attribute__((always_inline)) bool Eidos_RandomBool()
+static inline __attribute__((always_inline)) bool Eidos_RandomBool(Eidos_RNG_State &p_rng)
 {
 	bool retval;
 	
-	if (gEidos_RNG.random_bool_bit_counter_ > 0)
+	if (p_rng.random_bool_bit_counter_ > 0)
 	{
-		gEidos_RNG.random_bool_bit_counter_--;
-		gEidos_RNG.random_bool_bit_buffer_ >>= 1;
-		retval = gEidos_RNG.random_bool_bit_buffer_ & 0x01;
+		p_rng.random_bool_bit_counter_--;
+		p_rng.random_bool_bit_buffer_ >>= 1;
+		retval = p_rng.random_bool_bit_buffer_ & 0x01;
 	}
 	else
 	{
-		gEidos_RNG.random_bool_bit_buffer_ = Eidos_MT64_genrand64_int64();	// MT64 provides 64 independent bits
-		gEidos_RNG.random_bool_bit_counter_ = 63;				// 64 good bits originally, and we're about to use one
+		p_rng.random_bool_bit_buffer_ = Eidos_MT64_genrand64_int64(p_rng);	// MT64 provides 64 independent bits
+		p_rng.random_bool_bit_counter_ = 63;				// 64 good bits originally, and we're about to use one
 		
-		retval = gEidos_RNG.random_bool_bit_buffer_ & 0x01;
+		retval = p_rng.random_bool_bit_buffer_ & 0x01;
 	}
 	
 	return retval;
 }
 
+static inline __attribute__((always_inline)) bool Eidos_RandomBool()
+{
+	return Eidos_RandomBool(gEidos_RNG);
+}
+
 
 #endif /* defined(__Eidos__eidos_rng__) */
 
@@ -174,6 +174,17 @@ public:
 	inline __attribute__((always_inline)) EidosValue *GetValueRawOrRaiseForASTNode(const EidosASTNode *p_symbol_node) const { return _GetValue_RAW(p_symbol_node->cached_stringID_, p_symbol_node->token_); }
 	inline __attribute__((always_inline)) EidosValue *GetValueRawOrRaiseForSymbol(EidosGlobalStringID p_symbol_name) const { return _GetValue_RAW(p_symbol_name, nullptr); }
 	
+	// Non-raising variants used by the bytecode VM, which falls back to the tree-walking evaluators when a symbol is undefined.
+	// GetValueRawOrNullForSymbol() searches the chain like the getters above; GetVariableRawOrNullForSymbol() finds only variables
+	// defined in this table itself, and is used to modify a variable's value in place for assignment.
+	EidosValue *GetValueRawOrNullForSymbol(EidosGlobalStringID p_symbol_name) const;
+	inline __attribute__((always_inline)) EidosValue *GetVariableRawOrNullForSymbol(EidosGlobalStringID p_symbol_name) const
+	{
+		if ((table_type_ == EidosSymbolTableType::kVariablesTable) && (p_symbol_name < capacity_))
+			return slots_[p_symbol_name].symbol_value_SP_.get();
+		return nullptr;
+	}
+	
 	// Special getters that return a boolean flag, true if the fetched symbol is a constant
 	inline __attribute__((always_inline)) EidosValue_SP GetValueOrRaiseForASTNode_IsConst(const EidosASTNode *p_symbol_node, bool *p_is_const) const { return _GetValue_IsConst(p_symbol_node->cached_stringID_, p_symbol_node->token_, p_is_const); }
 	inline __attribute__((always_inline)) EidosValue_SP GetValueOrRaiseForSymbol_IsConst(EidosGlobalStringID p_symbol_name, bool *p_is_const) const { return _GetValue_IsConst(p_symbol_name, nullptr, p_is_const); }
@@ -276,6 +276,7 @@ static void _RunMethodTests(void);
 static void _RunCodeExampleTests(void);
 static void _RunUserDefinedFunctionTests(void);
 static void _RunVoidEidosValueTests(void);
+static void _RunRNGStreamTests(void);
 
 
 int RunEidosTests(void)
@@ -364,6 +365,7 @@ int RunEidosTests(void)
 	_RunCodeExampleTests();
 	_RunUserDefinedFunctionTests();
 	_RunVoidEidosValueTests();
+	_RunRNGStreamTests();
 	
 	// ************************************************************************************
 	//
@@ -1402,6 +1404,25 @@ void _RunSymbolsAndVariablesTests(void)
 	EidosAssertScriptSuccess("x = 1:5; y = x; y[1] = 0; x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 2, 3, 4, 5}));
 	EidosAssertScriptSuccess("x = 1:5; y = x; y[1] = 0; y;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 0, 3, 4, 5}));
 	EidosAssertScriptSuccess("for (i in 1:3) { x = 1:5; x[1] = x[1] + 1; } x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 3, 3, 4, 5}));
+	EidosAssertScriptSuccess("x = 1:5; for (i in 0:4) x[i] = x[i] * 2; x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{2, 4, 6, 8, 10}));
+	EidosAssertScriptRaise("x = 1:5; x[5] = 0;", 10, "out-of-range index");
+	
+	// in-place appends and operator results must not be visible through other references to the same values
+	EidosAssertScriptSuccess("x = 1:3; y = x; x = c(x, 4); x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 2, 3, 4}));
+	EidosAssertScriptSuccess("x = 1:3; y = x; x = c(x, 4); y;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 2, 3}));
+	EidosAssertScriptSuccess("x = NULL; for (i in 1:5) x = c(x, i, NULL); x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 2, 3, 4, 5}));
+	EidosAssertScriptSuccess("x = 1:3; x = c(x, x); x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 2, 3, 1, 2, 3}));
+	EidosAssertScriptSuccess("x = c(1.5, 2.5); x = c(x, 3, T); x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{1.5, 2.5, 3.0, 1.0}));
+	EidosAssertScriptSuccess("x = 1:3; x = c(x, 4.5); x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{1.0, 2.0, 3.0, 4.5}));
+	EidosAssertScriptSuccess("x = c('a', 'b'); x = c(x, 1, T); x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_vector{"a", "b", "1", "T"}));
+	EidosAssertScriptSuccess("x = c(T, F); x = c(x, T); x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Logical{true, false, true}));
+	EidosAssertScriptSuccess("x = c(_Test(2), _Test(3)); x = c(x, _Test(4)); x._yolk;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{2, 3, 4}));
+	EidosAssertScriptSuccess("x = matrix(1:4, nrow=2); x = c(x, 5); dim(x);", gStaticEidosValueNULL);
+	EidosAssertScriptSuccess("x = c(c(1, 2), 3); x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 2, 3}));
+	EidosAssertScriptRaise("x = 1:3; x = c(x, _Test(1));", 13, "cannot be mixed");
+	EidosAssertScriptSuccess("a = c(1.0, 2.0, 3.0); b = (a + 1.0) * 2.0 - a; a;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{1.0, 2.0, 3.0}));
+	EidosAssertScriptSuccess("a = c(1.0, 2.0, 3.0); b = (a + 1.0) * 2.0 - a; b;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{3.0, 4.0, 5.0}));
+	EidosAssertScriptSuccess("a = 1:3; b = -(a * 2) + a; c(a, b);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{1, 2, 3, -1, -2, -3}));
 }
 
 #pragma mark parsing
@@ -1657,6 +1678,9 @@ void _RunOperatorPlusTests1(void)
 	EidosAssertScriptRaise("5e18 + c(0, 0, 5e18, 0);", 5, "overflow with the binary");
 	EidosAssertScriptRaise("c(0, 0, 5e18, 0) + 5e18;", 17, "overflow with the binary");
 	EidosAssertScriptRaise("c(0, 0, 5e18, 0) + c(0, 0, 5e18, 0);", 17, "overflow with the binary");
+	EidosAssertScriptRaise("x = rep(0, 37); x[33] = 5e18; x + 5e18;", 32, "overflow with the binary");
+	EidosAssertScriptRaise("x = rep(0, 37); x[33] = 5e18; x + x;", 32, "overflow with the binary");
+	EidosAssertScriptSuccess("identical(rep(4611686018427387904, 37) + rep(4611686018427387903, 37), rep(9223372036854775807, 37));", gStaticEidosValue_LogicalT);
 #endif
 	
 	// operator +: test with mixed singletons, vectors, matrices, and arrays; the dimensionality code is shared across all operand types, so testing it with integer should suffice
@@ -1957,7 +1981,7 @@ void _RunOperatorPlusTests2(void)
 	EidosAssertScriptRaise("identical(array(1:6,c(1,2,3)) + array(1:6,c(3,2,1)), array(2:7, c(1,2,3)));", 30, "non-conformable");
 }
 
-#pragma mark operator −
+#pragma mark operator -
 void _RunOperatorMinusTests(void)
 {
 	// operator -
@@ -2011,6 +2035,10 @@ void _RunOperatorMinusTests(void)
 	EidosAssertScriptRaise("-5e18 - c(0, 0, 5e18, 0);", 6, "overflow with the binary");
 	EidosAssertScriptRaise("c(0, 0, -5e18, 0) - 5e18;", 18, "overflow with the binary");
 	EidosAssertScriptRaise("c(0, 0, -5e18, 0) - c(0, 0, 5e18, 0);", 18, "overflow with the binary");
+	EidosAssertScriptRaise("-c(rep(10, 36), -9223372036854775807 - 1);", 0, "overflow with the unary");
+	EidosAssertScriptRaise("x = rep(0, 37); x[33] = -5e18; x - 5e18;", 33, "overflow with the binary");
+	EidosAssertScriptRaise("x = rep(0, 37); x[33] = -5e18; 5e18 - x;", 36, "overflow with the binary");
+	EidosAssertScriptSuccess("identical(-5 - rep(-9223372036854775807, 37), rep(9223372036854775802, 37));", gStaticEidosValue_LogicalT);
 #endif
 	
 	// operator -: test with mixed singletons, vectors, matrices, and arrays; the dimensionality code is shared across all operand types, so testing it with integer should suffice
@@ -2130,6 +2158,8 @@ void _RunOperatorDivTests(void)
 	EidosAssertScriptRaise("/T;", 0, "unexpected token");
     EidosAssertScriptSuccess("3/4/5;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(0.15)));
 	EidosAssertScriptSuccess("6/0;", gStaticEidosValue_FloatINF);
+	EidosAssertScriptSuccess("x = runif(37); y = runif(37); identical(x / y, sapply(0:36, 'x[applyValue] / y[applyValue];'));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = runif(37); identical(3.5 / x, sapply(x, '3.5 / applyValue;')) & identical(x / 3.5, sapply(x, 'applyValue / 3.5;'));", gStaticEidosValue_LogicalT);
 	
 	// operator /: test with mixed singletons, vectors, matrices, and arrays; the dimensionality code is shared across all operand types, so testing it with integer should suffice
 	EidosAssertScriptSuccess("identical(5 / matrix(2), matrix(2.5));", gStaticEidosValue_LogicalT);
@@ -2601,6 +2631,24 @@ void _RunOperatorAssignTests(void)
 	EidosAssertScriptRaise("x = 5e18; x = x * 2;", 16, "multiplication overflow");
 	EidosAssertScriptRaise("x = c(5e18, 0); x = x * 2;", 22, "multiplication overflow");
 #endif
+	
+	// scalar expressions compiled to bytecode, including in-place assignment and fallback to the tree-walking evaluators
+	EidosAssertScriptSuccess("x = 3; y = 2.5; z = x * 2 + y / 5 - -1; z;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(7.5)));
+	EidosAssertScriptSuccess("x = 3; z = (x * 2 + 1) % 4; z;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(3.0)));
+	EidosAssertScriptSuccess("x = 3; y = x; x = x * 2 + 1; c(x, y);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{7, 3}));
+	EidosAssertScriptSuccess("x = 3; x = x * 2 + 0.5; x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(6.5)));
+	EidosAssertScriptSuccess("x = 1:3; y = 2; x = x * y + 1; x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{3, 5, 7}));
+	EidosAssertScriptSuccess("x = T; y = 5; for (i in 1:3) x = (y > i) & !(i == 2); x;", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = 0; for (i in 1:10) { y = i * 2; x = x + y - 1; } x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(100)));
+	EidosAssertScriptSuccess("x = 0.0; i = 0; while (i < 5 & x >= 0.0) { i = i + 1; x = x + i / 2; } c(x, i);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{7.5, 5.0}));
+	EidosAssertScriptSuccess("x = NAN; y = x == x; y;", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = 1:2; y = 3; for (i in 0:1) z = x * y + i; z;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{4, 7}));
+	EidosAssertScriptSuccess("x = 1:2; for (i in 1:40) x = x * 1 + i; x;", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_vector{821, 822}));
+	EidosAssertScriptRaise("x = 5e18; y = 2; z = x * y + 1;", 23, "multiplication overflow");
+	EidosAssertScriptRaise("x = NAN; y = !x;", 13, "cannot be converted");
+	EidosAssertScriptRaise("x = T; y = x + 1;", 13, "is not supported by the");
+	EidosAssertScriptRaise("y = undefined_var * 2 + 1;", 4, "undefined identifier");
+	EidosAssertScriptRaise("defineConstant('Q', 3); x = 2; Q = x * 2 + 1;", 33, "cannot be redefined because it is a constant");
 }
 
 #pragma mark operator >
@@ -4191,6 +4239,7 @@ void _RunFunctionMathTests_g_through_r(void)
 	EidosAssertScriptSuccess("log(float(0));", gStaticEidosValue_Float_ZeroVec);
 	EidosAssertScriptRaise("log(string(0));", 0, "cannot be type");
 	EidosAssertScriptSuccess("log(NAN);", gStaticEidosValue_FloatNAN);
+	EidosAssertScriptSuccess("x = runif(37); identical(log(x), sapply(x, 'log(applyValue);')) & identical(exp(x), sapply(x, 'exp(applyValue);'));", gStaticEidosValue_LogicalT);
 	
 	EidosAssertScriptSuccess("identical(log(matrix(0.5)), matrix(log(0.5)));", gStaticEidosValue_LogicalT);
 	EidosAssertScriptSuccess("identical(log(matrix(c(0.1, 0.2, 0.3))), matrix(log(c(0.1, 0.2, 0.3))));", gStaticEidosValue_LogicalT);
@@ -4781,6 +4830,8 @@ void _RunFunctionMathTests_s_through_z(void)
 	EidosAssertScriptSuccess("sqrt(64.0);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(8)));
 	EidosAssertScriptSuccess("isNAN(sqrt(-64.0));", gStaticEidosValue_LogicalT);
 	EidosAssertScriptSuccess("sqrt(c(4.0, -16.0, 9.0, 1024.0));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{2, NAN, 3, 32}));
+	EidosAssertScriptSuccess("x = sqrt(c(rep(4.0, 36), -1.0)); all(x[0:35] == 2.0) & isNAN(x[36]);", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = runif(37); identical(sqrt(x), sapply(x, 'sqrt(applyValue);'));", gStaticEidosValue_LogicalT);
 	EidosAssertScriptRaise("sqrt(T);", 0, "cannot be type");
 	EidosAssertScriptRaise("sqrt('foo');", 0, "cannot be type");
 	EidosAssertScriptRaise("sqrt(_Test(7));", 0, "cannot be type");
@@ -4799,6 +4850,9 @@ void _RunFunctionMathTests_s_through_z(void)
 	EidosAssertScriptSuccess("sum(-5);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(-5)));
 	EidosAssertScriptSuccess("sum(c(-2, 7, -18, 12));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(-1)));
 	EidosAssertScriptSuccess("sum(c(200000000, 3000000000000));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(3000200000000)));
+	EidosAssertScriptSuccess("sum(rep(4611686018427387903, 2));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(9223372036854775806LL)));
+	EidosAssertScriptSuccess("sum(c(9223372036854775807, -9223372036854775807, 5));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Int_singleton(5)));
+	EidosAssertScriptSuccess("x = sample(-1000:1000, 37, T); sum(x) == sum(asFloat(x));", gStaticEidosValue_LogicalT);
 #if EIDOS_HAS_OVERFLOW_BUILTINS
 	EidosAssertScriptSuccess("sum(rep(3000000000000000000, 100));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_singleton(3e20)));
 #endif
@@ -5116,6 +5170,8 @@ void _RunFunctionStatisticsTests(void)
 	EidosAssertScriptSuccess("pmin(c(1.,-INF,7.,INF, NAN, NAN), 5.);", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_Float_vector{1, -std::numeric_limits<double>::infinity(), 5, 5, std::numeric_limits<double>::quiet_NaN(), std::numeric_limits<double>::quiet_NaN()}));
 	EidosAssertScriptSuccess("pmin('baz', c('bar','baz','xyzzy','bar'));", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_vector{"bar", "baz", "baz", "bar"}));
 	EidosAssertScriptSuccess("pmin(c('foo','bar','xyzzy',''), 'baz');", EidosValue_SP(new (gEidosValuePool->AllocateChunk()) EidosValue_String_vector{"baz", "bar", "baz", ""}));
+	EidosAssertScriptSuccess("x = rnorm(37); y = rnorm(37); identical(pmin(x, y), sapply(0:36, 'min(x[applyValue], y[applyValue]);')) & identical(pmax(x, 0.0), sapply(x, 'max(applyValue, 0.0);'));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = sample(-100:100, 37, T); y = sample(-100:100, 37, T); identical(pmax(x, y), sapply(0:36, 'max(x[applyValue], y[applyValue]);')) & identical(pmin(x, 7), sapply(x, 'min(applyValue, 7);'));", gStaticEidosValue_LogicalT);
 	
 	EidosAssertScriptSuccess("identical(pmin(5, 3:7), c(3,4,5,5,5));", gStaticEidosValue_LogicalT);
 	EidosAssertScriptSuccess("identical(pmin(3:7, 5), c(3,4,5,5,5));", gStaticEidosValue_LogicalT);
@@ -5240,6 +5296,8 @@ void _RunFunctionDistributionTests(void)
 	EidosAssertScriptRaise("dnorm(1.0, c(-10, 10, 1), 100.0);", 0, "requires mean to be");
 	EidosAssertScriptRaise("dnorm(1.0, 10.0, c(0.1, 10, 1));", 0, "requires sd to be");
 	EidosAssertScriptSuccess("dnorm(NAN);", gStaticEidosValue_FloatNAN);
+	EidosAssertScriptSuccess("x = rnorm(37); identical(dnorm(x, 0.5, 2.0), sapply(x, 'dnorm(applyValue, 0.5, 2.0);'));", gStaticEidosValue_LogicalT);
+	EidosAssertScriptSuccess("x = rnorm(37); m = rnorm(37); identical(dnorm(x, m, 2.0), sapply(0:36, 'dnorm(x[applyValue], m[applyValue], 2.0);'));", gStaticEidosValue_LogicalT);
 	
 	// pnorm()
 	EidosAssertScriptSuccess("pnorm(float(0));", gStaticEidosValue_Float_ZeroVec);
@@ -7852,64 +7910,70 @@ void _RunVoidEidosValueTests(void)
 	EidosAssertScriptRaise("for (x in citation()) T;", 0, "does not allow void");
 }
 
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
+#pragma mark RNG streams
+void _RunRNGStreamTests(void)
+{
+	// Stream 0 of an RNG state with multiple streams must produce exactly the same draws as an RNG state without streams,
+	// while the other streams must be independent of stream 0 and of each other, and reproducible from the seed
+	Eidos_RNG_State single_rng, multi_rng;
+	const int draw_count = 1000;
+	std::vector<uint64_t> single_draws, stream_draws[3];
+	
+	EIDOS_BZERO(&single_rng, sizeof(Eidos_RNG_State));
+	EIDOS_BZERO(&multi_rng, sizeof(Eidos_RNG_State));
+	
+	Eidos_InitializeRNG(single_rng);
+	Eidos_SetRNGSeed(single_rng, 10);
+	
+	Eidos_InitializeRNG(multi_rng);
+	Eidos_InitializeRNGStreams(multi_rng, 3);
+	Eidos_SetRNGSeed(multi_rng, 10);
+	
+	for (int draw_index = 0; draw_index < draw_count; ++draw_index)
+	{
+		single_draws.push_back(Eidos_rng_uniform_int(single_rng.gsl_rng_, 1000000));
+		single_draws.push_back(Eidos_MT64_genrand64_int64(single_rng));
+		single_draws.push_back(Eidos_RandomBool(single_rng));
+#ifndef USE_GSL_POISSON
+		single_draws.push_back(Eidos_FastRandomPoisson(single_rng.gsl_rng_, 2.5));
+#endif
+	}
+	
+	for (int stream_index = 0; stream_index < 3; ++stream_index)
+	{
+		Eidos_RNG_State &stream = ((stream_index == 0) ? multi_rng : multi_rng.streams_[stream_index - 1]);
+		
+		for (int draw_index = 0; draw_index < draw_count; ++draw_index)
+		{
+			stream_draws[stream_index].push_back(Eidos_rng_uniform_int(stream.gsl_rng_, 1000000));
+			stream_draws[stream_index].push_back(Eidos_MT64_genrand64_int64(stream));
+			stream_draws[stream_index].push_back(Eidos_RandomBool(stream));
+#ifndef USE_GSL_POISSON
+			stream_draws[stream_index].push_back(Eidos_FastRandomPoisson(stream.gsl_rng_, 2.5));
+#endif
+		}
+	}
+	
+	Eidos_RNG_State &stream_2_again = multi_rng.streams_[1];
+	std::vector<uint64_t> stream_2_redraws;
+	
+	Eidos_SetRNGSeed(multi_rng, 10);
+	
+	for (int draw_index = 0; draw_index < draw_count; ++draw_index)
+	{
+		stream_2_redraws.push_back(Eidos_rng_uniform_int(stream_2_again.gsl_rng_, 1000000));
+		stream_2_redraws.push_back(Eidos_MT64_genrand64_int64(stream_2_again));
+		stream_2_redraws.push_back(Eidos_RandomBool(stream_2_again));
+#ifndef USE_GSL_POISSON
+		stream_2_redraws.push_back(Eidos_FastRandomPoisson(stream_2_again.gsl_rng_, 2.5));
+#endif
+	}
+	
+	if (stream_draws[0] == single_draws) gEidosTestSuccessCount++; else { gEidosTestFailureCount++; std::cerr << "RNG stream 0 : " << EIDOS_OUTPUT_FAILURE_TAG << " : draws do not match an RNG without streams" << std::endl; }
+	if (stream_draws[1] != stream_draws[0]) gEidosTestSuccessCount++; else { gEidosTestFailureCount++; std::cerr << "RNG stream 1 : " << EIDOS_OUTPUT_FAILURE_TAG << " : draws match stream 0" << std::endl; }
+	if (stream_draws[2] != stream_draws[1]) gEidosTestSuccessCount++; else { gEidosTestFailureCount++; std::cerr << "RNG stream 2 : " << EIDOS_OUTPUT_FAILURE_TAG << " : draws match stream 1" << std::endl; }
+	if (stream_2_redraws == stream_draws[2]) gEidosTestSuccessCount++; else { gEidosTestFailureCount++; std::cerr << "RNG stream 2 : " << EIDOS_OUTPUT_FAILURE_TAG << " : draws are not reproducible after reseeding" << std::endl; }
+	
+	Eidos_FreeRNG(single_rng);
+	Eidos_FreeRNG(multi_rng);
+}